@@ -0,0 +1,95 @@
+/**
+ * Learned index against the B+ tree on monotonic integer keys, the shape of an id
+ * column like account.id in sql_gen.
+ *
+ * Usage: learned_index_benchmark [keys] [lookups]
+ *
+ * Both indexes are filled with the same ids in increasing order, then probed with the
+ * same random ids. The B+ tree footprint is the pages it allocated, the learned index
+ * footprint is what it holds in memory.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "common/instance.h"
+#include "index/b_plus_tree_index.h"
+#include "index/learned_index.h"
+#include "page/disk_file_meta_page.h"
+
+namespace {
+Row MakeKey(int32_t value) {
+  std::vector<Field> fields;
+  fields.emplace_back(TypeId::kTypeInt, value);
+  return Row(fields);
+}
+
+uint32_t AllocatedPages(DBStorageEngine &engine) {
+  return reinterpret_cast<DiskFileMetaPage *>(engine.disk_mgr_->GetMetaData())->GetAllocatedPages();
+}
+
+/** @return nanoseconds per lookup */
+double TimeLookups(const char *name, Index *index, const std::vector<int32_t> &probes) {
+  std::vector<RowId> result;
+  size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto id : probes) {
+    result.clear();
+    found += index->ScanKey(MakeKey(id), result, nullptr) == DB_SUCCESS;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  if (found != probes.size()) {
+    fprintf(stderr, "%s: %zu of %zu ids not found\n", name, probes.size() - found,
+            probes.size());
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() / probes.size();
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  int keys = argc > 1 ? atoi(argv[1]) : 200000;
+  int lookups = argc > 2 ? atoi(argv[2]) : 100000;
+
+  DBStorageEngine engine("learned_index_benchmark.db");
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+
+  // ids with occasional gaps, as left by rolled back inserts
+  std::mt19937 rng(42);
+  std::vector<int32_t> ids;
+  int32_t id = 0;
+  for (int i = 0; i < keys; i++) {
+    id += 1 + (rng() % 16 == 0 ? rng() % 100 : 0);
+    ids.push_back(id);
+  }
+  std::vector<int32_t> probes;
+  for (int i = 0; i < lookups; i++) {
+    probes.push_back(ids[rng() % ids.size()]);
+  }
+
+  uint32_t pages_before = AllocatedPages(engine);
+  BPlusTreeIndex b_plus_tree(0, key_schema, 16, engine.bpm_);
+  LearnedIndex learned(1, key_schema);
+  for (int i = 0; i < keys; i++) {
+    b_plus_tree.InsertEntry(MakeKey(ids[i]), RowId(i), nullptr);
+    learned.InsertEntry(MakeKey(ids[i]), RowId(i), nullptr);
+  }
+  learned.Retrain();
+  size_t b_plus_tree_bytes = static_cast<size_t>(AllocatedPages(engine) - pages_before) * PAGE_SIZE;
+
+  double b_plus_tree_ns = TimeLookups("bptree", &b_plus_tree, probes);
+  double learned_ns = TimeLookups("learned", &learned, probes);
+
+  printf("%d keys, %d lookups\n", keys, lookups);
+  printf("%-10s %14s %14s\n", "index", "bytes", "ns/lookup");
+  printf("%-10s %14zu %14.1f\n", "bptree", b_plus_tree_bytes, b_plus_tree_ns);
+  printf("%-10s %14zu %14.1f\n", "learned", learned.GetMemoryUsage(), learned_ns);
+  printf("learned model: %zu spline points\n", learned.GetSplinePointCount());
+
+  b_plus_tree.Destroy();
+  delete key_schema;
+  return 0;
+}
@@ -28,6 +28,7 @@ BufferPoolManager::~BufferPoolManager()
 
 Page *BufferPoolManager::FetchPage(page_id_t page_id)
 {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     // 1.     Search the page table for the requested page (P).
     // 1.1    If P exists, pin it and return it immediately.
     // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -36,14 +37,12 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id)
     // 3.     Delete R from the page table and insert P.
     // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
 
-    for (auto p : page_table_)
+    auto it = page_table_.find(page_id);
+    if (it != page_table_.end())
     {
-        if (p.first == page_id)
-        {
-            pages_[p.second].pin_count_++;
-            replacer_->Pin(p.second);
-            return pages_ + p.second;
-        }
+        pages_[it->second].pin_count_++;
+        replacer_->Pin(it->second);
+        return pages_ + it->second;
     }
 
     frame_id_t frame_id = INVALID_FRAME_ID;
@@ -75,22 +74,13 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id)
 
 Page *BufferPoolManager::NewPage(page_id_t &page_id)
 {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     // 0.   Make sure you call AllocatePage!
     // 1.   If all the pages in the buffer pool are pinned, return nullptr.
     // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
     // 3.   Update P's metadata, zero out memory and add P to the page table.
     // 4.   Set the page ID output parameter. Return a pointer to P.
-    int i = 0;
-    bool no_pool = true;
-    for (; i < pool_size_; i++)
-    {
-        if (pages_[i].pin_count_ == 0)
-        {
-            no_pool = false;
-            break;
-        }
-    }
-    if (no_pool)
+    if (free_list_.empty() && replacer_->Size() == 0)
         return nullptr;
 
     page_id = disk_manager_->AllocatePage();
@@ -122,6 +112,7 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id)
 
 bool BufferPoolManager::DeletePage(page_id_t page_id)
 {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     // 0.   Make sure you call DeallocatePage!
     // 1.   Search the page table for the requested page (P).
     // 1.   If P does not exist, return true.
@@ -129,11 +120,18 @@ bool BufferPoolManager::DeletePage(page_id_t page_id)
     // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
     auto it = page_table_.find(page_id);
     if (it == page_table_.end())
+    {
+        // a page deleted twice must not be counted off its extent again
+        if (!IsPageFree(page_id))
+            disk_manager_->DeAllocatePage(page_id);
         return true;
+    }
 
     frame_id_t frame_id = (*it).second;
     if (pages_[frame_id].pin_count_ > 0)
         return false;
+    // the frame goes to the free list, the replacer must not hand it out as well
+    replacer_->Pin(frame_id);
 
     pages_[frame_id].ResetMemory();
     disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
@@ -150,6 +148,7 @@ bool BufferPoolManager::DeletePage(page_id_t page_id)
 
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty)
 {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     auto it = page_table_.find(page_id);
     if (it == page_table_.end())
         return false;
@@ -166,6 +165,7 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty)
 
 bool BufferPoolManager::FlushPage(page_id_t page_id)
 {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     auto it = page_table_.find(page_id);
     if (it == page_table_.end())
         return false;
@@ -192,6 +192,7 @@ void BufferPoolManager::DeallocatePage(__attribute__((unused)) page_id_t page_id
 
 bool BufferPoolManager::IsPageFree(page_id_t page_id)
 {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     return disk_manager_->IsPageFree(page_id);
 }
 
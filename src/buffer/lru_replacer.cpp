@@ -1,12 +1,14 @@
 #include "buffer/lru_replacer.h"
-#include <algorithm>
 
 LRUReplacer::LRUReplacer(size_t num_pages)
 {
     capacity_ = num_pages;
 }
 
-LRUReplacer::~LRUReplacer() = default;
+LRUReplacer::~LRUReplacer()
+{
+    delete lru_list_;
+}
 
 bool LRUReplacer::Victim(frame_id_t *frame_id)
 {
@@ -17,18 +19,26 @@ bool LRUReplacer::Victim(frame_id_t *frame_id)
     }
     *frame_id = lru_list_->back();
     lru_list_->pop_back();
+    positions_.erase(*frame_id);
     return true;
 }
 
 void LRUReplacer::Pin(frame_id_t frame_id)
 {
-    lru_list_->remove(frame_id);
+    auto it = positions_.find(frame_id);
+    if (it == positions_.end())
+        return;
+    lru_list_->erase(it->second);
+    positions_.erase(it);
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id)
 {
-    if (lru_list_->size() < capacity_ && std::find(lru_list_->begin(), lru_list_->end(), frame_id) == lru_list_->end())
+    if (lru_list_->size() < capacity_ && positions_.find(frame_id) == positions_.end())
+    {
         lru_list_->push_front(frame_id);
+        positions_.emplace(frame_id, lru_list_->begin());
+    }
 }
 
 size_t LRUReplacer::Size()
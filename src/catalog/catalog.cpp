@@ -135,7 +135,9 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
 
     Schema *schema_copy = Schema::DeepCopySchema(schema);
     TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, schema_copy, txn, log_manager_, lock_manager_);
-    TableMetadata *table_meta_data = TableMetadata::Create(table_id, table_name, meta_page_id, schema_copy);
+    // the heap is found again through its first page, not through the page holding the metadata
+    TableMetadata *table_meta_data =
+        TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), schema_copy);
     table_meta_data->SerializeTo(table_meta_page->GetData());
     buffer_pool_manager_->UnpinPage(meta_page_id, true);
 
@@ -170,7 +172,8 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const
 
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info, const string &index_type)
+                                    IndexInfo *&index_info, const string &index_type,
+                                    const std::vector<std::string> &include_keys, bool unique)
 {
     if (table_names_.find(table_name) == table_names_.end())
         return DB_TABLE_NOT_EXIST;
@@ -178,6 +181,12 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
     if (index_names_[table_name].find(index_name) != index_names_[table_name].end())
         return DB_INDEX_ALREADY_EXIST;
 
+    // "btree" is what the parser defaults to, both names mean the B+ tree
+    std::string type = index_type == "btree" ? "bptree" : index_type;
+    if (type != "bptree" && type != "hash" && type != "bitmap" && type != "art" && type != "lsm" &&
+        type != "learned")
+        return DB_FAILED;
+
     table_id_t table_id = table_names_[table_name];
     TableInfo *table_info = tables_[table_id];
 
@@ -190,6 +199,23 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
             return DB_COLUMN_NAME_NOT_EXIST;
         key_map.push_back(index);
     }
+    // the model is fit to the values of one integer column
+    if (type == "learned" && (key_map.size() != 1 || schema->GetColumn(key_map[0])->GetType() != TypeId::kTypeInt))
+        return DB_FAILED;
+
+    // included columns sit next to a single record id, so only a unique B+ tree can keep them
+    std::vector<uint32_t> include_map;
+    for (auto index : key_map)
+        unique |= schema->GetColumn(index)->IsUnique();
+    for (auto key : include_keys)
+    {
+        uint32_t index;
+        if (schema->GetColumnIndex(key, index) == DB_COLUMN_NAME_NOT_EXIST)
+            return DB_COLUMN_NAME_NOT_EXIST;
+        if (type != "bptree" || !unique)
+            return DB_FAILED;
+        include_map.push_back(index);
+    }
 
     index_id_t index_id = catalog_meta_->GetNextIndexId();
     index_names_[table_name][index_name] = index_id;
@@ -197,7 +223,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
     page_id_t page_id;
     Page *index_meta_page = buffer_pool_manager_->NewPage(page_id);
     catalog_meta_->index_meta_pages_[index_id] = page_id;
-    IndexMetadata *index_meta_data = IndexMetadata::Create(index_id, index_name, table_id, key_map);
+    IndexMetadata *index_meta_data = IndexMetadata::Create(index_id, index_name, table_id, key_map, type, include_map, unique);
     index_meta_data->SerializeTo(index_meta_page->GetData());
     buffer_pool_manager_->UnpinPage(page_id, true);
 
@@ -231,8 +257,10 @@ dberr_t CatalogManager::GetTableIndexes(const std::string &table_name, std::vect
     if (table_names_.find(table_name) == table_names_.end())
         return DB_TABLE_NOT_EXIST;
 
-    auto map = index_names_.at(table_name);
-    for (auto it : map)
+    auto table_indexes = index_names_.find(table_name);
+    if (table_indexes == index_names_.end()) // table without any index
+        return DB_SUCCESS;
+    for (auto it : table_indexes->second)
     {
         index_id_t index_id = it.second;
         IndexInfo *index_info = indexes_.at(index_id);
@@ -344,6 +372,13 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
     IndexInfo *index_info = IndexInfo::Create();
     index_info->Init(index_meta_data, table_info, buffer_pool_manager_);
     indexes_[index_id] = index_info;
+    // an in-memory index starts out empty, rebuild it from the table heap
+    if (index_meta_data->GetIndexType() == "art" || index_meta_data->GetIndexType() == "learned")
+    {
+        TableHeap *table_heap = table_info->GetTableHeap();
+        for (auto row = table_heap->Begin(nullptr); row != table_heap->End(); row++)
+            index_info->GetIndex()->InsertEntry(index_info->GetEntry(*row), row.GetRid(), nullptr);
+    }
     // TODO: load from disk
     return DB_SUCCESS;
 }
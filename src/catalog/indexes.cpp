@@ -1,13 +1,21 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, const std::string &index_type,
+                             const std::vector<uint32_t> &include_map, bool unique)
+    : index_id_(index_id),
+      index_name_(index_name),
+      table_id_(table_id),
+      key_map_(key_map),
+      index_type_(index_type),
+      include_map_(include_map),
+      unique_(unique) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map)
+                                     const vector<uint32_t> &key_map, const string &index_type,
+                                     const vector<uint32_t> &include_map, bool unique)
 {
-    return new IndexMetadata(index_id, index_name, table_id, key_map);
+    return new IndexMetadata(index_id, index_name, table_id, key_map, index_type, include_map, unique);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const
@@ -38,13 +46,30 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const
         MACH_WRITE_UINT32(buf, col_index);
         buf += 4;
     }
+    // index type
+    MACH_WRITE_UINT32(buf, index_type_.length());
+    buf += 4;
+    MACH_WRITE_STRING(buf, index_type_);
+    buf += index_type_.length();
+    // included columns
+    MACH_WRITE_UINT32(buf, include_map_.size());
+    buf += 4;
+    for (auto &col_index : include_map_)
+    {
+        MACH_WRITE_UINT32(buf, col_index);
+        buf += 4;
+    }
+    // declared uniqueness
+    MACH_WRITE_TO(bool, buf, unique_);
+    buf += sizeof(bool);
     ASSERT(buf - p == ofs, "Unexpected serialize size.");
     return ofs;
 }
 
 uint32_t IndexMetadata::GetSerializedSize() const
 {
-    return sizeof(uint32_t) + sizeof(index_id_t) + sizeof(uint32_t) + index_name_.length() + sizeof(table_id_t) + sizeof(uint32_t) + sizeof(uint32_t) * key_map_.size();
+    return sizeof(uint32_t) + sizeof(index_id_t) + sizeof(uint32_t) + index_name_.length() + sizeof(table_id_t) + sizeof(uint32_t) + sizeof(uint32_t) * key_map_.size() + sizeof(uint32_t) + index_type_.length() +
+           sizeof(uint32_t) + sizeof(uint32_t) * include_map_.size() + sizeof(bool);
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta)
@@ -80,20 +105,46 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta)
         buf += 4;
         key_map.push_back(key_index);
     }
+    // index type
+    len = MACH_READ_UINT32(buf);
+    buf += 4;
+    std::string index_type(buf, len);
+    buf += len;
+    // included columns
+    uint32_t include_count = MACH_READ_UINT32(buf);
+    buf += 4;
+    std::vector<uint32_t> include_map;
+    for (uint32_t i = 0; i < include_count; i++)
+    {
+        include_map.push_back(MACH_READ_UINT32(buf));
+        buf += 4;
+    }
+    // declared uniqueness
+    bool unique = MACH_READ_FROM(bool, buf);
+    buf += sizeof(bool);
     // allocate space for index meta data
-    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, index_type, include_map, unique);
     return buf - p;
 }
 
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type)
 {
-    size_t max_size = 16 + key_schema_->GetColumns().size() / 8 + 1;
-    for (auto col : key_schema_->GetColumns())
-    {
-        max_size += col->GetLength();
-    }
+    // the bitmap index sizes the keys of its own tree
+    if (index_type == "bitmap")
+        return new BitmapIndex(meta_data_->index_id_, key_schema_, buffer_pool_manager);
+    // the radix tree lives in memory and takes keys of any length
+    if (index_type == "art")
+        return new ArtIndex(meta_data_->index_id_, key_schema_, unique_);
+    // the learned index models the values of a single integer column
+    if (index_type == "learned")
+        return new LearnedIndex(meta_data_->index_id_, key_schema_, unique_);
+    // the runs of an LSM tree hold keys of any length as well
+    if (index_type == "lsm")
+        return new LsmIndex(meta_data_->index_id_, key_schema_, buffer_pool_manager, unique_);
 
-    if (index_type == "bptree")
+    size_t max_size = KeyManager::GetMaxKeyLength(key_schema_);
+
+    if (index_type == "bptree" || index_type == "hash")
     {
         if (max_size <= 8)
             max_size = 16;
@@ -115,5 +166,40 @@ Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const stri
     {
         return nullptr;
     }
-    return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+    if (index_type == "hash")
+        return new ExtendibleHashIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique_);
+    return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique_,
+                              include_schema_);
+}
+
+Row IndexInfo::GetEntry(const Row &row) const
+{
+    std::vector<Field> fields;
+    for (auto col : key_schema_->GetColumns())
+        fields.push_back(*row.GetField(col->GetTableInd()));
+    if (include_schema_ != nullptr)
+    {
+        for (auto col : include_schema_->GetColumns())
+            fields.push_back(*row.GetField(col->GetTableInd()));
+    }
+    return Row(fields);
+}
+
+bool IndexInfo::Covers(uint32_t column_index) const
+{
+    if (!index_->SupportsIndexOnlyScan())
+        return false;
+    for (auto col : key_schema_->GetColumns())
+    {
+        if (col->GetTableInd() == column_index)
+            return true;
+    }
+    if (include_schema_ == nullptr)
+        return false;
+    for (auto col : include_schema_->GetColumns())
+    {
+        if (col->GetTableInd() == column_index)
+            return true;
+    }
+    return false;
 }
@@ -4,7 +4,7 @@
 #include "common/instance.h"
 
 DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
-    : db_file_name_(std::move(db_name)), init_(init) {
+    : thread_pool_(ThreadPool::Shared()), db_file_name_(std::move(db_name)), init_(init) {
   // Init database file if needed
   db_file_name_ = "./databases/"+db_file_name_;
   if (init_) {
@@ -48,5 +48,5 @@ DBStorageEngine::~DBStorageEngine() {
 }
 
 std::unique_ptr<ExecuteContext> DBStorageEngine::MakeExecuteContext(Transaction *txn) {
-  return std::make_unique<ExecuteContext>(txn, catalog_mgr_, bpm_);
+  return std::make_unique<ExecuteContext>(txn, catalog_mgr_, bpm_, thread_pool_.get());
 }
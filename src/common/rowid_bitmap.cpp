@@ -0,0 +1,202 @@
+#include "common/rowid_bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "common/macros.h"
+
+void RowIdBitmap::Container::Add(uint16_t slot)
+{
+    if (bitset_)
+    {
+        if (words_.size() <= (slot >> 6u))
+            words_.resize((slot >> 6u) + 1, 0);
+        uint64_t bit = 1ull << (slot & 63u);
+        if ((words_[slot >> 6u] & bit) == 0)
+        {
+            words_[slot >> 6u] |= bit;
+            cardinality_++;
+        }
+        return;
+    }
+    auto it = std::lower_bound(array_.begin(), array_.end(), slot);
+    if (it != array_.end() && *it == slot)
+        return;
+    array_.insert(it, slot);
+    cardinality_++;
+    if (BitsetIsSmaller(cardinality_, array_.back()))
+        ToBitset();
+}
+
+bool RowIdBitmap::Container::Contains(uint16_t slot) const
+{
+    if (bitset_)
+        return (slot >> 6u) < words_.size() && (words_[slot >> 6u] >> (slot & 63u) & 1u);
+    return std::binary_search(array_.begin(), array_.end(), slot);
+}
+
+void RowIdBitmap::Container::ToBitset()
+{
+    words_.assign(array_.empty() ? 0 : (array_.back() >> 6u) + 1, 0);
+    for (auto slot : array_)
+        words_[slot >> 6u] |= 1ull << (slot & 63u);
+    array_.clear();
+    array_.shrink_to_fit();
+    bitset_ = true;
+}
+
+void RowIdBitmap::Container::Normalize()
+{
+    while (!words_.empty() && words_.back() == 0)
+        words_.pop_back();
+    cardinality_ = 0;
+    for (auto word : words_)
+        cardinality_ += __builtin_popcountll(word);
+    if (words_.empty() ||
+        !BitsetIsSmaller(cardinality_, static_cast<uint16_t>(words_.size() * 64 - 1 - __builtin_clzll(words_.back()))))
+    {
+        std::vector<uint16_t> slots;
+        slots.reserve(cardinality_);
+        ForEach([&slots](uint16_t slot) { slots.push_back(slot); });
+        array_ = std::move(slots);
+        words_.clear();
+        words_.shrink_to_fit();
+        bitset_ = false;
+    }
+}
+
+void RowIdBitmap::Container::Assign(const uint64_t *words, size_t count)
+{
+    array_.clear();
+    words_.assign(words, words + count);
+    bitset_ = true;
+    Normalize();
+}
+
+void RowIdBitmap::Container::And(const Container &other)
+{
+    if (bitset_ && other.bitset_)
+    {
+        words_.resize(std::min(words_.size(), other.words_.size()));
+        for (size_t i = 0; i < words_.size(); i++)
+            words_[i] &= other.words_[i];
+        Normalize();
+        return;
+    }
+    // an array side bounds the result, probe the other side for each of its slots
+    const Container &sparse = bitset_ ? other : *this;
+    const Container &probed = bitset_ ? *this : other;
+    std::vector<uint16_t> slots;
+    for (auto slot : sparse.array_)
+    {
+        if (probed.Contains(slot))
+            slots.push_back(slot);
+    }
+    array_ = std::move(slots);
+    words_.clear();
+    bitset_ = false;
+    cardinality_ = array_.size();
+}
+
+void RowIdBitmap::Container::Or(const Container &other)
+{
+    if (!bitset_ && !other.bitset_)
+    {
+        std::vector<uint16_t> slots;
+        slots.reserve(array_.size() + other.array_.size());
+        std::set_union(array_.begin(), array_.end(), other.array_.begin(), other.array_.end(),
+                       std::back_inserter(slots));
+        array_ = std::move(slots);
+        cardinality_ = array_.size();
+        if (!array_.empty() && BitsetIsSmaller(cardinality_, array_.back()))
+            ToBitset();
+        return;
+    }
+    if (!other.bitset_)
+    {
+        for (auto slot : other.array_)
+            Add(slot);
+        return;
+    }
+    if (!bitset_)
+        ToBitset();
+    if (words_.size() < other.words_.size())
+        words_.resize(other.words_.size(), 0);
+    for (size_t i = 0; i < other.words_.size(); i++)
+        words_[i] |= other.words_[i];
+    Normalize();
+}
+
+void RowIdBitmap::Add(const RowId &rid)
+{
+    ASSERT(rid.GetSlotNum() <= UINT16_MAX, "Slot number out of range.");
+    containers_[rid.GetPageId()].Add(static_cast<uint16_t>(rid.GetSlotNum()));
+}
+
+void RowIdBitmap::AddPage(page_id_t page_id, const uint64_t *words, size_t count)
+{
+    Container page;
+    page.Assign(words, count);
+    if (page.Cardinality() == 0)
+        return;
+    auto it = containers_.find(page_id);
+    if (it == containers_.end())
+        containers_.emplace(page_id, std::move(page));
+    else
+        it->second.Or(page);
+}
+
+bool RowIdBitmap::Contains(const RowId &rid) const
+{
+    auto it = containers_.find(rid.GetPageId());
+    return it != containers_.end() && rid.GetSlotNum() <= UINT16_MAX &&
+           it->second.Contains(static_cast<uint16_t>(rid.GetSlotNum()));
+}
+
+uint64_t RowIdBitmap::Cardinality() const
+{
+    uint64_t cardinality = 0;
+    for (auto &it : containers_)
+        cardinality += it.second.Cardinality();
+    return cardinality;
+}
+
+void RowIdBitmap::IntersectWith(const RowIdBitmap &other)
+{
+    auto mine = containers_.begin();
+    auto theirs = other.containers_.begin();
+    while (mine != containers_.end())
+    {
+        while (theirs != other.containers_.end() && theirs->first < mine->first)
+            ++theirs;
+        if (theirs == other.containers_.end() || theirs->first != mine->first)
+        {
+            mine = containers_.erase(mine);
+            continue;
+        }
+        mine->second.And(theirs->second);
+        mine = mine->second.Cardinality() == 0 ? containers_.erase(mine) : std::next(mine);
+    }
+}
+
+void RowIdBitmap::UnionWith(const RowIdBitmap &other)
+{
+    for (auto &it : other.containers_)
+    {
+        auto mine = containers_.find(it.first);
+        if (mine == containers_.end())
+            containers_.emplace(it.first, it.second);
+        else
+            mine->second.Or(it.second);
+    }
+}
+
+void RowIdBitmap::ToVector(std::vector<RowId> &rids) const
+{
+    rids.reserve(rids.size() + Cardinality());
+    for (auto &it : containers_)
+    {
+        page_id_t page_id = it.first;
+        it.second.ForEach([&rids, page_id](uint16_t slot) { rids.emplace_back(page_id, slot); });
+    }
+}
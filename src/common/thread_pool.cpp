@@ -0,0 +1,187 @@
+#include "common/thread_pool.h"
+
+#include <algorithm>
+
+namespace
+{
+/** The pool the current thread works for, and its index there */
+thread_local ThreadPool *current_pool = nullptr;
+thread_local size_t current_index = 0;
+} // namespace
+
+void TaskGroup::Finish(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(latch_);
+    if (error != nullptr && error_ == nullptr)
+        error_ = error;
+    pending_--;
+    done_.notify_all();
+}
+
+ThreadPool::ThreadPool(size_t worker_count)
+{
+    worker_count = std::max<size_t>(worker_count, 1);
+    for (size_t i = 0; i < worker_count; i++)
+        queues_.push_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < worker_count; i++)
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        stop_ = true;
+    }
+    work_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::Shared()
+{
+    static std::mutex latch;
+    static std::weak_ptr<ThreadPool> shared;
+    std::lock_guard<std::mutex> lock(latch);
+    std::shared_ptr<ThreadPool> pool = shared.lock();
+    if (pool == nullptr)
+    {
+        pool = std::make_shared<ThreadPool>(std::thread::hardware_concurrency());
+        shared = pool;
+    }
+    return pool;
+}
+
+void ThreadPool::Submit(const std::shared_ptr<TaskGroup> &group, TaskPriority priority, std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(group->latch_);
+        group->pending_++;
+    }
+    // a worker keeps what it submits, the rest is spread out
+    size_t index = current_pool == this ? current_index : next_queue_++ % queues_.size();
+    Worker &queue = *queues_[index];
+    {
+        std::lock_guard<std::mutex> lock(queue.latch);
+        queue.tasks[static_cast<int>(priority)].push_back({std::move(task), group});
+    }
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        queued_++;
+    }
+    work_.notify_one();
+}
+
+void ThreadPool::Wait(const std::shared_ptr<TaskGroup> &group)
+{
+    while (true)
+    {
+        if (RunQueued(group))
+            continue;
+        // the rest of the group is running on the workers
+        std::unique_lock<std::mutex> lock(group->latch_);
+        group->done_.wait(lock, [&] { return group->pending_ == 0; });
+        break;
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(group->latch_);
+        std::swap(error, group->error_);
+    }
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
+
+bool ThreadPool::RunQueued(const std::shared_ptr<TaskGroup> &group)
+{
+    Task task;
+    if (!TakeFrom(group, &task))
+        return false;
+    Run(task);
+    return true;
+}
+
+void ThreadPool::WorkerLoop(size_t index)
+{
+    current_pool = this;
+    current_index = index;
+    while (true)
+    {
+        Task task;
+        if (Take(index, &task))
+        {
+            Run(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(latch_);
+        work_.wait(lock, [this] { return stop_ || queued_ > 0; });
+        if (stop_ && queued_ == 0)
+            return;
+    }
+}
+
+bool ThreadPool::Take(size_t index, Task *task)
+{
+    for (int priority = 0; priority < 2; priority++)
+    {
+        for (size_t i = 0; i < queues_.size(); i++)
+        {
+            Worker &queue = *queues_[(index + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.latch);
+            auto &tasks = queue.tasks[priority];
+            if (tasks.empty())
+                continue;
+            if (i == 0)
+            {
+                *task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+            else
+            {
+                *task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            std::lock_guard<std::mutex> pool_lock(latch_);
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::TakeFrom(const std::shared_ptr<TaskGroup> &group, Task *task)
+{
+    for (auto &queue : queues_)
+    {
+        std::lock_guard<std::mutex> lock(queue->latch);
+        for (auto &tasks : queue->tasks)
+        {
+            auto it = std::find_if(tasks.begin(), tasks.end(), [&](const Task &t) { return t.group == group; });
+            if (it == tasks.end())
+                continue;
+            *task = std::move(*it);
+            tasks.erase(it);
+            std::lock_guard<std::mutex> pool_lock(latch_);
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Run(Task &task)
+{
+    std::exception_ptr error;
+    if (!task.group->IsCancelled())
+    {
+        try
+        {
+            task.function();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+    }
+    task.group->Finish(error);
+}
@@ -18,13 +18,24 @@ void DeleteExecutor::Init()
 
 bool DeleteExecutor::Next([[maybe_unused]] Row *_row, RowId *_rid)
 {
+    return NextFromBatch(_row, _rid);
+}
+
+bool DeleteExecutor::NextBatch(RowBatch *batch)
+{
+    if (!child_executor_->NextBatch(batch))
+        return false;
+    // the selection is narrowed to the rows actually deleted
+    auto &selection = batch->GetSelection();
+    size_t deleted = 0;
     Row row;
-    RowId rid;
-    if (child_executor_->Next(&row, &rid))
+    for (uint32_t i : selection)
     {
+        RowId rid = batch->GetRowId(i);
         if (!table_info->GetTableHeap()->MarkDelete(rid, nullptr))
-            return false;
+            continue;
 
+        batch->GetRow(i, &row);
         for (auto index : indexes)
         {
             std::vector<Field> fields{};
@@ -36,7 +47,8 @@ bool DeleteExecutor::Next([[maybe_unused]] Row *_row, RowId *_rid)
             Row idx(fields);
             index->GetIndex()->RemoveEntry(idx, rid, nullptr);
         }
-        return true;
+        selection[deleted++] = i;
     }
-    return false;
-}
\ No newline at end of file
+    selection.resize(deleted);
+    return true;
+}
@@ -8,9 +8,15 @@
 
 #include "common/result_writer.h"
 #include "executor/executors/delete_executor.h"
+#include "executor/executors/gather_executor.h"
+#include "executor/executors/hash_aggregate_executor.h"
+#include "executor/executors/hash_join_executor.h"
 #include "executor/executors/index_scan_executor.h"
 #include "executor/executors/insert_executor.h"
+#include "executor/executors/limit_executor.h"
+#include "executor/executors/nested_index_join_executor.h"
 #include "executor/executors/seq_scan_executor.h"
+#include "executor/executors/sort_executor.h"
 #include "executor/executors/update_executor.h"
 #include "executor/executors/values_executor.h"
 #include "glog/logging.h"
@@ -53,6 +59,11 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
     {
         return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan.get()));
     }
+    // Create a new parallel sequential scan executor
+    case PlanType::Gather:
+    {
+        return std::make_unique<GatherExecutor>(exec_ctx, dynamic_cast<const GatherPlanNode *>(plan.get()));
+    }
     // Create a new index scan executor
     case PlanType::IndexScan:
     {
@@ -78,6 +89,43 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
         auto child_executor = CreateExecutor(exec_ctx, insert_plan->GetChildPlan());
         return std::make_unique<InsertExecutor>(exec_ctx, insert_plan, std::move(child_executor));
     }
+    // Create a new hash join executor
+    case PlanType::HashJoin:
+    {
+        auto join_plan = dynamic_cast<const HashJoinPlanNode *>(plan.get());
+        auto left_executor = CreateExecutor(exec_ctx, join_plan->GetLeftPlan());
+        auto right_executor = CreateExecutor(exec_ctx, join_plan->GetRightPlan());
+        return std::make_unique<HashJoinExecutor>(exec_ctx, join_plan, std::move(left_executor),
+                                                  std::move(right_executor));
+    }
+    // Create a new nested index join executor
+    case PlanType::NestedIndexJoin:
+    {
+        auto join_plan = dynamic_cast<const NestedIndexJoinPlanNode *>(plan.get());
+        auto outer_executor = CreateExecutor(exec_ctx, join_plan->GetOuterPlan());
+        return std::make_unique<NestedIndexJoinExecutor>(exec_ctx, join_plan, std::move(outer_executor));
+    }
+    // Create a new hash aggregation executor
+    case PlanType::Aggregation:
+    {
+        auto aggregation_plan = dynamic_cast<const AggregationPlanNode *>(plan.get());
+        auto child_executor = CreateExecutor(exec_ctx, aggregation_plan->GetChildPlan());
+        return std::make_unique<HashAggregateExecutor>(exec_ctx, aggregation_plan, std::move(child_executor));
+    }
+    // Create a new sort executor
+    case PlanType::Sort:
+    {
+        auto sort_plan = dynamic_cast<const SortPlanNode *>(plan.get());
+        auto child_executor = CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+        return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child_executor));
+    }
+    // Create a new limit executor
+    case PlanType::Limit:
+    {
+        auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan.get());
+        auto child_executor = CreateExecutor(exec_ctx, limit_plan->GetChildPlan());
+        return std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor));
+    }
     case PlanType::Values:
     {
         return std::make_unique<ValuesExecutor>(exec_ctx, dynamic_cast<const ValuesPlanNode *>(plan.get()));
@@ -96,12 +144,15 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
     try
     {
         executor->Init();
-        RowId rid{};
-        Row row{};
-        while (executor->Next(&row, &rid))
+        RowBatch batch;
+        while (executor->NextBatch(&batch))
         {
-            if (result_set != nullptr)
+            if (result_set == nullptr)
+                continue;
+            for (uint32_t i : batch.GetSelection())
             {
+                Row row;
+                batch.GetRow(i, &row);
                 result_set->push_back(row);
             }
         }
@@ -184,7 +235,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast)
     std::stringstream ss;
     ResultWriter writer(ss);
 
-    if (planner.plan_->GetType() == PlanType::SeqScan || planner.plan_->GetType() == PlanType::IndexScan)
+    PlanType plan_type = planner.plan_->GetType();
+    if (plan_type != PlanType::Insert && plan_type != PlanType::Update && plan_type != PlanType::Delete)
     {
         auto schema = planner.plan_->OutputSchema();
         auto num_of_columns = schema->GetColumnCount();
@@ -465,8 +517,11 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
             for (auto key_iter = it->child_; key_iter != nullptr; key_iter = key_iter->next_)
             {
                 primary_keys.emplace_back(std::string(key_iter->val_));
-                // all primary keys are unique
-                int idx = std::find(col_name.begin(), col_name.end(), key_iter->val_) - col_name.begin();
+            }
+            // a single primary key column is unique by itself, a composite one only as a whole
+            if (primary_keys.size() == 1)
+            {
+                int idx = std::find(col_name.begin(), col_name.end(), primary_keys[0]) - col_name.begin();
                 is_unique[idx] = true;
             }
         }
@@ -502,9 +557,17 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     //? create table 时还没有记录，即index为空
     // primary index
     IndexInfo *index_info;
-    for (auto key : primary_keys)
+    if (primary_keys.size() == 1)
+    {
+        ret = context->GetCatalog()->CreateIndex(table_name, primary_keys[0], primary_keys, nullptr, index_info, "btree");
+        if (ret != DB_SUCCESS)
+            return ret;
+    }
+    else if (primary_keys.size() > 1)
     {
-        ret = context->GetCatalog()->CreateIndex(table_name, key, {key}, nullptr, index_info, "btree");
+        // one B+ tree over all key columns, so a lookup on a key prefix is a single range
+        ret = context->GetCatalog()->CreateIndex(table_name, "primary", primary_keys, nullptr, index_info, "btree", {},
+                                                 true);
         if (ret != DB_SUCCESS)
             return ret;
     }
@@ -512,7 +575,7 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     // unique index
     for (int i = 0; i < is_unique.size(); i++)
     {
-        if (is_unique[i] && std::find(primary_keys.begin(), primary_keys.end(), col_name[i]) == primary_keys.end())
+        if (is_unique[i] && (primary_keys.size() != 1 || primary_keys[0] != col_name[i]))
         {
             ret = context->GetCatalog()->CreateIndex(table_name, col_name[i], {col_name[i]}, nullptr, index_info, "btree");
             if (ret != DB_SUCCESS)
@@ -610,9 +673,16 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
         cols.emplace_back(std::string(it->val_));
     }
     std::string index_type("btree");
-    if (ast->child_->next_->next_->next_ != nullptr)
+    std::vector<std::string> include_cols;
+    for (auto it = ast->child_->next_->next_->next_; it != nullptr; it = it->next_)
     {
-        index_type = std::string(ast->child_->next_->next_->next_->child_->val_);
+        if (it->type_ == kNodeIndexType)
+            index_type = std::string(it->child_->val_);
+        else
+        {
+            for (auto col = it->child_; col != nullptr; col = col->next_)
+                include_cols.emplace_back(std::string(col->val_));
+        }
     }
 
     TableInfo *table_info;
@@ -623,7 +693,8 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     }
 
     IndexInfo *index_info;
-    ret = context->GetCatalog()->CreateIndex(table_name, index_name, cols, nullptr, index_info, index_type);
+    ret = context->GetCatalog()->CreateIndex(table_name, index_name, cols, nullptr, index_info, index_type,
+                                             include_cols);
     if (ret != DB_SUCCESS)
     {
         return ret;
@@ -631,13 +702,7 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
 
     for (auto row = table_info->GetTableHeap()->Begin(nullptr); row != table_info->GetTableHeap()->End(); row++)
     {
-        std::vector<Field> fields;
-        for (auto col : index_info->GetIndexKeySchema()->GetColumns())
-        {
-            fields.push_back(*row->GetField(col->GetTableInd()));
-        }
-        Row idx(fields);
-        ret = index_info->GetIndex()->InsertEntry(idx, row.GetRid(), nullptr);
+        ret = index_info->GetIndex()->InsertEntry(index_info->GetEntry(*row), row.GetRid(), nullptr);
         if (ret != DB_SUCCESS)
         {
             return ret;
@@ -0,0 +1,246 @@
+#include "executor/filter_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define MINISQL_HAS_AVX2_KERNELS
+#endif
+
+namespace
+{
+template <CompareOp Op, typename T>
+inline bool Apply(T left, T right)
+{
+    switch (Op)
+    {
+    case CompareOp::kEqual:
+        return left == right;
+    case CompareOp::kNotEqual:
+        return left != right;
+    case CompareOp::kLess:
+        return left < right;
+    case CompareOp::kLessEqual:
+        return left <= right;
+    case CompareOp::kGreater:
+        return left > right;
+    default:
+        return left >= right;
+    }
+}
+
+/** Compare rows from begin on, the right side is right[i] or the constant value */
+template <CompareOp Op, typename T, bool RightConstant>
+void FilterScalar(const T *left, const T *right, T value, size_t begin, size_t n, uint64_t *mask)
+{
+    for (size_t i = begin; i < n; i++)
+    {
+        bool pass = Apply<Op>(left[i], RightConstant ? value : right[i]);
+        mask[i / 64] |= static_cast<uint64_t>(pass) << (i % 64);
+    }
+}
+
+#ifdef MINISQL_HAS_AVX2_KERNELS
+const bool kHasAvx2 = __builtin_cpu_supports("avx2");
+
+/** @return one bit per lane of left Op right, for 8 ints */
+template <CompareOp Op>
+__attribute__((target("avx2"))) inline uint32_t CompareLanes(__m256i left, __m256i right)
+{
+    // AVX2 only has == and >, the other operators swap the sides or negate the result
+    __m256i result;
+    bool negate = Op == CompareOp::kNotEqual || Op == CompareOp::kLessEqual || Op == CompareOp::kGreaterEqual;
+    if (Op == CompareOp::kEqual || Op == CompareOp::kNotEqual)
+        result = _mm256_cmpeq_epi32(left, right);
+    else if (Op == CompareOp::kGreater || Op == CompareOp::kLessEqual)
+        result = _mm256_cmpgt_epi32(left, right);
+    else
+        result = _mm256_cmpgt_epi32(right, left);
+    uint32_t bits = _mm256_movemask_ps(_mm256_castsi256_ps(result));
+    return negate ? bits ^ 0xFF : bits;
+}
+
+/** @return one bit per lane of left Op right, for 8 floats */
+template <CompareOp Op>
+__attribute__((target("avx2"))) inline uint32_t CompareLanes(__m256 left, __m256 right)
+{
+    // Ordered predicates are false on NaN and the unordered != is true, as in scalar code
+    switch (Op)
+    {
+    case CompareOp::kEqual:
+        return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_EQ_OQ));
+    case CompareOp::kNotEqual:
+        return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_NEQ_UQ));
+    case CompareOp::kLess:
+        return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_LT_OQ));
+    case CompareOp::kLessEqual:
+        return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_LE_OQ));
+    case CompareOp::kGreater:
+        return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_GT_OQ));
+    default:
+        return _mm256_movemask_ps(_mm256_cmp_ps(left, right, _CMP_GE_OQ));
+    }
+}
+
+template <CompareOp Op, bool RightConstant>
+__attribute__((target("avx2"))) void FilterAvx2(const int32_t *left, const int32_t *right, int32_t value, size_t n,
+                                                 uint64_t *mask)
+{
+    __m256i constant = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + i));
+        __m256i r = RightConstant ? constant : _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + i));
+        mask[i / 64] |= static_cast<uint64_t>(CompareLanes<Op>(l, r)) << (i % 64);
+    }
+    FilterScalar<Op, int32_t, RightConstant>(left, right, value, i, n, mask);
+}
+
+template <CompareOp Op, bool RightConstant>
+__attribute__((target("avx2"))) void FilterAvx2(const float *left, const float *right, float value, size_t n,
+                                                 uint64_t *mask)
+{
+    __m256 constant = _mm256_set1_ps(value);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 l = _mm256_loadu_ps(left + i);
+        __m256 r = RightConstant ? constant : _mm256_loadu_ps(right + i);
+        mask[i / 64] |= static_cast<uint64_t>(CompareLanes<Op>(l, r)) << (i % 64);
+    }
+    FilterScalar<Op, float, RightConstant>(left, right, value, i, n, mask);
+}
+#endif
+
+template <CompareOp Op, typename T, bool RightConstant>
+void Filter(const T *left, const T *right, T value, size_t n, uint64_t *mask)
+{
+    std::fill(mask, mask + MaskWords(n), 0);
+#ifdef MINISQL_HAS_AVX2_KERNELS
+    if (kHasAvx2)
+    {
+        FilterAvx2<Op, RightConstant>(left, right, value, n, mask);
+        return;
+    }
+#endif
+    FilterScalar<Op, T, RightConstant>(left, right, value, 0, n, mask);
+}
+
+/** Instantiate the kernel for op, the switch runs once per batch instead of once per row */
+template <typename T, bool RightConstant>
+void Dispatch(CompareOp op, const T *left, const T *right, T value, size_t n, uint64_t *mask)
+{
+    switch (op)
+    {
+    case CompareOp::kEqual:
+        return Filter<CompareOp::kEqual, T, RightConstant>(left, right, value, n, mask);
+    case CompareOp::kNotEqual:
+        return Filter<CompareOp::kNotEqual, T, RightConstant>(left, right, value, n, mask);
+    case CompareOp::kLess:
+        return Filter<CompareOp::kLess, T, RightConstant>(left, right, value, n, mask);
+    case CompareOp::kLessEqual:
+        return Filter<CompareOp::kLessEqual, T, RightConstant>(left, right, value, n, mask);
+    case CompareOp::kGreater:
+        return Filter<CompareOp::kGreater, T, RightConstant>(left, right, value, n, mask);
+    case CompareOp::kGreaterEqual:
+        return Filter<CompareOp::kGreaterEqual, T, RightConstant>(left, right, value, n, mask);
+    }
+}
+
+inline int CompareChars(const char *left, uint32_t left_len, const char *right, uint32_t right_len)
+{
+    int order = memcmp(left, right, std::min(left_len, right_len));
+    return order != 0 ? order : static_cast<int>(left_len) - static_cast<int>(right_len);
+}
+
+template <CompareOp Op, bool RightConstant>
+void FilterChars(const ColumnVector &left, const ColumnVector *right, const char *value, uint32_t len,
+                 uint64_t *mask)
+{
+    size_t n = left.Size();
+    std::fill(mask, mask + MaskWords(n), 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        const char *data = RightConstant ? value : right->GetChars(i);
+        uint32_t data_len = RightConstant ? len : right->GetLength(i);
+        bool pass;
+        // Values of different lengths are never equal, skip reading them
+        if (Op == CompareOp::kEqual || Op == CompareOp::kNotEqual)
+            pass = (left.GetLength(i) == data_len && memcmp(left.GetChars(i), data, data_len) == 0) ==
+                   (Op == CompareOp::kEqual);
+        else
+            pass = Apply<Op>(CompareChars(left.GetChars(i), left.GetLength(i), data, data_len), 0);
+        mask[i / 64] |= static_cast<uint64_t>(pass) << (i % 64);
+    }
+}
+
+template <bool RightConstant>
+void DispatchChars(CompareOp op, const ColumnVector &left, const ColumnVector *right, const char *value, uint32_t len,
+                   uint64_t *mask)
+{
+    switch (op)
+    {
+    case CompareOp::kEqual:
+        return FilterChars<CompareOp::kEqual, RightConstant>(left, right, value, len, mask);
+    case CompareOp::kNotEqual:
+        return FilterChars<CompareOp::kNotEqual, RightConstant>(left, right, value, len, mask);
+    case CompareOp::kLess:
+        return FilterChars<CompareOp::kLess, RightConstant>(left, right, value, len, mask);
+    case CompareOp::kLessEqual:
+        return FilterChars<CompareOp::kLessEqual, RightConstant>(left, right, value, len, mask);
+    case CompareOp::kGreater:
+        return FilterChars<CompareOp::kGreater, RightConstant>(left, right, value, len, mask);
+    case CompareOp::kGreaterEqual:
+        return FilterChars<CompareOp::kGreaterEqual, RightConstant>(left, right, value, len, mask);
+    }
+}
+} // namespace
+
+void FilterInts(CompareOp op, const int32_t *left, const int32_t *right, size_t n, uint64_t *mask)
+{
+    Dispatch<int32_t, false>(op, left, right, 0, n, mask);
+}
+
+void FilterInts(CompareOp op, const int32_t *left, int32_t right, size_t n, uint64_t *mask)
+{
+    Dispatch<int32_t, true>(op, left, nullptr, right, n, mask);
+}
+
+void FilterFloats(CompareOp op, const float *left, const float *right, size_t n, uint64_t *mask)
+{
+    Dispatch<float, false>(op, left, right, 0, n, mask);
+}
+
+void FilterFloats(CompareOp op, const float *left, float right, size_t n, uint64_t *mask)
+{
+    Dispatch<float, true>(op, left, nullptr, right, n, mask);
+}
+
+void FilterChars(CompareOp op, const ColumnVector &left, const ColumnVector &right, uint64_t *mask)
+{
+    DispatchChars<false>(op, left, &right, nullptr, 0, mask);
+}
+
+void FilterChars(CompareOp op, const ColumnVector &left, const char *right, uint32_t len, uint64_t *mask)
+{
+    DispatchChars<true>(op, left, nullptr, right, len, mask);
+}
+
+void FilterNulls(const ColumnVector &column, bool is_null, uint64_t *mask)
+{
+    size_t n = column.Size();
+    const uint8_t *nulls = column.GetNulls();
+    std::fill(mask, mask + MaskWords(n), 0);
+    for (size_t i = 0; i < n; i++)
+        mask[i / 64] |= static_cast<uint64_t>((nulls[i] != 0) == is_null) << (i % 64);
+}
+
+void ClearNulls(const ColumnVector &column, uint64_t *mask)
+{
+    size_t n = column.Size();
+    const uint8_t *nulls = column.GetNulls();
+    for (size_t i = 0; i < n; i++)
+        mask[i / 64] &= ~(static_cast<uint64_t>(nulls[i] != 0) << (i % 64));
+}
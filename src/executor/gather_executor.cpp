@@ -0,0 +1,166 @@
+#include "executor/executors/gather_executor.h"
+
+GatherExecutor::GatherExecutor(ExecuteContext *exec_ctx, const GatherPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      morsels_(std::make_shared<MorselQueue>()) {}
+
+GatherExecutor::~GatherExecutor()
+{
+    Stop();
+}
+
+std::vector<std::unique_ptr<SeqScanExecutor>> GatherExecutor::MakeScans(ExecuteContext *exec_ctx,
+                                                                        const GatherPlanNode *plan,
+                                                                        const std::shared_ptr<MorselQueue> &morsels)
+{
+    TableInfo *table_info = nullptr;
+    if (exec_ctx->GetCatalog()->GetTable(plan->GetChildPlan()->GetTableName(), table_info) == DB_TABLE_NOT_EXIST)
+        throw std::runtime_error("no such table");
+    std::vector<page_id_t> page_ids;
+    table_info->GetTableHeap()->GetPageIds(&page_ids);
+    size_t morsel_count = (page_ids.size() + MorselQueue::MORSEL_PAGES - 1) / MorselQueue::MORSEL_PAGES;
+    ThreadPool *pool = exec_ctx->GetThreadPool();
+    size_t worker_count = pool == nullptr ? 1 : std::min<size_t>(plan->GetWorkers(), pool->GetWorkerCount());
+    worker_count = std::max<size_t>(1, std::min(worker_count, morsel_count));
+    morsels->Reset(std::move(page_ids));
+    std::vector<std::unique_ptr<SeqScanExecutor>> scans;
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        scans.push_back(std::make_unique<SeqScanExecutor>(exec_ctx, plan->GetChildPlan(), morsels));
+        scans.back()->Init();
+    }
+    return scans;
+}
+
+void GatherExecutor::Init()
+{
+    Stop();
+    scans_ = MakeScans(exec_ctx_, plan_, morsels_);
+    // a limit that fits in a batch is not worth starting workers for, the one scan left
+    // claims the morsels in page order
+    if (row_limit_ <= RowBatch::CAPACITY)
+        scans_.resize(1);
+    for (auto &scan : scans_)
+        scan->SetRowLimit(row_limit_);
+    size_t worker_count = scans_.size();
+    if (worker_count == 1)
+        return;
+    batches_.clear();
+    parked_.clear();
+    stopped_ = false;
+    error_ = nullptr;
+    queue_limit_ = QUEUED_PER_WORKER * worker_count;
+    running_ = worker_count;
+    tasks_ = std::make_shared<TaskGroup>();
+    for (auto &scan : scans_)
+        Submit(scan.get());
+}
+
+void GatherExecutor::Submit(SeqScanExecutor *scan)
+{
+    exec_ctx_->GetThreadPool()->Submit(tasks_, TaskPriority::kHigh, [this, scan] { Work(scan); });
+}
+
+bool GatherExecutor::Next(Row *row, RowId *rid)
+{
+    return NextFromBatch(row, rid);
+}
+
+bool GatherExecutor::NextBatch(RowBatch *batch)
+{
+    if (tasks_ == nullptr)
+    {
+        if (scans_.empty())
+        {
+            batch->Reset(GetOutputSchema());
+            return false;
+        }
+        return scans_[0]->NextBatch(batch);
+    }
+    ThreadPool *pool = exec_ctx_->GetThreadPool();
+    std::vector<SeqScanExecutor *> resumed;
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        while (batches_.empty() && running_ > 0 && error_ == nullptr)
+        {
+            // the workers of the pool may all be taken by other scans, the tasks of this one
+            // that are still queued run here rather than wait for them
+            lock.unlock();
+            bool ran = pool->RunQueued(tasks_);
+            lock.lock();
+            if (!ran)
+                not_empty_.wait(lock, [this] { return !batches_.empty() || running_ == 0 || error_ != nullptr; });
+        }
+        if (error_ != nullptr)
+            std::rethrow_exception(error_);
+        if (batches_.empty())
+        {
+            batch->Reset(GetOutputSchema());
+            return false;
+        }
+        *batch = std::move(batches_.front());
+        batches_.pop_front();
+        resumed.swap(parked_);
+    }
+    for (SeqScanExecutor *scan : resumed)
+        Submit(scan);
+    return true;
+}
+
+void GatherExecutor::Work(SeqScanExecutor *scan)
+{
+    try
+    {
+        RowBatch batch;
+        while (true)
+        {
+            if (tasks_->IsCancelled())
+                return;
+            bool more = scan->NextBatch(&batch);
+            std::lock_guard<std::mutex> lock(latch_);
+            if (stopped_)
+                return;
+            if (!more)
+                break;
+            batches_.push_back(std::move(batch));
+            not_empty_.notify_one();
+            // a full queue ends the task instead of blocking a worker of the pool, the scan
+            // is submitted again once a batch was taken
+            if (batches_.size() >= queue_limit_)
+            {
+                parked_.push_back(scan);
+                return;
+            }
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        if (error_ == nullptr)
+            error_ = std::current_exception();
+        // the result is lost anyway, let the other workers finish early
+        stopped_ = true;
+    }
+    std::lock_guard<std::mutex> lock(latch_);
+    running_--;
+    not_empty_.notify_all();
+}
+
+void GatherExecutor::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        stopped_ = true;
+    }
+    if (tasks_ != nullptr)
+    {
+        // tasks not started yet are dropped, the others see stopped_
+        tasks_->Cancel();
+        exec_ctx_->GetThreadPool()->Wait(tasks_);
+        tasks_ = nullptr;
+    }
+    batches_.clear();
+    parked_.clear();
+    scans_.clear();
+}
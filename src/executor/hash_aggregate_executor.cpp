@@ -0,0 +1,600 @@
+#include "executor/executors/hash_aggregate_executor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+#include "executor/executors/gather_executor.h"
+#include "planner/expressions/column_value_expression.h"
+
+namespace
+{
+/** Compare two char values the way TypeChar does */
+int CompareChars(const char *lhs, uint32_t lhs_length, const char *rhs, uint32_t rhs_length)
+{
+    int ret = memcmp(lhs, rhs, std::min(lhs_length, rhs_length));
+    if (ret == 0 && lhs_length != rhs_length)
+        ret = lhs_length < rhs_length ? -1 : 1;
+    return ret;
+}
+
+/** @return whether value should replace the minimum (or maximum) in state */
+template <typename T>
+bool Replaces(const AggregateState &state, T current, T value, bool min)
+{
+    return state.count == 0 || (min ? value < current : value > current);
+}
+
+bool ReplacesChars(const AggregateState &state, const char *value, uint32_t length, bool min)
+{
+    if (state.count == 0)
+        return true;
+    int cmp = CompareChars(value, length, state.chars, state.length);
+    return min ? cmp < 0 : cmp > 0;
+}
+} // namespace
+
+AggregateState *AggregateHashTable::FindOrInsert(std::string_view key, uint64_t hash)
+{
+    if (slots_.empty())
+        slots_.assign(MIN_SLOTS, Slot{0, nullptr});
+    size_t states_size = state_count_ * sizeof(AggregateState);
+    size_t mask = slots_.size() - 1;
+    size_t pos = hash & mask;
+    while (slots_[pos].group != nullptr)
+    {
+        char *group = slots_[pos].group;
+        if (slots_[pos].hash == hash && reinterpret_cast<GroupHeader *>(group)->key_size == key.size() &&
+            memcmp(group + HEADER_SIZE + states_size, key.data(), key.size()) == 0)
+            return reinterpret_cast<AggregateState *>(group + HEADER_SIZE);
+        pos = (pos + 1) & mask;
+    }
+    char *group = Allocate(HEADER_SIZE + states_size + key.size());
+    auto header = reinterpret_cast<GroupHeader *>(group);
+    header->hash = hash;
+    header->key_size = key.size();
+    memset(group + HEADER_SIZE, 0, states_size);
+    memcpy(group + HEADER_SIZE + states_size, key.data(), key.size());
+    slots_[pos] = Slot{hash, group};
+    groups_.push_back(group);
+    if (groups_.size() * 2 > slots_.size())
+        Grow();
+    return reinterpret_cast<AggregateState *>(group + HEADER_SIZE);
+}
+
+const char *AggregateHashTable::CopyChars(const char *data, uint32_t length)
+{
+    char *copy = Allocate(length);
+    memcpy(copy, data, length);
+    return copy;
+}
+
+std::string_view AggregateHashTable::GetKey(size_t i) const
+{
+    auto header = reinterpret_cast<const GroupHeader *>(groups_[i]);
+    return {groups_[i] + HEADER_SIZE + state_count_ * sizeof(AggregateState), header->key_size};
+}
+
+void AggregateHashTable::Clear()
+{
+    std::vector<Slot>().swap(slots_);
+    std::vector<char *>().swap(groups_);
+    blocks_.clear();
+    block_used_ = 0;
+    block_size_ = 0;
+    arena_bytes_ = 0;
+}
+
+char *AggregateHashTable::Allocate(size_t size)
+{
+    size = (size + 7) & ~size_t(7);
+    if (block_used_ + size > block_size_)
+    {
+        block_size_ = std::max(BLOCK_SIZE, size);
+        blocks_.emplace_back(new char[block_size_]);
+        block_used_ = 0;
+        arena_bytes_ += block_size_;
+    }
+    char *data = blocks_.back().get() + block_used_;
+    block_used_ += size;
+    return data;
+}
+
+void AggregateHashTable::Grow()
+{
+    std::vector<Slot> slots(slots_.size() * 2, Slot{0, nullptr});
+    size_t mask = slots.size() - 1;
+    for (auto &slot : slots_)
+    {
+        if (slot.group == nullptr)
+            continue;
+        size_t pos = slot.hash & mask;
+        while (slots[pos].group != nullptr)
+            pos = (pos + 1) & mask;
+        slots[pos] = slot;
+    }
+    slots_.swap(slots);
+}
+
+HashAggregateExecutor::HashAggregateExecutor(ExecuteContext *exec_ctx, const AggregationPlanNode *plan,
+                                             std::unique_ptr<AbstractExecutor> child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child))
+{
+    const Schema *input = plan_->GetChildPlan()->OutputSchema();
+    for (auto &expr : plan_->group_bys_)
+    {
+        uint32_t col = dynamic_cast<const ColumnValueExpression *>(expr.get())->GetColIdx();
+        group_columns_.push_back(col);
+        group_types_.push_back(input->GetColumn(col)->GetType());
+    }
+    for (size_t i = 0; i < plan_->aggregates_.size(); i++)
+    {
+        auto &expr = plan_->aggregates_[i];
+        int64_t col = -1;
+        if (expr != nullptr)
+            col = dynamic_cast<const ColumnValueExpression *>(expr.get())->GetColIdx();
+        TypeId type = col < 0 ? kTypeInt : input->GetColumn(col)->GetType();
+        agg_columns_.push_back(col);
+        agg_input_types_.push_back(type);
+        switch (plan_->agg_types_[i])
+        {
+        case AggregationType::CountStarAggregate:
+        case AggregationType::CountAggregate:
+            agg_output_types_.push_back(kTypeInt);
+            break;
+        case AggregationType::AvgAggregate:
+            agg_output_types_.push_back(kTypeFloat);
+            break;
+        default:
+            agg_output_types_.push_back(type);
+        }
+    }
+    group_schema_ = std::make_unique<Schema>(
+        std::vector<Column *>{new Column("group", kTypeChar, VARCHAR_MAX_LEN, 0, false, false)});
+}
+
+HashAggregateExecutor::Sink HashAggregateExecutor::MakeSink(uint32_t level, size_t budget) const
+{
+    return Sink{std::make_unique<AggregateHashTable>(plan_->aggregates_.size()), {}, level, budget};
+}
+
+void HashAggregateExecutor::Init()
+{
+    pending_.clear();
+    result_ = MakeSink(0, plan_->memory_budget_);
+    result_pos_ = 0;
+    std::string key;
+    std::vector<AggregateState *> group_states;
+    RowBatch batch;
+
+    // a parallel scan below is run here, each worker aggregating what it reads
+    std::vector<std::unique_ptr<SeqScanExecutor>> scans;
+    auto gather = dynamic_cast<const GatherPlanNode *>(plan_->GetChildPlan().get());
+    if (gather != nullptr)
+        scans = GatherExecutor::MakeScans(exec_ctx_, gather, std::make_shared<MorselQueue>());
+    worker_count_ = std::max<size_t>(1, scans.size());
+    if (scans.size() > 1)
+    {
+        std::vector<Sink> partials;
+        for (size_t i = 0; i < scans.size(); i++)
+            partials.push_back(MakeSink(0, plan_->memory_budget_ / scans.size()));
+        auto tasks = std::make_shared<TaskGroup>();
+        ThreadPool *pool = exec_ctx_->GetThreadPool();
+        for (size_t i = 0; i < scans.size(); i++)
+        {
+            pool->Submit(tasks, TaskPriority::kHigh, [this, scan = scans[i].get(), partial = &partials[i]] {
+                std::string worker_key;
+                std::vector<AggregateState *> worker_states;
+                RowBatch worker_batch;
+                while (scan->NextBatch(&worker_batch))
+                    Aggregate(worker_batch, partial, &worker_key, &worker_states);
+            });
+        }
+        pool->Wait(tasks);
+        for (auto &partial : partials)
+        {
+            for (size_t i = 0; i < partial.table->GetGroupCount(); i++)
+            {
+                Merge(&result_, partial.table->GetKey(i), partial.table->GetHash(i), partial.table->GetStates(i));
+                FlushIfFull(&result_);
+            }
+            partial.table->Clear();
+            if (!partial.partitions.empty())
+                QueuePartitions(&partial, 0);
+        }
+    }
+    else
+    {
+        AbstractExecutor *input = scans.empty() ? child_.get() : scans[0].get();
+        if (scans.empty())
+            child_->Init();
+        while (input->NextBatch(&batch))
+            Aggregate(batch, &result_, &key, &group_states);
+    }
+
+    // groups in memory may have rows flushed to disk too, they are all merged partition by partition
+    spilled_ = !pending_.empty() || !result_.partitions.empty();
+    if (spilled_)
+    {
+        QueuePartitions(&result_, 0);
+        NextPartition();
+    }
+    else if (group_columns_.empty() && result_.table->GetGroupCount() == 0)
+    {
+        // aggregates over no rows at all still make a row
+        result_.table->FindOrInsert({}, std::hash<std::string_view>{}({}));
+    }
+}
+
+bool HashAggregateExecutor::NextBatch(RowBatch *batch)
+{
+    batch->Reset(GetOutputSchema());
+    while (!batch->Full())
+    {
+        if (result_pos_ == result_.table->GetGroupCount() && !NextPartition())
+            break;
+        Emit(result_pos_++, batch);
+    }
+    return batch->Size() > 0;
+}
+
+void HashAggregateExecutor::Stop()
+{
+    child_->Stop();
+    pending_.clear();
+}
+
+void HashAggregateExecutor::Aggregate(const RowBatch &batch, Sink *sink, std::string *key,
+                                      std::vector<AggregateState *> *group_states) const
+{
+    const std::vector<uint32_t> &selection = batch.GetSelection();
+    if (selection.empty())
+        return;
+    group_states->resize(selection.size());
+    if (group_columns_.empty())
+    {
+        AggregateState *states = sink->table->FindOrInsert({}, std::hash<std::string_view>{}({}));
+        std::fill(group_states->begin(), group_states->end(), states);
+    }
+    else
+    {
+        for (size_t k = 0; k < selection.size(); k++)
+        {
+            MakeKey(batch, selection[k], key);
+            (*group_states)[k] = sink->table->FindOrInsert(*key, std::hash<std::string_view>{}(*key));
+        }
+    }
+
+    // one aggregate at a time over the whole batch
+    for (size_t a = 0; a < agg_columns_.size(); a++)
+    {
+        AggregationType type = plan_->agg_types_[a];
+        if (type == AggregationType::CountStarAggregate)
+        {
+            for (size_t k = 0; k < selection.size(); k++)
+                (*group_states)[k][a].count++;
+            continue;
+        }
+        const ColumnVector &column = batch.GetColumn(agg_columns_[a]);
+        const uint8_t *nulls = column.GetNulls();
+        const int32_t *ints = column.GetInts();
+        const float *floats = column.GetFloats();
+        bool is_int = column.GetType() == kTypeInt;
+        bool min = type == AggregationType::MinAggregate;
+        for (size_t k = 0; k < selection.size(); k++)
+        {
+            uint32_t i = selection[k];
+            if (nulls[i])
+                continue;
+            AggregateState &state = (*group_states)[k][a];
+            switch (type)
+            {
+            case AggregationType::SumAggregate:
+            case AggregationType::AvgAggregate:
+                if (is_int && type == AggregationType::SumAggregate)
+                    state.int_sum += ints[i];
+                else
+                    state.float_sum += is_int ? ints[i] : floats[i];
+                break;
+            case AggregationType::MinAggregate:
+            case AggregationType::MaxAggregate:
+                if (is_int)
+                {
+                    if (Replaces(state, state.int_value, ints[i], min))
+                        state.int_value = ints[i];
+                }
+                else if (column.GetType() == kTypeFloat)
+                {
+                    if (Replaces(state, state.float_value, floats[i], min))
+                        state.float_value = floats[i];
+                }
+                else if (ReplacesChars(state, column.GetChars(i), column.GetLength(i), min))
+                {
+                    state.chars = sink->table->CopyChars(column.GetChars(i), column.GetLength(i));
+                    state.length = column.GetLength(i);
+                }
+                break;
+            default:
+                break;
+            }
+            state.count++;
+        }
+    }
+    FlushIfFull(sink);
+}
+
+void HashAggregateExecutor::MakeKey(const RowBatch &batch, size_t i, std::string *key) const
+{
+    // a null bitmap, then the values that are not null
+    key->assign((group_columns_.size() + 7) / 8, 0);
+    for (size_t c = 0; c < group_columns_.size(); c++)
+    {
+        const ColumnVector &column = batch.GetColumn(group_columns_[c]);
+        if (column.IsNull(i))
+        {
+            (*key)[c / 8] |= static_cast<char>(1 << (c % 8));
+            continue;
+        }
+        switch (column.GetType())
+        {
+        case kTypeInt:
+            key->append(reinterpret_cast<const char *>(&column.GetInts()[i]), sizeof(int32_t));
+            break;
+        case kTypeFloat:
+        {
+            // 0 and -0 are the same group
+            float value = column.GetFloats()[i] == 0 ? 0.0f : column.GetFloats()[i];
+            key->append(reinterpret_cast<const char *>(&value), sizeof(float));
+            break;
+        }
+        default:
+        {
+            uint32_t length = column.GetLength(i);
+            key->append(reinterpret_cast<const char *>(&length), sizeof(uint32_t));
+            key->append(column.GetChars(i), length);
+        }
+        }
+    }
+}
+
+void HashAggregateExecutor::Merge(Sink *sink, std::string_view key, uint64_t hash,
+                                  const AggregateState *states) const
+{
+    AggregateState *target = sink->table->FindOrInsert(key, hash);
+    for (size_t a = 0; a < agg_columns_.size(); a++)
+    {
+        const AggregateState &from = states[a];
+        AggregateState &state = target[a];
+        if (from.count == 0)
+            continue;
+        AggregationType type = plan_->agg_types_[a];
+        bool min = type == AggregationType::MinAggregate;
+        switch (type)
+        {
+        case AggregationType::SumAggregate:
+        case AggregationType::AvgAggregate:
+            if (agg_input_types_[a] == kTypeInt && type == AggregationType::SumAggregate)
+                state.int_sum += from.int_sum;
+            else
+                state.float_sum += from.float_sum;
+            break;
+        case AggregationType::MinAggregate:
+        case AggregationType::MaxAggregate:
+            if (agg_input_types_[a] == kTypeInt)
+            {
+                if (Replaces(state, state.int_value, from.int_value, min))
+                    state.int_value = from.int_value;
+            }
+            else if (agg_input_types_[a] == kTypeFloat)
+            {
+                if (Replaces(state, state.float_value, from.float_value, min))
+                    state.float_value = from.float_value;
+            }
+            else if (ReplacesChars(state, from.chars, from.length, min))
+            {
+                state.chars = sink->table->CopyChars(from.chars, from.length);
+                state.length = from.length;
+            }
+            break;
+        default:
+            break;
+        }
+        state.count += from.count;
+    }
+}
+
+void HashAggregateExecutor::FlushIfFull(Sink *sink) const
+{
+    // a table of a single group can not be split any further
+    if (sink->level < MAX_LEVELS && sink->table->GetGroupCount() > 1 &&
+        sink->table->GetMemoryUsage() > sink->budget)
+        Flush(sink);
+}
+
+void HashAggregateExecutor::Flush(Sink *sink) const
+{
+    BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+    if (sink->partitions.empty())
+    {
+        for (uint32_t i = 0; i < FANOUT; i++)
+            sink->partitions.push_back(std::make_unique<SpillPartition>(bpm, group_schema_.get()));
+    }
+    std::string buffer;
+    for (size_t i = 0; i < sink->table->GetGroupCount(); i++)
+    {
+        EncodeGroup(*sink->table, i, &buffer);
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeChar, buffer.data(), buffer.size(), false);
+        Row row(fields);
+        sink->partitions[PartitionOf(sink->table->GetHash(i), sink->level)]->Append(row);
+    }
+    sink->table->Clear();
+}
+
+void HashAggregateExecutor::EncodeGroup(const AggregateHashTable &table, size_t i, std::string *buffer) const
+{
+    uint64_t hash = table.GetHash(i);
+    std::string_view key = table.GetKey(i);
+    auto key_size = static_cast<uint32_t>(key.size());
+    buffer->assign(reinterpret_cast<const char *>(&hash), sizeof(hash));
+    buffer->append(reinterpret_cast<const char *>(&key_size), sizeof(key_size));
+    buffer->append(key);
+    const AggregateState *states = table.GetStates(i);
+    buffer->append(reinterpret_cast<const char *>(states), agg_columns_.size() * sizeof(AggregateState));
+    for (size_t a = 0; a < agg_columns_.size(); a++)
+    {
+        if (agg_input_types_[a] == kTypeChar && states[a].count > 0)
+            buffer->append(states[a].chars, states[a].length);
+    }
+}
+
+void HashAggregateExecutor::MergePending(const PendingPartition &pending, Sink *sink) const
+{
+    std::vector<Row> rows;
+    std::vector<AggregateState> states(agg_columns_.size());
+    for (auto &part : pending.parts)
+    {
+        for (size_t p = 0; p < part->GetPageCount(); p++)
+        {
+            part->ReadPage(p, &rows);
+            for (auto &row : rows)
+            {
+                const char *data = row.GetField(0)->GetData();
+                uint64_t hash;
+                uint32_t key_size;
+                memcpy(&hash, data, sizeof(hash));
+                memcpy(&key_size, data + sizeof(hash), sizeof(key_size));
+                std::string_view key(data + sizeof(hash) + sizeof(key_size), key_size);
+                const char *pos = key.data() + key_size;
+                memcpy(states.data(), pos, states.size() * sizeof(AggregateState));
+                pos += states.size() * sizeof(AggregateState);
+                for (size_t a = 0; a < states.size(); a++)
+                {
+                    if (agg_input_types_[a] == kTypeChar && states[a].count > 0)
+                    {
+                        states[a].chars = pos;
+                        pos += states[a].length;
+                    }
+                }
+                Merge(sink, key, hash, states.data());
+                FlushIfFull(sink);
+            }
+        }
+    }
+}
+
+void HashAggregateExecutor::QueuePartitions(Sink *sink, size_t first)
+{
+    Flush(sink);
+    if (pending_.size() == first)
+    {
+        for (uint32_t i = 0; i < FANOUT; i++)
+            pending_.push_back(PendingPartition{{}, sink->level + 1});
+    }
+    for (uint32_t i = 0; i < FANOUT; i++)
+    {
+        if (sink->partitions[i]->GetRowCount() > 0)
+            pending_[first + i].parts.push_back(std::move(sink->partitions[i]));
+    }
+    sink->partitions.clear();
+}
+
+bool HashAggregateExecutor::NextPartition()
+{
+    while (!pending_.empty())
+    {
+        PendingPartition pending = std::move(pending_.back());
+        pending_.pop_back();
+        result_ = MakeSink(pending.level, plan_->memory_budget_);
+        result_pos_ = 0;
+        MergePending(pending, &result_);
+        if (!result_.partitions.empty())
+        {
+            QueuePartitions(&result_, pending_.size());
+            continue;
+        }
+        if (result_.table->GetGroupCount() > 0)
+            return true;
+    }
+    return false;
+}
+
+void HashAggregateExecutor::Emit(size_t i, RowBatch *batch) const
+{
+    std::vector<Field> fields;
+    fields.reserve(group_columns_.size() + agg_columns_.size());
+    std::string_view key = result_.table->GetKey(i);
+    const char *pos = key.data() + (group_columns_.size() + 7) / 8;
+    for (size_t c = 0; c < group_columns_.size(); c++)
+    {
+        if (key[c / 8] & (1 << (c % 8)))
+        {
+            fields.emplace_back(group_types_[c]);
+            continue;
+        }
+        switch (group_types_[c])
+        {
+        case kTypeInt:
+        {
+            int32_t value;
+            memcpy(&value, pos, sizeof(value));
+            pos += sizeof(value);
+            fields.emplace_back(kTypeInt, value);
+            break;
+        }
+        case kTypeFloat:
+        {
+            float value;
+            memcpy(&value, pos, sizeof(value));
+            pos += sizeof(value);
+            fields.emplace_back(kTypeFloat, value);
+            break;
+        }
+        default:
+        {
+            uint32_t length;
+            memcpy(&length, pos, sizeof(length));
+            fields.emplace_back(kTypeChar, const_cast<char *>(pos + sizeof(length)), length, true);
+            pos += sizeof(length) + length;
+        }
+        }
+    }
+    const AggregateState *states = result_.table->GetStates(i);
+    for (size_t a = 0; a < agg_columns_.size(); a++)
+    {
+        const AggregateState &state = states[a];
+        AggregationType type = plan_->agg_types_[a];
+        if (type == AggregationType::CountStarAggregate || type == AggregationType::CountAggregate)
+            fields.emplace_back(kTypeInt, static_cast<int32_t>(state.count));
+        else if (state.count == 0)
+            fields.emplace_back(agg_output_types_[a]);
+        else if (type == AggregationType::AvgAggregate)
+            fields.emplace_back(kTypeFloat, static_cast<float>(state.float_sum / state.count));
+        else if (type == AggregationType::SumAggregate)
+        {
+            if (agg_input_types_[a] == kTypeInt)
+            {
+                // the sum is kept in 64 bits but goes out as an int, as its column is typed
+                if (state.int_sum > INT32_MAX || state.int_sum < INT32_MIN)
+                    throw std::runtime_error("integer out of range in SUM");
+                fields.emplace_back(kTypeInt, static_cast<int32_t>(state.int_sum));
+            }
+            else
+                fields.emplace_back(kTypeFloat, static_cast<float>(state.float_sum));
+        }
+        else if (agg_input_types_[a] == kTypeInt)
+            fields.emplace_back(kTypeInt, state.int_value);
+        else if (agg_input_types_[a] == kTypeFloat)
+            fields.emplace_back(kTypeFloat, state.float_value);
+        else
+            fields.emplace_back(kTypeChar, const_cast<char *>(state.chars), state.length, true);
+    }
+    Row aggregated(fields);
+    std::vector<Field> output;
+    output.reserve(plan_->columns_.size());
+    for (auto &column : plan_->columns_)
+        output.emplace_back(column->Evaluate(&aggregated));
+    Row row(output);
+    batch->Append(row);
+}
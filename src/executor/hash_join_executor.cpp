@@ -0,0 +1,277 @@
+#include "executor/executors/hash_join_executor.h"
+
+#include <tuple>
+
+HashJoinExecutor::HashJoinExecutor(ExecuteContext *exec_ctx, const HashJoinPlanNode *plan,
+                                   std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right)
+    : AbstractExecutor(exec_ctx), plan_(plan)
+{
+    if (plan_->build_left_)
+    {
+        build_executor_ = std::move(left);
+        probe_executor_ = std::move(right);
+        build_keys_ = &plan_->left_keys_;
+        probe_keys_ = &plan_->right_keys_;
+    }
+    else
+    {
+        build_executor_ = std::move(right);
+        probe_executor_ = std::move(left);
+        build_keys_ = &plan_->right_keys_;
+        probe_keys_ = &plan_->left_keys_;
+    }
+}
+
+void HashJoinExecutor::Init()
+{
+    table_.clear();
+    table_bytes_ = 0;
+    spilled_ = false;
+    partitions_.clear();
+    current_ = Partition();
+    probe_batch_.Reset(probe_executor_->GetOutputSchema());
+    probe_rows_.clear();
+    probe_pos_ = 0;
+
+    build_executor_->Init();
+    RowBatch batch;
+    Row row;
+    std::string key;
+    while (build_executor_->NextBatch(&batch))
+    {
+        for (uint32_t i : batch.GetSelection())
+        {
+            batch.GetRow(i, &row);
+            if (!MakeKey(*build_keys_, row, &key))
+                continue;
+            if (spilled_)
+                partitions_[PartitionOf(key, 0)].build->Append(row);
+            else if (!Insert(key, row))
+                SpillBuild();
+        }
+    }
+    // the probe side starts only once the build side is done, two parallel scans running at
+    // once would compete for the workers of the pool
+    probe_executor_->Init();
+    while (spilled_ && probe_executor_->NextBatch(&batch))
+    {
+        for (uint32_t i : batch.GetSelection())
+        {
+            batch.GetRow(i, &row);
+            if (MakeKey(*probe_keys_, row, &key))
+                partitions_[PartitionOf(key, 0)].probe->Append(row);
+        }
+    }
+    match_ = match_end_ = table_.cend();
+}
+
+bool HashJoinExecutor::NextBatch(RowBatch *batch)
+{
+    batch->Reset(GetOutputSchema());
+    while (!batch->Full())
+    {
+        if (match_ != match_end_)
+        {
+            Emit(match_->second, *probe_row_, batch);
+            ++match_;
+            continue;
+        }
+        probe_row_ = NextProbeRow();
+        if (probe_row_ == nullptr)
+            break;
+        match_ = match_end_ = table_.cend();
+        if (MakeKey(*probe_keys_, *probe_row_, &probe_key_))
+            std::tie(match_, match_end_) = table_.equal_range(probe_key_);
+    }
+    return batch->Size() > 0;
+}
+
+void HashJoinExecutor::Stop()
+{
+    build_executor_->Stop();
+    probe_executor_->Stop();
+}
+
+bool HashJoinExecutor::MakeKey(const std::vector<AbstractExpressionRef> &keys, const Row &row, std::string *key)
+{
+    key->clear();
+    for (auto &expr : keys)
+    {
+        Field field = expr->Evaluate(&row);
+        if (field.IsNull())
+            return false;
+        // an int key may meet a float one, both go in as the double holding either exactly
+        if (field.GetTypeId() == kTypeInt || field.GetTypeId() == kTypeFloat)
+        {
+            double value;
+            if (field.GetTypeId() == kTypeInt)
+            {
+                int32_t integer;
+                field.SerializeTo(reinterpret_cast<char *>(&integer));
+                value = integer;
+            }
+            else
+            {
+                float real;
+                field.SerializeTo(reinterpret_cast<char *>(&real));
+                value = real;
+            }
+            // 0 and -0 are equal but serialize differently
+            if (value == 0)
+                value = 0;
+            key->append(reinterpret_cast<const char *>(&value), sizeof(double));
+            continue;
+        }
+        size_t offset = key->size();
+        key->resize(offset + field.GetSerializedSize());
+        field.SerializeTo(&(*key)[offset]);
+    }
+    return true;
+}
+
+uint32_t HashJoinExecutor::PartitionOf(const std::string &key, uint32_t level)
+{
+    return (std::hash<std::string>{}(key) >> (level * PARTITION_BITS)) % FANOUT;
+}
+
+bool HashJoinExecutor::Insert(const std::string &key, const Row &row)
+{
+    table_.emplace(key, row);
+    // the key, the row's fields and the node holding them
+    table_bytes_ +=
+        key.size() + row.GetFieldCount() * (sizeof(Field) + sizeof(Field *)) + sizeof(HashTable::value_type);
+    for (uint32_t i = 0; i < row.GetFieldCount(); i++)
+        table_bytes_ += row.GetField(i)->GetTypeId() == kTypeChar ? row.GetField(i)->GetLength() : 0;
+    return table_bytes_ <= plan_->memory_budget_;
+}
+
+void HashJoinExecutor::SpillBuild()
+{
+    spilled_ = true;
+    AddPartitions(0);
+    for (auto &entry : table_)
+        partitions_[PartitionOf(entry.first, 0)].build->Append(entry.second);
+    table_.clear();
+    table_bytes_ = 0;
+}
+
+size_t HashJoinExecutor::AddPartitions(uint32_t level)
+{
+    BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+    size_t first = partitions_.size();
+    for (uint32_t i = 0; i < FANOUT; i++)
+    {
+        partitions_.push_back({std::make_unique<SpillPartition>(bpm, build_executor_->GetOutputSchema()),
+                               std::make_unique<SpillPartition>(bpm, probe_executor_->GetOutputSchema()), level});
+    }
+    return first;
+}
+
+void HashJoinExecutor::Repartition(Partition &partition)
+{
+    uint32_t level = partition.level + 1;
+    size_t first = AddPartitions(level);
+    std::string key;
+    std::vector<Row> rows;
+    for (size_t i = 0; i < partition.build->GetPageCount(); i++)
+    {
+        partition.build->ReadPage(i, &rows);
+        for (auto &row : rows)
+        {
+            MakeKey(*build_keys_, row, &key);
+            partitions_[first + PartitionOf(key, level)].build->Append(row);
+        }
+    }
+    for (size_t i = 0; i < partition.probe->GetPageCount(); i++)
+    {
+        partition.probe->ReadPage(i, &rows);
+        for (auto &row : rows)
+        {
+            MakeKey(*probe_keys_, row, &key);
+            partitions_[first + PartitionOf(key, level)].probe->Append(row);
+        }
+    }
+}
+
+bool HashJoinExecutor::NextPartition()
+{
+    std::string key;
+    std::vector<Row> rows;
+    while (!partitions_.empty())
+    {
+        Partition partition = std::move(partitions_.back());
+        partitions_.pop_back();
+        table_.clear();
+        table_bytes_ = 0;
+        if (partition.build->GetRowCount() == 0 || partition.probe->GetRowCount() == 0)
+            continue;
+        bool fits = true;
+        for (size_t i = 0; fits && i < partition.build->GetPageCount(); i++)
+        {
+            partition.build->ReadPage(i, &rows);
+            for (auto &row : rows)
+            {
+                MakeKey(*build_keys_, row, &key);
+                if (!Insert(key, row) && partition.level + 1 < MAX_LEVELS)
+                {
+                    fits = false;
+                    break;
+                }
+            }
+        }
+        if (!fits)
+        {
+            table_.clear();
+            table_bytes_ = 0;
+            Repartition(partition);
+            continue;
+        }
+        current_ = std::move(partition);
+        probe_page_ = 0;
+        return true;
+    }
+    current_ = Partition();
+    return false;
+}
+
+const Row *HashJoinExecutor::NextProbeRow()
+{
+    if (!spilled_)
+    {
+        while (probe_pos_ == probe_batch_.GetSelection().size())
+        {
+            probe_pos_ = 0;
+            if (!probe_executor_->NextBatch(&probe_batch_))
+                return nullptr;
+        }
+        probe_batch_.GetRow(probe_batch_.GetSelection()[probe_pos_++], &probe_buffer_);
+        return &probe_buffer_;
+    }
+    while (probe_pos_ == probe_rows_.size())
+    {
+        if (current_.probe == nullptr || probe_page_ == current_.probe->GetPageCount())
+        {
+            if (!NextPartition())
+                return nullptr;
+            continue;
+        }
+        current_.probe->ReadPage(probe_page_++, &probe_rows_);
+        probe_pos_ = 0;
+    }
+    return &probe_rows_[probe_pos_++];
+}
+
+void HashJoinExecutor::Emit(const Row &build_row, const Row &probe_row, RowBatch *batch)
+{
+    const Row *left = plan_->build_left_ ? &build_row : &probe_row;
+    const Row *right = plan_->build_left_ ? &probe_row : &build_row;
+    if (plan_->predicate_ != nullptr &&
+        plan_->predicate_->EvaluateJoin(left, right).CompareEquals(Field(kTypeInt, 1)) != CmpBool::kTrue)
+        return;
+    std::vector<Field> fields;
+    fields.reserve(plan_->columns_.size());
+    for (auto &column : plan_->columns_)
+        fields.emplace_back(column->EvaluateJoin(left, right));
+    Row row(fields);
+    batch->Append(row);
+}
@@ -1,95 +1,146 @@
 #include "executor/executors/index_scan_executor.h"
-#include <algorithm>
-/**
- * TODO: Student Implement
- */
+
 IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
 
+namespace
+{
+/** Hands out the row ids of a bitmap in heap order */
+class RowIdListCursor : public IndexScanCursor
+{
+public:
+    explicit RowIdListCursor(const RowIdBitmap &bitmap) { bitmap.ToVector(rids_); }
+
+    bool Next(RowId *rid) override
+    {
+        if (pos_ == rids_.size())
+            return false;
+        *rid = rids_[pos_++];
+        return true;
+    }
+
+private:
+    std::vector<RowId> rids_;
+    size_t pos_{0};
+};
+
+std::unique_ptr<IndexScanCursor> OpenRange(const IndexScanRange &range)
+{
+    // an empty bound leaves that side open
+    std::vector<Field> lower_fields(range.lower_key);
+    std::vector<Field> upper_fields(range.upper_key);
+    Row lower(lower_fields);
+    Row upper(upper_fields);
+    return range.index->GetIndex()->Scan(lower_fields.empty() ? nullptr : &lower, range.lower_inclusive,
+                                         upper_fields.empty() ? nullptr : &upper, range.upper_inclusive, nullptr);
+}
+} // namespace
+
 void IndexScanExecutor::Init()
 {
     std::string table_name = plan_->GetTableName();
     exec_ctx_->GetCatalog()->GetTable(table_name, table_info);
-    Schema *schema = table_info->GetSchema();
-
-    std::map<uint32_t, IndexInfo *> col_idx_map;
-    for (auto index : plan_->indexes_)
+    residual_filter_ = plan_->need_filter_ && plan_->GetPredicate() != nullptr;
+    output_columns_.clear();
+    for (auto col : plan_->OutputSchema()->GetColumns())
+        output_columns_.push_back(col->GetTableInd());
+    entry_columns_.clear();
+    if (plan_->IsSingleRange() && plan_->index_only_)
     {
-        uint32_t idx;
-        if (schema->GetColumnIndex(index->GetIndexName(), idx) != DB_SUCCESS)
+        const IndexScanRange &range = plan_->range_sets_[0][0];
+        for (auto col : range.index->GetIndexKeySchema()->GetColumns())
+            entry_columns_.push_back(col->GetTableInd());
+        if (range.index->GetIncludeSchema() != nullptr)
         {
-            idx = index->GetIndexKeySchema()->GetColumns()[0]->GetTableInd();
+            for (auto col : range.index->GetIncludeSchema()->GetColumns())
+                entry_columns_.push_back(col->GetTableInd());
         }
-        col_idx_map[idx] = index;
     }
+    // the ranges are opened by the first NextBatch(), a scan that is never read costs nothing
+    cursor_ = nullptr;
+    opened_ = false;
+    produced_ = 0;
+}
 
-    std::vector<std::vector<RowId>> scan_buffer{};
-    ScanIndex(plan_->GetPredicate(), col_idx_map, scan_buffer);
-    res = scan_buffer[0];
-    for (int i = 1; i < scan_buffer.size(); i++)
+void IndexScanExecutor::Open()
+{
+    opened_ = true;
+    if (plan_->IsSingleRange())
     {
-        auto end = set_intersection(res.begin(), res.end(), scan_buffer[i].begin(), scan_buffer[i].end(), res.begin(), [](RowId a, RowId b)
-                                    { return a.Get() < b.Get(); });
-        res.resize(end - res.begin());
+        cursor_ = OpenRange(plan_->range_sets_[0][0]);
+        return;
     }
-    iter = res.begin();
-}
 
-bool IndexScanExecutor::Next(Row *row, RowId *rid)
-{
-    while (iter != res.end())
+    // union within a set, intersection across sets, both on compressed bitmaps; the
+    // result comes out in heap order
+    RowIdBitmap result;
+    for (size_t i = 0; i < plan_->range_sets_.size(); i++)
     {
-        Row current_row(*iter);
-        table_info->GetTableHeap()->GetTuple(&current_row, nullptr);
-        if (plan_->need_filter_ == false ||
-            plan_->filter_predicate_.get()->Evaluate(&current_row).CompareEquals(Field(kTypeInt, 1)))
-        {
-            vector<Field> output{};
-            auto columns = plan_->OutputSchema()->GetColumns();
-            for (int idx = 0; auto col : columns)
-            {
-                output.push_back(*current_row.GetField(col->GetTableInd()));
-            }
-            *row = Row(output);
-            row->SetRowId(*iter);
-            *rid = RowId(*iter);
-            ++iter;
-            return true;
-        }
+        RowIdBitmap set;
+        for (auto &range : plan_->range_sets_[i])
+            OpenRange(range)->CollectRowIds(&set);
+        if (i == 0)
+            result = std::move(set);
         else
-            ++iter;
+            result.IntersectWith(set);
+        if (result.Empty())
+            break;
     }
-    return false;
+    cursor_ = std::make_unique<RowIdListCursor>(result);
+}
+
+void IndexScanExecutor::Stop()
+{
+    opened_ = true;
+    cursor_ = nullptr;
 }
 
-void IndexScanExecutor::ScanIndex(AbstractExpressionRef node, const std::map<uint32_t, IndexInfo *> &map, std::vector<std::vector<RowId>> &res)
+bool IndexScanExecutor::FetchRow(Row *row, RowId *rid)
 {
-    if (node->GetType() == ExpressionType::ComparisonExpression && node->GetChildAt(0)->GetType() == ExpressionType::ColumnExpression && node->GetChildAt(1)->GetType() == ExpressionType::ConstantExpression)
-    // leaf node
+    if (cursor_ == nullptr)
+        return false;
+    if (!plan_->index_only_)
     {
-        auto col_idx = dynamic_pointer_cast<ColumnValueExpression>(node->GetChildAt(0))->GetColIdx();
-        if (map.count(col_idx))
-        // has index
-        {
-            std::string operand_ = dynamic_pointer_cast<ComparisonExpression>(node)->GetComparisonType();
-            const Field &operator_ = dynamic_pointer_cast<ConstantValueExpression>(node->GetChildAt(1))->val_;
-            std::vector<Field> f{Field(operator_)};
-            Row r(f);
-            std::vector<RowId> tmp{};
-            map.at(col_idx)->GetIndex()->ScanKey(r, tmp, nullptr, operand_);
-            std::sort(tmp.begin(), tmp.end(),
-                      [](RowId a, RowId b)
-                      {
-                          return a.Get() < b.Get();
-                      });
-            res.push_back(tmp);
-        }
-        else if (plan_->need_filter_ != true)
-            throw std::runtime_error("need_filter should be true");
+        if (!cursor_->Next(rid))
+            return false;
+        *row = Row(*rid);
+        table_info->GetTableHeap()->GetTuple(row, nullptr);
+        return true;
     }
-    else
+    Row entry;
+    if (!cursor_->NextEntry(rid, &entry))
+        return false;
+    // columns the index does not hold stay null, the plan guarantees nobody reads them
+    std::vector<Field> fields;
+    for (auto col : table_info->GetSchema()->GetColumns())
+        fields.emplace_back(col->GetType());
+    for (size_t i = 0; i < entry_columns_.size(); i++)
+        fields[entry_columns_[i]] = *entry.GetField(i);
+    *row = Row(fields);
+    row->SetRowId(*rid);
+    return true;
+}
+
+bool IndexScanExecutor::Next(Row *row, RowId *rid)
+{
+    return NextFromBatch(row, rid);
+}
+
+bool IndexScanExecutor::NextBatch(RowBatch *batch)
+{
+    batch->Reset(plan_->OutputSchema());
+    if (!opened_)
+        Open();
+    RowId current_rid;
+    Row current_row;
+    // under a row limit, no more rows are fetched from the heap than it takes to reach it
+    while (!batch->Full() && produced_ + batch->Size() < row_limit_ && FetchRow(&current_row, &current_rid))
     {
-        for (int i = 0; i < node->GetChildren().size(); i++)
-            ScanIndex(node->GetChildAt(i), map, res);
+        if (!residual_filter_ || plan_->EvaluatePredicate(&current_row))
+            batch->Append(current_row, output_columns_, current_rid);
     }
+    produced_ += batch->Size();
+    if (produced_ >= row_limit_)
+        Stop();
+    return batch->Size() > 0;
 }
@@ -4,6 +4,24 @@
 
 #include "executor/executors/insert_executor.h"
 
+namespace
+{
+/** Whether two index entries hold the same values */
+bool SameEntry(const Row &lhs, const Row &rhs)
+{
+    if (lhs.GetFieldCount() != rhs.GetFieldCount())
+        return false;
+    for (uint32_t i = 0; i < lhs.GetFieldCount(); i++)
+    {
+        const Field *a = lhs.GetField(i);
+        const Field *b = rhs.GetField(i);
+        if (a->IsNull() || b->IsNull() ? a->IsNull() != b->IsNull() : a->CompareEquals(*b) != CmpBool::kTrue)
+            return false;
+    }
+    return true;
+}
+} // namespace
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -14,84 +32,168 @@ void InsertExecutor::Init()
     exec_ctx_->GetCatalog()->GetTable(table_name, table_info);
     exec_ctx_->GetCatalog()->GetTableIndexes(table_name, indexes);
     child_executor_->Init();
+}
 
-#ifndef INSERT_NEXT_VERSION
-    Row row;
-    RowId rid;
-    while (child_executor_->Next(&row, &rid))
+void InsertExecutor::InsertBatch(std::vector<Row> &rows, RowBatch *batch)
+{
+    std::vector<RowId> row_ids;
+    for (auto &row : rows)
     {
-        bool flag = false;
-        std::vector<Row> keys;
-        keys.clear();
-        for (auto idx : indexes)
+        table_info->GetTableHeap()->InsertTuple(row, nullptr);
+        row_ids.push_back(row.GetRowId());
+    }
+
+    // the first row clashing with a unique key, of the table or of an earlier row
+    size_t conflict = rows.size();
+    std::vector<std::vector<Row>> keys(indexes.size());
+    std::vector<std::vector<bool>> inserted(indexes.size());
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+        for (auto &row : rows)
+            keys[i].push_back(indexes[i]->GetEntry(row));
+        indexes[i]->GetIndex()->InsertEntries(keys[i], row_ids, inserted[i], nullptr);
+        if (!indexes[i]->IsUnique())
+            continue;
+        for (size_t j = 0; j < conflict; j++)
         {
-            std::vector<Field> key_fields;
-            for (auto col : idx->GetIndexKeySchema()->GetColumns())
-                key_fields.push_back(*row.GetField(col->GetTableInd()));
-
-            Row key(key_fields);
-            keys.push_back(key);
-            std::vector<RowId> scan_buffer;
-            if (idx->GetIndex()->ScanKey(key, scan_buffer, nullptr) == DB_SUCCESS) // index already exists
+            if (!inserted[i][j])
             {
-                flag = true;
+                conflict = j;
                 break;
             }
         }
-        if (flag)
-            continue;
+    }
 
-        table_info->GetTableHeap()->InsertTuple(row, nullptr);
-        if (keys.size() != indexes.size())
-            throw std::runtime_error("size of both containers should equal.");
-        for (int i = 0; i < keys.size(); i++)
+    for (size_t j = conflict; j < rows.size(); j++)
+    {
+        for (size_t i = 0; i < indexes.size(); i++)
         {
-            indexes[i]->GetIndex()->InsertEntry(keys[i], row.GetRowId(), nullptr);
+            if (inserted[i][j])
+                indexes[i]->GetIndex()->RemoveEntry(keys[i][j], row_ids[j], nullptr);
         }
-        //? python flavor code, available in c++23
-        // for (auto const& [index, key] : std::views::zip(indexes, keys))
-        // {
-        //     index->GetIndex()->InsertEntry(key, row.GetRowId(), nullptr);
-        // }
+        table_info->GetTableHeap()->ApplyDelete(row_ids[j], nullptr);
     }
-    is_finished = true;
-#endif
+    if (conflict < rows.size())
+        stopped = true;
+    for (size_t j = 0; j < conflict; j++)
+        batch->AppendRowId(row_ids[j]);
 }
 
-bool InsertExecutor::Next([[maybe_unused]] Row *_row, RowId *_rid)
+bool InsertExecutor::Upsert(Row &row)
 {
-#ifdef INSERT_NEXT_VERSION
-    Row row;
-    RowId rid;
-    if (child_executor_->Next(&row, &rid))
+    TableHeap *table_heap = table_info->GetTableHeap();
+    table_heap->InsertTuple(row, nullptr);
+    RowId rid = row.GetRowId();
+
+    std::vector<Row> keys;
+    for (auto idx : indexes)
+        keys.push_back(idx->GetEntry(row));
+    // unique indexes first, they decide whether the row stays
+    RowId existing;
+    size_t conflict = indexes.size();
+    for (size_t i = 0; i < indexes.size() && conflict == indexes.size(); i++)
     {
-        std::vector<Row> keys{};
-        for (auto idx : indexes)
+        if (indexes[i]->IsUnique() &&
+            indexes[i]->GetIndex()->InsertOrGetEntry(keys[i], rid, &existing, nullptr) == DB_ALREADY_EXIST)
+            conflict = i;
+    }
+    if (conflict == indexes.size())
+    {
+        for (size_t i = 0; i < indexes.size(); i++)
         {
-            std::vector<Field> key_fields;
-            for (auto col : idx->GetIndexKeySchema()->GetColumns())
-                key_fields.push_back(*row.GetField(col->GetTableInd()));
-
-            Row key(key_fields);
-            keys.push_back(key);
-            std::vector<RowId> scan_buffer;
-            if (idx->GetIndex()->ScanKey(key, scan_buffer, nullptr) == DB_SUCCESS) // index already exists
-            {
-                return false;
-            }
+            if (!indexes[i]->IsUnique())
+                indexes[i]->GetIndex()->InsertEntry(keys[i], rid, nullptr);
         }
+        return true;
+    }
 
-        table_info->GetTableHeap()->InsertTuple(row, nullptr);
-        if (keys.size() != indexes.size())
-            throw std::runtime_error("size of both containers should be equal.");
-        for (int i = 0; i < keys.size(); i++)
-        {
-            indexes[i]->GetIndex()->InsertEntry(keys[i], row.GetRowId(), nullptr);
-        }
+    for (size_t i = 0; i < conflict; i++)
+    {
+        if (indexes[i]->IsUnique())
+            indexes[i]->GetIndex()->RemoveEntry(keys[i], rid, nullptr);
+    }
+    table_heap->ApplyDelete(rid, nullptr);
+    if (plan_->GetOnConflict() == OnConflict::DoNothing)
+        return false;
+    UpdateExisting(existing);
+    return true;
+}
+
+void InsertExecutor::UpdateExisting(const RowId &rid)
+{
+    Row old_row(rid);
+    table_info->GetTableHeap()->GetTuple(&old_row, nullptr);
+    std::vector<Field> fields;
+    for (uint32_t i = 0; i < old_row.GetFieldCount(); i++)
+        fields.emplace_back(*old_row.GetField(i));
+    for (auto &modify : plan_->GetUpdateAttr())
+    {
+        Field new_field = modify.second->Evaluate(&old_row);
+        fields[modify.first] = new_field;
+    }
+    Row new_row(fields);
+
+    TableHeap *table_heap = table_info->GetTableHeap();
+    table_heap->UpdateTuple(new_row, rid, nullptr);
+    // the row only gets a new id when it had to move to another page
+    RowId new_rid = new_row.GetRowId().GetPageId() == INVALID_PAGE_ID ? rid : new_row.GetRowId();
+    std::vector<Row> old_entries, new_entries;
+    size_t failed = indexes.size();
+    for (size_t i = 0; i < indexes.size() && failed == indexes.size(); i++)
+    {
+        old_entries.push_back(indexes[i]->GetEntry(old_row));
+        new_entries.push_back(indexes[i]->GetEntry(new_row));
+        if (new_rid == rid && SameEntry(old_entries[i], new_entries[i]))
+            continue;
+        indexes[i]->GetIndex()->RemoveEntry(old_entries[i], rid, nullptr);
+        if (indexes[i]->GetIndex()->InsertEntry(new_entries[i], new_rid, nullptr) != DB_SUCCESS)
+            failed = i;
+    }
+    if (failed == indexes.size())
+        return;
+
+    // the new values clash with another row of a unique index, put the old row back
+    for (size_t i = 0; i <= failed; i++)
+    {
+        if (new_rid == rid && SameEntry(old_entries[i], new_entries[i]))
+            continue;
+        if (i < failed)
+            indexes[i]->GetIndex()->RemoveEntry(new_entries[i], new_rid, nullptr);
+        indexes[i]->GetIndex()->InsertEntry(old_entries[i], rid, nullptr);
+    }
+    if (new_rid == rid)
+        table_heap->UpdateTuple(old_row, rid, nullptr);
+    else
+    {
+        table_heap->ApplyDelete(new_rid, nullptr);
+        table_heap->RollbackDelete(rid, nullptr);
+    }
+    throw std::runtime_error("duplicate key for unique index " + indexes[failed]->GetIndexName());
+}
+
+bool InsertExecutor::Next([[maybe_unused]] Row *_row, RowId *_rid)
+{
+    return NextFromBatch(_row, _rid);
+}
+
+bool InsertExecutor::NextBatch(RowBatch *batch)
+{
+    batch->Reset(nullptr);
+    if (stopped || !child_executor_->NextBatch(&input))
+        return false;
+    std::vector<Row> rows(input.GetSelection().size());
+    for (size_t j = 0; j < rows.size(); j++)
+        input.GetRow(input.GetSelection()[j], &rows[j]);
+
+    if (plan_->GetOnConflict() == OnConflict::Stop)
+    {
+        InsertBatch(rows, batch);
         return true;
     }
-    return false;
-#else
-    return is_finished;
-#endif
-}
\ No newline at end of file
+    for (auto &row : rows)
+    {
+        if (Upsert(row))
+            batch->AppendRowId(row.GetRowId());
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#include "executor/executors/limit_executor.h"
+
+#include <algorithm>
+
+void LimitExecutor::Init()
+{
+    produced_ = 0;
+    if (plan_->limit_ == 0)
+        return;
+    child_->SetRowLimit(std::min(plan_->limit_, row_limit_));
+    child_->Init();
+}
+
+bool LimitExecutor::NextBatch(RowBatch *batch)
+{
+    if (produced_ == plan_->limit_)
+    {
+        batch->Reset(GetOutputSchema());
+        return false;
+    }
+    if (!child_->NextBatch(batch))
+        return false;
+    std::vector<uint32_t> &selection = batch->GetSelection();
+    if (selection.size() > plan_->limit_ - produced_)
+        selection.resize(plan_->limit_ - produced_);
+    produced_ += selection.size();
+    // the rest of the tree stops at once rather than when it is destroyed
+    if (produced_ == plan_->limit_)
+        child_->Stop();
+    return true;
+}
+
+void LimitExecutor::Stop()
+{
+    if (plan_->limit_ > 0)
+        child_->Stop();
+}
@@ -0,0 +1,97 @@
+#include "executor/executors/nested_index_join_executor.h"
+
+NestedIndexJoinExecutor::NestedIndexJoinExecutor(ExecuteContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
+                                                 std::unique_ptr<AbstractExecutor> outer)
+    : AbstractExecutor(exec_ctx), plan_(plan), outer_executor_(std::move(outer))
+{
+}
+
+void NestedIndexJoinExecutor::Init()
+{
+    exec_ctx_->GetCatalog()->GetTable(plan_->inner_table_name_, inner_table_);
+    outer_executor_->Init();
+    outer_batch_.Reset(outer_executor_->GetOutputSchema());
+    outer_rows_.clear();
+    matches_.clear();
+    outer_pos_ = 0;
+    match_pos_ = 0;
+}
+
+bool NestedIndexJoinExecutor::NextBatch(RowBatch *batch)
+{
+    batch->Reset(GetOutputSchema());
+    while (!batch->Full())
+    {
+        if (outer_pos_ == outer_rows_.size())
+        {
+            if (!NextOuterBatch())
+                break;
+            continue;
+        }
+        if (match_pos_ == matches_[outer_pos_].size())
+        {
+            outer_pos_++;
+            match_pos_ = 0;
+            continue;
+        }
+        inner_row_ = Row(matches_[outer_pos_][match_pos_++]);
+        // entries of rows deleted by this transaction may still be in the index
+        if (!inner_table_->GetTableHeap()->GetTuple(&inner_row_, nullptr))
+            continue;
+        if (plan_->EvaluateInnerFilter(&inner_row_))
+            Emit(outer_rows_[outer_pos_], inner_row_, batch);
+    }
+    return batch->Size() > 0;
+}
+
+void NestedIndexJoinExecutor::Stop()
+{
+    outer_executor_->Stop();
+}
+
+bool NestedIndexJoinExecutor::NextOuterBatch()
+{
+    outer_rows_.clear();
+    outer_pos_ = 0;
+    match_pos_ = 0;
+    std::vector<Row> keys;
+    Row row;
+    while (keys.empty())
+    {
+        if (!outer_executor_->NextBatch(&outer_batch_))
+            return false;
+        for (uint32_t i : outer_batch_.GetSelection())
+        {
+            outer_batch_.GetRow(i, &row);
+            std::vector<Field> fields;
+            fields.reserve(plan_->outer_keys_.size());
+            bool has_null = false;
+            for (auto &expr : plan_->outer_keys_)
+            {
+                fields.emplace_back(expr->Evaluate(&row));
+                has_null |= fields.back().IsNull();
+            }
+            if (has_null)
+                continue;
+            keys.emplace_back(fields);
+            outer_rows_.push_back(row);
+        }
+    }
+    plan_->index_->GetIndex()->ScanKeys(keys, matches_, nullptr);
+    return true;
+}
+
+void NestedIndexJoinExecutor::Emit(const Row &outer_row, const Row &inner_row, RowBatch *batch)
+{
+    const Row *left = plan_->outer_left_ ? &outer_row : &inner_row;
+    const Row *right = plan_->outer_left_ ? &inner_row : &outer_row;
+    if (plan_->predicate_ != nullptr &&
+        plan_->predicate_->EvaluateJoin(left, right).CompareEquals(Field(kTypeInt, 1)) != CmpBool::kTrue)
+        return;
+    std::vector<Field> fields;
+    fields.reserve(plan_->columns_.size());
+    for (auto &column : plan_->columns_)
+        fields.emplace_back(column->EvaluateJoin(left, right));
+    Row row(fields);
+    batch->Append(row);
+}
@@ -0,0 +1,145 @@
+#include "executor/row_batch.h"
+
+void ColumnVector::Clear()
+{
+    nulls_.clear();
+    ints_.clear();
+    floats_.clear();
+    chars_.clear();
+    offsets_.resize(1);
+}
+
+void ColumnVector::Append(const Field &field)
+{
+    nulls_.push_back(field.IsNull());
+    switch (type_)
+    {
+    case TypeId::kTypeInt:
+    {
+        int32_t value = 0;
+        if (!field.IsNull())
+            field.SerializeTo(reinterpret_cast<char *>(&value));
+        ints_.push_back(value);
+        break;
+    }
+    case TypeId::kTypeFloat:
+    {
+        float value = 0;
+        if (!field.IsNull())
+            field.SerializeTo(reinterpret_cast<char *>(&value));
+        floats_.push_back(value);
+        break;
+    }
+    case TypeId::kTypeChar:
+    {
+        if (!field.IsNull())
+            chars_.insert(chars_.end(), field.GetData(), field.GetData() + field.GetLength());
+        offsets_.push_back(chars_.size());
+        break;
+    }
+    default:
+        ASSERT(false, "Unsupported column type.");
+    }
+}
+
+void ColumnVector::Append(const ColumnVector &other, size_t i)
+{
+    nulls_.push_back(other.nulls_[i]);
+    switch (type_)
+    {
+    case TypeId::kTypeInt:
+        ints_.push_back(other.ints_[i]);
+        break;
+    case TypeId::kTypeFloat:
+        floats_.push_back(other.floats_[i]);
+        break;
+    default:
+        chars_.insert(chars_.end(), other.GetChars(i), other.GetChars(i) + other.GetLength(i));
+        offsets_.push_back(chars_.size());
+        break;
+    }
+}
+
+Field ColumnVector::GetField(size_t i) const
+{
+    if (IsNull(i))
+        return Field(type_);
+    switch (type_)
+    {
+    case TypeId::kTypeInt:
+        return Field(type_, ints_[i]);
+    case TypeId::kTypeFloat:
+        return Field(type_, floats_[i]);
+    default:
+        return Field(type_, const_cast<char *>(GetChars(i)), GetLength(i), true);
+    }
+}
+
+void RowBatch::Reset(const Schema *schema)
+{
+    row_ids_.clear();
+    selection_.clear();
+    // a batch moved from keeps its schema but not its columns
+    if (schema != nullptr && schema == schema_ && columns_.size() == schema->GetColumnCount())
+    {
+        for (auto &column : columns_)
+            column.Clear();
+        return;
+    }
+    schema_ = schema;
+    columns_.clear();
+    if (schema != nullptr)
+    {
+        for (auto column : schema->GetColumns())
+            columns_.emplace_back(column->GetType());
+    }
+}
+
+void RowBatch::Append(const Row &tuple, const std::vector<uint32_t> &columns, const RowId &rid)
+{
+    ASSERT(columns.size() == columns_.size(), "The row must fill every column.");
+    for (size_t i = 0; i < columns.size(); i++)
+        columns_[i].Append(*tuple.GetField(columns[i]));
+    selection_.push_back(row_ids_.size());
+    row_ids_.push_back(rid);
+}
+
+void RowBatch::Append(const Row &row)
+{
+    if (schema_ == nullptr && Size() == 0)
+    {
+        columns_.clear();
+        for (uint32_t i = 0; i < row.GetFieldCount(); i++)
+            columns_.emplace_back(row.GetField(i)->GetTypeId());
+    }
+    ASSERT(row.GetFieldCount() == columns_.size(), "The row must fill every column.");
+    for (uint32_t i = 0; i < row.GetFieldCount(); i++)
+        columns_[i].Append(*row.GetField(i));
+    selection_.push_back(row_ids_.size());
+    row_ids_.push_back(row.GetRowId());
+}
+
+void RowBatch::Append(const RowBatch &other, size_t i, const std::vector<uint32_t> &columns)
+{
+    ASSERT(columns.size() == columns_.size(), "The row must fill every column.");
+    for (size_t j = 0; j < columns.size(); j++)
+        columns_[j].Append(other.columns_[columns[j]], i);
+    selection_.push_back(row_ids_.size());
+    row_ids_.push_back(other.row_ids_[i]);
+}
+
+void RowBatch::AppendRowId(const RowId &rid)
+{
+    selection_.push_back(row_ids_.size());
+    row_ids_.push_back(rid);
+}
+
+void RowBatch::GetRow(size_t i, Row *row) const
+{
+    std::vector<Field> fields;
+    fields.reserve(columns_.size());
+    for (auto &column : columns_)
+        fields.emplace_back(column.GetField(i));
+    *row = Row(fields);
+    row->SetRowId(row_ids_[i]);
+}
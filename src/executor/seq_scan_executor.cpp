@@ -6,40 +6,103 @@
 /**
  * TODO: Student Implement
  */
-SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan)
+SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan,
+                                 std::shared_ptr<MorselQueue> morsels)
     : AbstractExecutor(exec_ctx),
-      plan_(plan) {}
+      plan_(plan),
+      morsels(std::move(morsels)) {}
 
 void SeqScanExecutor::Init()
 {
     if (exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info) == DB_TABLE_NOT_EXIST)
         throw std::runtime_error("no such table");
-    table_iter = table_info->GetTableHeap()->Begin(nullptr);
-    end = table_info->GetTableHeap()->End();
+    next_page_id = table_info->GetTableHeap()->GetFirstPageId();
+    morsel_pos = morsel_end = 0;
+    produced = 0;
+    exhausted = row_limit_ == 0;
+    output_columns.clear();
+    for (auto col : plan_->OutputSchema()->GetColumns())
+        output_columns.push_back(col->GetTableInd());
+    table_columns.clear();
+    for (uint32_t i = 0; i < table_info->GetSchema()->GetColumnCount(); i++)
+        table_columns.push_back(i);
+    scan_mask.assign(MaskWords(RowBatch::CAPACITY), 0);
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid)
 {
-    while (table_iter != end)
+    return NextFromBatch(row, rid);
+}
+
+bool SeqScanExecutor::NextBatch(RowBatch *batch)
+{
+    batch->Reset(plan_->OutputSchema());
+    const CompiledPredicate *compiled = plan_->compiled_predicate_.get();
+    // A compiled filter runs over batches of whole rows before they are projected, an
+    // interpreted one on each row as it is read
+    RowBatch *target = compiled != nullptr ? &scan_batch : batch;
+    const std::vector<uint32_t> &columns = compiled != nullptr ? table_columns : output_columns;
+    while (batch->Size() == 0 && !exhausted)
     {
-        if (plan_->filter_predicate_ == nullptr ||
-            plan_->filter_predicate_.get()->Evaluate(table_iter.operator->()).CompareEquals(Field(kTypeInt, 1)))
+        if (compiled != nullptr)
+            scan_batch.Reset(table_info->GetSchema());
+        // under a row limit, no more pages are read than it takes to reach it
+        while (target->Size() + TablePage::MAX_TUPLE_COUNT <= RowBatch::CAPACITY &&
+               produced + target->Size() < row_limit_)
         {
-            vector<Field> output{};
-            auto columns = plan_->OutputSchema()->GetColumns();
-            Row *tuple = table_iter.operator->();
-            for (auto col : columns)
+            page_id_t page_id = NextPage();
+            if (page_id == INVALID_PAGE_ID)
             {
-                output.push_back(*tuple->GetField(col->GetTableInd()));
+                exhausted = true;
+                break;
             }
-            *row = Row(output);
-            row->SetRowId(table_iter.GetRid());
-            *rid = RowId(table_iter.GetRid());
-            ++table_iter;
-            return true;
+            ReadPage(page_id, target, columns, compiled == nullptr);
         }
-        else
-            ++table_iter;
+        if (compiled == nullptr)
+            continue;
+        compiled->Filter(scan_batch, scan_mask.data());
+        for (size_t i = 0; i < scan_batch.Size(); i++)
+        {
+            if (scan_mask[i / 64] >> (i % 64) & 1)
+                batch->Append(scan_batch, i, output_columns);
+        }
+    }
+    produced += batch->Size();
+    if (produced >= row_limit_)
+        exhausted = true;
+    return batch->Size() > 0;
+}
+
+page_id_t SeqScanExecutor::NextPage()
+{
+    if (morsels == nullptr)
+        return next_page_id;
+    if (morsel_pos == morsel_end && !morsels->Next(&morsel_pos, &morsel_end))
+        return INVALID_PAGE_ID;
+    return morsels->GetPageId(morsel_pos++);
+}
+
+void SeqScanExecutor::ReadPage(page_id_t page_id, RowBatch *target, const std::vector<uint32_t> &columns, bool filter)
+{
+    BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+    auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr)
+        throw std::runtime_error("failed to fetch a table page");
+    page->RLatch();
+    RowId rid;
+    bool found = page->GetFirstTupleRid(&rid);
+    while (found)
+    {
+        page_row.CleanRow();
+        page_row.SetRowId(rid);
+        page->GetTuple(&page_row, table_info->GetSchema(), nullptr, nullptr);
+        if (!filter || plan_->filter_predicate_ == nullptr || plan_->EvaluatePredicate(&page_row))
+            target->Append(page_row, columns, rid);
+        RowId next;
+        found = page->GetNextTupleRid(rid, &next);
+        rid = next;
     }
-    return false;
+    next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
 }
@@ -0,0 +1,286 @@
+#include "executor/executors/sort_executor.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "planner/expressions/column_value_expression.h"
+
+namespace
+{
+/** Append value to key big-endian, so that bytes compare like the value */
+void AppendBigEndian(uint32_t value, std::string *key)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        key->push_back(static_cast<char>(value >> shift));
+}
+} // namespace
+
+SortExecutor::SortExecutor(ExecuteContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child))
+{
+    for (auto &order_by : plan_->order_bys_)
+    {
+        key_columns_.push_back(dynamic_cast<const ColumnValueExpression *>(order_by.second.get())->GetColIdx());
+        descending_.push_back(order_by.first == OrderByType::Desc);
+    }
+    run_schema_ = std::make_unique<Schema>(
+        std::vector<Column *>{new Column("run", kTypeChar, VARCHAR_MAX_LEN, 0, false, false)});
+}
+
+void SortExecutor::Init()
+{
+    data_.clear();
+    entries_.clear();
+    runs_.clear();
+    cursors_.clear();
+    heap_.clear();
+    produced_ = 0;
+    live_bytes_ = 0;
+    top_n_ = plan_->limit_ <= MAX_HEAP_ROWS;
+    if (plan_->limit_ == 0)
+        return;
+
+    child_->Init();
+    RowBatch batch;
+    std::string key;
+    Row row;
+    uint64_t seq = 0;
+    while (child_->NextBatch(&batch))
+    {
+        for (uint32_t i : batch.GetSelection())
+        {
+            if (top_n_)
+            {
+                PushTopN(batch, i, seq++, &key, &row);
+                continue;
+            }
+            MakeKey(batch, i, &key);
+            batch.GetRow(i, &row);
+            entries_.push_back(Store(key, row, seq++));
+            if (GetMemoryUsage() > plan_->memory_budget_)
+                SpillRun();
+        }
+    }
+    if (top_n_)
+        std::sort_heap(entries_.begin(), entries_.end(), [this](auto &lhs, auto &rhs) { return Less(lhs, rhs); });
+    else
+        std::sort(entries_.begin(), entries_.end(), [this](auto &lhs, auto &rhs) { return Less(lhs, rhs); });
+
+    // the buffer is merged with the runs written before it
+    cursors_.push_back(RunCursor{nullptr, 0, {}, 0, {}, nullptr});
+    for (auto &run : runs_)
+        cursors_.push_back(RunCursor{run.get(), 0, {}, 0, {}, nullptr});
+    auto greater = [this](size_t lhs, size_t rhs) { return CursorGreater(lhs, rhs); };
+    for (size_t i = 0; i < cursors_.size(); i++)
+    {
+        if (Advance(&cursors_[i]))
+            heap_.push_back(i);
+    }
+    std::make_heap(heap_.begin(), heap_.end(), greater);
+}
+
+bool SortExecutor::NextBatch(RowBatch *batch)
+{
+    batch->Reset(GetOutputSchema());
+    auto greater = [this](size_t lhs, size_t rhs) { return CursorGreater(lhs, rhs); };
+    Schema *child_schema = const_cast<Schema *>(child_->GetOutputSchema());
+    std::vector<Field> fields;
+    while (!batch->Full() && !heap_.empty() && produced_ < plan_->limit_)
+    {
+        std::pop_heap(heap_.begin(), heap_.end(), greater);
+        RunCursor &cursor = cursors_[heap_.back()];
+        Row row;
+        row.DeserializeFrom(const_cast<char *>(cursor.row), child_schema);
+        fields.clear();
+        for (auto &column : plan_->columns_)
+            fields.emplace_back(column->Evaluate(&row));
+        Row output(fields);
+        batch->Append(output);
+        produced_++;
+        if (Advance(&cursor))
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        else
+            heap_.pop_back();
+    }
+    return batch->Size() > 0;
+}
+
+void SortExecutor::Stop()
+{
+    child_->Stop();
+    heap_.clear();
+    cursors_.clear();
+    runs_.clear();
+    std::string().swap(data_);
+    std::vector<SortEntry>().swap(entries_);
+}
+
+void SortExecutor::MakeKey(const RowBatch &batch, uint32_t i, std::string *key) const
+{
+    key->clear();
+    for (size_t k = 0; k < key_columns_.size(); k++)
+    {
+        const ColumnVector &column = batch.GetColumn(key_columns_[k]);
+        // nulls come before every value, in either direction, so their marker is never inverted
+        key->push_back(column.IsNull(i) ? 0 : 1);
+        size_t start = key->size();
+        if (!column.IsNull(i))
+        {
+            switch (column.GetType())
+            {
+            case kTypeInt:
+                // flipping the sign bit orders negative values first
+                AppendBigEndian(static_cast<uint32_t>(column.GetInts()[i]) ^ 0x80000000U, key);
+                break;
+            case kTypeFloat:
+            {
+                float value = column.GetFloats()[i] == 0 ? 0.0f : column.GetFloats()[i];
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                // negative values are ordered backwards by their bits
+                AppendBigEndian((bits & 0x80000000U) != 0 ? ~bits : bits | 0x80000000U, key);
+                break;
+            }
+            default:
+            {
+                // a zero byte is escaped so that the terminator sorts before any byte
+                const char *chars = column.GetChars(i);
+                for (uint32_t j = 0; j < column.GetLength(i); j++)
+                {
+                    key->push_back(chars[j]);
+                    if (chars[j] == 0)
+                        key->push_back(static_cast<char>(0xff));
+                }
+                key->append(2, 0);
+            }
+            }
+        }
+        if (descending_[k])
+        {
+            for (size_t j = start; j < key->size(); j++)
+                (*key)[j] = static_cast<char>(~(*key)[j]);
+        }
+    }
+}
+
+SortExecutor::SortEntry SortExecutor::MakeEntry(const std::string &key, uint32_t row_length, size_t offset,
+                                                uint64_t seq)
+{
+    uint64_t prefix = 0;
+    for (size_t j = 0; j < sizeof(prefix); j++)
+        prefix = prefix << 8 | (j < key.size() ? static_cast<uint8_t>(key[j]) : 0);
+    return SortEntry{prefix, offset, static_cast<uint32_t>(key.size()), row_length, seq};
+}
+
+SortExecutor::SortEntry SortExecutor::Store(const std::string &key, const Row &row, uint64_t seq)
+{
+    Schema *child_schema = const_cast<Schema *>(child_->GetOutputSchema());
+    uint32_t row_length = row.GetSerializedSize(child_schema);
+    size_t offset = data_.size();
+    data_.append(key);
+    data_.resize(offset + key.size() + row_length);
+    row.SerializeTo(&data_[offset + key.size()], child_schema);
+    return MakeEntry(key, row_length, offset, seq);
+}
+
+bool SortExecutor::Less(const SortEntry &lhs, const SortEntry &rhs) const
+{
+    if (lhs.prefix != rhs.prefix)
+        return lhs.prefix < rhs.prefix;
+    int cmp = memcmp(data_.data() + lhs.offset, data_.data() + rhs.offset, std::min(lhs.key_length, rhs.key_length));
+    if (cmp != 0)
+        return cmp < 0;
+    if (lhs.key_length != rhs.key_length)
+        return lhs.key_length < rhs.key_length;
+    return lhs.seq < rhs.seq;
+}
+
+bool SortExecutor::CursorGreater(size_t lhs, size_t rhs) const
+{
+    int cmp = cursors_[lhs].key.compare(cursors_[rhs].key);
+    if (cmp != 0)
+        return cmp > 0;
+    // the rows of the buffer came after those of the runs, which came in the order of the runs
+    return (lhs == 0 ? cursors_.size() : lhs) > (rhs == 0 ? cursors_.size() : rhs);
+}
+
+void SortExecutor::PushTopN(const RowBatch &batch, uint32_t i, uint64_t seq, std::string *key, Row *row)
+{
+    auto less = [this](auto &lhs, auto &rhs) { return Less(lhs, rhs); };
+    MakeKey(batch, i, key);
+    if (entries_.size() == plan_->limit_)
+    {
+        // the heap holds the last row kept on top, a row with an equal key came after it
+        const SortEntry &last = entries_.front();
+        std::string_view last_key(data_.data() + last.offset, last.key_length);
+        if (std::string_view(*key).compare(last_key) >= 0)
+            return;
+        live_bytes_ -= last.key_length + last.row_length;
+        std::pop_heap(entries_.begin(), entries_.end(), less);
+        entries_.pop_back();
+    }
+    batch.GetRow(i, row);
+    entries_.push_back(Store(*key, *row, seq));
+    live_bytes_ += entries_.back().key_length + entries_.back().row_length;
+    std::push_heap(entries_.begin(), entries_.end(), less);
+    // replaced rows stay in the buffer until they take up half of it
+    if (data_.size() > MIN_COMPACT_BYTES && data_.size() > 2 * live_bytes_)
+        Compact();
+}
+
+void SortExecutor::Compact()
+{
+    std::string data;
+    for (auto &entry : entries_)
+    {
+        size_t offset = data.size();
+        data.append(data_, entry.offset, entry.key_length + entry.row_length);
+        entry.offset = offset;
+    }
+    data_.swap(data);
+}
+
+void SortExecutor::SpillRun()
+{
+    std::sort(entries_.begin(), entries_.end(), [this](auto &lhs, auto &rhs) { return Less(lhs, rhs); });
+    runs_.push_back(std::make_unique<SpillPartition>(exec_ctx_->GetBufferPoolManager(), run_schema_.get()));
+    std::string buffer;
+    for (auto &entry : entries_)
+    {
+        buffer.assign(reinterpret_cast<const char *>(&entry.key_length), sizeof(entry.key_length));
+        buffer.append(data_, entry.offset, entry.key_length + entry.row_length);
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeChar, buffer.data(), buffer.size(), false);
+        Row row(fields);
+        runs_.back()->Append(row);
+    }
+    std::string().swap(data_);
+    std::vector<SortEntry>().swap(entries_);
+}
+
+bool SortExecutor::Advance(RunCursor *cursor)
+{
+    if (cursor->run == nullptr)
+    {
+        if (cursor->pos == entries_.size())
+            return false;
+        const SortEntry &entry = entries_[cursor->pos++];
+        cursor->key = std::string_view(data_.data() + entry.offset, entry.key_length);
+        cursor->row = data_.data() + entry.offset + entry.key_length;
+        return true;
+    }
+    while (cursor->pos == cursor->rows.size())
+    {
+        if (cursor->page == cursor->run->GetPageCount())
+            return false;
+        cursor->run->ReadPage(cursor->page++, &cursor->rows);
+        cursor->pos = 0;
+    }
+    const char *data = cursor->rows[cursor->pos++].GetField(0)->GetData();
+    uint32_t key_length;
+    memcpy(&key_length, data, sizeof(key_length));
+    cursor->key = std::string_view(data + sizeof(key_length), key_length);
+    cursor->row = data + sizeof(key_length) + key_length;
+    return true;
+}
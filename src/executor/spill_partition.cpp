@@ -0,0 +1,59 @@
+#include "executor/spill_partition.h"
+
+#include <stdexcept>
+
+#include "page/table_page.h"
+
+SpillPartition::~SpillPartition()
+{
+    for (auto page_id : page_ids_)
+        bpm_->DeletePage(page_id);
+}
+
+void SpillPartition::Append(Row &row)
+{
+    Schema *schema = const_cast<Schema *>(schema_);
+    if (!page_ids_.empty())
+    {
+        auto page = reinterpret_cast<TablePage *>(bpm_->FetchPage(page_ids_.back()));
+        if (page == nullptr)
+            throw std::runtime_error("failed to fetch a spill partition page");
+        bool inserted = page->InsertTuple(row, schema, nullptr, nullptr, nullptr);
+        bpm_->UnpinPage(page_ids_.back(), inserted);
+        if (inserted)
+        {
+            row_count_++;
+            return;
+        }
+    }
+    page_id_t page_id;
+    auto page = reinterpret_cast<TablePage *>(bpm_->NewPage(page_id));
+    if (page == nullptr)
+        throw std::runtime_error("no free page for a spill partition");
+    page->Init(page_id, page_ids_.empty() ? INVALID_PAGE_ID : page_ids_.back(), nullptr, nullptr);
+    page_ids_.push_back(page_id);
+    bool inserted = page->InsertTuple(row, schema, nullptr, nullptr, nullptr);
+    bpm_->UnpinPage(page_id, true);
+    if (!inserted)
+        throw std::runtime_error("row too large for a spill partition page");
+    row_count_++;
+}
+
+void SpillPartition::ReadPage(size_t i, std::vector<Row> *rows) const
+{
+    auto page = reinterpret_cast<TablePage *>(bpm_->FetchPage(page_ids_[i]));
+    if (page == nullptr)
+        throw std::runtime_error("failed to fetch a spill partition page");
+    rows->clear();
+    RowId rid;
+    bool found = page->GetFirstTupleRid(&rid);
+    while (found)
+    {
+        rows->emplace_back(rid);
+        page->GetTuple(&rows->back(), const_cast<Schema *>(schema_), nullptr, nullptr);
+        RowId next;
+        found = page->GetNextTupleRid(rid, &next);
+        rid = next;
+    }
+    bpm_->UnpinPage(page_ids_[i], false);
+}
@@ -11,41 +11,37 @@ UpdateExecutor::UpdateExecutor(ExecuteContext *exec_ctx, const UpdatePlanNode *p
 void UpdateExecutor::Init()
 {
     exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info);
+    exec_ctx_->GetCatalog()->GetTableIndexes(plan_->GetTableName(), index_info_);
     child_executor_->Init();
 }
 
 bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid)
 {
+    return NextFromBatch(row, rid);
+}
+
+bool UpdateExecutor::NextBatch(RowBatch *batch)
+{
+    if (!child_executor_->NextBatch(batch))
+        return false;
     Row old_row;
-    RowId old_rid;
-    if (child_executor_->Next(&old_row, &old_rid))
+    for (uint32_t i : batch->GetSelection())
     {
+        RowId old_rid = batch->GetRowId(i);
+        batch->GetRow(i, &old_row);
         Row new_row = GenerateUpdatedTuple(old_row);
         table_info->GetTableHeap()->UpdateTuple(new_row, old_rid, nullptr);
-        RowId new_rid = new_row.GetRowId();
+        // the row only gets a new id when it had to move to another page
+        RowId new_rid = new_row.GetRowId().GetPageId() == INVALID_PAGE_ID ? old_rid : new_row.GetRowId();
 
         for (auto index_info : index_info_)
         {
             auto index = index_info->GetIndex();
-            std::vector<Field> fields{};
-            for (auto col : index_info->GetIndexKeySchema()->GetColumns())
-            {
-                fields.push_back(*old_row.GetField(col->GetTableInd()));
-            }
-            Row old_index(fields);
-            index->RemoveEntry(old_index, old_rid, nullptr);
-
-            fields.clear();
-            for (auto col : index_info->GetIndexKeySchema()->GetColumns())
-            {
-                fields.push_back(*new_row.GetField(col->GetTableInd()));
-            }
-            Row new_index(fields);
-            index->InsertEntry(new_index, new_rid, nullptr);
+            index->RemoveEntry(index_info->GetEntry(old_row), old_rid, nullptr);
+            index->InsertEntry(index_info->GetEntry(new_row), new_rid, nullptr);
         }
-        return true;
     }
-    return false;
+    return true;
 }
 
 Row UpdateExecutor::GenerateUpdatedTuple(const Row &src_row)
@@ -3,6 +3,7 @@
 
 #include <list>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -39,6 +40,8 @@ public:
 private:
     // add your own private member variables here
     std::list<frame_id_t> *lru_list_ = new std::list<frame_id_t>();
+    // where each unpinned frame sits in lru_list_, so pinning it doesn't walk the list
+    std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> positions_;
     size_t capacity_ = 0;
 };
 
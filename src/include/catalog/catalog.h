@@ -90,7 +90,8 @@ public:
 
     dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                         const std::vector<std::string> &index_keys, Transaction *txn, IndexInfo *&index_info,
-                        const string &index_type);
+                        const string &index_type, const std::vector<std::string> &include_keys = {},
+                        bool unique = false);
 
     dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
@@ -6,8 +6,13 @@
 #include "catalog/table.h"
 #include "common/macros.h"
 #include "common/rowid.h"
+#include "index/art_index.h"
 #include "index/b_plus_tree_index.h"
+#include "index/bitmap_index.h"
+#include "index/extendible_hash_index.h"
 #include "index/generic_key.h"
+#include "index/learned_index.h"
+#include "index/lsm_index.h"
 #include "record/schema.h"
 
 class IndexMetadata
@@ -16,7 +21,8 @@ class IndexMetadata
 
 public:
     static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                                 const std::vector<uint32_t> &key_map);
+                                 const std::vector<uint32_t> &key_map, const std::string &index_type = "bptree",
+                                 const std::vector<uint32_t> &include_map = {}, bool unique = false);
 
     uint32_t SerializeTo(char *buf) const;
 
@@ -34,11 +40,21 @@ public:
 
     inline index_id_t GetIndexId() const { return index_id_; }
 
+    /** The access method, "bptree", "hash", "bitmap", "art", "lsm" or "learned" */
+    inline const std::string &GetIndexType() const { return index_type_; }
+
+    /** Table columns stored in the index beside the key, see CREATE INDEX ... INCLUDE */
+    inline const std::vector<uint32_t> &GetIncludeMapping() const { return include_map_; }
+
+    /** Whether the key was declared unique as a whole, e.g. a composite primary key */
+    inline bool IsUnique() const { return unique_; }
+
 private:
     IndexMetadata() = delete;
 
     explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                           const std::vector<uint32_t> &key_map);
+                           const std::vector<uint32_t> &key_map, const std::string &index_type,
+                           const std::vector<uint32_t> &include_map, bool unique);
 
 private:
     static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
@@ -46,6 +62,9 @@ private:
     std::string index_name_;
     table_id_t table_id_;
     std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+    std::string index_type_;
+    std::vector<uint32_t> include_map_;
+    bool unique_;
 };
 
 /**
@@ -61,6 +80,7 @@ public:
         delete meta_data_;
         delete index_;
         delete key_schema_;
+        delete include_schema_;
     }
 
     void Init(IndexMetadata *meta_data, TableInfo *table_info, BufferPoolManager *buffer_pool_manager)
@@ -69,18 +89,39 @@ public:
         meta_data_ = meta_data;
         // Step2: mapping index key to key schema
         key_schema_ = Schema::ShallowCopySchema(table_info->GetSchema(), meta_data->GetKeyMapping());
+        if (!meta_data->GetIncludeMapping().empty())
+            include_schema_ = Schema::ShallowCopySchema(table_info->GetSchema(), meta_data->GetIncludeMapping());
+        // a key declared unique or holding a unique column is unique, anything else may repeat
+        unique_ = meta_data->IsUnique();
+        for (auto col : key_schema_->GetColumns())
+            unique_ |= col->IsUnique();
         // Step3: call CreateIndex to create the index
-        index_ = CreateIndex(buffer_pool_manager,"bptree");
+        index_ = CreateIndex(buffer_pool_manager, meta_data->GetIndexType());
     }
 
     inline Index *GetIndex() { return index_; }
 
     std::string GetIndexName() { return meta_data_->GetIndexName(); }
 
+    const std::string &GetIndexType() const { return meta_data_->GetIndexType(); }
+
     IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+    /** @return the included columns, null if there are none */
+    IndexSchema *GetIncludeSchema() { return include_schema_; }
+
+    /** The key columns of row followed by the included ones, as InsertEntry takes it */
+    Row GetEntry(const Row &row) const;
+
+    /** Whether an index-only scan can produce the table column at column_index */
+    bool Covers(uint32_t column_index) const;
+
+    /** Whether every key maps to a single row */
+    bool IsUnique() const { return unique_; }
+
 private:
-    explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr} {}
+    explicit IndexInfo()
+        : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr}, include_schema_{nullptr}, unique_{true} {}
 
     Index *CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type);
 
@@ -88,6 +129,8 @@ private:
     IndexMetadata *meta_data_;
     Index *index_;
     IndexSchema *key_schema_;
+    IndexSchema *include_schema_;
+    bool unique_;
 };
 
 #endif // MINISQL_INDEXES_H
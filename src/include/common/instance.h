@@ -9,6 +9,7 @@
 #include "common/config.h"
 #include "common/dberr.h"
 #include "common/macros.h"
+#include "common/thread_pool.h"
 #include "executor/execute_context.h"
 #include "storage/disk_manager.h"
 
@@ -24,6 +25,8 @@ class DBStorageEngine {
   DiskManager *disk_mgr_;
   BufferPoolManager *bpm_;
   CatalogManager *catalog_mgr_;
+  /** The pool of the process, held so it outlives the catalog's indexes */
+  std::shared_ptr<ThreadPool> thread_pool_;
   std::string db_file_name_;
   bool init_;
 };
@@ -0,0 +1,98 @@
+#ifndef MINISQL_ROWID_BITMAP_H
+#define MINISQL_ROWID_BITMAP_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "common/rowid.h"
+
+/**
+ * Compressed set of row ids, roaring style: the ids are split by page id and the slots of
+ * each page live in a container of their own. A container is a sorted array while it is
+ * sparse and becomes a bitset once that takes less space, so intersection and union run
+ * a word at a time on dense pages. Enumeration yields the ids in (page, slot) order, which
+ * is the order the table heap is read in.
+ *
+ * Slot numbers must fit in 16 bits, which any slot of a page does.
+ */
+class RowIdBitmap
+{
+public:
+    void Add(const RowId &rid);
+
+    bool Contains(const RowId &rid) const;
+
+    /** Add the slots of page_id whose bits are set in words, bit i of word w is slot w * 64 + i */
+    void AddPage(page_id_t page_id, const uint64_t *words, size_t count);
+
+    /** @return the number of row ids in the set */
+    uint64_t Cardinality() const;
+
+    bool Empty() const { return containers_.empty(); }
+
+    /** Keep only the row ids other holds too */
+    void IntersectWith(const RowIdBitmap &other);
+
+    /** Add every row id of other */
+    void UnionWith(const RowIdBitmap &other);
+
+    /** Append the row ids in (page, slot) order */
+    void ToVector(std::vector<RowId> &rids) const;
+
+private:
+    /** The slots of one page */
+    class Container
+    {
+    public:
+        void Add(uint16_t slot);
+
+        bool Contains(uint16_t slot) const;
+
+        void And(const Container &other);
+
+        void Or(const Container &other);
+
+        uint32_t Cardinality() const { return cardinality_; }
+
+        /** Take the slots of a bitset */
+        void Assign(const uint64_t *words, size_t count);
+
+        template <typename F>
+        void ForEach(F &&f) const
+        {
+            if (!bitset_)
+            {
+                for (auto slot : array_)
+                    f(slot);
+                return;
+            }
+            for (size_t i = 0; i < words_.size(); i++)
+            {
+                for (uint64_t word = words_[i]; word != 0; word &= word - 1)
+                    f(static_cast<uint16_t>(i * 64 + __builtin_ctzll(word)));
+            }
+        }
+
+    private:
+        /** An array holds 16 bits per slot, a bitset 64 per word up to the highest slot */
+        static bool BitsetIsSmaller(uint32_t cardinality, uint16_t max_slot)
+        {
+            return cardinality > 4 * ((max_slot >> 6) + 1u);
+        }
+
+        void ToBitset();
+
+        /** Recount after a word-wise operation and fall back to an array if that is smaller */
+        void Normalize();
+
+        std::vector<uint16_t> array_;
+        std::vector<uint64_t> words_;
+        bool bitset_{false};
+        uint32_t cardinality_{0};
+    };
+
+    std::map<page_id_t, Container> containers_;
+};
+
+#endif // MINISQL_ROWID_BITMAP_H
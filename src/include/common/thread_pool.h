@@ -0,0 +1,119 @@
+#ifndef MINISQL_THREAD_POOL_H
+#define MINISQL_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Query work runs before background maintenance */
+enum class TaskPriority
+{
+    kHigh,
+    kLow
+};
+
+/**
+ * Tasks submitted together, to wait for or cancel as one. Cancelling drops the tasks
+ * that have not started; those running poll IsCancelled() and return early.
+ */
+class TaskGroup
+{
+    friend class ThreadPool;
+
+public:
+    void Cancel() { cancelled_ = true; }
+
+    bool IsCancelled() const { return cancelled_; }
+
+private:
+    /** A task of the group finished, with the exception it threw if any */
+    void Finish(std::exception_ptr error);
+
+    std::atomic<bool> cancelled_{false};
+    std::mutex latch_;
+    std::condition_variable done_;
+    size_t pending_ = 0;
+    std::exception_ptr error_;
+};
+
+/**
+ * Work-stealing thread pool. Every worker has a deque of tasks per priority: it pushes
+ * the tasks it submits and pops them at the back, and when its own deques are empty it
+ * steals from the front of the others'. Tasks submitted from outside the pool are
+ * spread over the workers round robin. A worker takes any high priority task before
+ * a low priority one.
+ *
+ * The process shares one pool sized to the machine, see Shared(), so the threads busy
+ * with queries and maintenance stay bounded however many run at once.
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t worker_count);
+
+    /** Runs the queued tasks, then stops the workers */
+    ~ThreadPool();
+
+    /** @return the pool of the process, created with a worker per hardware thread while anything holds it */
+    static std::shared_ptr<ThreadPool> Shared();
+
+    size_t GetWorkerCount() const { return workers_.size(); }
+
+    void Submit(const std::shared_ptr<TaskGroup> &group, TaskPriority priority, std::function<void()> task);
+
+    /**
+     * Block until every task of group finished or was dropped. Tasks of group still queued
+     * run on the calling thread meanwhile, so this never waits on a pool with no worker free.
+     * Rethrows the first exception a task of the group threw.
+     */
+    void Wait(const std::shared_ptr<TaskGroup> &group);
+
+    /**
+     * Run a queued task of group on the calling thread, for a caller waiting on the group
+     * other than through Wait().
+     * @return false if no task of group was queued
+     */
+    bool RunQueued(const std::shared_ptr<TaskGroup> &group);
+
+private:
+    struct Task
+    {
+        std::function<void()> function;
+        std::shared_ptr<TaskGroup> group;
+    };
+
+    struct Worker
+    {
+        std::mutex latch;
+        /** One deque per TaskPriority */
+        std::deque<Task> tasks[2];
+    };
+
+    void WorkerLoop(size_t index);
+
+    /** Take a task for worker index, its own newest first, then the oldest of the others */
+    bool Take(size_t index, Task *task);
+
+    /** Take a queued task of group from any worker */
+    bool TakeFrom(const std::shared_ptr<TaskGroup> &group, Task *task);
+
+    static void Run(Task &task);
+
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+
+    /** Guards the sleep of idle workers */
+    std::mutex latch_;
+    std::condition_variable work_;
+    size_t queued_ = 0;
+    bool stop_ = false;
+};
+
+#endif // MINISQL_THREAD_POOL_H
@@ -8,6 +8,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/macros.h"
+#include "common/thread_pool.h"
 #include "transaction/transaction.h"
 
 class ExecuteContext {
@@ -17,9 +18,11 @@ class ExecuteContext {
    * @param transaction The transaction executing the query
    * @param catalog The catalog that the executor uses
    * @param bpm The buffer pool manager that the executor uses
+   * @param thread_pool The pool running the parallel parts of the query, without one it runs serially
    */
-  ExecuteContext(Transaction *transaction, CatalogManager *catalog, BufferPoolManager *bpm)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm} {}
+  ExecuteContext(Transaction *transaction, CatalogManager *catalog, BufferPoolManager *bpm,
+                 ThreadPool *thread_pool = nullptr)
+      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, thread_pool_{thread_pool} {}
 
   ~ExecuteContext() = default;
 
@@ -34,6 +37,9 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** @return the thread pool, or null */
+  ThreadPool *GetThreadPool() { return thread_pool_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -41,6 +47,8 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** The thread pool associated with this executor context */
+  ThreadPool *thread_pool_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
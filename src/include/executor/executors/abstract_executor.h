@@ -1,9 +1,14 @@
 #ifndef MINISQL_ABSTRACT_EXECUTOR_H
 #define MINISQL_ABSTRACT_EXECUTOR_H
 
+#include <cstdint>
+
 #include "executor/execute_context.h"
+#include "executor/row_batch.h"
 /**
- * The AbstractExecutor implements the Volcano row-at-a-time iterator model.
+ * The AbstractExecutor implements the Volcano iterator model, either a row at a
+ * time through Next() or a batch of rows at a time through NextBatch(). Each
+ * executor implements one of the two natively, the other is adapted from it.
  * This is the base class from which all executors in the execution engine
  * inherit, and defines the minimal interface that all executors support.
  */
@@ -32,6 +37,36 @@ class AbstractExecutor {
    */
   virtual bool Next(Row *row, RowId *rid) = 0;
 
+  /**
+   * Yield the next rows from this executor, at most RowBatch::CAPACITY of them. The
+   * rows in the selection of the batch are the ones produced, it may be empty.
+   * By default the rows are pulled from Next() one by one.
+   * @param[out] batch Reset and filled with the next rows
+   * @return `true` if rows were looked at, `false` if there are no more rows
+   */
+  virtual bool NextBatch(RowBatch *batch) {
+    batch->Reset(GetOutputSchema());
+    Row row;
+    RowId rid;
+    while (!batch->Full() && Next(&row, &rid)) {
+      row.SetRowId(rid);
+      batch->Append(row);
+    }
+    return batch->Size() > 0;
+  }
+
+  /**
+   * Tell the executor, before Init(), that no more than limit of its rows will be taken.
+   * Scans stop reading once they produced that many, other executors ignore it.
+   */
+  void SetRowLimit(size_t limit) { row_limit_ = limit; }
+
+  /**
+   * Tell the executor that no more rows will be taken from it: it stops its workers and
+   * lets go of what it holds, and executors with children pass the signal on to them.
+   */
+  virtual void Stop() {}
+
   /** @return The schema of the rows that this executor produces */
   virtual const Schema *GetOutputSchema() const = 0;
 
@@ -39,8 +74,30 @@ class AbstractExecutor {
   ExecuteContext *GetExecutorContext() { return exec_ctx_; }
 
  protected:
+  /** Next() of executors that produce batches natively: hands out the selected rows of a batch one by one */
+  bool NextFromBatch(Row *row, RowId *rid) {
+    while (batch_pos_ == row_batch_.GetSelection().size()) {
+      if (!NextBatch(&row_batch_)) {
+        return false;
+      }
+      batch_pos_ = 0;
+    }
+    uint32_t i = row_batch_.GetSelection()[batch_pos_++];
+    row_batch_.GetRow(i, row);
+    *rid = row_batch_.GetRowId(i);
+    return true;
+  }
+
   /** The executor context in which the executor runs */
   ExecuteContext *exec_ctx_;
+
+  /** The most rows that will be taken from the executor, see SetRowLimit() */
+  size_t row_limit_{SIZE_MAX};
+
+ private:
+  /** The batch NextFromBatch() is handing out, and the position in its selection */
+  RowBatch row_batch_;
+  size_t batch_pos_{0};
 };
 
 #endif  // MINISQL_ABSTRACT_EXECUTOR_H
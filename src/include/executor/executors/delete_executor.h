@@ -41,6 +41,9 @@ public:
      */
     bool Next(Row *row, RowId *rid) override;
 
+    /** Delete the rows of the next child batch, those deleted stay selected */
+    bool NextBatch(RowBatch *batch) override;
+
     /** @return The output schema for the delete */
     const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
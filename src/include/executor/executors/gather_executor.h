@@ -0,0 +1,97 @@
+#ifndef MINISQL_GATHER_EXECUTOR_H
+#define MINISQL_GATHER_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/executors/seq_scan_executor.h"
+#include "executor/plans/gather_plan.h"
+
+/**
+ * The GatherExecutor scans a table in parallel: one SeqScanExecutor per task on the
+ * thread pool of the context, all claiming morsels of pages from a shared MorselQueue,
+ * each scanning, filtering and projecting into its own batches. Finished batches are
+ * handed over through a bounded queue and come out of NextBatch() in the order they
+ * were finished.
+ *
+ * No worker of the pool ever waits on the queue: a task that finds it full ends, and its
+ * scan is submitted again once a batch was taken. While the queue is empty, NextBatch()
+ * runs the queued tasks of its own scans on the calling thread, so that scans open at the
+ * same time cannot starve each other of workers.
+ *
+ * A table with a single morsel, a context without a pool, or a row limit that fits in
+ * one batch, is scanned on the calling thread, in page order.
+ */
+class GatherExecutor : public AbstractExecutor
+{
+public:
+    /**
+     * Construct a new GatherExecutor instance.
+     * @param exec_ctx The executor context
+     * @param plan The gather plan to be executed
+     */
+    GatherExecutor(ExecuteContext *exec_ctx, const GatherPlanNode *plan);
+
+    /** Stops the workers that are still running */
+    ~GatherExecutor() override;
+
+    /** Split the table into morsels and start the workers */
+    void Init() override;
+
+    bool Next(Row *row, RowId *rid) override;
+
+    /** Take the next batch finished by any worker */
+    bool NextBatch(RowBatch *batch) override;
+
+    /** Stop the workers and drop the batches they queued, NextBatch() produces nothing after it */
+    void Stop() override;
+
+    /** @return The output schema for the gather */
+    const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+    /**
+     * Split the table of the plan into morsels and make the initialized scans of its workers, as
+     * many as the morsels and the pool of exec_ctx allow, at least one.
+     */
+    static std::vector<std::unique_ptr<SeqScanExecutor>> MakeScans(ExecuteContext *exec_ctx, const GatherPlanNode *plan,
+                                                                   const std::shared_ptr<MorselQueue> &morsels);
+
+private:
+    /** Most finished batches waiting to be taken, per worker */
+    static constexpr size_t QUEUED_PER_WORKER = 2;
+
+    /** Submit a task running scan */
+    void Submit(SeqScanExecutor *scan);
+
+    /** Body of a worker task: run scan until it ends or the queue is full, queueing its batches */
+    void Work(SeqScanExecutor *scan);
+
+    /** The gather plan node to be executed */
+    const GatherPlanNode *plan_;
+
+    std::shared_ptr<MorselQueue> morsels_;
+    std::vector<std::unique_ptr<SeqScanExecutor>> scans_;
+    /** The worker tasks, null when the scan runs on the calling thread */
+    std::shared_ptr<TaskGroup> tasks_;
+
+    /** Guards everything below */
+    std::mutex latch_;
+    std::condition_variable not_empty_;
+    std::deque<RowBatch> batches_;
+    size_t queue_limit_ = 0;
+    /** Scans not done yet, parked ones included */
+    size_t running_ = 0;
+    /** Scans whose task ended on a full queue, to submit again */
+    std::vector<SeqScanExecutor *> parked_;
+    bool stopped_ = false;
+    /** The first exception thrown by a worker, rethrown to the caller */
+    std::exception_ptr error_;
+};
+
+#endif // MINISQL_GATHER_EXECUTOR_H
@@ -0,0 +1,236 @@
+#ifndef MINISQL_HASH_AGGREGATE_EXECUTOR_H
+#define MINISQL_HASH_AGGREGATE_EXECUTOR_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/aggregation_plan.h"
+#include "executor/spill_partition.h"
+
+/** The running value of one aggregate over the rows of a group, all zero before the first row */
+struct AggregateState
+{
+    union
+    {
+        int64_t int_sum;
+        double float_sum;
+        int32_t int_value;
+        float float_value;
+        /** The minimum or maximum of a char column, in the arena of the table */
+        const char *chars;
+    };
+    /** The rows counted by COUNT(*), else the non-null values seen */
+    int64_t count;
+    /** Bytes of chars */
+    uint32_t length;
+};
+
+/**
+ * Open-addressing hash table from the serialized values of the group-by columns to the
+ * aggregate states of the group. Each group is laid out in an arena as a header, its fixed
+ * size states and its key, so a group costs one allocation and no per-group objects. The
+ * slots hold the hash and the group and are probed linearly, the table doubles once it is
+ * half full.
+ */
+class AggregateHashTable
+{
+public:
+    explicit AggregateHashTable(size_t state_count) : state_count_(state_count) {}
+
+    DISALLOW_COPY_AND_MOVE(AggregateHashTable);
+
+    /** @return the states of the group with key, zeroed if the group is new */
+    AggregateState *FindOrInsert(std::string_view key, uint64_t hash);
+
+    /** Copy length bytes of data into the arena, @return the copy */
+    const char *CopyChars(const char *data, uint32_t length);
+
+    /** @return the number of groups, in the order they were inserted */
+    size_t GetGroupCount() const { return groups_.size(); }
+
+    uint64_t GetHash(size_t i) const { return reinterpret_cast<const GroupHeader *>(groups_[i])->hash; }
+
+    std::string_view GetKey(size_t i) const;
+
+    AggregateState *GetStates(size_t i) const { return reinterpret_cast<AggregateState *>(groups_[i] + HEADER_SIZE); }
+
+    /** @return approximate bytes held by the table */
+    size_t GetMemoryUsage() const
+    {
+        return arena_bytes_ + slots_.capacity() * sizeof(Slot) + groups_.capacity() * sizeof(char *);
+    }
+
+    /** Drop all groups and release the arena */
+    void Clear();
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 << 10;
+    static constexpr size_t MIN_SLOTS = 1024;
+
+    struct GroupHeader
+    {
+        uint64_t hash;
+        uint32_t key_size;
+    };
+    static constexpr size_t HEADER_SIZE = (sizeof(GroupHeader) + 7) & ~size_t(7);
+
+    struct Slot
+    {
+        uint64_t hash;
+        char *group;
+    };
+
+    /** @return size bytes of the arena, aligned for the states */
+    char *Allocate(size_t size);
+
+    /** Double the slots and put every group back */
+    void Grow();
+
+    size_t state_count_;
+    std::vector<Slot> slots_;
+    std::vector<char *> groups_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    /** Bytes used of the last block */
+    size_t block_used_ = 0;
+    size_t block_size_ = 0;
+    size_t arena_bytes_ = 0;
+};
+
+/**
+ * The HashAggregateExecutor groups the rows of its child in an AggregateHashTable, reading
+ * keys and aggregate inputs straight from the columns of each batch.
+ *
+ * When the table outgrows the memory budget of the plan, its groups are flushed to FANOUT
+ * partitions on temporary pages by the next bits of their hash, and the table starts over
+ * empty. A group can then be split over several flushes: once the input is done, each
+ * partition is read back and its groups merged into a fresh table before they are output.
+ * A partition still over budget is split again on the next bits, up to MAX_LEVELS deep.
+ *
+ * Over a parallel scan, each worker of the scan aggregates the morsels it reads into its own
+ * table, with its share of the budget and its own partitions. The partial tables are merged
+ * into one at the end, and the partitions of the workers with the same index are merged
+ * together, as a group always lands in the same one.
+ */
+class HashAggregateExecutor : public AbstractExecutor
+{
+public:
+    /**
+     * Construct a new HashAggregateExecutor instance.
+     * @param exec_ctx The executor context
+     * @param plan The aggregation plan to be executed
+     * @param child The executor producing the rows to aggregate
+     */
+    HashAggregateExecutor(ExecuteContext *exec_ctx, const AggregationPlanNode *plan,
+                          std::unique_ptr<AbstractExecutor> child);
+
+    /** Aggregate all rows of the child */
+    void Init() override;
+
+    bool Next(Row *row, RowId *rid) override { return NextFromBatch(row, rid); }
+
+    bool NextBatch(RowBatch *batch) override;
+
+    /** Stop the input and drop the partitions not output yet */
+    void Stop() override;
+
+    /** @return The output schema for the aggregation */
+    const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+    /** @return whether groups were flushed to disk, for tests */
+    bool IsSpilled() const { return spilled_; }
+
+    /** @return how many partial aggregations ran in parallel, for tests */
+    size_t GetWorkerCount() const { return worker_count_; }
+
+private:
+    static constexpr uint32_t PARTITION_BITS = 4;
+    static constexpr uint32_t FANOUT = 1U << PARTITION_BITS;
+    static constexpr uint32_t MAX_LEVELS = 4;
+
+    /** A table and the partitions it is flushed to */
+    struct Sink
+    {
+        std::unique_ptr<AggregateHashTable> table;
+        /** FANOUT partitions, empty until the first flush */
+        std::vector<std::unique_ptr<SpillPartition>> partitions;
+        /** How many times the groups were split, selects the bits of the hash to split on */
+        uint32_t level;
+        size_t budget;
+    };
+
+    /** Flushed groups with the same partition index, to be merged together */
+    struct PendingPartition
+    {
+        std::vector<std::unique_ptr<SpillPartition>> parts;
+        uint32_t level;
+    };
+
+    /** @return a sink with an empty table */
+    Sink MakeSink(uint32_t level, size_t budget) const;
+
+    /** Add the selected rows of batch to the groups of sink */
+    void Aggregate(const RowBatch &batch, Sink *sink, std::string *key,
+                   std::vector<AggregateState *> *group_states) const;
+
+    /** Serialize the group-by values of row i of batch into key */
+    void MakeKey(const RowBatch &batch, size_t i, std::string *key) const;
+
+    /** Fold the states of a group into those of the group with the same key in sink */
+    void Merge(Sink *sink, std::string_view key, uint64_t hash, const AggregateState *states) const;
+
+    /** Move the groups of the table of sink to its partitions if it is over budget */
+    void FlushIfFull(Sink *sink) const;
+
+    /** Move the groups of the table of sink to its partitions */
+    void Flush(Sink *sink) const;
+
+    /** Serialize the group at i of table into buffer: hash, key and states, with their chars inline */
+    void EncodeGroup(const AggregateHashTable &table, size_t i, std::string *buffer) const;
+
+    /** Merge the groups of the partitions of pending into sink */
+    void MergePending(const PendingPartition &pending, Sink *sink) const;
+
+    /** Queue the partitions of sink, flushing it first, with those of the same index in pending_ */
+    void QueuePartitions(Sink *sink, size_t first);
+
+    /** Load the groups of the next pending partition into result_, @return false if none is left */
+    bool NextPartition();
+
+    /** Append the output row of the group at i of result_ to batch */
+    void Emit(size_t i, RowBatch *batch) const;
+
+    /** @return the partition of a group with hash, among those split at level */
+    static uint32_t PartitionOf(uint64_t hash, uint32_t level)
+    {
+        return (hash >> (64 - (level + 1) * PARTITION_BITS)) & (FANOUT - 1);
+    }
+
+    /** The aggregation plan node to be executed */
+    const AggregationPlanNode *plan_;
+
+    std::unique_ptr<AbstractExecutor> child_;
+
+    /** Child column of each group-by column and of each aggregate, -1 for COUNT(*) */
+    std::vector<uint32_t> group_columns_;
+    std::vector<TypeId> group_types_;
+    std::vector<int64_t> agg_columns_;
+    std::vector<TypeId> agg_input_types_;
+    std::vector<TypeId> agg_output_types_;
+
+    /** Rows of the spilled groups, a single char field each */
+    std::unique_ptr<Schema> group_schema_;
+
+    /** The groups being output */
+    Sink result_;
+    size_t result_pos_ = 0;
+    /** Partitions waiting to be merged and output, the last one is next */
+    std::vector<PendingPartition> pending_;
+    bool spilled_ = false;
+    size_t worker_count_ = 0;
+};
+
+#endif // MINISQL_HASH_AGGREGATE_EXECUTOR_H
@@ -0,0 +1,133 @@
+#ifndef MINISQL_HASH_JOIN_EXECUTOR_H
+#define MINISQL_HASH_JOIN_EXECUTOR_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/hash_join_plan.h"
+#include "executor/spill_partition.h"
+
+/**
+ * The HashJoinExecutor joins the rows of its two children on equal keys. Init() reads the
+ * build side into a hash table on the serialized keys, then NextBatch() looks up every
+ * row of the probe side. Rows with a null key match nothing and are dropped up front.
+ *
+ * When the build rows outgrow the memory budget of the plan, the join turns into a grace
+ * hash join: the build rows, then all probe rows, are split by key hash into FANOUT pairs
+ * of partitions on temporary pages, and the pairs are joined one after the other, each
+ * building its own hash table. A build partition still over budget is split again on the
+ * next bits of the hash, up to MAX_LEVELS deep; past that, as with many equal keys, it is
+ * joined in memory whatever its size.
+ */
+class HashJoinExecutor : public AbstractExecutor
+{
+public:
+    /**
+     * Construct a new HashJoinExecutor instance.
+     * @param exec_ctx The executor context
+     * @param plan The hash join plan to be executed
+     * @param left The executor producing the left rows
+     * @param right The executor producing the right rows
+     */
+    HashJoinExecutor(ExecuteContext *exec_ctx, const HashJoinPlanNode *plan, std::unique_ptr<AbstractExecutor> left,
+                     std::unique_ptr<AbstractExecutor> right);
+
+    /** Build the hash table, partitioning both inputs if it does not fit */
+    void Init() override;
+
+    bool Next(Row *row, RowId *rid) override { return NextFromBatch(row, rid); }
+
+    bool NextBatch(RowBatch *batch) override;
+
+    /** Stop both inputs */
+    void Stop() override;
+
+
+    /** @return The output schema for the join */
+    const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+    /** @return whether the inputs were partitioned to disk, for tests */
+    bool IsSpilled() const { return spilled_; }
+
+private:
+    static constexpr uint32_t PARTITION_BITS = 4;
+    static constexpr uint32_t FANOUT = 1U << PARTITION_BITS;
+    static constexpr uint32_t MAX_LEVELS = 4;
+
+    /** Rows of both sides whose keys hash to the same partition */
+    struct Partition
+    {
+        std::unique_ptr<SpillPartition> build;
+        std::unique_ptr<SpillPartition> probe;
+        /** How many times the rows were split, selects the bits of the hash to split on */
+        uint32_t level;
+    };
+
+    using HashTable = std::unordered_multimap<std::string, Row>;
+
+    /**
+     * Serialize the keys of row into key, numbers as doubles so that int and float keys match.
+     * @return false if some key is null, the row matches nothing
+     */
+    static bool MakeKey(const std::vector<AbstractExpressionRef> &keys, const Row &row, std::string *key);
+
+    /** @return the partition of key among those split at level */
+    static uint32_t PartitionOf(const std::string &key, uint32_t level);
+
+    /** Add the row with key to the hash table, @return false if the table is now over budget */
+    bool Insert(const std::string &key, const Row &row);
+
+    /** Move the hash table to new level 0 partitions, the rest of the build rows follow it there */
+    void SpillBuild();
+
+    /** Append FANOUT new partitions of level to partitions_, @return the index of the first */
+    size_t AddPartitions(uint32_t level);
+
+    /** Split the rows of partition once more */
+    void Repartition(Partition &partition);
+
+    /** Load the hash table of the next partition with rows on both sides, @return false if none is left */
+    bool NextPartition();
+
+    /** @return the next probe row, valid until the next call, or null if there are no more */
+    const Row *NextProbeRow();
+
+    /** Append the join of the two rows to batch if they pass the predicate */
+    void Emit(const Row &build_row, const Row &probe_row, RowBatch *batch);
+
+    /** The hash join plan node to be executed */
+    const HashJoinPlanNode *plan_;
+
+    std::unique_ptr<AbstractExecutor> build_executor_;
+    std::unique_ptr<AbstractExecutor> probe_executor_;
+    const std::vector<AbstractExpressionRef> *build_keys_;
+    const std::vector<AbstractExpressionRef> *probe_keys_;
+
+    HashTable table_;
+    /** Approximate bytes held by table_ */
+    size_t table_bytes_ = 0;
+    /** The matches of the current probe row not joined yet */
+    HashTable::const_iterator match_;
+    HashTable::const_iterator match_end_;
+    const Row *probe_row_ = nullptr;
+    std::string probe_key_;
+
+    bool spilled_ = false;
+    /** Partitions waiting to be joined, the last one is next */
+    std::vector<Partition> partitions_;
+    /** The partition being joined */
+    Partition current_;
+    size_t probe_page_ = 0;
+
+    /** Probe rows not looked up yet, from the probe executor or a page of current_ */
+    RowBatch probe_batch_;
+    std::vector<Row> probe_rows_;
+    size_t probe_pos_ = 0;
+    Row probe_buffer_;
+};
+
+#endif // MINISQL_HASH_JOIN_EXECUTOR_H
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "executor/execute_context.h"
@@ -8,9 +9,13 @@
 #include "planner/expressions/column_value_expression.h"
 #include "planner/expressions/comparison_expression.h"
 #include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
 
 /**
  * The IndexScanExecutor executor can over a table.
+ *
+ * The ranges are opened on the first NextBatch(), and the index cursor is let go of as soon
+ * as the scan reaches its row limit or is stopped.
  */
 class IndexScanExecutor : public AbstractExecutor
 {
@@ -33,6 +38,12 @@ public:
      */
     bool Next(Row *row, RowId *rid) override;
 
+    /** Fill batch with the next rows of the ranges that pass the residual filter */
+    bool NextBatch(RowBatch *batch) override;
+
+    /** Close the index cursor, no more rows are produced */
+    void Stop() override;
+
     /** @return The output schema for the sequential scan */
     const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
@@ -40,8 +51,23 @@ private:
     /** The sequential scan plan node to be executed */
     const IndexScanPlanNode *plan_;
 
-    void ScanIndex(AbstractExpressionRef, const std::map<uint32_t, IndexInfo *> &, std::vector<std::vector<RowId>> &);
+    /** Open the cursor over the planned ranges, collecting their row ids first if there are several */
+    void Open();
+
+    /** Produce the next row of the ranges, from the heap or from the index entry alone */
+    bool FetchRow(Row *row, RowId *rid);
+
     TableInfo *table_info;
-    std::vector<RowId> res;
-    std::vector<RowId>::iterator iter;
+    /** Streams the row ids of the planned ranges, one per Next() */
+    std::unique_ptr<IndexScanCursor> cursor_;
+    /** Whether the ranges were opened, null cursor_ then means the scan is over */
+    bool opened_{false};
+    /** Rows produced since Init(), counted against the row limit */
+    size_t produced_{0};
+    /** Whether rows still have to be checked against the whole predicate */
+    bool residual_filter_{true};
+    /** Table column of every field of an index entry, index-only scans only */
+    std::vector<uint32_t> entry_columns_;
+    /** Table column of every output column */
+    std::vector<uint32_t> output_columns_;
 };
\ No newline at end of file
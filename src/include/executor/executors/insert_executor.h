@@ -2,8 +2,6 @@
 // Created by njz on 2023/1/27.
 //
 
-#define INSERT_NEXT_VERSION
-
 #ifndef MINISQL_INSERT_EXECUTOR_H
 #define MINISQL_INSERT_EXECUTOR_H
 
@@ -14,7 +12,9 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor, a batch at a time:
+ * each index gets the keys of a whole batch at once, so it can sort them and
+ * place them with one pass over its pages instead of one lookup per row.
  */
 class InsertExecutor : public AbstractExecutor
 {
@@ -41,19 +41,47 @@ public:
      */
     bool Next([[maybe_unused]] Row *row, RowId *rid) override;
 
+    /**
+     * Insert the rows of the next child batch, all of them go to every index at once.
+     * @param[out] batch The ids of the rows inserted or updated, without values
+     */
+    bool NextBatch(RowBatch *batch) override;
+
     /** @return The output schema for the insert */
     const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
 private:
+    /**
+     * Insert rows, and append the ids of those that went in to batch. On a duplicate key
+     * of a unique index the rows from the first offending one on are taken back out and
+     * the insert stops, as if the rows had gone in one by one.
+     */
+    void InsertBatch(std::vector<Row> &rows, RowBatch *batch);
+
+    /**
+     * Insert a row for an insert with an ON CONFLICT action. Each unique index is
+     * probed and filled by a single descent, if one has the key already the row is
+     * taken back out and the action applies to the row holding the key.
+     * @return whether a row was inserted or updated
+     */
+    bool Upsert(Row &row);
+
+    /**
+     * Apply the DO UPDATE values to the row at rid. If the new values clash with another
+     * row of a unique index, the row and its index entries are put back and it throws.
+     */
+    void UpdateExisting(const RowId &rid);
+
     /** The insert plan node to be executed*/
     const InsertPlanNode *plan_;
     std::unique_ptr<AbstractExecutor> child_executor_;
 
     TableInfo *table_info = nullptr;
     std::vector<IndexInfo *> indexes;
-#ifndef INSERT_NEXT_VERSION
-    bool is_finished = false;
-#endif
+    /** The rows pulled from the child */
+    RowBatch input;
+    /** Set once a duplicate key ended the insert */
+    bool stopped = false;
 };
 
 #endif // MINISQL_INSERT_EXECUTOR_H
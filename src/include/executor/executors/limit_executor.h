@@ -0,0 +1,52 @@
+#ifndef MINISQL_LIMIT_EXECUTOR_H
+#define MINISQL_LIMIT_EXECUTOR_H
+
+#include <memory>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/limit_plan.h"
+
+/**
+ * The LimitExecutor passes on the batches of its child until the limit of the plan is
+ * reached, the last one cut down to the rows still wanted.
+ *
+ * The limit is handed down to the child as its row limit, and the child is stopped as
+ * soon as the limit is reached, so that scans below read no further than they must.
+ */
+class LimitExecutor : public AbstractExecutor
+{
+public:
+    /**
+     * Construct a new LimitExecutor instance.
+     * @param exec_ctx The executor context
+     * @param plan The limit plan to be executed
+     * @param child The executor producing the rows
+     */
+    LimitExecutor(ExecuteContext *exec_ctx, const LimitPlanNode *plan, std::unique_ptr<AbstractExecutor> child)
+        : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child))
+    {
+    }
+
+    void Init() override;
+
+    bool Next(Row *row, RowId *rid) override { return NextFromBatch(row, rid); }
+
+    bool NextBatch(RowBatch *batch) override;
+
+    void Stop() override;
+
+    /** @return The output schema for the limit */
+    const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+private:
+    /** The limit plan node to be executed */
+    const LimitPlanNode *plan_;
+
+    std::unique_ptr<AbstractExecutor> child_;
+
+    /** Rows produced so far */
+    size_t produced_ = 0;
+};
+
+#endif // MINISQL_LIMIT_EXECUTOR_H
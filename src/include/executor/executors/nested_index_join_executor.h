@@ -0,0 +1,66 @@
+#ifndef MINISQL_NESTED_INDEX_JOIN_EXECUTOR_H
+#define MINISQL_NESTED_INDEX_JOIN_EXECUTOR_H
+
+#include <memory>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/nested_index_join_plan.h"
+
+/**
+ * The NestedIndexJoinExecutor looks up the rows of the inner table matching each outer row
+ * in an index of the inner table, instead of reading the inner table at all. The keys of a
+ * whole batch of outer rows are looked up together through Index::ScanKeys(), which lets a
+ * B+ tree sort them and find them all in one walk along its leaves. The matching rows are
+ * then fetched from the table heap one outer row after the other, in the order of the outer
+ * rows. Outer rows with a null key match nothing.
+ */
+class NestedIndexJoinExecutor : public AbstractExecutor
+{
+public:
+    /**
+     * Construct a new NestedIndexJoinExecutor instance.
+     * @param exec_ctx The executor context
+     * @param plan The nested index join plan to be executed
+     * @param outer The executor producing the outer rows
+     */
+    NestedIndexJoinExecutor(ExecuteContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
+                            std::unique_ptr<AbstractExecutor> outer);
+
+    void Init() override;
+
+    bool Next(Row *row, RowId *rid) override { return NextFromBatch(row, rid); }
+
+    bool NextBatch(RowBatch *batch) override;
+
+    /** Stop the outer input */
+    void Stop() override;
+
+    /** @return The output schema for the join */
+    const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+private:
+    /** Read the next batch of outer rows and look up their keys, @return false if there are none left */
+    bool NextOuterBatch();
+
+    /** Append the join of the two rows to batch if they pass the predicate */
+    void Emit(const Row &outer_row, const Row &inner_row, RowBatch *batch);
+
+    /** The nested index join plan node to be executed */
+    const NestedIndexJoinPlanNode *plan_;
+
+    std::unique_ptr<AbstractExecutor> outer_executor_;
+    TableInfo *inner_table_ = nullptr;
+
+    RowBatch outer_batch_;
+    /** The outer rows of the batch with a key, and the inner row ids matching each */
+    std::vector<Row> outer_rows_;
+    std::vector<std::vector<RowId>> matches_;
+    /** The next match to join, the match_pos_-th of the outer_pos_-th row */
+    size_t outer_pos_ = 0;
+    size_t match_pos_ = 0;
+    Row inner_row_;
+};
+
+#endif // MINISQL_NESTED_INDEX_JOIN_EXECUTOR_H
@@ -5,14 +5,59 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/seq_scan_plan.h"
 
+/**
+ * The page ids of a table, handed out MORSEL_PAGES at a time to the scans of a parallel
+ * plan. A worker claims its next morsel when it is done with the last, so the work
+ * evens out across workers whatever the pages hold.
+ */
+class MorselQueue
+{
+public:
+    static constexpr size_t MORSEL_PAGES = 16;
+
+    /** Start handing out page_ids, only before the scans sharing the queue run */
+    void Reset(std::vector<page_id_t> page_ids)
+    {
+        page_ids_ = std::move(page_ids);
+        next_ = 0;
+    }
+
+    size_t GetPageCount() const { return page_ids_.size(); }
+
+    page_id_t GetPageId(size_t i) const { return page_ids_[i]; }
+
+    /**
+     * Claim the next morsel, the pages at begin to end of the directory.
+     * @return false if every page was handed out
+     */
+    bool Next(size_t *begin, size_t *end)
+    {
+        *begin = next_.fetch_add(MORSEL_PAGES);
+        if (*begin >= page_ids_.size())
+            return false;
+        *end = std::min(*begin + MORSEL_PAGES, page_ids_.size());
+        return true;
+    }
+
+private:
+    std::vector<page_id_t> page_ids_;
+    std::atomic<size_t> next_{0};
+};
+
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * Pages are read whole, one fetch per page. A scan given a MorselQueue reads the
+ * morsels it claims instead of following the page chain, for the workers of a
+ * GatherExecutor. Under a row limit, the scan ends once it produced that many rows.
  */
 class SeqScanExecutor : public AbstractExecutor
 {
@@ -21,8 +66,10 @@ public:
      * Construct a new SeqScanExecutor instance.
      * @param exec_ctx The executor context
      * @param plan The sequential scan plan to be executed
+     * @param morsels The pages to read, shared with other scans of the same plan, or null for all of them
      */
-    SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan);
+    SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan,
+                    std::shared_ptr<MorselQueue> morsels = nullptr);
 
     /** Initialize the sequential scan */
     void Init() override;
@@ -35,6 +82,12 @@ public:
      */
     bool Next(Row *row, RowId *rid) override;
 
+    /** Fill batch with the next rows that pass the filter, projected to the output columns */
+    bool NextBatch(RowBatch *batch) override;
+
+    /** End the scan */
+    void Stop() override { exhausted = true; }
+
     /** @return The output schema for the sequential scan */
     const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
@@ -42,9 +95,30 @@ private:
     /** The sequential scan plan node to be executed */
     const SeqScanPlanNode *plan_;
 
-    TableIterator table_iter;
-    TableIterator end;
+    /** @return the next page to read, INVALID_PAGE_ID once the scan is done */
+    page_id_t NextPage();
+
+    /** Append the live rows of a page, those passing the filter unless filter is false */
+    void ReadPage(page_id_t page_id, RowBatch *target, const std::vector<uint32_t> &columns, bool filter);
+
+    std::shared_ptr<MorselQueue> morsels;
+    /** The rest of the claimed morsel, from morsel_pos to morsel_end */
+    size_t morsel_pos = 0;
+    size_t morsel_end = 0;
+    /** The page after the last one read, when following the page chain */
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    bool exhausted = false;
+    /** Rows produced since Init(), counted against the row limit */
+    size_t produced = 0;
+    Row page_row;
+
     TableInfo *table_info = nullptr;
+    /** Table column of every output column */
+    std::vector<uint32_t> output_columns;
+    /** Every column of the table, read into scan_batch when the filter runs on whole batches */
+    std::vector<uint32_t> table_columns;
+    RowBatch scan_batch;
+    std::vector<uint64_t> scan_mask;
 };
 
 #endif // MINISQL_SEQ_SCAN_EXECUTOR_H
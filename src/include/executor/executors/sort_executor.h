@@ -0,0 +1,141 @@
+#ifndef MINISQL_SORT_EXECUTOR_H
+#define MINISQL_SORT_EXECUTOR_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/sort_plan.h"
+#include "executor/spill_partition.h"
+
+/**
+ * The SortExecutor orders the rows of its child by normalized keys: the order-by values of a
+ * row encoded so that comparing the bytes of two keys compares the rows, directions and nulls
+ * included. Keys and serialized rows are kept back to back in one buffer and sorted through
+ * small entries holding the first bytes of the key, which settle most comparisons.
+ *
+ * When the buffer outgrows the memory budget of the plan it is sorted and written out as a
+ * run on temporary pages, and the rows are merged from all runs at the end.
+ *
+ * With a limit of at most MAX_HEAP_ROWS rows, only the first rows of the order are kept in a
+ * bounded heap, a row after all of them is dropped as soon as its key is made.
+ */
+class SortExecutor : public AbstractExecutor
+{
+public:
+    /**
+     * Construct a new SortExecutor instance.
+     * @param exec_ctx The executor context
+     * @param plan The sort plan to be executed
+     * @param child The executor producing the rows to sort
+     */
+    SortExecutor(ExecuteContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> child);
+
+    /** Read and sort all rows of the child */
+    void Init() override;
+
+    bool Next(Row *row, RowId *rid) override { return NextFromBatch(row, rid); }
+
+    bool NextBatch(RowBatch *batch) override;
+
+    /** Stop the input and drop the sorted rows and runs */
+    void Stop() override;
+
+    /** @return The output schema for the sort */
+    const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+    /** @return how many sorted runs were written to disk, for tests */
+    size_t GetRunCount() const { return runs_.size(); }
+
+    /** @return whether the rows were kept in a bounded heap, for tests */
+    bool IsTopN() const { return top_n_; }
+
+private:
+    /** The largest limit kept in a heap, larger ones sort everything and stop early */
+    static constexpr size_t MAX_HEAP_ROWS = 1 << 16;
+    /** Bytes of the buffer below which the rows replaced in the heap are left in it */
+    static constexpr size_t MIN_COMPACT_BYTES = 1 << 20;
+
+    /** A row in the buffer: its key, followed by its serialized fields */
+    struct SortEntry
+    {
+        /** The first bytes of the key, big-endian and zero padded */
+        uint64_t prefix;
+        size_t offset;
+        uint32_t key_length;
+        uint32_t row_length;
+        /** Position of the row in the input, orders equal keys */
+        uint64_t seq;
+    };
+
+    /** Reads sorted rows from the buffer or from a run */
+    struct RunCursor
+    {
+        /** Null for the buffer */
+        const SpillPartition *run;
+        size_t page;
+        std::vector<Row> rows;
+        size_t pos;
+        std::string_view key;
+        const char *row;
+    };
+
+    /** Encode the order-by values of row i of batch into key */
+    void MakeKey(const RowBatch &batch, uint32_t i, std::string *key) const;
+
+    /** @return an entry for key and the serialized row, not yet in the buffer */
+    static SortEntry MakeEntry(const std::string &key, uint32_t row_length, size_t offset, uint64_t seq);
+
+    /** Append key and row to the buffer, @return its entry */
+    SortEntry Store(const std::string &key, const Row &row, uint64_t seq);
+
+    bool Less(const SortEntry &lhs, const SortEntry &rhs) const;
+
+    /** Add row i of batch, the seq-th of the input, to the bounded heap if it is among the first rows */
+    void PushTopN(const RowBatch &batch, uint32_t i, uint64_t seq, std::string *key, Row *row);
+
+    /** Copy the rows of the heap to a fresh buffer, dropping those replaced */
+    void Compact();
+
+    /** Sort the buffer and write it out as a run */
+    void SpillRun();
+
+    /** @return bytes held by the buffer */
+    size_t GetMemoryUsage() const { return data_.size() + entries_.capacity() * sizeof(SortEntry); }
+
+    /** @return whether the current row of cursor rhs comes before that of lhs */
+    bool CursorGreater(size_t lhs, size_t rhs) const;
+
+    /** Move cursor to its next row, @return false if it has none */
+    bool Advance(RunCursor *cursor);
+
+    /** The sort plan node to be executed */
+    const SortPlanNode *plan_;
+
+    std::unique_ptr<AbstractExecutor> child_;
+
+    /** The child column and direction of each key */
+    std::vector<uint32_t> key_columns_;
+    std::vector<bool> descending_;
+
+    /** Rows of the runs, a single char field each: key length, key and serialized row */
+    std::unique_ptr<Schema> run_schema_;
+
+    /** Keys and serialized rows of the buffer */
+    std::string data_;
+    std::vector<SortEntry> entries_;
+    std::vector<std::unique_ptr<SpillPartition>> runs_;
+    bool top_n_ = false;
+    /** Bytes of the buffer held by the rows in the heap */
+    size_t live_bytes_ = 0;
+
+    /** The buffer and every run, and a heap of the cursors by their current key */
+    std::vector<RunCursor> cursors_;
+    std::vector<size_t> heap_;
+    size_t produced_ = 0;
+};
+
+#endif // MINISQL_SORT_EXECUTOR_H
@@ -41,6 +41,9 @@ public:
      */
     bool Next([[maybe_unused]] Row *row, RowId *rid) override;
 
+    /** Update the rows of the next child batch */
+    bool NextBatch(RowBatch *batch) override;
+
     /** @return The output schema for the update */
     const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
@@ -0,0 +1,41 @@
+#ifndef MINISQL_FILTER_KERNELS_H
+#define MINISQL_FILTER_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "executor/row_batch.h"
+
+/**
+ * Kernels comparing whole columns of a RowBatch, for predicates evaluated a batch at a
+ * time. Each sets bit i of a selection mask (bit i % 64 of word i / 64) when row i
+ * passes, and clears it otherwise. The mask holds MaskWords(n) words.
+ *
+ * Int and float kernels use AVX2 when the cpu has it, 8 rows per instruction, and plain
+ * loops otherwise. Values of null rows are compared like any other, ClearNulls() drops
+ * them afterwards.
+ */
+enum class CompareOp { kEqual, kNotEqual, kLess, kLessEqual, kGreater, kGreaterEqual };
+
+inline size_t MaskWords(size_t n) { return (n + 63) / 64; }
+
+void FilterInts(CompareOp op, const int32_t *left, const int32_t *right, size_t n, uint64_t *mask);
+
+void FilterInts(CompareOp op, const int32_t *left, int32_t right, size_t n, uint64_t *mask);
+
+void FilterFloats(CompareOp op, const float *left, const float *right, size_t n, uint64_t *mask);
+
+void FilterFloats(CompareOp op, const float *left, float right, size_t n, uint64_t *mask);
+
+/** Compare char values byte-wise over their common prefix, then by length */
+void FilterChars(CompareOp op, const ColumnVector &left, const ColumnVector &right, uint64_t *mask);
+
+void FilterChars(CompareOp op, const ColumnVector &left, const char *right, uint32_t len, uint64_t *mask);
+
+/** Set the bits of the rows of column that are null, or of those that are not */
+void FilterNulls(const ColumnVector &column, bool is_null, uint64_t *mask);
+
+/** Clear the bits of the rows of column that are null */
+void ClearNulls(const ColumnVector &column, uint64_t *mask);
+
+#endif // MINISQL_FILTER_KERNELS_H
@@ -21,8 +21,12 @@ enum class PlanType {
   Values,
   Aggregation,
   Limit,
+  Sort,
   Distinct,
   NestedLoopJoin,
+  Gather,
+  HashJoin,
+  NestedIndexJoin,
 };
 
 class AbstractPlanNode;
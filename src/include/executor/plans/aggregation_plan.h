@@ -0,0 +1,67 @@
+#ifndef MINISQL_AGGREGATION_PLAN_H
+#define MINISQL_AGGREGATION_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "planner/expressions/abstract_expression.h"
+
+/** The aggregate functions of a SELECT list */
+enum class AggregationType { CountStarAggregate, CountAggregate, SumAggregate, AvgAggregate, MinAggregate, MaxAggregate };
+
+/**
+ * The AggregationPlanNode groups the rows of its child by the values of the group-by columns
+ * and computes aggregates over the rows of each group. An aggregated row holds the group-by
+ * values followed by the value of each aggregate, the output rows are made of the output
+ * expressions evaluated over it. Without group-by columns all rows form a single group, one
+ * row is produced even if there are none.
+ */
+class AggregationPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new AggregationPlanNode.
+   * @param output The output schema of the aggregation
+   * @param child The plan producing the rows to aggregate
+   * @param group_bys The columns of a child row the rows are grouped by
+   * @param aggregates The column of a child row each aggregate reads, null for COUNT(*)
+   * @param agg_types The function of each aggregate
+   * @param columns The expression of each output column over an aggregated row
+   * @param memory_budget Bytes of groups held in memory before they are partitioned to disk
+   */
+  AggregationPlanNode(const Schema *output, AbstractPlanNodeRef child, std::vector<AbstractExpressionRef> group_bys,
+                      std::vector<AbstractExpressionRef> aggregates, std::vector<AggregationType> agg_types,
+                      std::vector<AbstractExpressionRef> columns, size_t memory_budget)
+      : AbstractPlanNode(output, {std::move(child)}),
+        group_bys_(std::move(group_bys)),
+        aggregates_(std::move(aggregates)),
+        agg_types_(std::move(agg_types)),
+        columns_(std::move(columns)),
+        memory_budget_(memory_budget) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Aggregation; }
+
+  /** @return The plan producing the rows to aggregate */
+  AbstractPlanNodeRef GetChildPlan() const {
+    ASSERT(GetChildren().size() == 1, "Aggregation expected to only have one child.");
+    return GetChildAt(0);
+  }
+
+  /** The columns rows are grouped by */
+  std::vector<AbstractExpressionRef> group_bys_;
+
+  /** The input column of each aggregate, null for COUNT(*) */
+  std::vector<AbstractExpressionRef> aggregates_;
+
+  /** The function of each aggregate */
+  std::vector<AggregationType> agg_types_;
+
+  /** The expressions of the output columns */
+  std::vector<AbstractExpressionRef> columns_;
+
+  /** Bytes of groups the aggregation holds in memory */
+  size_t memory_budget_;
+};
+
+#endif  // MINISQL_AGGREGATION_PLAN_H
@@ -0,0 +1,40 @@
+#ifndef MINISQL_GATHER_PLAN_H
+#define MINISQL_GATHER_PLAN_H
+
+#include <utility>
+
+#include "abstract_plan.h"
+#include "executor/plans/seq_scan_plan.h"
+
+/**
+ * The GatherPlanNode runs its sequential scan child on several worker threads, each
+ * reading morsels of the table's pages, and merges the rows they produce. The rows
+ * come out in no particular order.
+ */
+class GatherPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new GatherPlanNode.
+   * @param output The output schema, that of the scan
+   * @param child The sequential scan run by every worker
+   * @param workers The number of worker threads
+   */
+  GatherPlanNode(const Schema *output, AbstractPlanNodeRef child, uint32_t workers)
+      : AbstractPlanNode(output, {std::move(child)}), workers_(workers) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Gather; }
+
+  /** @return The scan run by the workers */
+  const SeqScanPlanNode *GetChildPlan() const {
+    ASSERT(GetChildren().size() == 1, "Gather should have only one child plan.");
+    return dynamic_cast<const SeqScanPlanNode *>(GetChildAt(0).get());
+  }
+
+  uint32_t GetWorkers() const { return workers_; }
+
+  /** The number of worker threads */
+  uint32_t workers_;
+};
+
+#endif  // MINISQL_GATHER_PLAN_H
@@ -0,0 +1,68 @@
+#ifndef MINISQL_HASH_JOIN_PLAN_H
+#define MINISQL_HASH_JOIN_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "planner/expressions/abstract_expression.h"
+
+/**
+ * The HashJoinPlanNode joins the rows of its left and right children whose join keys are
+ * equal: it builds a hash table over one of them and probes it with the rows of the other.
+ * Output rows are made of the output expressions evaluated over the left and right rows,
+ * see AbstractExpression::EvaluateJoin(), and have to pass the predicate if there is one.
+ */
+class HashJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new HashJoinPlanNode.
+   * @param output The output schema of the join
+   * @param left The plan producing the left rows
+   * @param right The plan producing the right rows
+   * @param left_keys The join keys over a left row, without keys every pair of rows matches
+   * @param right_keys The join keys over a right row, of the same types as left_keys
+   * @param predicate The conditions on both rows the keys do not cover, null if there are none
+   * @param columns The expression of each output column
+   * @param build_left Whether the hash table is built over the left rows, else over the right ones
+   * @param memory_budget Bytes of build rows held in memory before they are partitioned to disk
+   */
+  HashJoinPlanNode(const Schema *output, AbstractPlanNodeRef left, AbstractPlanNodeRef right,
+                   std::vector<AbstractExpressionRef> left_keys, std::vector<AbstractExpressionRef> right_keys,
+                   AbstractExpressionRef predicate, std::vector<AbstractExpressionRef> columns, bool build_left,
+                   size_t memory_budget)
+      : AbstractPlanNode(output, {std::move(left), std::move(right)}),
+        left_keys_(std::move(left_keys)),
+        right_keys_(std::move(right_keys)),
+        predicate_(std::move(predicate)),
+        columns_(std::move(columns)),
+        build_left_(build_left),
+        memory_budget_(memory_budget) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::HashJoin; }
+
+  AbstractPlanNodeRef GetLeftPlan() const { return GetChildAt(0); }
+
+  AbstractPlanNodeRef GetRightPlan() const { return GetChildAt(1); }
+
+  /** The join keys over a left row */
+  std::vector<AbstractExpressionRef> left_keys_;
+
+  /** The join keys over a right row */
+  std::vector<AbstractExpressionRef> right_keys_;
+
+  /** The rest of the join condition, null if there is none */
+  AbstractExpressionRef predicate_;
+
+  /** The expressions of the output columns */
+  std::vector<AbstractExpressionRef> columns_;
+
+  /** Whether the left rows are the build side */
+  bool build_left_;
+
+  /** Bytes of build rows the join holds in memory */
+  size_t memory_budget_;
+};
+
+#endif  // MINISQL_HASH_JOIN_PLAN_H
@@ -5,8 +5,22 @@
 
 #include "abstract_plan.h"
 #include "catalog/catalog.h"
+#include "planner/compiled_predicate.h"
 #include "planner/expressions/abstract_expression.h"
 
+/**
+ * One key range of an index: equal values for a prefix of the key columns, then at most one
+ * value of the next column. A bound covering fewer columns than the key matches every key
+ * starting with it, an empty one leaves that side open.
+ */
+struct IndexScanRange {
+  IndexInfo *index{nullptr};
+  std::vector<Field> lower_key;
+  bool lower_inclusive{true};
+  std::vector<Field> upper_key;
+  bool upper_inclusive{true};
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
  */
@@ -16,14 +30,18 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_name The identifier of table to be scanned
+   * @param range_sets The index ranges holding every row of the result, see range_sets_
+   * @param index_only Whether the single range's index covers every column the query touches
    */
-  IndexScanPlanNode(const Schema *output, std::string table_name, std::vector<IndexInfo *> indexes, bool need_filter,
-                    AbstractExpressionRef filter_predicate = nullptr)
+  IndexScanPlanNode(const Schema *output, std::string table_name, std::vector<std::vector<IndexScanRange>> range_sets,
+                    bool need_filter, AbstractExpressionRef filter_predicate = nullptr, bool index_only = false)
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
-        indexes_(std::move(indexes)),
+        range_sets_(std::move(range_sets)),
         need_filter_(need_filter),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        compiled_predicate_(CompiledPredicate::Compile(filter_predicate_)),
+        index_only_(index_only) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::IndexScan; }
@@ -33,15 +51,35 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   AbstractExpressionRef GetPredicate() const { return filter_predicate_; }
 
+  /** @return whether row passes the predicate, through its compiled form if it has one */
+  bool EvaluatePredicate(const Row *row) const {
+    if (compiled_predicate_ != nullptr) {
+      return compiled_predicate_->Evaluate(*row);
+    }
+    return filter_predicate_->Evaluate(row).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+  }
+
   /** The table name */
   std::string table_name_;
 
-  /** The indexes*/
-  std::vector<IndexInfo *> indexes_;
+  /**
+   * The rows to read are those in every set, and a row is in a set if one of its ranges holds it.
+   * A set without ranges holds no row, e.g. when the conjuncts contradict each other.
+   */
+  std::vector<std::vector<IndexScanRange>> range_sets_;
+
+  /** Whether the rows come from a single range, which is read in key order without merging */
+  bool IsSingleRange() const { return range_sets_.size() == 1 && range_sets_[0].size() == 1; }
 
-  /** Whether there are indexes on all columns in the predicate*/
+  /** Whether rows of the ranges still have to be checked against the predicate */
   bool need_filter_ = true;
 
   /** The predicate to filter in IndexScan.*/
   AbstractExpressionRef filter_predicate_;
-};
\ No newline at end of file
+
+  /** filter_predicate_ compiled when the plan is built, null if it can only be interpreted */
+  std::shared_ptr<const CompiledPredicate> compiled_predicate_;
+
+  /** Rows are rebuilt from the index entries, the table heap is never read */
+  bool index_only_ = false;
+};
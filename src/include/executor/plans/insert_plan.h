@@ -5,10 +5,19 @@
 #ifndef MINISQL_INSERT_PLAN_H
 #define MINISQL_INSERT_PLAN_H
 
+#include <unordered_map>
+
 #include "abstract_plan.h"
 #include "catalog/catalog.h"
 #include "planner/expressions/abstract_expression.h"
 
+/** What an insert does with a row whose key is already taken in a unique index */
+enum class OnConflict {
+  Stop,      // the row and the rest of the insert are dropped
+  DoNothing, // the row is skipped
+  DoUpdate   // the row holding the key is updated instead
+};
+
 /**
  * The InsertPlanNode identifies a table into which rows are inserted.
  * The values to be inserted will come from the child of the node.
@@ -19,9 +28,16 @@ class InsertPlanNode : public AbstractPlanNode {
    * Creates a new insert plan node for inserting values from a child plan.
    * @param child the child plan to obtain values from
    * @param table_name the identifier of the table that should be inserted into
+   * @param on_conflict what to do with rows whose unique key is taken
+   * @param update_attrs the columns set on the row holding the key, for OnConflict::DoUpdate
    */
-  InsertPlanNode(Schema *output, AbstractPlanNodeRef child, std::string table_name)
-      : AbstractPlanNode(output, {std::move(child)}), table_name_(std::move(table_name)) {}
+  InsertPlanNode(Schema *output, AbstractPlanNodeRef child, std::string table_name,
+                 OnConflict on_conflict = OnConflict::Stop,
+                 std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs = {})
+      : AbstractPlanNode(output, {std::move(child)}),
+        table_name_(std::move(table_name)),
+        on_conflict_(on_conflict),
+        update_attrs_(std::move(update_attrs)) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::Insert; }
@@ -29,6 +45,11 @@ class InsertPlanNode : public AbstractPlanNode {
   /** @return The identifier of the table which rows are inserted intol*/
   std::string GetTableName() const { return table_name_; }
 
+  OnConflict GetOnConflict() const { return on_conflict_; }
+
+  /** @return Map from column index -> new value of the row holding a taken key */
+  const std::unordered_map<uint32_t, AbstractExpressionRef> &GetUpdateAttr() const { return update_attrs_; }
+
   /** @return the child plan providing rows to be inserted */
   AbstractPlanNodeRef GetChildPlan() const {
     ASSERT(GetChildren().size() == 1, "Insert should have only one child plan.");
@@ -37,6 +58,10 @@ class InsertPlanNode : public AbstractPlanNode {
 
   /** The table to be inserted into. */
   std::string table_name_;
+
+  OnConflict on_conflict_;
+
+  std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs_;
 };
 
 #endif  // MINISQL_INSERT_PLAN_H
@@ -0,0 +1,35 @@
+#ifndef MINISQL_LIMIT_PLAN_H
+#define MINISQL_LIMIT_PLAN_H
+
+#include <utility>
+
+#include "abstract_plan.h"
+
+/**
+ * The LimitPlanNode outputs the first rows of its child, up to a number of them.
+ */
+class LimitPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new LimitPlanNode.
+   * @param output The output schema, that of the child
+   * @param child The plan producing the rows
+   * @param limit The number of rows produced at most
+   */
+  LimitPlanNode(const Schema *output, AbstractPlanNodeRef child, size_t limit)
+      : AbstractPlanNode(output, {std::move(child)}), limit_(limit) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Limit; }
+
+  /** @return The plan producing the rows */
+  AbstractPlanNodeRef GetChildPlan() const {
+    ASSERT(GetChildren().size() == 1, "Limit expected to only have one child.");
+    return GetChildAt(0);
+  }
+
+  /** The number of rows produced at most */
+  size_t limit_;
+};
+
+#endif  // MINISQL_LIMIT_PLAN_H
@@ -0,0 +1,88 @@
+#ifndef MINISQL_NESTED_INDEX_JOIN_PLAN_H
+#define MINISQL_NESTED_INDEX_JOIN_PLAN_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "catalog/catalog.h"
+#include "planner/compiled_predicate.h"
+#include "planner/expressions/abstract_expression.h"
+
+/**
+ * The NestedIndexJoinPlanNode joins the rows of its child, the outer side, with the rows of
+ * the inner table whose index key equals the join keys of the outer row: the inner table is
+ * never scanned, each outer row looks its matches up in the index. Output rows are made as
+ * in HashJoinPlanNode, with the outer row on the side it came from in the statement.
+ */
+class NestedIndexJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new NestedIndexJoinPlanNode.
+   * @param output The output schema of the join
+   * @param outer The plan producing the outer rows
+   * @param inner_table_name The table looked up for every outer row
+   * @param index The index of the inner table the outer rows are looked up in
+   * @param outer_keys One expression over an outer row for each column of the index key, in key order
+   * @param inner_filter The conditions on the inner row alone, null if there are none
+   * @param predicate The conditions on both rows the keys do not cover, null if there are none
+   * @param columns The expression of each output column
+   * @param outer_left Whether the outer rows are the left rows of the join, else the right ones
+   */
+  NestedIndexJoinPlanNode(const Schema *output, AbstractPlanNodeRef outer, std::string inner_table_name,
+                          IndexInfo *index, std::vector<AbstractExpressionRef> outer_keys,
+                          AbstractExpressionRef inner_filter, AbstractExpressionRef predicate,
+                          std::vector<AbstractExpressionRef> columns, bool outer_left)
+      : AbstractPlanNode(output, {std::move(outer)}),
+        inner_table_name_(std::move(inner_table_name)),
+        index_(index),
+        outer_keys_(std::move(outer_keys)),
+        inner_filter_(std::move(inner_filter)),
+        compiled_inner_filter_(CompiledPredicate::Compile(inner_filter_)),
+        predicate_(std::move(predicate)),
+        columns_(std::move(columns)),
+        outer_left_(outer_left) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::NestedIndexJoin; }
+
+  AbstractPlanNodeRef GetOuterPlan() const { return GetChildAt(0); }
+
+  /** @return whether an inner row passes the inner filter, through its compiled form if it has one */
+  bool EvaluateInnerFilter(const Row *row) const {
+    if (inner_filter_ == nullptr) {
+      return true;
+    }
+    if (compiled_inner_filter_ != nullptr) {
+      return compiled_inner_filter_->Evaluate(*row);
+    }
+    return inner_filter_->Evaluate(row).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+  }
+
+  /** The table looked up */
+  std::string inner_table_name_;
+
+  /** The index of the inner table */
+  IndexInfo *index_;
+
+  /** The key of the index over an outer row */
+  std::vector<AbstractExpressionRef> outer_keys_;
+
+  /** The conditions on the inner row alone, null if there are none */
+  AbstractExpressionRef inner_filter_;
+
+  /** inner_filter_ compiled when the plan is built, null if it can only be interpreted */
+  std::shared_ptr<const CompiledPredicate> compiled_inner_filter_;
+
+  /** The rest of the join condition, null if there is none */
+  AbstractExpressionRef predicate_;
+
+  /** The expressions of the output columns */
+  std::vector<AbstractExpressionRef> columns_;
+
+  /** Whether the outer rows are the left side */
+  bool outer_left_;
+};
+
+#endif  // MINISQL_NESTED_INDEX_JOIN_PLAN_H
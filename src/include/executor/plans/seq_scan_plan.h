@@ -7,6 +7,7 @@
 
 #include "abstract_plan.h"
 #include "catalog/catalog.h"
+#include "planner/compiled_predicate.h"
 #include "planner/expressions/abstract_expression.h"
 
 class SeqScanPlanNode : public AbstractPlanNode {
@@ -19,7 +20,8 @@ class SeqScanPlanNode : public AbstractPlanNode {
   SeqScanPlanNode(const Schema *output, std::string table_name, AbstractExpressionRef filter_predicate = nullptr)
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        compiled_predicate_(CompiledPredicate::Compile(filter_predicate_)) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::SeqScan; }
@@ -29,11 +31,22 @@ class SeqScanPlanNode : public AbstractPlanNode {
 
   AbstractExpressionRef GetPredicate() const { return filter_predicate_; }
 
+  /** @return whether row passes the predicate, through its compiled form if it has one */
+  bool EvaluatePredicate(const Row *row) const {
+    if (compiled_predicate_ != nullptr) {
+      return compiled_predicate_->Evaluate(*row);
+    }
+    return filter_predicate_->Evaluate(row).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+  }
+
   /** The table name */
   std::string table_name_;
 
   /** The predicate to filter in SeqScan.*/
   AbstractExpressionRef filter_predicate_;
+
+  /** filter_predicate_ compiled when the plan is built, null if it can only be interpreted */
+  std::shared_ptr<const CompiledPredicate> compiled_predicate_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_PLAN_H
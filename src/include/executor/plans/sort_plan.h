@@ -0,0 +1,63 @@
+#ifndef MINISQL_SORT_PLAN_H
+#define MINISQL_SORT_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "planner/expressions/abstract_expression.h"
+
+/** The direction of a key of ORDER BY, nulls come first in either direction */
+enum class OrderByType { Asc, Desc };
+
+/**
+ * The SortPlanNode outputs the rows of its child ordered by the order-by keys, each row made
+ * of the output expressions evaluated over a child row. The child may produce columns the keys
+ * read but the output leaves out. With a limit only the first rows of the order are produced.
+ */
+class SortPlanNode : public AbstractPlanNode {
+ public:
+  /** No limit on the rows produced */
+  static constexpr size_t NO_LIMIT = static_cast<size_t>(-1);
+
+  /**
+   * Construct a new SortPlanNode.
+   * @param output The output schema of the sort
+   * @param child The plan producing the rows to sort
+   * @param order_bys The direction and the expression over a child row of each key
+   * @param columns The expression of each output column over a child row
+   * @param limit The number of rows produced at most, NO_LIMIT for all of them
+   * @param memory_budget Bytes of rows held in memory before sorted runs are written to disk
+   */
+  SortPlanNode(const Schema *output, AbstractPlanNodeRef child,
+               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys,
+               std::vector<AbstractExpressionRef> columns, size_t limit, size_t memory_budget)
+      : AbstractPlanNode(output, {std::move(child)}),
+        order_bys_(std::move(order_bys)),
+        columns_(std::move(columns)),
+        limit_(limit),
+        memory_budget_(memory_budget) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Sort; }
+
+  /** @return The plan producing the rows to sort */
+  AbstractPlanNodeRef GetChildPlan() const {
+    ASSERT(GetChildren().size() == 1, "Sort expected to only have one child.");
+    return GetChildAt(0);
+  }
+
+  /** The keys of the order, the first one most significant */
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys_;
+
+  /** The expressions of the output columns */
+  std::vector<AbstractExpressionRef> columns_;
+
+  /** The number of rows produced at most */
+  size_t limit_;
+
+  /** Bytes of rows the sort holds in memory */
+  size_t memory_budget_;
+};
+
+#endif  // MINISQL_SORT_PLAN_H
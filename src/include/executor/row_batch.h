@@ -0,0 +1,114 @@
+#ifndef MINISQL_ROW_BATCH_H
+#define MINISQL_ROW_BATCH_H
+
+#include <vector>
+
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * The values of one column of a RowBatch. They are kept in a plain array of their
+ * type instead of as Fields, so loops over a column compile to tight code.
+ */
+class ColumnVector
+{
+public:
+    explicit ColumnVector(TypeId type) : type_(type) {}
+
+    TypeId GetType() const { return type_; }
+
+    size_t Size() const { return nulls_.size(); }
+
+    void Clear();
+
+    void Append(const Field &field);
+
+    /** Append the value at i of other, a column of the same type */
+    void Append(const ColumnVector &other, size_t i);
+
+    bool IsNull(size_t i) const { return nulls_[i] != 0; }
+
+    /** One byte per row, non-zero for nulls */
+    const uint8_t *GetNulls() const { return nulls_.data(); }
+
+    /** Values of an int column, those of null rows are undefined */
+    const int32_t *GetInts() const { return ints_.data(); }
+
+    /** Values of a float column, those of null rows are undefined */
+    const float *GetFloats() const { return floats_.data(); }
+
+    /** Bytes of the value at i of a char column */
+    const char *GetChars(size_t i) const { return chars_.data() + offsets_[i]; }
+
+    uint32_t GetLength(size_t i) const { return offsets_[i + 1] - offsets_[i]; }
+
+    /** @return the value at i as a field owning a copy of its data */
+    Field GetField(size_t i) const;
+
+private:
+    TypeId type_;
+    std::vector<uint8_t> nulls_;
+    std::vector<int32_t> ints_;
+    std::vector<float> floats_;
+    /** Char values back to back, value i spans offsets_[i] to offsets_[i + 1] */
+    std::vector<char> chars_;
+    std::vector<uint32_t> offsets_{0};
+};
+
+/**
+ * Column-major batch of up to CAPACITY rows passed between executors by NextBatch().
+ *
+ * Besides the columns, a batch holds the row id of each row and a selection vector:
+ * the positions of the rows that are part of the result, ascending. Appending a row
+ * selects it, an executor drops rows from the result by narrowing the selection
+ * instead of moving the values around.
+ */
+class RowBatch
+{
+public:
+    static constexpr size_t CAPACITY = 1024;
+
+    /**
+     * Drop all rows and lay out columns for the rows of schema. A batch without a schema
+     * takes its columns from the first row appended, or has none if only row ids are.
+     */
+    void Reset(const Schema *schema);
+
+    /** @return the number of rows, selected or not */
+    size_t Size() const { return row_ids_.size(); }
+
+    bool Full() const { return Size() == CAPACITY; }
+
+    /** Append a row whose values are the fields at columns of tuple */
+    void Append(const Row &tuple, const std::vector<uint32_t> &columns, const RowId &rid);
+
+    /** Append all fields of row, with its row id */
+    void Append(const Row &row);
+
+    /** Append the row at i of other, whose values are those of its columns at columns */
+    void Append(const RowBatch &other, size_t i, const std::vector<uint32_t> &columns);
+
+    /** Append a row without values, for batches that only count rows */
+    void AppendRowId(const RowId &rid);
+
+    uint32_t GetColumnCount() const { return columns_.size(); }
+
+    const ColumnVector &GetColumn(uint32_t i) const { return columns_[i]; }
+
+    const RowId &GetRowId(size_t i) const { return row_ids_[i]; }
+
+    std::vector<uint32_t> &GetSelection() { return selection_; }
+
+    const std::vector<uint32_t> &GetSelection() const { return selection_; }
+
+    /** Build the row at i as a Row, for consumers of the row interface */
+    void GetRow(size_t i, Row *row) const;
+
+private:
+    const Schema *schema_{nullptr};
+    std::vector<ColumnVector> columns_;
+    std::vector<RowId> row_ids_;
+    std::vector<uint32_t> selection_;
+};
+
+#endif // MINISQL_ROW_BATCH_H
@@ -0,0 +1,40 @@
+#ifndef MINISQL_SPILL_PARTITION_H
+#define MINISQL_SPILL_PARTITION_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Rows written out to temporary table pages by an operator that does not fit in memory.
+ * Rows are appended to the last page and read back a page at a time in the order they
+ * were written. The pages are deleted with the partition.
+ */
+class SpillPartition
+{
+public:
+    SpillPartition(BufferPoolManager *bpm, const Schema *schema) : bpm_(bpm), schema_(schema) {}
+
+    ~SpillPartition();
+
+    DISALLOW_COPY_AND_MOVE(SpillPartition);
+
+    void Append(Row &row);
+
+    size_t GetRowCount() const { return row_count_; }
+
+    size_t GetPageCount() const { return page_ids_.size(); }
+
+    /** Replace rows with the rows of page i */
+    void ReadPage(size_t i, std::vector<Row> *rows) const;
+
+private:
+    BufferPoolManager *bpm_;
+    const Schema *schema_;
+    std::vector<page_id_t> page_ids_;
+    size_t row_count_ = 0;
+};
+
+#endif // MINISQL_SPILL_PARTITION_H
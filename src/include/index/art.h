@@ -0,0 +1,83 @@
+#ifndef MINISQL_ART_H
+#define MINISQL_ART_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/rowid.h"
+
+/**
+ * In-memory adaptive radix tree over byte string keys.
+ *
+ * Inner nodes branch on one key byte and come in four sizes (4, 16, 48 and 256
+ * children), growing and shrinking with their fan-out, so a sparse node stays a
+ * cache line or two. Chains of single-child nodes are collapsed into a prefix kept
+ * on the node below them (path compression); up to kMaxPrefix bytes of it are stored
+ * inline and a longer one is read back from any leaf underneath.
+ *
+ * No key may be a prefix of another, which holds for KeyManager's normalized keys.
+ * Iteration is in memcmp order of the keys.
+ */
+class AdaptiveRadixTree {
+ public:
+  struct Leaf {
+    std::string key;
+    RowId value;
+  };
+
+  struct Node;
+
+  /** Forward iterator over the leaves in key order */
+  class Iterator {
+    friend class AdaptiveRadixTree;
+
+   public:
+    /** @return the next leaf, null once the tree is exhausted */
+    const Leaf *Next();
+
+   private:
+    struct Frame {
+      const Node *node;
+      /** Where to continue: a child index for nodes of 4 and 16, a key byte for larger ones */
+      int pos;
+    };
+
+    std::vector<Frame> stack_;
+    /** A leaf found by the seek, handed out before the stack is walked */
+    const Leaf *pending_{nullptr};
+  };
+
+  AdaptiveRadixTree() = default;
+
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+
+  AdaptiveRadixTree &operator=(const AdaptiveRadixTree &) = delete;
+
+  ~AdaptiveRadixTree();
+
+  /** @return false if the key is already present, the tree is left unchanged */
+  bool Insert(const std::string &key, const RowId &value);
+
+  /** @return false if the key is not present */
+  bool Remove(const std::string &key);
+
+  /** @return the leaf of key, null if it is not present */
+  const Leaf *Lookup(const std::string &key) const;
+
+  /** An iterator starting at the first key not less than key */
+  Iterator LowerBound(const std::string &key) const;
+
+  Iterator Begin() const;
+
+  size_t Size() const { return size_; }
+
+  /** Drop every key */
+  void Clear();
+
+ private:
+  Node *root_{nullptr};
+  size_t size_{0};
+};
+
+#endif  // MINISQL_ART_H
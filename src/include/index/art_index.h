@@ -0,0 +1,50 @@
+#ifndef MINISQL_ART_INDEX_H
+#define MINISQL_ART_INDEX_H
+
+#include <string>
+#include <vector>
+
+#include "index/art.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Memory resident adaptive radix tree index (CREATE INDEX ... USING art).
+ *
+ * Keys are indexed in the byte comparable form of KeyManager, so a point lookup
+ * walks at most one node per key byte without touching the buffer pool, and range
+ * scans come out in key order. A non-unique index appends the row id to every key
+ * to keep the keys distinct. Nothing is written to disk: the catalog fills the tree
+ * from the table heap whenever it loads the index.
+ */
+class ArtIndex : public Index {
+ public:
+  ArtIndex(index_id_t index_id, IndexSchema *key_schema, bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                  std::string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanCursor> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                        bool upper_inclusive, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  bool SupportsIndexOnlyScan() const override { return true; }
+
+ private:
+  /** The normalized bytes of the leading key columns of key */
+  std::string EncodeKey(const Row &key) const;
+
+  /** The tree key of an entry, the row id follows the key unless the index is unique */
+  std::string EncodeEntry(const Row &key, RowId row_id) const;
+
+  KeyManager processor_;
+  AdaptiveRadixTree tree_;
+  bool unique_;
+};
+
+#endif  // MINISQL_ART_INDEX_H
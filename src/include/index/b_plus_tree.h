@@ -1,6 +1,7 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -16,10 +17,14 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, or map to posting lists of values in a non-unique tree
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Leaf pages may keep their keys prefix compressed, and leaf splits push up
+ *     the shortest separator instead of a full key (compress_keys)
+ * (6) A covering unique tree stores an opaque payload (the included columns of
+ *     an index) with every value
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
@@ -27,20 +32,50 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
-                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
+                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE,
+                     bool compress_keys = true, bool unique = true, bool covering = false);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
-  bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+  // Insert a key-value pair into this B+ tree, payload is only kept by a covering tree.
+  bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr, const std::string &payload = "");
+
+  // Insert a key-value pair unless the key is there already, whose value then goes to existing.
+  // Unique trees only, both take a single descent.
+  bool InsertOrGet(GenericKey *key, const RowId &value, RowId &existing, Transaction *transaction = nullptr,
+                   const std::string &payload = "");
+
+  // Insert key-value pairs sorted by key, descending once per leaf they land in. inserted[i] is set to
+  // what Insert would return for pair i, equal keys go in in the order given.
+  void InsertBatch(const std::vector<GenericKey *> &keys, const std::vector<RowId> &values,
+                   const std::vector<std::string> &payloads, std::vector<bool> &inserted,
+                   Transaction *transaction = nullptr);
+
+  // Rewrite the payload of key in a covering tree, with a single descent. update gets the payload, empty
+  // for a key not there yet, and returns false to leave it alone. A key left with an empty payload is
+  // removed, a new one goes in with value. @return what update returned.
+  bool UpdatePayload(GenericKey *key, const RowId &value, const std::function<bool(std::string &)> &update,
+                     Transaction *transaction = nullptr);
 
   // Remove a key and its value from this B+ tree.
   void Remove(const GenericKey *key, Transaction *transaction = nullptr);
 
+  // Remove one key-value pair, other values of a non-unique key are kept.
+  void Remove(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  bool IsUnique() const { return unique_; }
+
+  bool IsCovering() const { return covering_; }
+
   // return the value associated with a given key
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
 
+  // Look up keys sorted by key, results[i] gets the values of keys[i]. Walks the leaf chain from one
+  // key to the next, descending again only when a key lies beyond the next leaf.
+  void GetValues(const std::vector<GenericKey *> &keys, std::vector<std::vector<RowId>> &results,
+                 Transaction *transaction = nullptr);
+
   IndexIterator Begin();
 
   IndexIterator Begin(const GenericKey *key);
@@ -68,9 +103,19 @@ class BPlusTree {
   }
 
  private:
-  void StartNewTree(GenericKey *key, const RowId &value);
+  void StartNewTree(GenericKey *key, const RowId &value, const std::string &payload);
+
+  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction, const std::string &payload,
+                      RowId *existing = nullptr);
+
+  LeafFormat GetLeafFormat() const;
 
-  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+  // Append the values of key to result if leaf holds it
+  bool LookupInLeaf(LeafPage *leaf, const GenericKey *key, std::vector<RowId> &result);
+
+  void StorePosting(LeafPage *leaf, const GenericKey *key, const std::string &posting, Transaction *transaction);
+
+  void RemoveFromLeaf(LeafPage *leaf, int index, Transaction *transaction);
 
   void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
@@ -79,6 +124,8 @@ class BPlusTree {
 
   InternalPage *Split(InternalPage *node, Transaction *transaction);
 
+  void TruncateSeparator(const GenericKey *left, GenericKey *right) const;
+
   template <typename N>
   bool CoalesceOrRedistribute(N *&node, Transaction *transaction = nullptr);
 
@@ -108,6 +155,9 @@ class BPlusTree {
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool compress_keys_;
+  bool unique_;
+  bool covering_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -7,16 +7,32 @@
 
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  /** The included columns are stored in the leaves when include_schema is given, unique trees only */
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true, IndexSchema *include_schema = nullptr);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
+  dberr_t InsertOrGetEntry(const Row &key, RowId row_id, RowId *existing, Transaction *txn) override;
+
+  /** Sorts the keys and merges them into the tree with one descent per leaf they land in */
+  void InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, std::vector<bool> &inserted,
+                     Transaction *txn) override;
+
   dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
 
+  /** Sorts the keys and looks them up in one walk along the leaves */
+  void ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &results, Transaction *txn) override;
+
+  std::unique_ptr<IndexScanCursor> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                        bool upper_inclusive, Transaction *txn) override;
+
   dberr_t Destroy() override;
 
+  bool SupportsIndexOnlyScan() const override { return true; }
+
   IndexIterator GetBeginIterator();
 
   IndexIterator GetBeginIterator(GenericKey *key);
@@ -26,6 +42,8 @@ class BPlusTreeIndex : public Index {
  protected:
   // comparator for key
   KeyManager processor_;
+  // columns kept next to the row ids, null if the tree is not covering
+  IndexSchema *include_schema_;
   // container
   BPlusTree container_;
 };
@@ -0,0 +1,56 @@
+#ifndef MINISQL_BITMAP_INDEX_H
+#define MINISQL_BITMAP_INDEX_H
+
+#include <string>
+#include <vector>
+
+#include "index/b_plus_tree.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Bitmap index for columns with few distinct values (CREATE INDEX ... USING bitmap).
+ *
+ * Every distinct key owns a bitmap of heap positions, split by heap page: a covering
+ * B+ tree holds one entry per key and page, keyed by the key columns followed by the
+ * page id, with the bitset of the page's slots as payload. Maintenance flips one bit of
+ * a single entry in place, through one leaf lookup, and range cursors hand whole pages
+ * over to a RowIdBitmap, so AND/OR with other indexes never enumerates the row ids one
+ * by one.
+ */
+class BitmapIndex : public Index {
+ public:
+  BitmapIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
+
+  ~BitmapIndex() override;
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanCursor> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                        bool upper_inclusive, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+ private:
+  /** The key columns followed by the heap page id */
+  static Schema *MakeEntrySchema(const IndexSchema *key_schema);
+
+  /** Serialize the key columns of key followed by page_id */
+  GenericKey *MakeEntryKey(const Row &key, page_id_t page_id) const;
+
+  /**
+   * Set or clear the bit of slot in a page bitset, dropping trailing zero words.
+   * @return false if the bit already was as asked, the payload is unchanged then
+   */
+  static bool SetSlot(std::string &payload, uint32_t slot, bool set);
+
+  Schema *entry_schema_;
+  KeyManager processor_;
+  BPlusTree container_;
+};
+
+#endif  // MINISQL_BITMAP_INDEX_H
@@ -0,0 +1,69 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_INDEX_H
+#define MINISQL_EXTENDIBLE_HASH_INDEX_H
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+#include "page/hash_bucket_page.h"
+#include "page/hash_directory_page.h"
+#include "page/hash_header_page.h"
+
+/**
+ * Disk resident extendible hash index (CREATE INDEX ... USING hash).
+ *
+ * A point lookup reads the header page, one directory page and the bucket, no
+ * matter how many keys there are. The header page id is kept in the index roots
+ * page like the root of a B+ tree. Keys are stored in the serialized form of
+ * KeyManager, so range scans still work by filtering every bucket, but in no
+ * particular order.
+ */
+class ExtendibleHashIndex : public Index {
+ public:
+  ExtendibleHashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                      BufferPoolManager *buffer_pool_manager, bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanCursor> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                        bool upper_inclusive, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  /** Ranges come out in bucket order */
+  bool IsOrdered() const override { return false; }
+
+ private:
+  uint32_t Hash(const GenericKey *key) const;
+
+  bool Insert(const GenericKey *key, const RowId &value);
+
+  bool Remove(const GenericKey *key, const RowId &value);
+
+  /** Append the values of key to result */
+  bool Lookup(const GenericKey *key, std::vector<RowId> &result);
+
+  /** @return the directory serving hash, INVALID_PAGE_ID if it doesn't exist and create is not set */
+  page_id_t FindDirectory(uint32_t hash, bool create);
+
+  /** Put the pair in the first bucket of the chain with room, growing the chain if needed */
+  void InsertIntoChain(page_id_t bucket_page_id, const GenericKey *key, const RowId &value);
+
+  /** Split the bucket of directory entry "index", the directory grows if needed */
+  void SplitBucket(HashDirectoryPage *directory, uint32_t index);
+
+  /** Fold the empty bucket of entry "index" into its split image */
+  void MergeBucket(HashDirectoryPage *directory, uint32_t index);
+
+  HashBucketPage *NewBucket(page_id_t &page_id);
+
+  KeyManager processor_;
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t header_page_id_{INVALID_PAGE_ID};
+  bool unique_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_INDEX_H
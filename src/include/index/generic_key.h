@@ -1,6 +1,7 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <algorithm>
 #include <cstring>
 
 #include "record/field.h"
@@ -27,6 +28,19 @@ private:
     char data[0];
 };
 
+/**
+ * Keys are stored in a normalized, byte comparable form so that the B+ tree can
+ * compare them with memcmp and share common prefixes between neighbours.
+ *
+ * Per column:
+ *  ---------------------------------------------------------------
+ * | NotNull (1) | INT: 4 bytes big endian, sign bit flipped       |
+ * |             | FLOAT: 4 bytes big endian, order preserving bits |
+ * |             | CHAR: raw bytes followed by a 0 terminator       |
+ *  ---------------------------------------------------------------
+ * A null column is stored as a single 0 byte and sorts before every value.
+ * The rest of the key buffer is zero filled.
+ */
 class KeyManager
 {
 public: /**/
@@ -35,53 +49,141 @@ public: /**/
         return (GenericKey *)malloc(key_size_); // remember delete
     }
 
+    /** Only the leading fields of key that match the schema are used, an index entry may carry more */
     inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const
     {
-        // initialize to 0
-        [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
-        ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-        ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
-        memset(key_buf->data, 0, key_size_);
-        key.SerializeTo(key_buf->data, schema);
+        ASSERT(key.GetFieldCount() >= schema->GetColumnCount(), "field nums not match.");
+        SerializePrefix(key_buf, key, schema);
     }
 
-    inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const
+    /**
+     * Serialize the leading key columns given by key, which may have fewer fields than the schema.
+     * Every full key starting with these values has the returned number of bytes in common with key_buf.
+     */
+    inline int SerializePrefix(GenericKey *key_buf, const Row &key, Schema *schema) const
     {
-        [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-        ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+        memset(key_buf->data, 0, key_size_);
+        auto *buf = reinterpret_cast<uint8_t *>(key_buf->data);
+        uint32_t ofs = 0;
+        uint32_t count = std::min<uint32_t>(key.GetFieldCount(), schema->GetColumnCount());
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const Field *field = key.GetField(i);
+            TypeId type = schema->GetColumn(i)->GetType();
+            if (field->IsNull())
+            {
+                ASSERT(ofs + 1 <= (uint32_t)key_size_, "Index key size exceed max key size.");
+                buf[ofs++] = 0;
+                continue;
+            }
+            if (type == TypeId::kTypeChar)
+            {
+                uint32_t len = field->GetLength();
+                ASSERT(ofs + len + 2 <= (uint32_t)key_size_, "Index key size exceed max key size.");
+                buf[ofs++] = 1;
+                memcpy(buf + ofs, field->GetData(), len);
+                ofs += len + 1;
+                continue;
+            }
+            ASSERT(ofs + 5 <= (uint32_t)key_size_, "Index key size exceed max key size.");
+            uint32_t bits;
+            if (type == TypeId::kTypeInt)
+            {
+                int32_t val = field->GetTypeId() == TypeId::kTypeFloat ? (int32_t)field->value_.float_ : field->value_.integer_;
+                bits = (uint32_t)val ^ 0x80000000u;
+            }
+            else
+            {
+                float val = field->GetTypeId() == TypeId::kTypeInt ? (float)field->value_.integer_ : field->value_.float_;
+                if (val == 0.0f) // -0.0 equals 0.0
+                    val = 0.0f;
+                memcpy(&bits, &val, sizeof(bits));
+                bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+            }
+            buf[ofs++] = 1;
+            for (int b = 3; b >= 0; b--)
+                buf[ofs++] = (uint8_t)(bits >> (b * 8));
+        }
+        return ofs;
     }
 
-    // compare
-    [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const
+    inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const
     {
-        //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-        uint32_t column_count = key_schema_->GetColumnCount();
-        Row lhs_key(INVALID_ROWID);
-        Row rhs_key(INVALID_ROWID);
-        DeserializeToKey(lhs, lhs_key, key_schema_);
-        DeserializeToKey(rhs, rhs_key, key_schema_);
-
-        for (uint32_t i = 0; i < column_count; i++)
+        const auto *buf = reinterpret_cast<const uint8_t *>(key_buf->data);
+        uint32_t ofs = 0;
+        std::vector<Field> fields;
+        for (uint32_t i = 0; i < schema->GetColumnCount(); i++)
         {
-            Field *lhs_value = lhs_key.GetField(i);
-            Field *rhs_value = rhs_key.GetField(i);
-
-            if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue)
+            TypeId type = schema->GetColumn(i)->GetType();
+            if (buf[ofs++] == 0)
             {
-                return -1;
+                fields.emplace_back(type);
+                continue;
             }
-
-            if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue)
+            if (type == TypeId::kTypeChar)
             {
-                return 1;
+                uint32_t len = strnlen(reinterpret_cast<const char *>(buf + ofs), key_size_ - ofs);
+                fields.emplace_back(type, const_cast<char *>(reinterpret_cast<const char *>(buf + ofs)), len, true);
+                ofs += len + 1;
+                continue;
+            }
+            uint32_t bits = 0;
+            for (int b = 0; b < 4; b++)
+                bits = (bits << 8) | buf[ofs++];
+            if (type == TypeId::kTypeInt)
+                fields.emplace_back(type, (int32_t)(bits ^ 0x80000000u));
+            else
+            {
+                bits = (bits & 0x80000000u) ? bits & ~0x80000000u : ~bits;
+                float val;
+                memcpy(&val, &bits, sizeof(val));
+                fields.emplace_back(type, val);
             }
         }
-        // equals
-        return 0;
+        ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+        key = Row(fields);
+    }
+
+    // compare
+    [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const
+    {
+        return memcmp(lhs->data, rhs->data, key_size_);
+    }
+
+    /** Compare only the first length bytes, a key against a bound built by SerializePrefix */
+    [[nodiscard]] inline int ComparePrefix(const GenericKey *lhs, const GenericKey *rhs, int length) const
+    {
+        return memcmp(lhs->data, rhs->data, length);
     }
 
     inline int GetKeySize() const { return key_size_; }
 
+    /** @return the length of a normalized key once its zero padding is stripped */
+    static inline int KeyLength(const char *key, int key_size)
+    {
+        while (key_size > 0 && key[key_size - 1] == 0)
+            key_size--;
+        return key_size;
+    }
+
+    /** @return the number of leading bytes shared by two normalized keys */
+    static inline int CommonPrefix(const char *lhs, const char *rhs, int key_size)
+    {
+        int len = 0;
+        while (len < key_size && lhs[len] == rhs[len])
+            len++;
+        return len;
+    }
+
+    /** @return the normalized size of the widest key of this schema */
+    static uint32_t GetMaxKeyLength(const Schema *key_schema)
+    {
+        uint32_t len = 0;
+        for (auto col : key_schema->GetColumns())
+            len += 1 + col->GetLength() + (col->GetType() == TypeId::kTypeChar ? 1 : 0);
+        return len;
+    }
+
     KeyManager(const KeyManager &other)
     {
         this->key_schema_ = other.key_schema_;
@@ -2,26 +2,121 @@
 #define MINISQL_INDEX_H
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/dberr.h"
+#include "common/rowid_bitmap.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
+/**
+ * Forward-only cursor over the row ids of an index range, produced by Index::Scan.
+ * Entries are handed out one at a time, in key order unless the index is not
+ * IsOrdered(), so callers never need to materialize the whole range.
+ */
+class IndexScanCursor {
+ public:
+  virtual ~IndexScanCursor() {}
+
+  /**
+   * Fetch the next row id of the range.
+   * @return false once the range is exhausted
+   */
+  virtual bool Next(RowId *rid) = 0;
+
+  /**
+   * Like Next(), and rebuild the entry from the index alone: the key columns
+   * followed by the included ones. Only for indexes that SupportsIndexOnlyScan().
+   */
+  virtual bool NextEntry(RowId * /*rid*/, Row * /*entry*/) {
+    ASSERT(false, "The index can not hand out its entries.");
+    return false;
+  }
+
+  /**
+   * Add the rest of the range to bitmap. Indexes that keep row ids in bitmap form
+   * override this to merge them without enumerating each one.
+   */
+  virtual void CollectRowIds(RowIdBitmap *bitmap) {
+    RowId rid;
+    while (Next(&rid)) {
+      bitmap->Add(rid);
+    }
+  }
+};
+
 class Index {
  public:
   explicit Index(index_id_t index_id, IndexSchema *key_schema) : index_id_(index_id), key_schema_(key_schema) {}
 
   virtual ~Index() {}
 
+  /** key may be followed by the values of the included columns, which are kept if the index covers them */
   virtual dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
+  /**
+   * Insert an entry of a unique index unless its key is taken.
+   * @return DB_ALREADY_EXIST with the row id holding the key in existing, or what InsertEntry
+   * returns. Indexes that find the key on the way to its place override this to look only once.
+   */
+  virtual dberr_t InsertOrGetEntry(const Row &key, RowId row_id, RowId *existing, Transaction *txn) {
+    std::vector<RowId> result;
+    if (ScanKey(key, result, txn) == DB_SUCCESS && !result.empty()) {
+      *existing = result[0];
+      return DB_ALREADY_EXIST;
+    }
+    return InsertEntry(key, row_id, txn);
+  }
+
+  /**
+   * Insert a batch of entries, inserted[i] tells whether keys[i] went in as InsertEntry would.
+   * Entries with equal keys go in in the order given. Indexes that can share the work of
+   * finding their place across entries override this.
+   */
+  virtual void InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids,
+                             std::vector<bool> &inserted, Transaction *txn) {
+    inserted.assign(keys.size(), false);
+    for (size_t i = 0; i < keys.size(); i++) {
+      inserted[i] = InsertEntry(keys[i], row_ids[i], txn) == DB_SUCCESS;
+    }
+  }
+
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
-                          string compare_operator = "=") = 0;
+                          std::string compare_operator = "=") = 0;
+
+  /**
+   * Look up a batch of keys for equality, results[i] gets the row ids of keys[i]. Indexes
+   * that can share the work of finding keys across the batch override this.
+   */
+  virtual void ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &results, Transaction *txn) {
+    results.assign(keys.size(), {});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], results[i], txn);
+    }
+  }
+
+  /**
+   * Open a cursor over all entries whose key lies between lower and upper.
+   * A null bound leaves that side of the range open. A bound may hold only the leading
+   * key columns, it then compares equal to every key starting with those values.
+   */
+  virtual std::unique_ptr<IndexScanCursor> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                bool upper_inclusive, Transaction *txn) = 0;
 
   virtual dberr_t Destroy() = 0;
 
+  /** Whether the cursors of this index implement NextEntry() */
+  virtual bool SupportsIndexOnlyScan() const { return false; }
+
+  /**
+   * Whether Scan() hands out a range in key order. A hash index still scans a range by
+   * filtering every bucket, but in bucket order, so the planner only uses it for whole keys.
+   */
+  virtual bool IsOrdered() const { return true; }
+
  protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
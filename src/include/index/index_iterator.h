@@ -1,6 +1,8 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
 class IndexIterator
@@ -13,11 +15,21 @@ public:
 
     explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
 
+    // the iterator owns a pin on its current leaf, so it can only be moved
+    IndexIterator(const IndexIterator &other) = delete;
+
+    IndexIterator(IndexIterator &&other) noexcept;
+
+    IndexIterator &operator=(IndexIterator &&other) noexcept;
+
     ~IndexIterator();
 
     /** Return the key/value pair this iterator is currently pointing at. */
     std::pair<GenericKey *, RowId> operator*();
 
+    /** The included columns stored with the current pair, only in a covering tree */
+    const char *Payload(int &length) const;
+
     /** Move to the next key/value pair.*/
     IndexIterator &operator++();
 
@@ -27,11 +39,26 @@ public:
     /** Return whether two iterators are not equal. */
     bool operator!=(const IndexIterator &itr) const;
 
+    /** Return whether the iterator has run past the last leaf */
+    inline bool IsEnd() const { return current_page_id == INVALID_PAGE_ID; }
+
 private:
+    /** Skip to the first pair at or after item_index, following the leaf chain */
+    void SkipExhausted();
+
+    /** Read the posting list of the current record of a non-unique tree */
+    void LoadPostings();
+
     page_id_t current_page_id{INVALID_PAGE_ID};
     LeafPage *page{nullptr};
     int item_index{0};
     BufferPoolManager *buffer_pool_manager{nullptr};
+    // leaves only keep compressed keys, the current one is rebuilt here
+    GenericKey *key_{nullptr};
+    // values of the current key in a non-unique tree, overflow pages are read one at a time
+    std::vector<RowId> postings_;
+    int posting_index_{0};
+    page_id_t overflow_page_id_{INVALID_PAGE_ID};
     // add your own private member variables here
 };
 
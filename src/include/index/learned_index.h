@@ -0,0 +1,76 @@
+#ifndef MINISQL_LEARNED_INDEX_H
+#define MINISQL_LEARNED_INDEX_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "index/index.h"
+
+/**
+ * Learned index over a single integer column (CREATE INDEX ... USING learned), for
+ * read-mostly tables whose keys grow monotonically.
+ *
+ * The entries are kept in one sorted array. A RadixSpline models it: a linear spline
+ * through (key, position) points that predicts the position of any key within
+ * MAX_ERROR, and a radix table on the leading key bits that finds the spline segment
+ * of a key. A lookup is a table probe, a short search among spline points and a binary
+ * search over at most 2 * MAX_ERROR + 1 keys, in a model that takes a few bytes per
+ * segment instead of a page per few hundred keys.
+ *
+ * New entries go to a small ordered delta buffer and removed ones are only marked.
+ * Once the buffer and the marks grow past an eighth of the array, both are merged
+ * into a new array and the model is trained again. Like ArtIndex, nothing is written
+ * to disk: the catalog fills the index from the table heap whenever it loads it.
+ */
+class LearnedIndex : public Index {
+ public:
+  /** Largest distance between the position the spline predicts and the real one */
+  static constexpr int64_t MAX_ERROR = 32;
+  /** Changes buffered before retraining, for arrays too small for an eighth to matter */
+  static constexpr size_t MIN_RETRAIN_CHANGES = 1024;
+
+  /** The trained array and its model, shared with the scans started on it */
+  struct Segment;
+
+  LearnedIndex(index_id_t index_id, IndexSchema *key_schema, bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                  std::string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanCursor> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                        bool upper_inclusive, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  bool SupportsIndexOnlyScan() const override { return true; }
+
+  /** Merge the delta buffer and the removals into a new sorted array and fit a new model */
+  void Retrain();
+
+  /** @return the bytes held by the array, the model and the delta buffer */
+  size_t GetMemoryUsage() const;
+
+  size_t GetSplinePointCount() const;
+
+ private:
+  /** The value of the key column, nulls sort first */
+  static int64_t KeyOf(const Row &key);
+
+  void RetrainIfDue();
+
+  bool unique_;
+  std::shared_ptr<Segment> segment_;
+  /** Entries inserted since the last training, in key order */
+  std::multimap<int64_t, RowId> delta_;
+  /** Entries of segment_ marked removed */
+  size_t removed_count_{0};
+};
+
+#endif  // MINISQL_LEARNED_INDEX_H
@@ -0,0 +1,52 @@
+#ifndef MINISQL_LSM_INDEX_H
+#define MINISQL_LSM_INDEX_H
+
+#include <string>
+#include <vector>
+
+#include "index/generic_key.h"
+#include "index/index.h"
+#include "index/lsm_tree.h"
+
+/**
+ * Log-structured merge tree index (CREATE INDEX ... USING lsm), for tables that
+ * take many more writes than reads.
+ *
+ * Keys are indexed in the byte comparable form of KeyManager, like ArtIndex: a
+ * non-unique index appends the row id to every key and leaves it out of the Bloom
+ * filters, so an equality lookup on the whole key only reads the runs that hold it.
+ */
+class LsmIndex : public Index {
+ public:
+  LsmIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+           bool unique = true, size_t memtable_limit = LsmTree::DEFAULT_MEMTABLE_LIMIT);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                  std::string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanCursor> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                        bool upper_inclusive, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  bool SupportsIndexOnlyScan() const override { return true; }
+
+  LsmTree &GetTree() { return tree_; }
+
+ private:
+  /** The normalized bytes of the leading key columns of key */
+  std::string EncodeKey(const Row &key) const;
+
+  /** The tree key of an entry, the row id follows the key unless the index is unique */
+  std::string EncodeEntry(const Row &key, RowId row_id) const;
+
+  KeyManager processor_;
+  bool unique_;
+  LsmTree tree_;
+};
+
+#endif  // MINISQL_LSM_INDEX_H
@@ -0,0 +1,157 @@
+#ifndef MINISQL_LSM_TREE_H
+#define MINISQL_LSM_TREE_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/thread_pool.h"
+#include "page/lsm_page.h"
+
+/**
+ * Log-structured merge tree over byte string keys, for indexes that take far more
+ * writes than reads.
+ *
+ * Writes go to an in-memory skip list (the memtable). A full memtable is written out
+ * front to back as an immutable sorted run of SortedRunPages, so inserts never split
+ * or rewrite pages. Every run keeps the first key of each page (fence pointers) and a
+ * Bloom filter of its keys in memory: a point lookup reads at most one page per run
+ * and skips most runs without reading anything.
+ *
+ * Runs are organized in levels. Level 0 holds flushed memtables, which overlap; every
+ * deeper level is a single run ten times the size of the one above. A low priority task
+ * on the shared ThreadPool merges level 0 into level 1 once it has LEVEL0_RUN_LIMIT runs, and a level into
+ * the next once it outgrows its size. Deletes write tombstones, which merges drop on
+ * reaching the deepest level.
+ *
+ * The list of runs lives in a chain of LsmMetaPages whose head is registered in the
+ * index roots page. The memtable is only written out when it fills up or the tree is
+ * closed.
+ */
+class LsmTree {
+ public:
+  class MemTable;
+  class SortedRun;
+  class Source;
+
+  /** Iterator merging the memtable and the runs, newer versions of a key hide older ones */
+  class Iterator {
+    friend class LsmTree;
+
+   public:
+    Iterator(Iterator &&other) noexcept;
+
+    ~Iterator();
+
+    /** @return the next live entry in key order, null once the tree is exhausted */
+    const LsmEntry *Next();
+
+   private:
+    explicit Iterator(bool keep_deleted);
+
+    /** Newest first, the first source holding a key has its current version */
+    std::vector<std::unique_ptr<Source>> sources_;
+    /** Sources positioned on the entry returned last, moved on by the next call */
+    std::vector<size_t> advance_;
+    /** Whether tombstones are returned too, as merges need them */
+    bool keep_deleted_;
+  };
+
+  static constexpr size_t DEFAULT_MEMTABLE_LIMIT = 16384;
+  static constexpr size_t LEVEL0_RUN_LIMIT = 4;
+
+  /**
+   * @param suffix_length trailing key bytes left out of the Bloom filters, point lookups
+   * by Seek() then find every key that starts with the same bytes
+   * @param memtable_limit number of entries after which the memtable is written out
+   */
+  LsmTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, uint32_t suffix_length = 0,
+          size_t memtable_limit = DEFAULT_MEMTABLE_LIMIT);
+
+  LsmTree(const LsmTree &) = delete;
+
+  LsmTree &operator=(const LsmTree &) = delete;
+
+  /** Write out the memtable so nothing is lost */
+  ~LsmTree();
+
+  void Put(const std::string &key, const RowId &value);
+
+  void Delete(const std::string &key);
+
+  /** @return false if key has no live version */
+  bool Get(const std::string &key, RowId *value);
+
+  /**
+   * An iterator from the first key not less than key. With point set, only keys
+   * that equal key up to the suffix are of interest, runs whose filter rules key
+   * out are not read.
+   */
+  Iterator Seek(const std::string &key, bool point = false);
+
+  /** Write the memtable out as a new run of level 0 */
+  void Flush();
+
+  /** Block until no compaction is running or due */
+  void WaitForCompaction();
+
+  /** @return the number of runs, of all levels */
+  size_t GetRunCount();
+
+  /** Free every page of the tree, it must not be used afterwards */
+  void Destroy();
+
+ private:
+  struct Compaction {
+    std::vector<std::shared_ptr<SortedRun>> inputs;
+    /** Level of the output run, 1 for a merge of level 0 */
+    size_t level;
+    bool drop_deleted;
+  };
+
+  /** @return false if no level needs to be merged, latch_ must be held */
+  bool PickCompaction(Compaction &compaction) const;
+
+  /** Swap the inputs of a finished compaction for its output, latch_ must be held */
+  void InstallCompaction(const Compaction &compaction, const std::shared_ptr<SortedRun> &output);
+
+  /** Start a compaction task if a merge is due and none is running, latch_ must be held */
+  void ScheduleCompaction();
+
+  /** Body of the compaction task: merge levels until none is due */
+  void RunCompactions();
+
+  void StopWorker();
+
+  /** Store the list of runs, latch_ must be held */
+  void WriteManifest();
+
+  void LoadManifest();
+
+  index_id_t index_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  uint32_t suffix_length_;
+  size_t memtable_limit_;
+  /** Only the writer touches the memtable, readers hold on to it through their iterators */
+  std::shared_ptr<MemTable> memtable_;
+  page_id_t manifest_page_id_{INVALID_PAGE_ID};
+
+  /** Guards the runs and the manifest, shared with the compaction task */
+  std::mutex latch_;
+  std::condition_variable idle_cv_;
+  /** Level 0, newest first */
+  std::vector<std::shared_ptr<SortedRun>> level0_;
+  /** levels_[i] is the run of level i + 1, null while the level is empty */
+  std::vector<std::shared_ptr<SortedRun>> levels_;
+  /** Whether a compaction task is queued or running */
+  bool busy_{false};
+  bool stop_{false};
+  bool destroyed_{false};
+  std::shared_ptr<ThreadPool> thread_pool_{ThreadPool::Shared()};
+  std::shared_ptr<TaskGroup> compactions_{std::make_shared<TaskGroup>()};
+};
+
+#endif  // MINISQL_LSM_TREE_H
@@ -0,0 +1,89 @@
+#ifndef MINISQL_POSTING_LIST_H
+#define MINISQL_POSTING_LIST_H
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "page/posting_page.h"
+
+#define POSTING_INLINE_LIMIT (LEAF_PAGE_CAPACITY / 8)
+
+/**
+ * Row ids sharing one key of a non-unique B+ tree, kept sorted and delta
+ * encoded in the value of the leaf record.
+ *
+ * Short lists live in the leaf record itself:
+ *  ------------------------------------------------------
+ * | Tag = 0 (1) | Count (varint) | Deltas (varint) ... |
+ *  ------------------------------------------------------
+ * Once the encoding grows past POSTING_INLINE_LIMIT the row ids move to a chain
+ * of PostingPages and the record only points to it:
+ *  -------------------------------------------------------------
+ * | Tag = 1 (1) | HeadPageId (4) | TailPageId (4) | Count (4) |
+ *  -------------------------------------------------------------
+ * Row ids mostly arrive in increasing order, they are appended to the tail page
+ * without touching the rest of the chain.
+ */
+class PostingList
+{
+public:
+    /** Open the list stored in a leaf record, data may be null for a new list */
+    PostingList(const char *data, int length, BufferPoolManager *buffer_pool_manager);
+
+    /** @return false if rid is already in the list */
+    bool Insert(const RowId &rid);
+
+    /** @return false if rid is not in the list */
+    bool Remove(const RowId &rid);
+
+    int GetSize() const { return overflow_ ? count_ : static_cast<int>(rids_.size()); }
+
+    bool IsEmpty() const { return GetSize() == 0; }
+
+    /** The encoded list to store back in the leaf record */
+    const std::string &GetData() const { return data_; }
+
+    /** Append every row id of the list to rids */
+    void GetAll(std::vector<RowId> &rids) const;
+
+    /** Free the overflow pages, the list is empty afterwards */
+    void Destroy();
+
+    /**
+     * Read the row ids kept in the record, or in the first overflow page.
+     * @return the next overflow page to read with LoadPage, INVALID_PAGE_ID at the end
+     */
+    static page_id_t LoadFirst(const char *data, int length, std::vector<RowId> &rids,
+                               BufferPoolManager *buffer_pool_manager);
+
+    static page_id_t LoadPage(page_id_t page_id, std::vector<RowId> &rids, BufferPoolManager *buffer_pool_manager);
+
+private:
+    static constexpr uint8_t INLINE_TAG = 0;
+    static constexpr uint8_t OVERFLOW_TAG = 1;
+
+    /** Rebuild data_ from the current state */
+    void Serialize();
+
+    /** Move the inline row ids to a new overflow chain */
+    void Spill();
+
+    /** Move a short overflow chain back into the record */
+    void Unspill();
+
+    PostingPage *FetchPostingPage(page_id_t page_id);
+
+    PostingPage *NewPostingPage(page_id_t &page_id);
+
+    BufferPoolManager *buffer_pool_manager_;
+    std::string data_;
+    bool overflow_{false};
+    std::vector<RowId> rids_; // inline lists only
+    page_id_t head_{INVALID_PAGE_ID};
+    page_id_t tail_{INVALID_PAGE_ID};
+    int count_{0};
+};
+
+#endif // MINISQL_POSTING_LIST_H
@@ -4,12 +4,15 @@
 #include <string.h>
 
 #include <queue>
+#include <vector>
 
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define INTERNAL_PAGE_HEADER_SIZE 28
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(std::pair<GenericKey *, page_id_t>)) - 1)
+#define INTERNAL_PAGE_HEADER_SIZE 32
+#define INTERNAL_PAGE_CAPACITY (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE)
+#define INTERNAL_SLOT_SIZE (2 * sizeof(uint16_t))
+#define INTERNAL_PAGE_SIZE (INTERNAL_PAGE_CAPACITY / (INTERNAL_SLOT_SIZE + sizeof(page_id_t)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -18,10 +21,23 @@
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Keys are separators produced by leaf splits and are stored without their
+ * zero padding, so short separators take less room and raise the fanout.
+ *
+ * Internal page format (slots are stored in increasing key order):
+ *  ------------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | ... | SLOT(n) | FREE | RECORD(n) | ... | RECORD(1) |
+ *  ------------------------------------------------------------------------------
+ *  SLOT   = | RecordOffset (2) | KeyLength (2) |
+ *  RECORD = | PAGE_ID (4) | KEY |
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ---------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | RecordStart (2) | RecordBytes (2) |
+ *  ---------------------------------------------------------------------
  */
 class BPlusTreeInternalPage : public BPlusTreePage
 {
@@ -30,9 +46,11 @@ public:
     void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
               int max_size = UNDEFINED_SIZE);
 
-    GenericKey *KeyAt(int index);
+    /** Rebuild the full key at "index" into key */
+    void KeyAt(int index, GenericKey *key) const;
 
-    void SetKeyAt(int index, GenericKey *key);
+    /** @return false if the page has no room for the longer key, the page is left untouched */
+    bool SetKeyAt(int index, const GenericKey *key);
 
     int ValueIndex(const page_id_t &value) const;
 
@@ -40,38 +58,58 @@ public:
 
     void SetValueAt(int index, page_id_t value);
 
-    void *PairPtrAt(int index);
+    page_id_t Lookup(const GenericKey *key) const;
 
-    void PairCopy(void *dest, void *src, int pair_num = 1);
+    /** Bytes taken by the slots and the live records */
+    int GetUsedBytes() const;
 
-    page_id_t Lookup(const GenericKey *key, const KeyManager &KP);
+    /** Less than a quarter of the page is in use */
+    bool IsUnderflow() const;
 
-    void PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+    void PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value);
 
-    int InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+    /** @return false if the page has no room for the pair, the page is left untouched */
+    bool InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value);
 
     void Remove(int index);
 
     page_id_t RemoveAndReturnOnlyChild();
 
     // Split and Merge utility methods
-    void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
+    bool MoveAllTo(BPlusTreeInternalPage *recipient, const GenericKey *middle_key,
+                   BufferPoolManager *buffer_pool_manager);
 
     void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
 
-    void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
+    bool MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const GenericKey *middle_key,
                           BufferPoolManager *buffer_pool_manager);
 
-    void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
+    bool MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const GenericKey *middle_key,
                            BufferPoolManager *buffer_pool_manager);
 
 private:
-    void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
+    /** Copy the full keys and values of [begin, end) out of the page */
+    void Export(std::vector<char> &keys, std::vector<page_id_t> &values, int begin = 0, int end = -1) const;
+
+    /** Replace the content of the page, @return false if the pairs do not fit */
+    bool Load(const char *keys, const page_id_t *values, int size);
+
+    bool InsertRecord(int index, const char *key, page_id_t value);
+
+    /** Adopt the children in [begin, end) by rewriting their parent page id */
+    void Adopt(int begin, int end, BufferPoolManager *buffer_pool_manager);
+
+    /** Squeeze out the holes left by removed records */
+    void Compact();
+
+    void WriteSlot(int index, uint16_t offset, uint16_t length);
 
-    void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
+    uint16_t SlotOffset(int index) const;
 
-    void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
+    uint16_t SlotLength(int index) const;
 
+    uint16_t record_start_;
+    uint16_t record_bytes_;
     char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
 };
 
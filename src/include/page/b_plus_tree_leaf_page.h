@@ -6,29 +6,55 @@
  *
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
-
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ * page. In a unique tree every record holds one record id, in a non-unique
+ * tree it holds the posting list of all the record ids sharing the key (see
+ * index/posting_list.h). A covering unique tree also keeps the included
+ * columns of the row next to its record id.
+ *
+ * Keys are variable length: the bytes shared by every key of the page are kept
+ * once as the page prefix, and each record only keeps the rest of its key with
+ * the zero padding stripped. The slot directory grows from the front of the
+ * data area and the records grow from its end.
  *
- *  Header format (size in byte, 24 bytes in total):
+ * Leaf page format (slots are stored in key order):
+ *  ---------------------------------------------------------------------------
+ * | HEADER | PREFIX | SLOT(1) | ... | SLOT(n) | FREE | RECORD(n) | ... | RECORD(1) |
+ *  ---------------------------------------------------------------------------
+ *  SLOT   = | RecordOffset (2) | SuffixLength (2) |
+ *  RECORD = | RID (8) | KEY SUFFIX |                                 (unique)
+ *  RECORD = | PostingLength (2) | POSTING LIST | KEY SUFFIX |       (non-unique)
+ *  RECORD = | RID (8) | PayloadLength (2) | PAYLOAD | KEY SUFFIX |  (covering)
+ *
+ *  Header format (size in byte, 40 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrefixLength (2) |
+ *  ---------------------------------------------------------------------
+ *  ------------------------------------------------------------------
+ * | RecordStart (2) | RecordBytes (2) | Compress (1) | Format (1) |
+ *  ----------------------------------------------------------------
  */
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
-#define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType)) - 1)
+#define LEAF_PAGE_HEADER_SIZE 40
+#define LEAF_PAGE_CAPACITY (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE)
+#define LEAF_SLOT_SIZE (2 * sizeof(uint16_t))
+#define LEAF_PAGE_SIZE (LEAF_PAGE_CAPACITY / (LEAF_SLOT_SIZE + sizeof(RowId)))
+
+/** What the records of a leaf keep in front of their key suffix */
+enum LeafFormat : uint8_t
+{
+    LEAF_ROW_ID = 0,   // one record id
+    LEAF_POSTING = 1,  // a posting list
+    LEAF_COVERING = 2, // one record id and the included columns
+};
 
 class BPlusTreeLeafPage : public BPlusTreePage
 {
@@ -36,54 +62,110 @@ public:
     // After creating a new leaf page from buffer pool, must call initialize
     // method to set default values
     void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
-              int max_size = UNDEFINED_SIZE);
+              int max_size = UNDEFINED_SIZE, bool compress = true, LeafFormat format = LEAF_ROW_ID);
 
     // helper methods
     page_id_t GetNextPageId() const;
 
     void SetNextPageId(page_id_t next_page_id);
 
-    GenericKey *KeyAt(int index);
-
-    void SetKeyAt(int index, GenericKey *key);
+    /** Rebuild the full key at "index" into key */
+    void KeyAt(int index, GenericKey *key) const;
 
     RowId ValueAt(int index) const;
 
     void SetValueAt(int index, RowId value);
 
-    int KeyIndex(const GenericKey *key, const KeyManager &comparator);
+    /** Whether the records hold posting lists instead of single record ids */
+    bool IsPostingPage() const { return format_ == LEAF_POSTING; }
+
+    /** Whether the records carry included columns after their record id */
+    bool IsCoveringPage() const { return format_ == LEAF_COVERING; }
+
+    /** The encoded posting list of the record at "index" */
+    const char *PostingAt(int index, int &length) const;
+
+    /** The included columns of the record at "index" */
+    const char *PayloadAt(int index, int &length) const;
+
+    /** Compare the key stored at "index" with key, in the same sense as memcmp */
+    int CompareAt(int index, const GenericKey *key) const;
+
+    int KeyIndex(const GenericKey *key) const;
 
-    void *PairPtrAt(int index);
+    int GetPrefixLength() const { return prefix_len_; }
 
-    void PairCopy(void *dest, void *src, int pair_num = 1);
+    /** Bytes taken by the prefix, the slots and the live records */
+    int GetUsedBytes() const;
 
-    std::pair<GenericKey *, RowId> GetItem(int index);
+    /** Less than a quarter of the page is in use */
+    bool IsUnderflow() const;
 
     // insert and delete methods
-    int Insert(GenericKey *key, const RowId &value, const KeyManager &comparator);
+    /** @return false if the page has no room for the pair, the page is left untouched */
+    bool Insert(const GenericKey *key, const RowId &value, const char *payload = nullptr, int length = 0);
 
-    bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator);
+    bool InsertPosting(const GenericKey *key, const char *posting, int length);
 
-    int RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &comparator);
+    /** Replace the posting list at "index", @return false if the page has no room, nothing changes then */
+    bool SetPostingAt(int index, const char *posting, int length);
+
+    /** Replace the included columns at "index" of a covering page, @return false if the page has no room */
+    bool SetPayloadAt(int index, const char *payload, int length);
+
+    bool Lookup(const GenericKey *key, RowId &value) const;
+
+    int RemoveAndDeleteRecord(const GenericKey *key);
+
+    void Remove(int index);
 
     // Split and Merge utility methods
     void MoveHalfTo(BPlusTreeLeafPage *recipient);
 
-    void MoveAllTo(BPlusTreeLeafPage *recipient);
+    bool MoveAllTo(BPlusTreeLeafPage *recipient);
 
-    void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+    bool MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
 
-    void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+    bool MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
 private:
-    void CopyNFrom(void *src, int size);
+    /** Copy the full keys and the raw values of [begin, end) out of the page */
+    void Export(std::vector<char> &keys, std::vector<std::string> &values, int begin = 0, int end = -1) const;
 
-    void CopyLastFrom(GenericKey *key, const RowId value);
+    /** Replace the content of the page, @return false if the pairs do not fit */
+    bool Load(const char *keys, const std::string *values, int size);
 
-    void CopyFirstFrom(GenericKey *key, const RowId value);
+    /** Replace the length prefixed tail of the value at "index", which starts base bytes into it */
+    bool SetTailAt(int index, int base, const char *data, int length);
 
-    page_id_t next_page_id_{INVALID_PAGE_ID};
+    /** Insert a raw value, laid out as in the record */
+    bool InsertRecord(const GenericKey *key, const char *value, int value_size);
+
+    /** Size of the value stored at the front of the record at "offset" */
+    int ValueSize(uint16_t offset) const;
+
+    int RecordSize(int index) const;
 
+    const char *SuffixAt(int index) const;
+
+    /** Compare the suffix stored at "index" with the same bytes of key, key_len is the stripped length of key */
+    int CompareSuffix(int index, const char *key, int key_len) const;
+
+    /** Squeeze out the holes left by removed records */
+    void Compact();
+
+    void WriteSlot(int index, uint16_t offset, uint16_t length);
+
+    uint16_t SlotOffset(int index) const;
+
+    uint16_t SlotLength(int index) const;
+
+    page_id_t next_page_id_{INVALID_PAGE_ID};
+    uint16_t prefix_len_;
+    uint16_t record_start_;
+    uint16_t record_bytes_;
+    uint8_t compress_;
+    uint8_t format_;
     char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
 };
 
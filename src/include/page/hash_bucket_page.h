@@ -0,0 +1,54 @@
+#ifndef MINISQL_HASH_BUCKET_PAGE_H
+#define MINISQL_HASH_BUCKET_PAGE_H
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * Bucket of an extendible hash index, holding fixed size key & row id pairs in
+ * no particular order. Once its keys can't be told apart by more hash bits, be
+ * it copies of one key or a directory at its maximum depth, a bucket chains
+ * overflow buckets through NextPageId.
+ *
+ * Format (size in byte):
+ *  -------------------------------------------------------------------------
+ * | KeySize (4) | Size (4) | NextPageId (4) | KEY(1) + RID(1) | ... |
+ *  -------------------------------------------------------------------------
+ */
+class HashBucketPage
+{
+public:
+    void Init(int key_size);
+
+    int GetSize() const { return size_; }
+
+    int GetCapacity() const { return HASH_BUCKET_CAPACITY / (key_size_ + sizeof(RowId)); }
+
+    bool IsFull() const { return size_ >= GetCapacity(); }
+
+    page_id_t GetNextPageId() const { return next_page_id_; }
+
+    void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+    const GenericKey *KeyAt(int index) const;
+
+    RowId ValueAt(int index) const;
+
+    /** @return false if the bucket is full */
+    bool Insert(const GenericKey *key, const RowId &value);
+
+    /** The last pair takes the place of the removed one */
+    void RemoveAt(int index);
+
+private:
+    static constexpr int HASH_BUCKET_HEADER_SIZE = 12;
+    static constexpr int HASH_BUCKET_CAPACITY = PAGE_SIZE - HASH_BUCKET_HEADER_SIZE;
+
+    int key_size_;
+    int size_;
+    page_id_t next_page_id_;
+    char data_[HASH_BUCKET_CAPACITY];
+};
+
+#endif // MINISQL_HASH_BUCKET_PAGE_H
@@ -0,0 +1,61 @@
+#ifndef MINISQL_HASH_DIRECTORY_PAGE_H
+#define MINISQL_HASH_DIRECTORY_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+#define HASH_DIRECTORY_MAX_DEPTH 9
+
+/**
+ * Directory of an extendible hash index. Entry i serves the keys whose hash
+ * ends with the low global depth bits of i. Entries sharing the low local depth
+ * bits point to the same bucket.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------------------------
+ * | GlobalDepth (4) | LocalDepth (1) x 512 | BucketPageId (4) x 512 |
+ *  ------------------------------------------------------------------
+ */
+class HashDirectoryPage
+{
+public:
+    /** A new directory has a single entry pointing to bucket_page_id */
+    void Init(page_id_t bucket_page_id);
+
+    uint32_t HashToBucketIndex(uint32_t hash) const { return hash & GetGlobalDepthMask(); }
+
+    page_id_t GetBucketPageId(uint32_t index) const { return bucket_page_ids_[index]; }
+
+    void SetBucketPageId(uint32_t index, page_id_t page_id) { bucket_page_ids_[index] = page_id; }
+
+    uint32_t GetLocalDepth(uint32_t index) const { return local_depths_[index]; }
+
+    void SetLocalDepth(uint32_t index, uint32_t depth) { local_depths_[index] = depth; }
+
+    uint32_t GetGlobalDepth() const { return global_depth_; }
+
+    uint32_t GetGlobalDepthMask() const { return (1 << global_depth_) - 1; }
+
+    uint32_t GetSize() const { return 1 << global_depth_; }
+
+    bool CanGrow() const { return global_depth_ < HASH_DIRECTORY_MAX_DEPTH; }
+
+    /** Double the directory, the new half mirrors the old one */
+    void IncrGlobalDepth();
+
+    /** Whether no bucket uses the highest bit of the global depth */
+    bool CanShrink() const;
+
+    void DecrGlobalDepth() { global_depth_--; }
+
+    /** The entry a bucket was split from, or split into */
+    uint32_t GetSplitImageIndex(uint32_t index) const { return index ^ (1 << (local_depths_[index] - 1)); }
+
+private:
+    uint32_t global_depth_;
+    uint8_t local_depths_[1 << HASH_DIRECTORY_MAX_DEPTH];
+    page_id_t bucket_page_ids_[1 << HASH_DIRECTORY_MAX_DEPTH];
+};
+
+#endif // MINISQL_HASH_DIRECTORY_PAGE_H
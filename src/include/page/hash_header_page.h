@@ -0,0 +1,38 @@
+#ifndef MINISQL_HASH_HEADER_PAGE_H
+#define MINISQL_HASH_HEADER_PAGE_H
+
+#include "common/config.h"
+
+#define HASH_HEADER_MAX_DEPTH 9
+
+/**
+ * Top level of an extendible hash index. The high bits of a hash pick one of
+ * the directories, which are only created once a key maps to them.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------------------
+ * | DirectoryPageId(0) (4) | ... | DirectoryPageId(511) (4) |
+ *  ------------------------------------------------------------
+ */
+class HashHeaderPage
+{
+public:
+    void Init()
+    {
+        for (auto &page_id : directory_page_ids_)
+            page_id = INVALID_PAGE_ID;
+    }
+
+    static constexpr uint32_t GetMaxSize() { return 1 << HASH_HEADER_MAX_DEPTH; }
+
+    static uint32_t HashToDirectoryIndex(uint32_t hash) { return hash >> (32 - HASH_HEADER_MAX_DEPTH); }
+
+    page_id_t GetDirectoryPageId(uint32_t index) const { return directory_page_ids_[index]; }
+
+    void SetDirectoryPageId(uint32_t index, page_id_t page_id) { directory_page_ids_[index] = page_id; }
+
+private:
+    page_id_t directory_page_ids_[1 << HASH_HEADER_MAX_DEPTH];
+};
+
+#endif // MINISQL_HASH_HEADER_PAGE_H
@@ -0,0 +1,72 @@
+#ifndef MINISQL_LSM_PAGE_H
+#define MINISQL_LSM_PAGE_H
+
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+
+/** A key of an LSM tree with its row id, or the tombstone hiding older versions of the key */
+struct LsmEntry
+{
+    std::string key;
+    RowId value;
+    bool deleted{false};
+};
+
+/**
+ * Data page of an immutable sorted run of an LSM tree. Runs are written front to
+ * back in key order and never modified, so entries are packed without slots.
+ *
+ * Format (size in byte):
+ *  --------------------------------------------------------------------------------
+ * | Count (4) | Bytes (4) | KeyLength (2) | Key | Rid (8) | Deleted (1) | ...      |
+ *  --------------------------------------------------------------------------------
+ */
+class SortedRunPage
+{
+public:
+    void Init();
+
+    int GetCount() const { return count_; }
+
+    /** @return false if the entry does not fit */
+    bool Append(const LsmEntry &entry);
+
+    /** Append the entries of this page to entries */
+    void Decode(std::vector<LsmEntry> &entries) const;
+
+    /** @return the space an entry takes, an empty page holds any key an index can produce */
+    static int EntrySize(const LsmEntry &entry) { return 2 + entry.key.size() + 8 + 1; }
+
+private:
+    static constexpr int SORTED_RUN_PAGE_HEADER_SIZE = 8;
+    static constexpr int SORTED_RUN_PAGE_CAPACITY = PAGE_SIZE - SORTED_RUN_PAGE_HEADER_SIZE;
+
+    int count_;
+    int bytes_;
+    char data_[SORTED_RUN_PAGE_CAPACITY];
+};
+
+/**
+ * Page of a chain holding a byte string that may span several pages, used for the
+ * metadata of the runs and the list of runs of an LSM tree.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------
+ * | NextPageId (4) | Bytes (4) | Data ...       |
+ *  ----------------------------------------------
+ */
+class LsmMetaPage
+{
+public:
+    static constexpr int LSM_META_PAGE_HEADER_SIZE = 8;
+    static constexpr int LSM_META_PAGE_CAPACITY = PAGE_SIZE - LSM_META_PAGE_HEADER_SIZE;
+
+    page_id_t next_page_id_;
+    int bytes_;
+    char data_[LSM_META_PAGE_CAPACITY];
+};
+
+#endif // MINISQL_LSM_PAGE_H
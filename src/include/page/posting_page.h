@@ -0,0 +1,65 @@
+#ifndef MINISQL_POSTING_PAGE_H
+#define MINISQL_POSTING_PAGE_H
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+
+/**
+ * Overflow page of a posting list that outgrew its leaf record. The pages of one
+ * list are chained in row id order, and each one holds a run of row ids encoded
+ * as varint deltas, the first one relative to zero. The last row id is kept in
+ * the header so appends and chain walks don't have to decode the page.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------
+ * | LastRid (8) | NextPageId (4) | Count (4) | Bytes (4) | Deltas (varint) ... |
+ *  ---------------------------------------------------------------------------
+ */
+class PostingPage
+{
+public:
+    void Init();
+
+    page_id_t GetNextPageId() const { return next_page_id_; }
+
+    void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+    int GetCount() const { return count_; }
+
+    RowId GetLastRid() const { return RowId(last_rid_); }
+
+    /** Append the row ids of this page to rids */
+    void Decode(std::vector<RowId> &rids) const;
+
+    /** Replace the content of the page, @return false if the row ids do not fit */
+    bool Encode(const RowId *rids, int count);
+
+    /** Append a row id greater than the last one, @return false if the page is full */
+    bool Append(const RowId &rid);
+
+    /** Row ids are ordered as unsigned 64 bit numbers */
+    static uint64_t Order(const RowId &rid) { return static_cast<uint64_t>(rid.Get()); }
+
+    /** @return bytes written, at most 10 */
+    static int PutVarint(char *buf, uint64_t value);
+
+    /** @return bytes read */
+    static int GetVarint(const char *buf, uint64_t &value);
+
+    /** Like GetVarint(), reading no further than end. @return bytes read, 0 if the value runs past end */
+    static int GetVarint(const char *buf, const char *end, uint64_t &value);
+
+private:
+    static constexpr int POSTING_PAGE_HEADER_SIZE = 20;
+    static constexpr int POSTING_PAGE_CAPACITY = PAGE_SIZE - POSTING_PAGE_HEADER_SIZE;
+
+    int64_t last_rid_;
+    page_id_t next_page_id_;
+    int count_;
+    int bytes_;
+    char data_[POSTING_PAGE_CAPACITY];
+};
+
+#endif // MINISQL_POSTING_PAGE_H
@@ -123,6 +123,9 @@ private:
 public:
     static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
 
+    /** Bound on the tuples of a page, were they all empty */
+    static constexpr size_t MAX_TUPLE_COUNT = (PAGE_SIZE - SIZE_TABLE_PAGE_HEADER) / SIZE_TUPLE;
+
     enum ret
     {
         OK,
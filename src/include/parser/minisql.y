@@ -1,5 +1,7 @@
 %{
   #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -12,10 +14,10 @@
 }
 
 %token <syntax_node> CREATE DROP SELECT INSERT DELETE UPDATE
-%token <syntax_node> TRXBEGIN TRXCOMMIT TRXROLLBACK QUIT EXECFILE SHOW USE USING
+%token <syntax_node> TRXBEGIN TRXCOMMIT TRXROLLBACK QUIT EXECFILE SHOW USE USING INCLUDE
 %token <syntax_node> DATABASE DATABASES TABLE TABLES INDEX INDEXES
-%token <syntax_node> ON FROM WHERE INTO SET VALUES PRIMARY KEY UNIQUE
-%token <syntax_node> CHAR INT FLOAT AND OR NOT IS FLAGNULL
+%token <syntax_node> ON FROM JOIN WHERE GROUP BY ORDER ASC DESC LIMIT INTO SET VALUES PRIMARY KEY UNIQUE CONFLICT DO NOTHING
+%token <syntax_node> CHAR INT FLOAT AND OR NOT IS IN FLAGNULL
 %token <syntax_node> IDENTIFIER STRING NUMBER EQ NE LE GE
 
 %type <syntax_node> start sql
@@ -24,7 +26,8 @@
 %type <syntax_node> column_definition_list column_definition column_type column_list
 %type <syntax_node> sql_create_index sql_drop_index sql_show_indexes
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
-%type <syntax_node> sql_select select_columns column_values column_value operator
+%type <syntax_node> sql_select select_columns select_column_list select_column column_ref column_ref_list from_tables
+%type <syntax_node> where_clause group_by_clause order_by_clause order_list order_item limit_clause column_values column_value insert_rows operator
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
 %type <syntax_node> sql_quit sql_exec_file
@@ -180,6 +183,31 @@ sql_create_index:
       SyntaxNodeAddChildren(index_type_node, $10);
       SyntaxNodeAddChildren($$, index_type_node);
   }
+  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' INCLUDE '(' column_list ')' {
+      $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
+      SyntaxNodeAddChildren($$, $3);
+      SyntaxNodeAddChildren($$, $5);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $7);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      pSyntaxNode include_node = CreateSyntaxNode(kNodeColumnList, "include columns");
+      SyntaxNodeAddChildren(include_node, $11);
+      SyntaxNodeAddChildren($$, include_node);
+  }
+  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' USING IDENTIFIER INCLUDE '(' column_list ')' {
+      $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
+      SyntaxNodeAddChildren($$, $3);
+      SyntaxNodeAddChildren($$, $5);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $7);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
+      SyntaxNodeAddChildren(index_type_node, $10);
+      SyntaxNodeAddChildren($$, index_type_node);
+      pSyntaxNode include_node = CreateSyntaxNode(kNodeColumnList, "include columns");
+      SyntaxNodeAddChildren(include_node, $13);
+      SyntaxNodeAddChildren($$, include_node);
+  }
   ;
 
 sql_drop_index:
@@ -196,18 +224,105 @@ sql_show_indexes:
   ;
 
 sql_select:
-  SELECT select_columns FROM IDENTIFIER {
+  SELECT select_columns FROM from_tables where_clause group_by_clause order_by_clause limit_clause {
     $$ = CreateSyntaxNode(kNodeSelect, NULL);
     SyntaxNodeAddChildren($$, $2);
     SyntaxNodeAddChildren($$, $4);
+    if ($5 != NULL) {
+      SyntaxNodeAddChildren($$, $5);
+    }
+    if ($6 != NULL) {
+      SyntaxNodeAddChildren($$, $6);
+    }
+    if ($7 != NULL) {
+      SyntaxNodeAddChildren($$, $7);
+    }
+    if ($8 != NULL) {
+      SyntaxNodeAddChildren($$, $8);
+    }
   }
-  | SELECT select_columns FROM IDENTIFIER WHERE where_conditions {
-    $$ = CreateSyntaxNode(kNodeSelect, NULL);
+  ;
+
+where_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | WHERE where_conditions {
+    $$ = CreateSyntaxNode(kNodeConditions, NULL);
     SyntaxNodeAddChildren($$, $2);
-    SyntaxNodeAddChildren($$, $4);
+  }
+  ;
+
+group_by_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | GROUP BY column_ref_list {
+    $$ = CreateSyntaxNode(kNodeGroupBy, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+order_by_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | ORDER BY order_list {
+    $$ = CreateSyntaxNode(kNodeOrderBy, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+order_list:
+  order_item ',' order_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | order_item {
+    $$ = $1;
+  }
+  ;
+
+order_item:
+  select_column {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "asc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  | select_column ASC {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "asc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  | select_column DESC {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "desc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  ;
+
+limit_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | LIMIT NUMBER {
+    $$ = CreateSyntaxNode(kNodeLimit, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
+from_tables:
+  IDENTIFIER {
+    $$ = $1;
+  }
+  | IDENTIFIER ',' IDENTIFIER {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | IDENTIFIER JOIN IDENTIFIER ON where_conditions {
+    // the join condition is one more set of conditions, and-ed with the where clause
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
     pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
-    SyntaxNodeAddChildren(condition_node, $6);
-    SyntaxNodeAddChildren($$, condition_node);
+    SyntaxNodeAddChildren(condition_node, $5);
+    SyntaxNodeAddSibling($$, condition_node);
   }
   ;
 
@@ -215,12 +330,61 @@ select_columns:
   '*' {
     $$ = CreateSyntaxNode(kNodeAllColumns, NULL);
   }
-  | column_list {
+  | select_column_list {
     $$ = CreateSyntaxNode(kNodeColumnList, "select columns");
     SyntaxNodeAddChildren($$, $1);
   }
   ;
 
+select_column_list:
+  select_column ',' select_column_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | select_column {
+    $$ = $1;
+  }
+  ;
+
+select_column:
+  column_ref {
+    $$ = $1;
+  }
+  | IDENTIFIER '(' '*' ')' {
+    // an aggregate function named by the identifier, over all rows or over a column
+    $$ = CreateSyntaxNode(kNodeAggregate, $1->val_);
+    SyntaxNodeAddChildren($$, CreateSyntaxNode(kNodeAllColumns, NULL));
+  }
+  | IDENTIFIER '(' column_ref ')' {
+    $$ = CreateSyntaxNode(kNodeAggregate, $1->val_);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+column_ref_list:
+  column_ref ',' column_ref_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | column_ref {
+    $$ = $1;
+  }
+  ;
+
+column_ref:
+  IDENTIFIER {
+    $$ = $1;
+  }
+  | IDENTIFIER '.' IDENTIFIER {
+    // a column qualified with its table is a single identifier "table.column"
+    size_t len = strlen($1->val_) + strlen($3->val_) + 2;
+    char *name = (char *) malloc(len);
+    snprintf(name, len, "%s.%s", $1->val_, $3->val_);
+    $$ = CreateSyntaxNode(kNodeIdentifier, name);
+    free(name);
+  }
+  ;
+
 where_conditions:
   where_conditions connector where_condition  {
     $$ = $2;
@@ -242,11 +406,37 @@ connector:
   ;
 
 where_condition:
-  IDENTIFIER operator column_value {
+  column_ref operator column_value {
     $$ = $2;
     SyntaxNodeAddChildren($$, $1);
     SyntaxNodeAddChildren($$, $3);
   }
+  | column_ref operator column_ref {
+    $$ = $2;
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | column_ref IN '(' column_values ')' {
+    // column in (v1, v2, ...) is column = v1 or column = v2 or ...
+    $$ = NULL;
+    pSyntaxNode value = $4;
+    while (value != NULL) {
+      pSyntaxNode next = value->next_;
+      value->next_ = NULL;
+      pSyntaxNode compare = CreateSyntaxNode(kNodeCompareOperator, "=");
+      SyntaxNodeAddChildren(compare, $$ == NULL ? $1 : CreateSyntaxNode(kNodeIdentifier, $1->val_));
+      SyntaxNodeAddChildren(compare, value);
+      if ($$ == NULL) {
+        $$ = compare;
+      } else {
+        pSyntaxNode connector = CreateSyntaxNode(kNodeConnector, "or");
+        SyntaxNodeAddChildren(connector, $$);
+        SyntaxNodeAddChildren(connector, compare);
+        $$ = connector;
+      }
+      value = next;
+    }
+  }
   ;
 
 column_value:
@@ -289,12 +479,39 @@ operator:
   ;
 
 sql_insert:
-  INSERT INTO IDENTIFIER VALUES '(' column_values ')' {
+  INSERT INTO IDENTIFIER VALUES insert_rows {
+    $$ = CreateSyntaxNode(kNodeInsert, NULL);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, $5);
+  }
+  | INSERT INTO IDENTIFIER VALUES insert_rows ON CONFLICT DO NOTHING {
     $$ = CreateSyntaxNode(kNodeInsert, NULL);
     SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, $5);
+    SyntaxNodeAddChildren($$, CreateSyntaxNode(kNodeOnConflict, "nothing"));
+  }
+  | INSERT INTO IDENTIFIER VALUES insert_rows ON CONFLICT DO UPDATE SET update_values {
+    $$ = CreateSyntaxNode(kNodeInsert, NULL);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, $5);
+    pSyntaxNode conflict_node = CreateSyntaxNode(kNodeOnConflict, "update");
+    pSyntaxNode upd_values_node = CreateSyntaxNode(kNodeUpdateValues, NULL);
+    SyntaxNodeAddChildren(upd_values_node, $11);
+    SyntaxNodeAddChildren(conflict_node, upd_values_node);
+    SyntaxNodeAddChildren($$, conflict_node);
+  }
+  ;
+
+insert_rows:
+  '(' column_values ')' {
+    $$ = CreateSyntaxNode(kNodeColumnValues, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  | insert_rows ',' '(' column_values ')' {
+    $$ = $1;
     pSyntaxNode col_val_node = CreateSyntaxNode(kNodeColumnValues, NULL);
-    SyntaxNodeAddChildren(col_val_node, $6);
-    SyntaxNodeAddChildren($$, col_val_node);
+    SyntaxNodeAddChildren(col_val_node, $4);
+    SyntaxNodeAddSibling($$, col_val_node);
   }
   ;
 
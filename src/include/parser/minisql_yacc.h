@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,59 +31,93 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Tokens.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_MINISQL_YACC_H_INCLUDED
+# define YY_YY_MINISQL_YACC_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
-#define YYTOKENTYPE
-/* Put the tokens into the symbol table, so that GDB and other debuggers
-   know about them.  */
-enum yytokentype {
-  CREATE = 258,
-  DROP = 259,
-  SELECT = 260,
-  INSERT = 261,
-  DELETE = 262,
-  UPDATE = 263,
-  TRXBEGIN = 264,
-  TRXCOMMIT = 265,
-  TRXROLLBACK = 266,
-  QUIT = 267,
-  EXECFILE = 268,
-  SHOW = 269,
-  USE = 270,
-  USING = 271,
-  DATABASE = 272,
-  DATABASES = 273,
-  TABLE = 274,
-  TABLES = 275,
-  INDEX = 276,
-  INDEXES = 277,
-  ON = 278,
-  FROM = 279,
-  WHERE = 280,
-  INTO = 281,
-  SET = 282,
-  VALUES = 283,
-  PRIMARY = 284,
-  KEY = 285,
-  UNIQUE = 286,
-  CHAR = 287,
-  INT = 288,
-  FLOAT = 289,
-  AND = 290,
-  OR = 291,
-  NOT = 292,
-  IS = 293,
-  FLAGNULL = 294,
-  IDENTIFIER = 295,
-  STRING = 296,
-  NUMBER = 297,
-  EQ = 298,
-  NE = 299,
-  LE = 300,
-  GE = 301
-};
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    CREATE = 258,                  /* CREATE  */
+    DROP = 259,                    /* DROP  */
+    SELECT = 260,                  /* SELECT  */
+    INSERT = 261,                  /* INSERT  */
+    DELETE = 262,                  /* DELETE  */
+    UPDATE = 263,                  /* UPDATE  */
+    TRXBEGIN = 264,                /* TRXBEGIN  */
+    TRXCOMMIT = 265,               /* TRXCOMMIT  */
+    TRXROLLBACK = 266,             /* TRXROLLBACK  */
+    QUIT = 267,                    /* QUIT  */
+    EXECFILE = 268,                /* EXECFILE  */
+    SHOW = 269,                    /* SHOW  */
+    USE = 270,                     /* USE  */
+    USING = 271,                   /* USING  */
+    INCLUDE = 272,                 /* INCLUDE  */
+    DATABASE = 273,                /* DATABASE  */
+    DATABASES = 274,               /* DATABASES  */
+    TABLE = 275,                   /* TABLE  */
+    TABLES = 276,                  /* TABLES  */
+    INDEX = 277,                   /* INDEX  */
+    INDEXES = 278,                 /* INDEXES  */
+    ON = 279,                      /* ON  */
+    FROM = 280,                    /* FROM  */
+    JOIN = 281,                    /* JOIN  */
+    WHERE = 282,                   /* WHERE  */
+    GROUP = 283,                   /* GROUP  */
+    BY = 284,                      /* BY  */
+    ORDER = 285,                   /* ORDER  */
+    ASC = 286,                     /* ASC  */
+    DESC = 287,                    /* DESC  */
+    LIMIT = 288,                   /* LIMIT  */
+    INTO = 289,                    /* INTO  */
+    SET = 290,                     /* SET  */
+    VALUES = 291,                  /* VALUES  */
+    PRIMARY = 292,                 /* PRIMARY  */
+    KEY = 293,                     /* KEY  */
+    UNIQUE = 294,                  /* UNIQUE  */
+    CONFLICT = 295,                /* CONFLICT  */
+    DO = 296,                      /* DO  */
+    NOTHING = 297,                 /* NOTHING  */
+    CHAR = 298,                    /* CHAR  */
+    INT = 299,                     /* INT  */
+    FLOAT = 300,                   /* FLOAT  */
+    AND = 301,                     /* AND  */
+    OR = 302,                      /* OR  */
+    NOT = 303,                     /* NOT  */
+    IS = 304,                      /* IS  */
+    IN = 305,                      /* IN  */
+    FLAGNULL = 306,                /* FLAGNULL  */
+    IDENTIFIER = 307,              /* IDENTIFIER  */
+    STRING = 308,                  /* STRING  */
+    NUMBER = 309,                  /* NUMBER  */
+    EQ = 310,                      /* EQ  */
+    NE = 311,                      /* NE  */
+    LE = 312,                      /* LE  */
+    GE = 313                       /* GE  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define CREATE 258
 #define DROP 259
 #define SELECT 260
@@ -100,49 +132,70 @@ enum yytokentype {
 #define SHOW 269
 #define USE 270
 #define USING 271
-#define DATABASE 272
-#define DATABASES 273
-#define TABLE 274
-#define TABLES 275
-#define INDEX 276
-#define INDEXES 277
-#define ON 278
-#define FROM 279
-#define WHERE 280
-#define INTO 281
-#define SET 282
-#define VALUES 283
-#define PRIMARY 284
-#define KEY 285
-#define UNIQUE 286
-#define CHAR 287
-#define INT 288
-#define FLOAT 289
-#define AND 290
-#define OR 291
-#define NOT 292
-#define IS 293
-#define FLAGNULL 294
-#define IDENTIFIER 295
-#define STRING 296
-#define NUMBER 297
-#define EQ 298
-#define NE 299
-#define LE 300
-#define GE 301
-
-#if !defined YYSTYPE && !defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 10 "minisql.y"
+#define INCLUDE 272
+#define DATABASE 273
+#define DATABASES 274
+#define TABLE 275
+#define TABLES 276
+#define INDEX 277
+#define INDEXES 278
+#define ON 279
+#define FROM 280
+#define JOIN 281
+#define WHERE 282
+#define GROUP 283
+#define BY 284
+#define ORDER 285
+#define ASC 286
+#define DESC 287
+#define LIMIT 288
+#define INTO 289
+#define SET 290
+#define VALUES 291
+#define PRIMARY 292
+#define KEY 293
+#define UNIQUE 294
+#define CONFLICT 295
+#define DO 296
+#define NOTHING 297
+#define CHAR 298
+#define INT 299
+#define FLOAT 300
+#define AND 301
+#define OR 302
+#define NOT 303
+#define IS 304
+#define IN 305
+#define FLAGNULL 306
+#define IDENTIFIER 307
+#define STRING 308
+#define NUMBER 309
+#define EQ 310
+#define NE 311
+#define LE 312
+#define GE 313
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
 {
-  pSyntaxNode syntax_node;
-}
-/* Line 1529 of yacc.c.  */
-#line 145 "./minisql_yacc.h"
-YYSTYPE;
-#define yystype YYSTYPE /* obsolescent; will be withdrawn */
-#define YYSTYPE_IS_DECLARED 1
-#define YYSTYPE_IS_TRIVIAL 1
+#line 12 "minisql.y"
+
+	pSyntaxNode syntax_node;
+
+#line 187 "./minisql_yacc.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_MINISQL_YACC_H_INCLUDED  */
@@ -43,7 +43,13 @@ typedef enum {
   kNodeIndexType,            /** type of index */
   kNodeTrxBegin,             /** begin transaction command */
   kNodeTrxCommit,            /** commit transaction command */
-  kNodeTrxRollback           /** rollback transaction command */
+  kNodeTrxRollback,          /** rollback transaction command */
+  kNodeOnConflict,           /** action of an insert on a taken unique key: "nothing", or "update" with its update values */
+  kNodeAggregate,            /** aggregate function named by its value, over '*' or the column of its child */
+  kNodeGroupBy,              /** group by clause, contains the grouping columns */
+  kNodeOrderBy,              /** order by clause, contains the order items */
+  kNodeOrderItem,            /** one key of order by, "asc" or "desc", its child is the column or aggregate */
+  kNodeLimit                 /** limit clause, its child is the number of rows */
 } SyntaxNodeType;
 
 /**
@@ -0,0 +1,95 @@
+#ifndef MINISQL_COMPILED_PREDICATE_H
+#define MINISQL_COMPILED_PREDICATE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "executor/filter_kernels.h"
+#include "planner/expressions/abstract_expression.h"
+
+/**
+ * A filter predicate compiled at plan time into a flat program, so that rows are
+ * checked without walking the expression tree, building Fields or dispatching on
+ * operator strings.
+ *
+ * The program is in postfix order. Each comparison is resolved to a function
+ * instantiated for its operator, the type of its operands and whether the right side
+ * is a constant, which reads the values straight out of the fields of the row.
+ * Subtrees without columns are folded into constants, and AND / OR with a constant
+ * side are simplified. As with the interpreter the result is three-valued, a row
+ * passes only if it is true.
+ *
+ * The same program also runs over a whole RowBatch, with a selection mask per value on
+ * the stack. There null is kept as a cleared bit: AND and OR are monotone, so a row
+ * ends up true exactly when it would with null as a third value.
+ */
+class CompiledPredicate {
+ public:
+  /**
+   * @return the compiled form of expr, or null if expr holds something the compiler does
+   * not handle (a column used as a boolean, operands of different types); it must then be
+   * interpreted
+   */
+  static std::unique_ptr<CompiledPredicate> Compile(const AbstractExpressionRef &expr);
+
+  /** @return the value of the predicate for row, whose fields are the columns of the table */
+  CmpBool Run(const Row &row) const;
+
+  /** @return whether row passes the filter */
+  bool Evaluate(const Row &row) const { return Run(row) == CmpBool::kTrue; }
+
+  /**
+   * Evaluate the predicate for every row of batch with the filter kernels, setting the bits of
+   * mask of the rows that pass. Column i of batch must be column i of the table.
+   */
+  void Filter(const RowBatch &batch, uint64_t *mask) const;
+
+  size_t GetInstructionCount() const { return program_.size(); }
+
+ private:
+  enum class OpCode : uint8_t { kConstant, kCompare, kIsNull, kIsNotNull, kAnd, kOr };
+
+  struct Instruction;
+  using CompareFn = CmpBool (*)(const Instruction &instruction, const Row &row);
+
+  struct Instruction {
+    explicit Instruction(OpCode op) : op(op) {}
+
+    OpCode op;
+    /** Value of a kConstant */
+    CmpBool constant{CmpBool::kNull};
+    /** Comparison of a kCompare, per row and as the operator and operand type of a kernel */
+    CompareFn compare{nullptr};
+    CompareOp compare_op{CompareOp::kEqual};
+    TypeId type{TypeId::kTypeInvalid};
+    uint32_t left_column{0};
+    /** Right side of a comparison, a column or one of the constant values by type */
+    uint32_t right_column{0};
+    bool right_constant{false};
+    int32_t int_value{0};
+    float float_value{0};
+    std::string chars_value;
+  };
+
+  /** Most values the program keeps on its stack */
+  static constexpr size_t MAX_DEPTH = 64;
+
+  /** Append the postfix program of expr to program, @return false if it can not be compiled */
+  static bool Emit(const AbstractExpressionRef &expr, std::vector<Instruction> &program);
+
+  static bool EmitComparison(const AbstractExpressionRef &expr, std::vector<Instruction> &program);
+
+  /** Run the kernel of a kCompare over batch */
+  static void FilterColumn(const Instruction &instruction, const RowBatch &batch, uint64_t *mask);
+
+  template <typename Cmp, TypeId Type, bool RightConstant>
+  static CmpBool Compare(const Instruction &instruction, const Row &row);
+
+  template <typename Cmp>
+  static CompareFn Resolve(TypeId type, bool right_constant);
+
+  std::vector<Instruction> program_;
+};
+
+#endif  // MINISQL_COMPILED_PREDICATE_H
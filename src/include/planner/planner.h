@@ -7,10 +7,16 @@
 
 #include "common/instance.h"
 #include "executor/plans/abstract_plan.h"
+#include "executor/plans/aggregation_plan.h"
 #include "executor/plans/delete_plan.h"
+#include "executor/plans/gather_plan.h"
+#include "executor/plans/hash_join_plan.h"
 #include "executor/plans/index_scan_plan.h"
 #include "executor/plans/insert_plan.h"
+#include "executor/plans/limit_plan.h"
+#include "executor/plans/nested_index_join_plan.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "executor/plans/sort_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "planner/statement/abstract_statement.h"
@@ -34,6 +40,30 @@ class Planner {
 
   AbstractPlanNodeRef PlanSelect(std::shared_ptr<SelectStatement> statement);
 
+  /**
+   * Plan a SELECT with GROUP BY or aggregate functions, as a hash aggregation over a scan or a join,
+   * producing columns
+   */
+  AbstractPlanNodeRef PlanAggregation(std::shared_ptr<SelectStatement> statement,
+                                      const std::vector<std::pair<std::string, AbstractExpressionRef>> &columns);
+
+  /** Plan a scan of a single table producing its rows in the order of ORDER BY, null if no index has it */
+  AbstractPlanNodeRef PlanOrderedScan(std::shared_ptr<SelectStatement> statement);
+
+  /** Plan the sort of the rows of child by ORDER BY, keeping those of LIMIT */
+  AbstractPlanNodeRef PlanSort(std::shared_ptr<SelectStatement> statement, const AbstractPlanNodeRef &child);
+
+  /**
+   * Plan a SELECT over two tables, as a hash join of a scan of each or as index lookups for the rows of one,
+   * producing column_list
+   */
+  AbstractPlanNodeRef PlanJoin(std::shared_ptr<SelectStatement> statement,
+                               const std::vector<std::pair<std::string, AbstractExpressionRef>> &column_list);
+
+  /** Plan the cheapest scan of table_name for the rows passing where, an index scan or a sequential one */
+  AbstractPlanNodeRef PlanScan(const std::string &table_name, const Schema *out_schema,
+                               const AbstractExpressionRef &where, const std::vector<uint32_t> &column_in_condition);
+
   AbstractPlanNodeRef PlanInsert(std::shared_ptr<InsertStatement> statement);
 
   AbstractPlanNodeRef PlanDelete(std::shared_ptr<DeleteStatement> statement);
@@ -50,6 +80,21 @@ class Planner {
    */
   ExecuteContext *context_;
 
+  /** The most worker threads of a parallel sequential scan */
+  static constexpr const uint32_t MAX_SCAN_WORKERS = 16;
+
+  /** Bytes of rows a hash join holds in memory before it partitions its inputs to disk */
+  static constexpr const size_t JOIN_MEMORY_BUDGET = 16 << 20;
+
+  /** Bytes of groups a hash aggregation holds in memory before it partitions them to disk */
+  static constexpr const size_t AGGREGATE_MEMORY_BUDGET = 16 << 20;
+
+  /** Bytes of rows a sort holds in memory before it writes sorted runs to disk */
+  static constexpr const size_t SORT_MEMORY_BUDGET = 16 << 20;
+
+  /** How many times fewer pages than the other table the outer side of an index join may read */
+  static constexpr const size_t INDEX_JOIN_PAGE_RATIO = 32;
+
   /** The maximum size allowed for VARCHAR columns */
   static constexpr const uint32_t MAX_VARCHAR_SIZE = 128;
 };
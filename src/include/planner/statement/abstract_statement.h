@@ -35,18 +35,33 @@ class AbstractStatement {
   virtual std::string ToString() const {
     throw std::logic_error("ToString not supported for this type of SQLStatement");
   }
+  /**
+   * Split a column name as written in the query.
+   * @param name The column, optionally qualified with its table as "table.column"
+   * @return The table, empty if the column is not qualified, and the column
+   */
+  static std::pair<std::string, std::string> SplitColumnName(const std::string &name) {
+    auto dot = name.find('.');
+    if (dot == std::string::npos) {
+      return {"", name};
+    }
+    return {name.substr(0, dot), name.substr(dot + 1)};
+  }
+
   /**
    * Make a column value expression.
    * @param table_name The name of the table
    * @param col The ptr to the SyntaxNode of the column
    * @return A owning pointer to the ColumnValueExpression
    */
-  AbstractExpressionRef MakeColumnValueExpression(const std::string &table_name, pSyntaxNode col) {
+  virtual AbstractExpressionRef MakeColumnValueExpression(const std::string &table_name, pSyntaxNode col) {
     TableInfo *info = nullptr;
     context_->GetCatalog()->GetTable(table_name, info);
     auto schema = info->GetSchema();
+    auto name = SplitColumnName(col->val_);
     uint32_t index;
-    if (schema->GetColumnIndex(col->val_, index) != DB_SUCCESS) {
+    if ((!name.first.empty() && name.first != table_name) ||
+        schema->GetColumnIndex(name.second, index) != DB_SUCCESS) {
       throw std::logic_error("the column does not exist in table");
     }
     auto col_type = schema->GetColumn(index)->GetType();
@@ -102,8 +117,8 @@ class AbstractStatement {
                                       vector<uint32_t> *column_in_condition = nullptr, bool *has_or = nullptr) {
     switch (ast->type_) {
       case kNodeConnector: {
-        auto left = MakePredicate(ast->child_, table_name, column_in_condition);
-        auto right = MakePredicate(ast->child_->next_, table_name, column_in_condition);
+        auto left = MakePredicate(ast->child_, table_name, column_in_condition, has_or);
+        auto right = MakePredicate(ast->child_->next_, table_name, column_in_condition, has_or);
         if (has_or && !strcmp(ast->val_, "or")) {
           *has_or = true;
         }
@@ -113,15 +128,29 @@ class AbstractStatement {
         pSyntaxNode col = ast->child_;
         pSyntaxNode value = ast->child_->next_;
         auto col_expr = MakeColumnValueExpression(table_name, col);
-        auto const_expr = MakeConstantValueExpression(col_expr->GetReturnType(), value);
+        AbstractExpressionRef value_expr;
+        if (value->type_ == kNodeIdentifier) {
+          // a column compared with another column
+          value_expr = MakeColumnValueExpression(table_name, value);
+          if (value_expr->GetReturnType() != col_expr->GetReturnType()) {
+            throw std::logic_error("cannot compare columns of different types");
+          }
+        } else {
+          value_expr = MakeConstantValueExpression(col_expr->GetReturnType(), value);
+        }
         if (column_in_condition) {
-          uint32_t index = dynamic_pointer_cast<ColumnValueExpression>(col_expr)->GetColIdx();
-          if(std::find(column_in_condition->begin(), column_in_condition->end(), index) ==
-            column_in_condition->end()){
+          for (auto &expr : {col_expr, value_expr}) {
+            if (expr->GetType() != ExpressionType::ColumnExpression) {
+              continue;
+            }
+            uint32_t index = dynamic_pointer_cast<ColumnValueExpression>(expr)->GetColIdx();
+            if (std::find(column_in_condition->begin(), column_in_condition->end(), index) ==
+                column_in_condition->end()) {
               column_in_condition->emplace_back(index);
+            }
           }
         }
-        return MakeComparisonExpression(col_expr, const_expr, ast->val_);
+        return MakeComparisonExpression(col_expr, value_expr, ast->val_);
       }
       default:
         throw std::logic_error("The node kNodeConditions has a child node of the wrong type");
@@ -5,7 +5,10 @@
 #ifndef MINISQL_INSERT_STATEMENT_H
 #define MINISQL_INSERT_STATEMENT_H
 
+#include <unordered_map>
+
 #include "abstract_statement.h"
+#include "executor/plans/insert_plan.h"
 
 class SelectStatement;
 class InsertStatement : public AbstractStatement {
@@ -31,6 +34,17 @@ class InsertStatement : public AbstractStatement {
         MakeInsertValues(ast->child_);
         break;
       }
+      case kNodeOnConflict: {
+        if (strcmp(ast->val_, "nothing") == 0) {
+          on_conflict_ = OnConflict::DoNothing;
+          break;
+        }
+        on_conflict_ = OnConflict::DoUpdate;
+        for (auto value = ast->child_->child_; value != nullptr; value = value->next_) {
+          MakeUpdateValue(value);
+        }
+        break;
+      }
       default:
         throw std::logic_error("the ast_type is not supported in planner yet");
     }
@@ -60,6 +74,18 @@ class InsertStatement : public AbstractStatement {
     raw_values_.emplace_back(value);
   }
 
+  void MakeUpdateValue(pSyntaxNode ast) {
+    pSyntaxNode col = ast->child_;
+    TableInfo *info = nullptr;
+    context_->GetCatalog()->GetTable(table_name_, info);
+    auto schema = info->GetSchema();
+    uint32_t index;
+    if (schema->GetColumnIndex(col->val_, index) != DB_SUCCESS) {
+      throw std::logic_error("the column does not exist in table");
+    }
+    update_attrs_[index] = MakeConstantValueExpression(schema->GetColumn(index)->GetType(), col->next_);
+  }
+
   /** Bound FROM clause. */
   std::string table_name_;
 
@@ -69,6 +95,10 @@ class InsertStatement : public AbstractStatement {
   /** If raw insert, bound raw values. */
   std::vector<std::vector<AbstractExpressionRef>> raw_values_;
 
+  /** What to do with rows whose unique key is taken, and the columns DO UPDATE sets. */
+  OnConflict on_conflict_ = OnConflict::Stop;
+  std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs_;
+
   std::string ToString() const override {
     std::stringstream sstream;
     sstream << "Insert {{\\n  table={" << table_name_ << "}\\n }}";
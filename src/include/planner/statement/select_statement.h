@@ -6,6 +6,8 @@
 #define MINISQL_SELECT_STATEMENT_H
 
 #include "abstract_statement.h"
+#include "executor/plans/aggregation_plan.h"
+#include "executor/plans/sort_plan.h"
 
 class SelectStatement : public AbstractStatement {
  public:
@@ -23,17 +25,44 @@ class SelectStatement : public AbstractStatement {
           error_info << "the table " << ast->val_ << " is not exist.";
           throw std::logic_error(error_info.str());
         }
-        table_name_ = ast->val_;
+        // the second table of FROM is joined with the first
+        if (table_name_.empty()) {
+          table_name_ = ast->val_;
+        } else {
+          join_table_name_ = ast->val_;
+        }
         break;
       }
       case kNodeAllColumns:
       case kNodeColumnList: {
         SyntaxTree2Statement(ast->next_);
         MakeColumnList(ast->child_);
+        MakeOrderByList();
         return;
       }
       case kNodeConditions: {
-        where_ = MakePredicate(ast->child_, table_name_, &column_in_condition_);
+        // the conditions of a JOIN ... ON come before those of WHERE, a row has to meet both
+        auto predicate = MakePredicate(ast->child_, table_name_, &column_in_condition_, &has_or);
+        where_ = where_ == nullptr ? predicate : MakeLogicExpression(where_, predicate, LogicType::And);
+        break;
+      }
+      case kNodeGroupBy: {
+        for (auto col = ast->child_; col != nullptr; col = col->next_) {
+          group_by_.push_back(MakeColumnValueExpression(table_name_, col));
+        }
+        break;
+      }
+      case kNodeOrderBy: {
+        // bound once the SELECT list is, its keys may name columns of the list
+        order_by_ast_ = ast->child_;
+        break;
+      }
+      case kNodeLimit: {
+        std::string value = ast->child_->val_;
+        if (value.empty() || value.size() > 18 || value.find_first_not_of("0123456789") != std::string::npos) {
+          throw std::logic_error("the limit must be a non-negative integer.");
+        }
+        limit_ = std::stoull(value);
         break;
       }
       default:
@@ -43,37 +72,198 @@ class SelectStatement : public AbstractStatement {
   };
 
   void MakeColumnList(pSyntaxNode ast) {
-    TableInfo *info = nullptr;
-    context_->GetCatalog()->GetTable(table_name_, info);
-    auto schema = info->GetSchema();
+    if (!ast && !group_by_.empty()) {
+      throw std::logic_error("select * can not be used with group by.");
+    }
     if (!ast) {
-      auto columns = schema->GetColumns();
-      for (auto column : columns) {
-        auto expr = std::make_shared<ColumnValueExpression>(0, column->GetTableInd(), column->GetType());
-        column_list_.emplace_back(make_pair(column->GetName(), expr));
+      // all columns of the first table, then all of the second
+      std::vector<std::string> tables{table_name_};
+      if (!join_table_name_.empty()) {
+        tables.push_back(join_table_name_);
+      }
+      for (uint32_t side = 0; side < tables.size(); side++) {
+        TableInfo *info = nullptr;
+        context_->GetCatalog()->GetTable(tables[side], info);
+        for (auto column : info->GetSchema()->GetColumns()) {
+          auto expr = std::make_shared<ColumnValueExpression>(side, column->GetTableInd(), column->GetType());
+          column_list_.emplace_back(make_pair(column->GetName(), expr));
+        }
       }
+    } else if (!group_by_.empty() || HasAggregate(ast)) {
+      MakeAggregateList(ast);
     } else {
       while (ast) {
-        uint32_t index;
-        if (schema->GetColumnIndex(ast->val_, index) != DB_SUCCESS) {
-          throw std::logic_error("the column does not exist in table");
-        }
-        auto expr = std::make_shared<ColumnValueExpression>(0, index, schema->GetColumn(index)->GetType());
-        column_list_.emplace_back(make_pair(ast->val_, expr));
+        column_list_.emplace_back(make_pair(ast->val_, MakeColumnValueExpression(table_name_, ast)));
         ast = ast->next_;
       }
     }
   }
 
+  /** @return whether an aggregate function is in the SELECT list starting at ast */
+  static bool HasAggregate(pSyntaxNode ast) {
+    for (; ast != nullptr; ast = ast->next_) {
+      if (ast->type_ == kNodeAggregate) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Bind the SELECT list of an aggregation. A column has to be one of the group-by columns,
+   * every column of the list then reads an aggregated row: the group-by values followed by
+   * one value per aggregate.
+   */
+  void MakeAggregateList(pSyntaxNode ast) {
+    for (; ast != nullptr; ast = ast->next_) {
+      if (ast->type_ != kNodeAggregate) {
+        column_list_.emplace_back(make_pair(ast->val_, MakeGroupByColumn(ast)));
+        continue;
+      }
+      std::string function = ast->val_;
+      AbstractExpressionRef arg = nullptr;
+      if (ast->child_->type_ != kNodeAllColumns) {
+        arg = MakeColumnValueExpression(table_name_, ast->child_);
+      }
+      AggregationType type;
+      TypeId ret_type = arg == nullptr ? kTypeInt : arg->GetReturnType();
+      if (function == "count") {
+        type = arg == nullptr ? AggregationType::CountStarAggregate : AggregationType::CountAggregate;
+        ret_type = kTypeInt;
+      } else if (arg == nullptr) {
+        throw std::logic_error("only count can be applied to *.");
+      } else if (function == "sum" || function == "avg") {
+        if (arg->GetReturnType() == kTypeChar) {
+          throw std::logic_error("the function " + function + " can not be applied to a char column.");
+        }
+        type = function == "sum" ? AggregationType::SumAggregate : AggregationType::AvgAggregate;
+        ret_type = function == "sum" ? ret_type : kTypeFloat;
+      } else if (function == "min" || function == "max") {
+        type = function == "min" ? AggregationType::MinAggregate : AggregationType::MaxAggregate;
+      } else {
+        throw std::logic_error("the function " + function + " is not an aggregate function.");
+      }
+      column_list_.emplace_back(make_pair(AggregateName(ast), std::make_shared<ColumnValueExpression>(
+                                                    0, group_by_.size() + aggregates_.size(), ret_type)));
+      aggregates_.emplace_back(type, arg);
+    }
+  }
+
+  /** @return the column of an aggregated row holding the group-by column col */
+  AbstractExpressionRef MakeGroupByColumn(pSyntaxNode col) {
+    auto expr = dynamic_pointer_cast<ColumnValueExpression>(MakeColumnValueExpression(table_name_, col));
+    auto it = std::find_if(group_by_.begin(), group_by_.end(), [&](const AbstractExpressionRef &group_by) {
+      auto group_col = dynamic_pointer_cast<ColumnValueExpression>(group_by);
+      return group_col->GetRowIdx() == expr->GetRowIdx() && group_col->GetColIdx() == expr->GetColIdx();
+    });
+    if (it == group_by_.end()) {
+      std::stringstream error_info;
+      error_info << "the column " << col->val_
+                 << " must appear in the group by clause or be used in an aggregate function.";
+      throw std::logic_error(error_info.str());
+    }
+    return std::make_shared<ColumnValueExpression>(0, it - group_by_.begin(), expr->GetReturnType());
+  }
+
+  /** @return the name of the column of an aggregate function, e.g. "count(*)" */
+  static std::string AggregateName(pSyntaxNode ast) {
+    return std::string(ast->val_) + "(" + (ast->child_->type_ == kNodeAllColumns ? "*" : ast->child_->val_) + ")";
+  }
+
+  /**
+   * Bind ORDER BY over the rows of the SELECT list. A key is the column of the list with its
+   * name, or else a column the list leaves out, which the rows carry after the list.
+   */
+  void MakeOrderByList() {
+    for (auto item = order_by_ast_; item != nullptr; item = item->next_) {
+      auto key = item->child_;
+      auto type = std::string(item->val_) == "desc" ? OrderByType::Desc : OrderByType::Asc;
+      std::string name = key->type_ == kNodeAggregate ? AggregateName(key) : key->val_;
+      auto it = std::find_if(column_list_.begin(), column_list_.end(),
+                             [&](const std::pair<std::string, AbstractExpressionRef> &column) {
+                               return column.first == name;
+                             });
+      if (it != column_list_.end()) {
+        order_by_.emplace_back(type, std::make_shared<ColumnValueExpression>(0, it - column_list_.begin(),
+                                                                             it->second->GetReturnType()));
+        continue;
+      }
+      if (key->type_ == kNodeAggregate) {
+        throw std::logic_error("the function " + name + " of order by must appear in the select list.");
+      }
+      auto expr = IsAggregation() ? MakeGroupByColumn(key) : MakeColumnValueExpression(table_name_, key);
+      order_by_.emplace_back(type, std::make_shared<ColumnValueExpression>(
+                                       0, column_list_.size() + order_columns_.size(), expr->GetReturnType()));
+      order_columns_.emplace_back(name, expr);
+    }
+  }
+
+  /**
+   * Resolve a column against the tables of FROM. With two tables the column belongs to the
+   * one it is qualified with, or to the only one having a column of that name, and the
+   * expression reads it from the left (first) or right (second) row of the join.
+   */
+  AbstractExpressionRef MakeColumnValueExpression(const std::string &table_name, pSyntaxNode col) override {
+    if (join_table_name_.empty()) {
+      return AbstractStatement::MakeColumnValueExpression(table_name, col);
+    }
+    auto name = SplitColumnName(col->val_);
+    const std::string tables[] = {table_name_, join_table_name_};
+    AbstractExpressionRef expr = nullptr;
+    for (uint32_t side = 0; side < 2; side++) {
+      TableInfo *info = nullptr;
+      context_->GetCatalog()->GetTable(tables[side], info);
+      uint32_t index;
+      if ((!name.first.empty() && name.first != tables[side]) ||
+          info->GetSchema()->GetColumnIndex(name.second, index) != DB_SUCCESS) {
+        continue;
+      }
+      if (expr != nullptr) {
+        std::stringstream error_info;
+        error_info << "the column " << col->val_ << " is ambiguous.";
+        throw std::logic_error(error_info.str());
+      }
+      expr = std::make_shared<ColumnValueExpression>(side, index, info->GetSchema()->GetColumn(index)->GetType());
+    }
+    if (expr == nullptr) {
+      throw std::logic_error("the column does not exist in table");
+    }
+    return expr;
+  }
+
   /** Bound FROM clause. */
   std::string table_name_;
 
-  /** Bound SELECT list. */
+  /** The table joined with table_name_, empty if FROM has a single table. */
+  std::string join_table_name_;
+
+  /** Bound SELECT list, over the aggregated rows if the statement aggregates. */
   std::vector<std::pair<std::string, AbstractExpressionRef>> column_list_;
 
+  /** Bound GROUP BY clause. */
+  std::vector<AbstractExpressionRef> group_by_;
+
+  /** The aggregate functions of the SELECT list and the column each reads, null for COUNT(*). */
+  std::vector<std::pair<AggregationType, AbstractExpressionRef>> aggregates_;
+
+  /** Bound ORDER BY clause, over the columns of the SELECT list followed by order_columns_. */
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_by_;
+
+  /** The columns ORDER BY reads that the SELECT list leaves out. */
+  std::vector<std::pair<std::string, AbstractExpressionRef>> order_columns_;
+
+  /** The keys of ORDER BY until they are bound. */
+  pSyntaxNode order_by_ast_ = nullptr;
+
+  /** Bound LIMIT clause. */
+  size_t limit_ = SortPlanNode::NO_LIMIT;
+
   /** Index of columns in condition. */
   std::vector<uint32_t> column_in_condition_;
 
+  /** @return whether the rows are grouped and aggregated */
+  bool IsAggregation() const { return !group_by_.empty() || !aggregates_.empty(); }
+
   /** Has or in where clause */
   bool has_or = false;
 
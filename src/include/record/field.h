@@ -19,6 +19,10 @@ class Field
 
     friend class TypeFloat;
 
+    friend class KeyManager;
+
+    friend class CompiledPredicate;
+
 public:
     explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
@@ -108,6 +108,9 @@ public:
      */
     inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+    /** Collect the ids of the pages of the table in chain order, for scans that split it up */
+    void GetPageIds(std::vector<page_id_t> *page_ids);
+
 private:
     /**
      * create table heap and initialize first page
@@ -0,0 +1,719 @@
+#include "index/art.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace
+{
+/** Bytes of a compressed path stored in the node itself */
+constexpr uint32_t kMaxPrefix = 8;
+
+enum NodeType : uint8_t
+{
+    kNode4,
+    kNode16,
+    kNode48,
+    kNode256
+};
+} // namespace
+
+struct AdaptiveRadixTree::Node
+{
+    explicit Node(NodeType node_type) : type(node_type) {}
+
+    NodeType type;
+    uint16_t count{0};
+    /** Length of the compressed path, the first kMaxPrefix bytes of it are in prefix */
+    uint32_t prefix_len{0};
+    uint8_t prefix[kMaxPrefix];
+};
+
+namespace
+{
+using Node = AdaptiveRadixTree::Node;
+using Leaf = AdaptiveRadixTree::Leaf;
+
+/** Children sorted by key byte */
+struct Node4 : Node
+{
+    Node4() : Node(kNode4) {}
+
+    uint8_t keys[4];
+    Node *children[4];
+};
+
+struct Node16 : Node
+{
+    Node16() : Node(kNode16) {}
+
+    uint8_t keys[16];
+    Node *children[16];
+};
+
+/** child_index maps a key byte to its slot plus one, 0 if there is no child */
+struct Node48 : Node
+{
+    Node48() : Node(kNode48) { memset(child_index, 0, sizeof(child_index)); }
+
+    uint8_t child_index[256];
+    Node *children[48];
+};
+
+struct Node256 : Node
+{
+    Node256() : Node(kNode256) { memset(children, 0, sizeof(children)); }
+
+    Node *children[256];
+};
+
+/** Leaves hang in the child slots with the lowest pointer bit set */
+inline bool IsLeaf(const Node *node)
+{
+    return reinterpret_cast<uintptr_t>(node) & 1;
+}
+
+inline Leaf *AsLeaf(const Node *node)
+{
+    return reinterpret_cast<Leaf *>(reinterpret_cast<uintptr_t>(node) & ~static_cast<uintptr_t>(1));
+}
+
+inline Node *TagLeaf(Leaf *leaf)
+{
+    return reinterpret_cast<Node *>(reinterpret_cast<uintptr_t>(leaf) | 1);
+}
+
+void CopyHeader(Node *to, const Node *from)
+{
+    to->count = from->count;
+    to->prefix_len = from->prefix_len;
+    memcpy(to->prefix, from->prefix, std::min(from->prefix_len, kMaxPrefix));
+}
+
+void DeleteNode(Node *node)
+{
+    switch (node->type)
+    {
+    case kNode4:
+        delete static_cast<Node4 *>(node);
+        break;
+    case kNode16:
+        delete static_cast<Node16 *>(node);
+        break;
+    case kNode48:
+        delete static_cast<Node48 *>(node);
+        break;
+    case kNode256:
+        delete static_cast<Node256 *>(node);
+        break;
+    }
+}
+
+Node **FindChild(Node *node, uint8_t byte)
+{
+    switch (node->type)
+    {
+    case kNode4:
+    {
+        auto *n = static_cast<Node4 *>(node);
+        for (int i = 0; i < n->count; i++)
+        {
+            if (n->keys[i] == byte)
+                return &n->children[i];
+        }
+        return nullptr;
+    }
+    case kNode16:
+    {
+        auto *n = static_cast<Node16 *>(node);
+        for (int i = 0; i < n->count; i++)
+        {
+            if (n->keys[i] == byte)
+                return &n->children[i];
+        }
+        return nullptr;
+    }
+    case kNode48:
+    {
+        auto *n = static_cast<Node48 *>(node);
+        return n->child_index[byte] == 0 ? nullptr : &n->children[n->child_index[byte] - 1];
+    }
+    case kNode256:
+    {
+        auto *n = static_cast<Node256 *>(node);
+        return n->children[byte] == nullptr ? nullptr : &n->children[byte];
+    }
+    }
+    return nullptr;
+}
+
+/**
+ * The child at or after iteration position pos, which is then moved past it.
+ * Positions are child indexes in nodes of 4 and 16 and key bytes in the others.
+ * @return null once the node has no more children
+ */
+const Node *NextChild(const Node *node, int &pos)
+{
+    switch (node->type)
+    {
+    case kNode4:
+    {
+        auto *n = static_cast<const Node4 *>(node);
+        return pos < n->count ? n->children[pos++] : nullptr;
+    }
+    case kNode16:
+    {
+        auto *n = static_cast<const Node16 *>(node);
+        return pos < n->count ? n->children[pos++] : nullptr;
+    }
+    case kNode48:
+    {
+        auto *n = static_cast<const Node48 *>(node);
+        while (pos < 256)
+        {
+            uint8_t slot = n->child_index[pos++];
+            if (slot != 0)
+                return n->children[slot - 1];
+        }
+        return nullptr;
+    }
+    case kNode256:
+    {
+        auto *n = static_cast<const Node256 *>(node);
+        while (pos < 256)
+        {
+            const Node *child = n->children[pos++];
+            if (child != nullptr)
+                return child;
+        }
+        return nullptr;
+    }
+    }
+    return nullptr;
+}
+
+/** @return the iteration position of the first child whose byte is not less than byte */
+int SeekChild(const Node *node, uint8_t byte, bool &exact)
+{
+    switch (node->type)
+    {
+    case kNode4:
+    case kNode16:
+    {
+        const uint8_t *keys = node->type == kNode4 ? static_cast<const Node4 *>(node)->keys
+                                                   : static_cast<const Node16 *>(node)->keys;
+        int i = 0;
+        while (i < node->count && keys[i] < byte)
+            i++;
+        exact = i < node->count && keys[i] == byte;
+        return i;
+    }
+    case kNode48:
+        exact = static_cast<const Node48 *>(node)->child_index[byte] != 0;
+        return byte;
+    case kNode256:
+        exact = static_cast<const Node256 *>(node)->children[byte] != nullptr;
+        return byte;
+    }
+    return 0;
+}
+
+/** Any leaf below node shares its full prefix, take the leftmost */
+const Leaf *MinLeaf(const Node *node)
+{
+    while (!IsLeaf(node))
+    {
+        int pos = 0;
+        node = NextChild(node, pos);
+    }
+    return AsLeaf(node);
+}
+
+/** Compare the inline part of the prefix only, the leaf reached in the end confirms the rest */
+bool CheckPrefix(const Node *node, const std::string &key, uint32_t depth)
+{
+    uint32_t len = std::min(node->prefix_len, kMaxPrefix);
+    if (depth + node->prefix_len > key.size())
+        return false;
+    return memcmp(node->prefix, key.data() + depth, len) == 0;
+}
+
+/** @return the number of leading prefix bytes of node that key matches */
+uint32_t PrefixMismatch(const Node *node, const std::string &key, uint32_t depth)
+{
+    uint32_t i = 0;
+    for (; i < std::min(node->prefix_len, kMaxPrefix); i++)
+    {
+        if (depth + i >= key.size() || node->prefix[i] != static_cast<uint8_t>(key[depth + i]))
+            return i;
+    }
+    if (node->prefix_len > kMaxPrefix)
+    {
+        const Leaf *leaf = MinLeaf(node);
+        for (; i < node->prefix_len; i++)
+        {
+            if (depth + i >= key.size() || leaf->key[depth + i] != key[depth + i])
+                return i;
+        }
+    }
+    return i;
+}
+
+template <typename SortedNode>
+void InsertSorted(SortedNode *node, uint8_t byte, Node *child)
+{
+    int i = 0;
+    while (i < node->count && node->keys[i] < byte)
+        i++;
+    memmove(node->keys + i + 1, node->keys + i, node->count - i);
+    memmove(node->children + i + 1, node->children + i, (node->count - i) * sizeof(Node *));
+    node->keys[i] = byte;
+    node->children[i] = child;
+    node->count++;
+}
+
+/** Add a child under a byte that has none, ref is replaced by a larger node once node is full */
+void AddChild(Node *&ref, uint8_t byte, Node *child)
+{
+    Node *node = ref;
+    switch (node->type)
+    {
+    case kNode4:
+    {
+        auto *n = static_cast<Node4 *>(node);
+        if (n->count < 4)
+        {
+            InsertSorted(n, byte, child);
+            return;
+        }
+        auto *grown = new Node16();
+        CopyHeader(grown, n);
+        memcpy(grown->keys, n->keys, sizeof(n->keys));
+        memcpy(grown->children, n->children, sizeof(n->children));
+        InsertSorted(grown, byte, child);
+        ref = grown;
+        delete n;
+        return;
+    }
+    case kNode16:
+    {
+        auto *n = static_cast<Node16 *>(node);
+        if (n->count < 16)
+        {
+            InsertSorted(n, byte, child);
+            return;
+        }
+        auto *grown = new Node48();
+        CopyHeader(grown, n);
+        for (int i = 0; i < n->count; i++)
+        {
+            grown->child_index[n->keys[i]] = i + 1;
+            grown->children[i] = n->children[i];
+        }
+        grown->child_index[byte] = grown->count + 1;
+        grown->children[grown->count++] = child;
+        ref = grown;
+        delete n;
+        return;
+    }
+    case kNode48:
+    {
+        auto *n = static_cast<Node48 *>(node);
+        // slots are kept dense, the first free one is at count
+        if (n->count < 48)
+        {
+            n->child_index[byte] = n->count + 1;
+            n->children[n->count++] = child;
+            return;
+        }
+        auto *grown = new Node256();
+        CopyHeader(grown, n);
+        for (int b = 0; b < 256; b++)
+        {
+            if (n->child_index[b] != 0)
+                grown->children[b] = n->children[n->child_index[b] - 1];
+        }
+        grown->children[byte] = child;
+        grown->count++;
+        ref = grown;
+        delete n;
+        return;
+    }
+    case kNode256:
+    {
+        auto *n = static_cast<Node256 *>(node);
+        n->children[byte] = child;
+        n->count++;
+        return;
+    }
+    }
+}
+
+/**
+ * Take the only child of a node of 4 up in its place, its prefix grows by the
+ * node's prefix and the byte leading to it.
+ */
+Node *Collapse(Node4 *node)
+{
+    Node *child = node->children[0];
+    if (!IsLeaf(child))
+    {
+        uint8_t prefix[kMaxPrefix];
+        uint32_t len = std::min(node->prefix_len, kMaxPrefix);
+        memcpy(prefix, node->prefix, len);
+        if (len < kMaxPrefix)
+            prefix[len++] = node->keys[0];
+        uint32_t child_len = std::min(child->prefix_len, kMaxPrefix - len);
+        memcpy(prefix + len, child->prefix, child_len);
+        memcpy(child->prefix, prefix, len + child_len);
+        child->prefix_len += node->prefix_len + 1;
+    }
+    delete node;
+    return child;
+}
+
+template <typename SortedNode>
+void RemoveSorted(SortedNode *node, uint8_t byte)
+{
+    int i = 0;
+    while (node->keys[i] != byte)
+        i++;
+    memmove(node->keys + i, node->keys + i + 1, node->count - i - 1);
+    memmove(node->children + i, node->children + i + 1, (node->count - i - 1) * sizeof(Node *));
+    node->count--;
+}
+
+/** Drop the child under byte, ref is replaced by a smaller node once node is sparse enough */
+void RemoveChild(Node *&ref, uint8_t byte)
+{
+    Node *node = ref;
+    switch (node->type)
+    {
+    case kNode4:
+    {
+        auto *n = static_cast<Node4 *>(node);
+        RemoveSorted(n, byte);
+        if (n->count == 1)
+            ref = Collapse(n);
+        return;
+    }
+    case kNode16:
+    {
+        auto *n = static_cast<Node16 *>(node);
+        RemoveSorted(n, byte);
+        if (n->count > 3)
+            return;
+        auto *shrunk = new Node4();
+        CopyHeader(shrunk, n);
+        memcpy(shrunk->keys, n->keys, n->count);
+        memcpy(shrunk->children, n->children, n->count * sizeof(Node *));
+        ref = shrunk;
+        delete n;
+        return;
+    }
+    case kNode48:
+    {
+        auto *n = static_cast<Node48 *>(node);
+        // move the last slot into the hole to keep the slots dense
+        int slot = n->child_index[byte] - 1;
+        int last = --n->count;
+        n->child_index[byte] = 0;
+        if (slot != last)
+        {
+            n->children[slot] = n->children[last];
+            for (int b = 0; b < 256; b++)
+            {
+                if (n->child_index[b] == last + 1)
+                {
+                    n->child_index[b] = slot + 1;
+                    break;
+                }
+            }
+        }
+        if (n->count > 12)
+            return;
+        auto *shrunk = new Node16();
+        CopyHeader(shrunk, n);
+        shrunk->count = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            if (n->child_index[b] != 0)
+            {
+                shrunk->keys[shrunk->count] = b;
+                shrunk->children[shrunk->count++] = n->children[n->child_index[b] - 1];
+            }
+        }
+        ref = shrunk;
+        delete n;
+        return;
+    }
+    case kNode256:
+    {
+        auto *n = static_cast<Node256 *>(node);
+        n->children[byte] = nullptr;
+        if (--n->count > 37)
+            return;
+        auto *shrunk = new Node48();
+        CopyHeader(shrunk, n);
+        shrunk->count = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            if (n->children[b] != nullptr)
+            {
+                shrunk->child_index[b] = shrunk->count + 1;
+                shrunk->children[shrunk->count++] = n->children[b];
+            }
+        }
+        ref = shrunk;
+        delete n;
+        return;
+    }
+    }
+}
+
+bool InsertInto(Node *&ref, const std::string &key, uint32_t depth, Leaf *leaf)
+{
+    Node *node = ref;
+    if (node == nullptr)
+    {
+        ref = TagLeaf(leaf);
+        return true;
+    }
+    if (IsLeaf(node))
+    {
+        const Leaf *existing = AsLeaf(node);
+        if (existing->key == key)
+            return false;
+        // both leaves go below a new node holding what they have in common
+        uint32_t lcp = 0;
+        while (depth + lcp < key.size() && depth + lcp < existing->key.size() &&
+               key[depth + lcp] == existing->key[depth + lcp])
+            lcp++;
+        ASSERT(depth + lcp < key.size() && depth + lcp < existing->key.size(), "A key is a prefix of another.");
+        auto *inner = new Node4();
+        inner->prefix_len = lcp;
+        memcpy(inner->prefix, key.data() + depth, std::min(lcp, kMaxPrefix));
+        InsertSorted(inner, existing->key[depth + lcp], node);
+        InsertSorted(inner, key[depth + lcp], TagLeaf(leaf));
+        ref = inner;
+        return true;
+    }
+    if (node->prefix_len > 0)
+    {
+        uint32_t mismatch = PrefixMismatch(node, key, depth);
+        if (mismatch < node->prefix_len)
+        {
+            // split the path where the key leaves it, node keeps the part below the branch
+            ASSERT(depth + mismatch < key.size(), "A key is a prefix of another.");
+            auto *inner = new Node4();
+            inner->prefix_len = mismatch;
+            memcpy(inner->prefix, node->prefix, std::min(mismatch, kMaxPrefix));
+            uint8_t branch;
+            if (node->prefix_len <= kMaxPrefix)
+            {
+                branch = node->prefix[mismatch];
+                node->prefix_len -= mismatch + 1;
+                memmove(node->prefix, node->prefix + mismatch + 1, node->prefix_len);
+            }
+            else
+            {
+                const Leaf *min_leaf = MinLeaf(node);
+                branch = min_leaf->key[depth + mismatch];
+                node->prefix_len -= mismatch + 1;
+                memcpy(node->prefix, min_leaf->key.data() + depth + mismatch + 1,
+                       std::min(node->prefix_len, kMaxPrefix));
+            }
+            InsertSorted(inner, branch, node);
+            InsertSorted(inner, key[depth + mismatch], TagLeaf(leaf));
+            ref = inner;
+            return true;
+        }
+        depth += node->prefix_len;
+    }
+    ASSERT(depth < key.size(), "A key is a prefix of another.");
+    Node **child = FindChild(node, key[depth]);
+    if (child != nullptr)
+        return InsertInto(*child, key, depth + 1, leaf);
+    AddChild(ref, key[depth], TagLeaf(leaf));
+    return true;
+}
+
+bool RemoveFrom(Node *&ref, const std::string &key, uint32_t depth)
+{
+    Node *node = ref;
+    if (node == nullptr)
+        return false;
+    if (IsLeaf(node))
+    {
+        if (AsLeaf(node)->key != key)
+            return false;
+        delete AsLeaf(node);
+        ref = nullptr;
+        return true;
+    }
+    if (!CheckPrefix(node, key, depth))
+        return false;
+    depth += node->prefix_len;
+    if (depth >= key.size())
+        return false;
+    Node **child = FindChild(node, key[depth]);
+    if (child == nullptr)
+        return false;
+    if (!IsLeaf(*child))
+        return RemoveFrom(*child, key, depth + 1);
+    if (AsLeaf(*child)->key != key)
+        return false;
+    delete AsLeaf(*child);
+    RemoveChild(ref, key[depth]);
+    return true;
+}
+
+void FreeTree(Node *node)
+{
+    if (node == nullptr)
+        return;
+    if (IsLeaf(node))
+    {
+        delete AsLeaf(node);
+        return;
+    }
+    int pos = 0;
+    for (const Node *child = NextChild(node, pos); child != nullptr; child = NextChild(node, pos))
+        FreeTree(const_cast<Node *>(child));
+    DeleteNode(node);
+}
+} // namespace
+
+AdaptiveRadixTree::~AdaptiveRadixTree()
+{
+    Clear();
+}
+
+bool AdaptiveRadixTree::Insert(const std::string &key, const RowId &value)
+{
+    auto *leaf = new Leaf{key, value};
+    if (!InsertInto(root_, key, 0, leaf))
+    {
+        delete leaf;
+        return false;
+    }
+    size_++;
+    return true;
+}
+
+bool AdaptiveRadixTree::Remove(const std::string &key)
+{
+    if (!RemoveFrom(root_, key, 0))
+        return false;
+    size_--;
+    return true;
+}
+
+const AdaptiveRadixTree::Leaf *AdaptiveRadixTree::Lookup(const std::string &key) const
+{
+    Node *node = root_;
+    uint32_t depth = 0;
+    while (node != nullptr)
+    {
+        if (IsLeaf(node))
+        {
+            const Leaf *leaf = AsLeaf(node);
+            return leaf->key == key ? leaf : nullptr;
+        }
+        if (!CheckPrefix(node, key, depth))
+            return nullptr;
+        depth += node->prefix_len;
+        if (depth >= key.size())
+            return nullptr;
+        Node **child = FindChild(node, key[depth++]);
+        node = child == nullptr ? nullptr : *child;
+    }
+    return nullptr;
+}
+
+AdaptiveRadixTree::Iterator AdaptiveRadixTree::LowerBound(const std::string &key) const
+{
+    // descend along the key, every frame left behind resumes at the children greater than it
+    Iterator iter;
+    const Node *node = root_;
+    uint32_t depth = 0;
+    while (node != nullptr)
+    {
+        if (IsLeaf(node))
+        {
+            if (AsLeaf(node)->key.compare(key) >= 0)
+                iter.pending_ = AsLeaf(node);
+            return iter;
+        }
+        const Leaf *min_leaf = node->prefix_len > kMaxPrefix ? MinLeaf(node) : nullptr;
+        for (uint32_t i = 0; i < node->prefix_len; i++)
+        {
+            // the subtree is past the key once the key runs out or is smaller
+            if (depth + i >= key.size())
+            {
+                iter.stack_.push_back({node, 0});
+                return iter;
+            }
+            uint8_t byte = min_leaf != nullptr ? min_leaf->key[depth + i] : node->prefix[i];
+            if (byte != static_cast<uint8_t>(key[depth + i]))
+            {
+                if (byte > static_cast<uint8_t>(key[depth + i]))
+                    iter.stack_.push_back({node, 0});
+                return iter;
+            }
+        }
+        depth += node->prefix_len;
+        if (depth >= key.size())
+        {
+            iter.stack_.push_back({node, 0});
+            return iter;
+        }
+        bool exact = false;
+        Iterator::Frame frame{node, SeekChild(node, key[depth], exact)};
+        if (!exact)
+        {
+            iter.stack_.push_back(frame);
+            return iter;
+        }
+        node = NextChild(node, frame.pos);
+        iter.stack_.push_back(frame);
+        depth++;
+    }
+    return iter;
+}
+
+AdaptiveRadixTree::Iterator AdaptiveRadixTree::Begin() const
+{
+    return LowerBound("");
+}
+
+void AdaptiveRadixTree::Clear()
+{
+    FreeTree(root_);
+    root_ = nullptr;
+    size_ = 0;
+}
+
+const AdaptiveRadixTree::Leaf *AdaptiveRadixTree::Iterator::Next()
+{
+    if (pending_ != nullptr)
+    {
+        const Leaf *leaf = pending_;
+        pending_ = nullptr;
+        return leaf;
+    }
+    while (!stack_.empty())
+    {
+        const Node *child = NextChild(stack_.back().node, stack_.back().pos);
+        if (child == nullptr)
+        {
+            stack_.pop_back();
+            continue;
+        }
+        if (IsLeaf(child))
+            return AsLeaf(child);
+        stack_.push_back({child, 0});
+    }
+    return nullptr;
+}
@@ -0,0 +1,150 @@
+#include "index/art_index.h"
+
+namespace {
+/**
+ * Walks the tree in key order from the lower bound. Bounds are byte prefixes of the
+ * tree keys, so the row id suffix of a non-unique index never takes part in them.
+ */
+class ArtScanCursor : public IndexScanCursor {
+ public:
+  ArtScanCursor(AdaptiveRadixTree::Iterator &&iter, const KeyManager &processor, Schema *key_schema,
+                std::string lower, bool has_lower, bool lower_inclusive, std::string upper, bool has_upper,
+                bool upper_inclusive)
+      : iter_(std::move(iter)),
+        processor_(processor),
+        key_schema_(key_schema),
+        lower_(std::move(lower)),
+        skip_lower_(has_lower && !lower_inclusive),
+        upper_(std::move(upper)),
+        has_upper_(has_upper),
+        upper_inclusive_(upper_inclusive) {}
+
+  bool Next(RowId *rid) override { return Fetch(rid, nullptr); }
+
+  bool NextEntry(RowId *rid, Row *entry) override { return Fetch(rid, entry); }
+
+ private:
+  bool Fetch(RowId *rid, Row *row) {
+    const AdaptiveRadixTree::Leaf *leaf;
+    while ((leaf = iter_.Next()) != nullptr) {
+      // an exclusive lower bound only has to skip the keys equal to it, which come first
+      if (skip_lower_) {
+        if (leaf->key.compare(0, lower_.size(), lower_) == 0) {
+          continue;
+        }
+        skip_lower_ = false;
+      }
+      if (has_upper_) {
+        int cmp = leaf->key.compare(0, upper_.size(), upper_);
+        if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+          iter_ = AdaptiveRadixTree::Iterator();
+          return false;
+        }
+      }
+      *rid = leaf->value;
+      if (row != nullptr) {
+        // the key columns come first, a row id suffix is past what the schema reads
+        GenericKey *key = processor_.InitKey();
+        memset(key, 0, processor_.GetKeySize());
+        memcpy(key, leaf->key.data(), std::min<size_t>(leaf->key.size(), processor_.GetKeySize()));
+        processor_.DeserializeToKey(key, *row, key_schema_);
+        free(key);
+        row->SetRowId(leaf->value);
+      }
+      return true;
+    }
+    return false;
+  }
+
+  AdaptiveRadixTree::Iterator iter_;
+  const KeyManager &processor_;
+  Schema *key_schema_;
+  std::string lower_;
+  bool skip_lower_;
+  std::string upper_;
+  bool has_upper_;
+  bool upper_inclusive_;
+};
+}  // namespace
+
+ArtIndex::ArtIndex(index_id_t index_id, IndexSchema *key_schema, bool unique)
+    : Index(index_id, key_schema), processor_(key_schema_, KeyManager::GetMaxKeyLength(key_schema)), unique_(unique) {}
+
+std::string ArtIndex::EncodeKey(const Row &key) const {
+  GenericKey *key_buf = processor_.InitKey();
+  int length = processor_.SerializePrefix(key_buf, key, key_schema_);
+  std::string bytes(reinterpret_cast<const char *>(key_buf), length);
+  free(key_buf);
+  return bytes;
+}
+
+std::string ArtIndex::EncodeEntry(const Row &key, RowId row_id) const {
+  ASSERT(key.GetFieldCount() >= key_schema_->GetColumnCount(), "field nums not match.");
+  std::string bytes = EncodeKey(key);
+  if (!unique_) {
+    // big endian, so the entries of a key are ordered by row id
+    uint64_t rid = static_cast<uint64_t>(row_id.Get());
+    for (int b = 7; b >= 0; b--) {
+      bytes.push_back(static_cast<char>(rid >> (b * 8)));
+    }
+  }
+  return bytes;
+}
+
+dberr_t ArtIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  return tree_.Insert(EncodeEntry(key, row_id), row_id) ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t ArtIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  tree_.Remove(EncodeEntry(key, row_id));
+  return DB_SUCCESS;
+}
+
+std::unique_ptr<IndexScanCursor> ArtIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                bool upper_inclusive, Transaction *txn) {
+  std::string lower_key = lower == nullptr ? "" : EncodeKey(*lower);
+  std::string upper_key = upper == nullptr ? "" : EncodeKey(*upper);
+  return std::make_unique<ArtScanCursor>(tree_.LowerBound(lower_key), processor_, key_schema_, lower_key,
+                                         lower != nullptr, lower_inclusive, upper_key, upper != nullptr,
+                                         upper_inclusive);
+}
+
+dberr_t ArtIndex::ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                          std::string compare_operator) {
+  std::vector<std::unique_ptr<IndexScanCursor>> cursors;
+  if (compare_operator == "=") {
+    // a whole key of a unique index is a single lookup
+    if (unique_ && key.GetFieldCount() >= key_schema_->GetColumnCount()) {
+      const AdaptiveRadixTree::Leaf *leaf = tree_.Lookup(EncodeKey(key));
+      if (leaf == nullptr) {
+        return DB_KEY_NOT_FOUND;
+      }
+      result.emplace_back(leaf->value);
+      return DB_SUCCESS;
+    }
+    cursors.emplace_back(Scan(&key, true, &key, true, txn));
+  } else if (compare_operator == ">") {
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    cursors.emplace_back(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    cursors.emplace_back(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  }
+  RowId rid;
+  for (auto &cursor : cursors) {
+    while (cursor->Next(&rid)) {
+      result.emplace_back(rid);
+    }
+  }
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+dberr_t ArtIndex::Destroy() {
+  tree_.Clear();
+  return DB_SUCCESS;
+}
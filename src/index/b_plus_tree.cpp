@@ -5,28 +5,27 @@
 #include "glog/logging.h"
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "index/posting_list.h"
 #include "page/index_roots_page.h"
 
 #include "utils/tree_file_mgr.h"
 
 BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
-                     int leaf_max_size, int internal_max_size)
+                     int leaf_max_size, int internal_max_size, bool compress_keys, bool unique, bool covering)
     : index_id_(index_id),
       buffer_pool_manager_(buffer_pool_manager),
       processor_(KM),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size)
+      internal_max_size_(internal_max_size),
+      compress_keys_(compress_keys),
+      unique_(unique),
+      covering_(unique && covering)
 {
+    // pages fill up by bytes, the size limits only matter when set explicitly
     if (leaf_max_size_ == UNDEFINED_SIZE)
-    {
-        size_t size = KM.GetKeySize() + sizeof(RowId);
-        leaf_max_size_ = PAGE_SIZE / size;
-    }
+        leaf_max_size_ = LEAF_PAGE_SIZE;
     if (internal_max_size_ == UNDEFINED_SIZE)
-    {
-        size_t size = KM.GetKeySize() + sizeof(page_id_t);
-        internal_max_size_ = PAGE_SIZE / size;
-    }
+        internal_max_size_ = INTERNAL_PAGE_SIZE;
     IndexRootsPage *index_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
     if (!index_page->GetRootId(index_id_, &root_page_id_))
     {
@@ -37,22 +36,48 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
     buffer_pool_manager_->UnpinPage(root_page_id_, true);
 }
 
-// TODO
+/*
+ * Free every page of the tree, overflow pages of the posting lists included
+ */
 void BPlusTree::Destroy(page_id_t current_page_id)
 {
-    if (current_page_id == INVALID_PAGE_ID)
+    bool whole_tree = current_page_id == INVALID_PAGE_ID;
+    if (whole_tree)
+    {
+        if (IsEmpty())
+            return;
         current_page_id = root_page_id_;
+    }
 
-    auto current_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(current_page_id));
-    buffer_pool_manager_->UnpinPage(current_page_id, false);
+    auto *current_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(current_page_id)->GetData());
     if (!current_page->IsLeafPage())
     {
-        for (int i = 0; i < current_page->GetSize(); i++)
+        auto *internal = reinterpret_cast<InternalPage *>(current_page);
+        for (int i = 0; i < internal->GetSize(); i++)
+        {
+            Destroy(internal->ValueAt(i));
+        }
+    }
+    else if (reinterpret_cast<LeafPage *>(current_page)->IsPostingPage())
+    {
+        auto *leaf = reinterpret_cast<LeafPage *>(current_page);
+        for (int i = 0; i < leaf->GetSize(); i++)
         {
-            Destroy(current_page->ValueAt(i));
+            int length;
+            const char *data = leaf->PostingAt(i, length);
+            PostingList(data, length, buffer_pool_manager_).Destroy();
         }
     }
+    buffer_pool_manager_->UnpinPage(current_page_id, false);
     buffer_pool_manager_->DeletePage(current_page_id);
+
+    if (whole_tree)
+    {
+        root_page_id_ = INVALID_PAGE_ID;
+        auto *roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+        roots->Delete(index_id_);
+        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+    }
 }
 
 /*
@@ -67,7 +92,7 @@ bool BPlusTree::IsEmpty() const
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that associated with input key, at most one in a unique tree
  * This method is used for point query
  * @return : true means key exists
  */
@@ -76,14 +101,62 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Tran
     if (IsEmpty())
         return false;
     LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
-    RowId rid;
-    bool res = leaf->Lookup(key, rid, processor_);
-    if (res)
-        result.push_back(rid);
+    bool res = LookupInLeaf(leaf, key, result);
     buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
     return res;
 }
 
+void BPlusTree::GetValues(const std::vector<GenericKey *> &keys, std::vector<std::vector<RowId>> &results,
+                          Transaction *transaction)
+{
+    results.assign(keys.size(), {});
+    if (IsEmpty())
+        return;
+    LeafPage *leaf = nullptr;
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        const GenericKey *key = keys[i];
+        // past the last key of the leaf, the key is on a later one: the next leaf if it holds
+        // a key at least as large, else only a descent can tell
+        if (leaf != nullptr && leaf->GetSize() > 0 && leaf->CompareAt(leaf->GetSize() - 1, key) < 0 &&
+            leaf->GetNextPageId() != INVALID_PAGE_ID)
+        {
+            auto next = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(leaf->GetNextPageId())->GetData());
+            buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+            leaf = next;
+            if (leaf->GetSize() == 0 || leaf->CompareAt(leaf->GetSize() - 1, key) < 0)
+            {
+                buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+                leaf = nullptr;
+            }
+        }
+        if (leaf == nullptr)
+            leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+        LookupInLeaf(leaf, key, results[i]);
+    }
+    if (leaf != nullptr)
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+}
+
+bool BPlusTree::LookupInLeaf(LeafPage *leaf, const GenericKey *key, std::vector<RowId> &result)
+{
+    if (unique_)
+    {
+        RowId rid;
+        if (!leaf->Lookup(key, rid))
+            return false;
+        result.push_back(rid);
+        return true;
+    }
+    int index = leaf->KeyIndex(key);
+    if (index >= leaf->GetSize() || leaf->CompareAt(index, key) != 0)
+        return false;
+    int length;
+    const char *data = leaf->PostingAt(index, length);
+    PostingList(data, length, buffer_pool_manager_).GetAll(result);
+    return true;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -91,17 +164,119 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Tran
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: false if the key is already there in a unique tree, or the pair is
+ * already there in a non-unique one, otherwise true.
  */
-bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transaction)
+bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transaction, const std::string &payload)
 {
     if (IsEmpty())
     {
-        StartNewTree(key, value);
+        StartNewTree(key, value, payload);
         return true;
     }
-    return InsertIntoLeaf(key, value);
+    return InsertIntoLeaf(key, value, transaction, payload);
+}
+
+/*
+ * Insert pairs sorted by key, merging them into the leaf chain: after a descent
+ * the following keys go straight into the same leaf as long as they are no
+ * greater than its last key, or it is the last leaf. Only a key past the leaf
+ * or a leaf without room (which is split) takes another descent. Uniqueness is
+ * checked in the leaf while merging, as Insert does.
+ */
+void BPlusTree::InsertBatch(const std::vector<GenericKey *> &keys, const std::vector<RowId> &values,
+                            const std::vector<std::string> &payloads, std::vector<bool> &inserted,
+                            Transaction *transaction)
+{
+    inserted.assign(keys.size(), false);
+    size_t i = 0;
+    if (!keys.empty() && IsEmpty())
+    {
+        StartNewTree(keys[0], values[0], payloads[0]);
+        inserted[0] = true;
+        i = 1;
+    }
+
+    LeafPage *leaf = nullptr;
+    while (i < keys.size())
+    {
+        GenericKey *key = keys[i];
+        if (leaf == nullptr)
+            leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+        else if (leaf->GetNextPageId() != INVALID_PAGE_ID &&
+                 (leaf->GetSize() == 0 || leaf->CompareAt(leaf->GetSize() - 1, key) < 0))
+        {
+            // the key may belong to a later leaf, only a descent can tell
+            buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+            leaf = nullptr;
+            continue;
+        }
+
+        bool stored;
+        if (unique_)
+        {
+            RowId rid;
+            if (leaf->Lookup(key, rid))
+            {
+                i++;
+                continue;
+            }
+            stored = leaf->Insert(key, values[i], payloads[i].data(), payloads[i].size());
+        }
+        else
+        {
+            int index = leaf->KeyIndex(key);
+            bool found = index < leaf->GetSize() && leaf->CompareAt(index, key) == 0;
+            int length = 0;
+            const char *data = found ? leaf->PostingAt(index, length) : nullptr;
+            PostingList posting(data, length, buffer_pool_manager_);
+            if (!posting.Insert(values[i]))
+            {
+                i++;
+                continue;
+            }
+            const std::string &list = posting.GetData();
+            stored = found ? leaf->SetPostingAt(index, list.data(), list.size())
+                           : leaf->InsertPosting(key, list.data(), list.size());
+        }
+
+        if (!stored)
+        {
+            // split like on insert, the separator decides which half the key goes to
+            LeafPage *sibling = Split(leaf, transaction);
+            buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+            buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+            leaf = nullptr;
+            continue;
+        }
+        inserted[i++] = true;
+    }
+    if (leaf != nullptr)
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+}
+
+/*
+ * Like Insert, but a key that is already there hands back its value instead,
+ * found by the same descent that would have placed the pair.
+ * @return: true if the pair was inserted, false if existing was set.
+ */
+bool BPlusTree::InsertOrGet(GenericKey *key, const RowId &value, RowId &existing, Transaction *transaction,
+                            const std::string &payload)
+{
+    ASSERT(unique_, "Only a unique tree maps a key to a single value.");
+    if (IsEmpty())
+    {
+        StartNewTree(key, value, payload);
+        return true;
+    }
+    return InsertIntoLeaf(key, value, transaction, payload, &existing);
+}
+
+LeafFormat BPlusTree::GetLeafFormat() const
+{
+    if (!unique_)
+        return LEAF_POSTING;
+    return covering_ ? LEAF_COVERING : LEAF_ROW_ID;
 }
 /*
  * Insert constant key & value pair into an empty tree
@@ -109,17 +284,24 @@ bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transac
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
  */
-void BPlusTree::StartNewTree(GenericKey *key, const RowId &value)
+void BPlusTree::StartNewTree(GenericKey *key, const RowId &value, const std::string &payload)
 {
     InternalPage *root = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(root_page_id_)->GetData());
     root->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
 
     page_id_t id;
     LeafPage *leaf = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(id)->GetData());
-    leaf->Init(id, root_page_id_, processor_.GetKeySize(), leaf_max_size_);
+    leaf->Init(id, root_page_id_, processor_.GetKeySize(), leaf_max_size_, compress_keys_, GetLeafFormat());
 
     root->SetValueAt(0, id);
-    leaf->Insert(key, value, processor_);
+    if (unique_)
+        leaf->Insert(key, value, payload.data(), payload.size());
+    else
+    {
+        PostingList posting(nullptr, 0, buffer_pool_manager_);
+        posting.Insert(value);
+        leaf->InsertPosting(key, posting.GetData().data(), posting.GetData().size());
+    }
     buffer_pool_manager_->UnpinPage(root_page_id_, true);
     buffer_pool_manager_->UnpinPage(id, true);
     UpdateRootPageId(true);
@@ -129,31 +311,122 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value)
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
+ * immediately, otherwise insert entry. When the leaf has no room left it is
+ * split and the key is routed again, since the separator decides its side.
  * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * keys return false, otherwise return true. The value found for a duplicate
+ * key of a unique tree goes to existing if given.
  */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction)
+bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction,
+                               const std::string &payload, RowId *existing)
 {
     LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+    if (!unique_)
+    {
+        int index = leaf->KeyIndex(key);
+        bool found = index < leaf->GetSize() && leaf->CompareAt(index, key) == 0;
+        int length = 0;
+        const char *data = found ? leaf->PostingAt(index, length) : nullptr;
+        PostingList posting(data, length, buffer_pool_manager_);
+        if (!posting.Insert(value))
+        {
+            buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+            return false;
+        }
+        StorePosting(leaf, key, posting.GetData(), transaction);
+        return true;
+    }
+
     RowId rid;
     //? already inserted
-    if (leaf->Lookup(key, rid, processor_))
+    if (leaf->Lookup(key, rid))
     {
         buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+        if (existing != nullptr)
+            *existing = rid;
         return false;
     }
 
-    leaf->Insert(key, value, processor_);
+    while (!leaf->Insert(key, value, payload.data(), payload.size()))
+    {
+        LeafPage *sibling = Split(leaf, transaction);
+        buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+        leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+    }
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+    return true;
+}
 
-    if (leaf->GetSize() == leaf_max_size_)
+/*
+ * Write the posting list of key into its record, adding the record if the key
+ * is new. A leaf without room is split like on insert. Unpins the leaf.
+ */
+void BPlusTree::StorePosting(LeafPage *leaf, const GenericKey *key, const std::string &posting,
+                             Transaction *transaction)
+{
+    while (true)
     {
-        LeafPage *sibling = Split(leaf, nullptr);
+        int index = leaf->KeyIndex(key);
+        bool stored = index < leaf->GetSize() && leaf->CompareAt(index, key) == 0
+                          ? leaf->SetPostingAt(index, posting.data(), posting.size())
+                          : leaf->InsertPosting(key, posting.data(), posting.size());
+        if (stored)
+            break;
+        LeafPage *sibling = Split(leaf, transaction);
+        buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+        leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+    }
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+}
 
-        sibling->SetNextPageId(leaf->GetNextPageId());
-        leaf->SetNextPageId(sibling->GetPageId());
+/*
+ * Read, change and write back the payload of key through one leaf. A leaf
+ * without room for the grown record is split like on insert.
+ */
+bool BPlusTree::UpdatePayload(GenericKey *key, const RowId &value, const std::function<bool(std::string &)> &update,
+                              Transaction *transaction)
+{
+    ASSERT(covering_, "Only a covering tree keeps payloads.");
+    std::string payload;
+    if (IsEmpty())
+    {
+        if (!update(payload))
+            return false;
+        if (!payload.empty())
+            StartNewTree(key, value, payload);
+        return true;
+    }
 
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+    int index = leaf->KeyIndex(key);
+    bool found = index < leaf->GetSize() && leaf->CompareAt(index, key) == 0;
+    if (found)
+    {
+        int length;
+        const char *data = leaf->PayloadAt(index, length);
+        payload.assign(data, length);
+    }
+    bool changed = update(payload);
+    if (!changed || (!found && payload.empty()))
+    {
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+        return changed;
+    }
+    if (payload.empty())
+    {
+        RemoveFromLeaf(leaf, index, transaction);
+        return true;
+    }
+    while (!(found ? leaf->SetPayloadAt(index, payload.data(), payload.size())
+                   : leaf->Insert(key, value, payload.data(), payload.size())))
+    {
+        LeafPage *sibling = Split(leaf, transaction);
         buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+        leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+        index = leaf->KeyIndex(key);
     }
     buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
     return true;
@@ -161,7 +434,6 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction
 
 /*
  * Split input page and return newly created page.
- * Using template N to represent either internal page or leaf page.
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
@@ -172,31 +444,65 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transac
     page_id_t id;
     InternalPage *sibling = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(id)->GetData());
     sibling->Init(id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
-    sibling->SetSize(0);
     node->MoveHalfTo(sibling, buffer_pool_manager_);
-    InsertIntoParent(node, sibling->KeyAt(0), sibling);
+    // the first key of the sibling moves up, its copy in slot 0 is never read again
+    GenericKey *key = processor_.InitKey();
+    GenericKey *empty = processor_.InitKey();
+    memset(empty, 0, processor_.GetKeySize());
+    sibling->KeyAt(0, key);
+    sibling->SetKeyAt(0, empty);
+    InsertIntoParent(node, key, sibling, transaction);
+    free(key);
+    free(empty);
     return sibling;
 }
 
+/*
+ * A leaf split pushes up the shortest key that still separates the two halves
+ * instead of the full first key of the new page.
+ */
 BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction)
 {
     page_id_t id;
     LeafPage *sibling = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(id)->GetData());
-    sibling->Init(id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
-    sibling->SetParentPageId(node->GetParentPageId());
+    sibling->Init(id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_, compress_keys_,
+                  GetLeafFormat());
     node->MoveHalfTo(sibling);
-    InsertIntoParent(node, sibling->KeyAt(0), sibling);
+    sibling->SetNextPageId(node->GetNextPageId());
+    node->SetNextPageId(sibling->GetPageId());
+
+    GenericKey *last = processor_.InitKey();
+    GenericKey *separator = processor_.InitKey();
+    node->KeyAt(node->GetSize() - 1, last);
+    sibling->KeyAt(0, separator);
+    if (compress_keys_)
+        TruncateSeparator(last, separator);
+    InsertIntoParent(node, separator, sibling, transaction);
+    free(last);
+    free(separator);
     return sibling;
 }
 
+/*
+ * Cut right down to the shortest key greater than left, which is still no
+ * greater than right: the bytes they share plus the first differing byte.
+ */
+void BPlusTree::TruncateSeparator(const GenericKey *left, GenericKey *right) const
+{
+    char *buf = reinterpret_cast<char *>(right);
+    int len = KeyManager::CommonPrefix(reinterpret_cast<const char *>(left), buf, processor_.GetKeySize()) + 1;
+    if (len < processor_.GetKeySize())
+        memset(buf + len, 0, processor_.GetKeySize() - len);
+}
+
 /*
  * Insert key & value pair into internal page after split
  * @param   old_node      input page from split() method
  * @param   key
  * @param   new_node      returned page from split() method
  * User needs to first find the parent page of old_node, parent node must be
- * adjusted to take info of new_node into account. Remember to deal with split
- * recursively if necessary.
+ * adjusted to take info of new_node into account. A parent without room is
+ * split first, the pair then goes to the half holding old_node.
  */
 void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                                  Transaction *transaction)
@@ -210,18 +516,22 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
         new_node->SetParentPageId(root_page_id_);
         buffer_pool_manager_->UnpinPage(root_page_id_, true);
         UpdateRootPageId(false);
+        return;
     }
-    else
+    InternalPage *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId())->GetData());
+    while (!parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId()))
     {
-        InternalPage *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId())->GetData());
-        parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-        if (parent->GetSize() == internal_max_size_)
+        InternalPage *sibling = Split(parent, transaction);
+        if (sibling->ValueIndex(old_node->GetPageId()) != -1)
         {
-            InternalPage *sibling = Split(parent, nullptr);
-            buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+            buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+            parent = sibling;
         }
-        buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+        else
+            buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
     }
+    new_node->SetParentPageId(parent->GetPageId());
+    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 
 /*****************************************************************************
@@ -232,7 +542,7 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  * If current tree is empty, return immediately.
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * necessary. In a non-unique tree the whole posting list of key goes away.
  */
 void BPlusTree::Remove(const GenericKey *key, Transaction *transaction)
 {
@@ -240,160 +550,244 @@ void BPlusTree::Remove(const GenericKey *key, Transaction *transaction)
         return;
 
     LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
-    RowId id;
-    if (leaf->Lookup(key, id, processor_))
+    int index = leaf->KeyIndex(key);
+    if (index == leaf->GetSize() || leaf->CompareAt(index, key) != 0)
     {
-        leaf->RemoveAndDeleteRecord(key, processor_);
-        if (leaf->GetSize() < leaf->GetMinSize())
-            if (CoalesceOrRedistribute(leaf))
-            {
-                buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false); // no need to write back
-                buffer_pool_manager_->DeletePage(leaf->GetPageId());
-                return;
-            }
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+        return;
+    }
+    if (!unique_)
+    {
+        int length;
+        const char *data = leaf->PostingAt(index, length);
+        PostingList(data, length, buffer_pool_manager_).Destroy();
+    }
+    RemoveFromLeaf(leaf, index, transaction);
+}
+
+/*
+ * Delete a single key & value pair, the key stays as long as other values
+ * share it. A unique tree drops the key whatever its value is.
+ */
+void BPlusTree::Remove(const GenericKey *key, const RowId &value, Transaction *transaction)
+{
+    if (unique_)
+    {
+        Remove(key, transaction);
+        return;
+    }
+    if (IsEmpty())
+        return;
+
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key)->GetData());
+    int index = leaf->KeyIndex(key);
+    if (index == leaf->GetSize() || leaf->CompareAt(index, key) != 0)
+    {
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+        return;
+    }
+    int length;
+    const char *data = leaf->PostingAt(index, length);
+    PostingList posting(data, length, buffer_pool_manager_);
+    if (!posting.Remove(value))
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    else if (posting.IsEmpty())
+        RemoveFromLeaf(leaf, index, transaction);
+    else // a list moving back from its overflow pages can grow the record
+        StorePosting(leaf, key, posting.GetData(), transaction);
+}
+
+/*
+ * Drop the record at "index" and rebalance the leaf if it underflows. Unpins the leaf.
+ */
+void BPlusTree::RemoveFromLeaf(LeafPage *leaf, int index, Transaction *transaction)
+{
+    leaf->Remove(index);
+    if (!leaf->IsRootPage() && leaf->IsUnderflow() && CoalesceOrRedistribute(leaf, transaction))
+    {
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false); // no need to write back
+        buffer_pool_manager_->DeletePage(leaf->GetPageId());
+        return;
     }
     buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
 }
 
-/* todo
- * User needs to first find the sibling of input page. If sibling's size + input
- * page's size > page's max size, then redistribute. Otherwise, merge.
+/*
+ * User needs to first find the sibling of input page. If both pages fit into
+ * one, merge them, otherwise redistribute. The right page is always merged into
+ * the left one, so the leaf chain never points to a deleted page.
  * Using template N to represent either internal page or leaf page.
- * @return: true means target leaf page should be deleted, false means no
+ * @return: true means target page should be deleted, false means no
  * deletion happens
  */
 template <typename N>
 bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction)
 {
     InternalPage *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
-    int index = parent->ValueIndex(node->GetPageId());
-    int sibling_index = index == 0 ? 1 : index - 1;
-
     //! no sibling
-    if (parent->ValueAt(sibling_index) == 0)
+    if (parent->GetSize() < 2)
     {
         buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
         return false;
     }
-
+    int index = parent->ValueIndex(node->GetPageId());
+    int sibling_index = index == 0 ? 1 : index - 1;
     N *sibling = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_index))->GetData());
+
     bool res = false;
-    if (node->GetSize() + sibling->GetSize() >= sibling->GetMaxSize())
+    bool merged = index == 0 ? Coalesce(node, sibling, parent, 1, transaction)
+                             : Coalesce(sibling, node, parent, index, transaction);
+    if (!merged)
     {
         Redistribute(sibling, node, index);
+        buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+    }
+    else if (index == 0)
+    {
+        buffer_pool_manager_->UnpinPage(sibling->GetPageId(), false);
+        buffer_pool_manager_->DeletePage(sibling->GetPageId());
     }
     else
     {
-        if (Coalesce(sibling, node, parent, index))
-            buffer_pool_manager_->DeletePage(parent->GetPageId());
+        buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
         res = true;
     }
+
+    // the parent lost a child
+    if (merged && ((parent->IsRootPage() && AdjustRoot(parent)) ||
+                   (!parent->IsRootPage() && parent->IsUnderflow() && CoalesceOrRedistribute(parent, transaction))))
+    {
+        buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
+        buffer_pool_manager_->DeletePage(parent->GetPageId());
+        return res;
+    }
     buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
     return res;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
+ * Move all the key & value pairs from the right page "node" to its left
+ * sibling, then drop it from the parent.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
+ * @param   neighbor_node      left sibling page of input "node"
+ * @param   node               right page, emptied by the merge
  * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * @param   index              index of node in parent
+ * @return  true means the pages were merged, false means they do not fit in one page
  */
 bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
                          Transaction *transaction)
 {
-    if (index == 0)
-    {
-        neighbor_node->MoveAllTo(node);
-        node->MoveAllTo(neighbor_node);
-    }
-    else
-        node->MoveAllTo(neighbor_node);
-
+    if (!node->MoveAllTo(neighbor_node))
+        return false;
     parent->Remove(index);
-    if (!parent->IsRootPage() && parent->GetSize() < parent->GetMinSize())
-        return CoalesceOrRedistribute(parent);
-    return false;
+    return true;
 }
 
 bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
                          Transaction *transaction)
 {
-    if (index == 0)
-    {
-        neighbor_node->MoveAllTo(node, parent->KeyAt(1), buffer_pool_manager_);
-        node->MoveAllTo(neighbor_node, parent->KeyAt(0), buffer_pool_manager_);
-    }
-    else
-        node->MoveAllTo(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
-
-    parent->Remove(index);
-    if (!parent->IsRootPage() && parent->GetSize() < parent->GetMinSize())
-        return CoalesceOrRedistribute(parent);
-    return false;
+    GenericKey *middle_key = processor_.InitKey();
+    parent->KeyAt(index, middle_key);
+    bool merged = node->MoveAllTo(neighbor_node, middle_key, buffer_pool_manager_);
+    free(middle_key);
+    if (merged)
+        parent->Remove(index);
+    return merged;
 }
 
 /*
  * Redistribute key & value pairs from one page to its sibling page. If index ==
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
- * "node".
- * Using template N to represent either internal page or leaf page.
+ * "node". The new separator is placed first, when the parent has no room for
+ * it the pages are left as they are.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()s
  */
 void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index)
 {
+    if (neighbor_node->GetSize() < 2)
+        return;
     InternalPage *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(neighbor_node->GetParentPageId())->GetData());
+    int parent_index = index == 0 ? 1 : index;
+    int moved_index = index == 0 ? 0 : neighbor_node->GetSize() - 1;
+    int remain_index = index == 0 ? 1 : neighbor_node->GetSize() - 2;
 
-    if (index == 0)
-    {
-        neighbor_node->MoveFirstToEndOf(node);
-        parent->SetKeyAt(1, neighbor_node->KeyAt(0));
-    }
-    else
+    GenericKey *left = processor_.InitKey();
+    GenericKey *separator = processor_.InitKey();
+    GenericKey *old_separator = processor_.InitKey();
+    neighbor_node->KeyAt(index == 0 ? moved_index : remain_index, left);
+    neighbor_node->KeyAt(index == 0 ? remain_index : moved_index, separator);
+    if (compress_keys_)
+        TruncateSeparator(left, separator);
+    parent->KeyAt(parent_index, old_separator);
+    if (parent->SetKeyAt(parent_index, separator))
     {
-        neighbor_node->MoveLastToFrontOf(node);
-        parent->SetKeyAt(index, node->KeyAt(0));
+        bool moved = index == 0 ? neighbor_node->MoveFirstToEndOf(node) : neighbor_node->MoveLastToFrontOf(node);
+        if (!moved)
+            parent->SetKeyAt(parent_index, old_separator);
     }
+    free(left);
+    free(separator);
+    free(old_separator);
     buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 
 void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index)
 {
+    if (neighbor_node->GetSize() < 2)
+        return;
     InternalPage *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(neighbor_node->GetParentPageId())->GetData());
+    int parent_index = index == 0 ? 1 : index;
 
-    if (index == 0)
-    {
-        neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
-        parent->SetKeyAt(1, neighbor_node->KeyAt(0));
-    }
-    else
+    GenericKey *middle_key = processor_.InitKey();
+    GenericKey *separator = processor_.InitKey();
+    GenericKey *empty = processor_.InitKey();
+    memset(empty, 0, processor_.GetKeySize());
+    parent->KeyAt(parent_index, middle_key);
+    neighbor_node->KeyAt(index == 0 ? 1 : neighbor_node->GetSize() - 1, separator);
+    if (parent->SetKeyAt(parent_index, separator))
     {
-        neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
-        parent->SetKeyAt(index, node->KeyAt(0));
+        bool moved = index == 0 ? neighbor_node->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_)
+                                : neighbor_node->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_);
+        if (!moved)
+            parent->SetKeyAt(parent_index, middle_key);
+        // the separator left behind in slot 0 is never read again
+        (index == 0 ? neighbor_node : node)->SetKeyAt(0, empty);
     }
+    free(middle_key);
+    free(separator);
+    free(empty);
     buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
  * called within coalesceOrRedistribute() method
- * case 1: when you delete the last element in root page, but root page still
- * has one last child
- * case 2: when you delete the last element in whole b+ tree
+ * When the root is left with a single internal child, that child becomes the
+ * new root. The root always stays an internal page above the leaves.
  * @return : true means root page should be deleted, false means no deletion
  * happened
  */
-// TODO
 bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node)
 {
-    return false;
+    if (old_root_node->IsLeafPage() || old_root_node->GetSize() != 1)
+        return false;
+    auto *old_root = reinterpret_cast<InternalPage *>(old_root_node);
+    page_id_t child_id = old_root->ValueAt(0);
+    auto *child = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(child_id)->GetData());
+    if (child->IsLeafPage())
+    {
+        buffer_pool_manager_->UnpinPage(child_id, false);
+        return false;
+    }
+    old_root->RemoveAndReturnOnlyChild();
+    child->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(child_id, true);
+    root_page_id_ = child_id;
+    UpdateRootPageId(false);
+    return true;
 }
 
 /*****************************************************************************
@@ -406,6 +800,8 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node)
  */
 IndexIterator BPlusTree::Begin()
 {
+    if (IsEmpty())
+        return End();
     LeafPage *page = reinterpret_cast<LeafPage *>(FindLeafPage(nullptr, -1, true));
     buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
     return IndexIterator(page->GetPageId(), buffer_pool_manager_);
@@ -418,12 +814,12 @@ IndexIterator BPlusTree::Begin()
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key)
 {
+    if (IsEmpty())
+        return End();
     LeafPage *page = reinterpret_cast<LeafPage *>(FindLeafPage(key));
     buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    int index = page->KeyIndex(key, processor_);
-    if (index < page->GetSize())
-        return IndexIterator(page->GetPageId(), buffer_pool_manager_, index);
-    return IndexIterator();
+    // an index past the last pair makes the iterator continue on the next leaf
+    return IndexIterator(page->GetPageId(), buffer_pool_manager_, page->KeyIndex(key));
 }
 
 /*
@@ -454,7 +850,7 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
     while (page_ptr != nullptr && !page_ptr->IsLeafPage())
     {
         buffer_pool_manager_->UnpinPage(page_ptr->GetPageId(), false);
-        page_id_t next_page_id = leftMost ? page_ptr->ValueAt(0) : page_ptr->Lookup(key, processor_);
+        page_id_t next_page_id = leftMost ? page_ptr->ValueAt(0) : page_ptr->Lookup(key);
         page_ptr = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
     }
 
@@ -479,6 +875,23 @@ void BPlusTree::UpdateRootPageId(int insert_record)
     buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
+/**
+ * Keys are normalized bytes, print them as hex with the zero padding dropped
+ */
+static std::string KeyToString(const BPlusTreePage *page, const GenericKey *key)
+{
+    static const char *digits = "0123456789abcdef";
+    const char *data = reinterpret_cast<const char *>(key);
+    int len = KeyManager::KeyLength(data, page->GetKeySize());
+    std::string res;
+    for (int i = 0; i < len; i++)
+    {
+        res += digits[(data[i] >> 4) & 0xf];
+        res += digits[data[i] & 0xf];
+    }
+    return res;
+}
+
 /**
  * This method is used for debug only, You don't need to modify
  */
@@ -486,6 +899,7 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
 {
     std::string leaf_prefix("LEAF_");
     std::string internal_prefix("INT_");
+    GenericKey *key = processor_.InitKey();
     if (page->IsLeafPage())
     {
         auto *leaf = reinterpret_cast<LeafPage *>(page);
@@ -504,7 +918,8 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         out << "<TR>";
         for (int i = 0; i < leaf->GetSize(); i++)
         {
-            out << "<TD>" << leaf->KeyAt(i) << "</TD>\n";
+            leaf->KeyAt(i, key);
+            out << "<TD>" << KeyToString(leaf, key) << "</TD>\n";
         }
         out << "</TR>";
         // Print table end
@@ -544,7 +959,8 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
             out << "<TD PORT=\"p" << inner->ValueAt(i) << "\">";
             if (i > 0)
             {
-                out << inner->KeyAt(i);
+                inner->KeyAt(i, key);
+                out << KeyToString(inner, key);
             }
             else
             {
@@ -578,6 +994,7 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
             }
         }
     }
+    free(key);
     bpm->UnpinPage(page->GetPageId(), false);
 }
 
@@ -586,6 +1003,7 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
  */
 void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
 {
+    GenericKey *key = processor_.InitKey();
     if (page->IsLeafPage())
     {
         auto *leaf = reinterpret_cast<LeafPage *>(page);
@@ -593,7 +1011,8 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
                   << " next: " << leaf->GetNextPageId() << std::endl;
         for (int i = 0; i < leaf->GetSize(); i++)
         {
-            std::cout << leaf->KeyAt(i) << ",";
+            leaf->KeyAt(i, key);
+            std::cout << KeyToString(leaf, key) << ",";
         }
         std::cout << std::endl;
         std::cout << std::endl;
@@ -604,7 +1023,8 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
         std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
         for (int i = 0; i < internal->GetSize(); i++)
         {
-            std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
+            internal->KeyAt(i, key);
+            std::cout << KeyToString(internal, key) << ": " << internal->ValueAt(i) << ",";
         }
         std::cout << std::endl;
         std::cout << std::endl;
@@ -614,6 +1034,7 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
             bpm->UnpinPage(internal->ValueAt(i), false);
         }
     }
+    free(key);
 }
 
 bool BPlusTree::Check()
@@ -1,21 +1,67 @@
-#include <algorithm>
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
+namespace {
+/**
+ * The included columns of an entry, laid out as
+ *  -----------------------------------------------
+ * | NullBitmap (ceil(n / 8)) | Field(0) | ... |
+ *  -----------------------------------------------
+ * where the fields come from the entry right after the key columns.
+ */
+std::string EncodePayload(const Row &entry, uint32_t key_count, Schema *include_schema) {
+  uint32_t count = include_schema->GetColumnCount();
+  ASSERT(entry.GetFieldCount() == key_count + count, "The entry must hold the included columns.");
+  std::string payload((count + 7) / 8, 0);
+  for (uint32_t i = 0; i < count; i++) {
+    const Field *field = entry.GetField(key_count + i);
+    if (field->IsNull()) {
+      continue;
+    }
+    payload[i / 8] |= static_cast<char>(1 << (i % 8));
+    size_t ofs = payload.size();
+    payload.resize(ofs + field->GetSerializedSize());
+    field->SerializeTo(payload.data() + ofs);
+  }
+  return payload;
+}
+
+/** Append the included columns stored in payload to the fields of entry */
+void DecodePayload(const char *payload, Schema *include_schema, Row *entry) {
+  uint32_t count = include_schema->GetColumnCount();
+  const char *buf = payload + (count + 7) / 8;
+  for (uint32_t i = 0; i < count; i++) {
+    Field *field;
+    bool is_null = !(payload[i / 8] & (1 << (i % 8)));
+    buf += Field::DeserializeFrom(const_cast<char *>(buf), include_schema->GetColumn(i)->GetType(), &field, is_null);
+    entry->GetFields().push_back(field);
+  }
+}
+}  // namespace
+
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool unique, IndexSchema *include_schema)
     : Index(index_id, key_schema),
       processor_(key_schema_, key_size),
-      container_(index_id, buffer_pool_manager, processor_) {}
+      include_schema_(unique ? include_schema : nullptr),
+      container_(index_id, buffer_pool_manager, processor_, UNDEFINED_SIZE, UNDEFINED_SIZE, true, unique,
+                 include_schema_ != nullptr) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
-  bool status = container_.Insert(index_key, row_id, txn);
-  delete index_key;
+  std::string payload;
+  if (include_schema_ != nullptr) {
+    payload = EncodePayload(key, key_schema_->GetColumnCount(), include_schema_);
+  }
+  bool status = container_.Insert(index_key, row_id, txn, payload);
+  free(index_key);
   //  TreeFileManagers mgr("tree_");
   //  static int i = 0;
   //  if (i % 10 == 0) container_.PrintTree(mgr[i]);
@@ -27,56 +73,231 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *t
   return DB_SUCCESS;
 }
 
+dberr_t BPlusTreeIndex::InsertOrGetEntry(const Row &key, RowId row_id, RowId *existing, Transaction *txn) {
+  if (!container_.IsUnique()) {
+    return Index::InsertOrGetEntry(key, row_id, existing, txn);
+  }
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  std::string payload;
+  if (include_schema_ != nullptr) {
+    payload = EncodePayload(key, key_schema_->GetColumnCount(), include_schema_);
+  }
+  bool inserted = container_.InsertOrGet(index_key, row_id, *existing, txn, payload);
+  free(index_key);
+  return inserted ? DB_SUCCESS : DB_ALREADY_EXIST;
+}
+
+void BPlusTreeIndex::InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids,
+                                   std::vector<bool> &inserted, Transaction *txn) {
+  std::vector<GenericKey *> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i] = processor_.InitKey();
+    processor_.SerializeFromKey(index_keys[i], keys[i], key_schema_);
+  }
+  // stable, so a key repeated in the batch is inserted for its first row
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return processor_.CompareKeys(index_keys[a], index_keys[b]) < 0;
+  });
+
+  std::vector<GenericKey *> sorted_keys;
+  std::vector<RowId> sorted_ids;
+  std::vector<std::string> payloads;
+  for (size_t i : order) {
+    sorted_keys.push_back(index_keys[i]);
+    sorted_ids.push_back(row_ids[i]);
+    payloads.push_back(include_schema_ != nullptr
+                           ? EncodePayload(keys[i], key_schema_->GetColumnCount(), include_schema_)
+                           : std::string());
+  }
+  std::vector<bool> sorted_inserted;
+  container_.InsertBatch(sorted_keys, sorted_ids, payloads, sorted_inserted, txn);
+
+  inserted.assign(keys.size(), false);
+  for (size_t i = 0; i < order.size(); i++) {
+    inserted[order[i]] = sorted_inserted[i];
+  }
+  for (GenericKey *index_key : index_keys) {
+    free(index_key);
+  }
+}
+
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
-  container_.Remove(index_key, txn);
-  delete index_key;
+  container_.Remove(index_key, row_id, txn);
+  free(index_key);
   return DB_SUCCESS;
 }
 
+namespace {
+/**
+ * Walks the leaf chain from the lower bound and stops at the first key past the
+ * upper bound. Bounds are kept in serialized form so each step costs one compare.
+ */
+class BPlusTreeScanCursor : public IndexScanCursor {
+ public:
+  BPlusTreeScanCursor(IndexIterator &&iter, const KeyManager &processor, Schema *key_schema, Schema *include_schema,
+                      GenericKey *lower, int lower_length, bool lower_inclusive, GenericKey *upper, int upper_length,
+                      bool upper_inclusive)
+      : iter_(std::move(iter)),
+        processor_(processor),
+        key_schema_(key_schema),
+        include_schema_(include_schema),
+        lower_(lower),
+        lower_length_(lower_length),
+        lower_inclusive_(lower_inclusive),
+        upper_(upper),
+        upper_length_(upper_length),
+        upper_inclusive_(upper_inclusive) {}
+
+  ~BPlusTreeScanCursor() override {
+    free(lower_);
+    free(upper_);
+  }
+
+  bool Next(RowId *rid) override { return Fetch(rid, nullptr); }
+
+  bool NextEntry(RowId *rid, Row *entry) override { return Fetch(rid, entry); }
+
+ private:
+  bool Fetch(RowId *rid, Row *row) {
+    while (!iter_.IsEnd()) {
+      auto entry = *iter_;
+      // an exclusive lower bound only has to skip the keys equal to it, which come first
+      if (lower_ != nullptr && !lower_inclusive_) {
+        if (processor_.ComparePrefix(entry.first, lower_, lower_length_) == 0) {
+          ++iter_;
+          continue;
+        }
+        free(lower_);
+        lower_ = nullptr;
+      }
+      if (upper_ != nullptr) {
+        int cmp = processor_.ComparePrefix(entry.first, upper_, upper_length_);
+        if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+          iter_ = IndexIterator();
+          return false;
+        }
+      }
+      *rid = entry.second;
+      if (row != nullptr) {
+        // keys are stored in a form that decodes back to the column values
+        processor_.DeserializeToKey(entry.first, *row, key_schema_);
+        if (include_schema_ != nullptr) {
+          int length;
+          DecodePayload(iter_.Payload(length), include_schema_, row);
+        }
+        row->SetRowId(entry.second);
+      }
+      ++iter_;
+      return true;
+    }
+    return false;
+  }
+
+  IndexIterator iter_;
+  const KeyManager &processor_;
+  Schema *key_schema_;
+  Schema *include_schema_;
+  GenericKey *lower_;
+  int lower_length_;
+  bool lower_inclusive_;
+  GenericKey *upper_;
+  int upper_length_;
+  bool upper_inclusive_;
+};
+}  // namespace
+
+std::unique_ptr<IndexScanCursor> BPlusTreeIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                      bool upper_inclusive, Transaction *txn) {
+  GenericKey *lower_key = nullptr;
+  GenericKey *upper_key = nullptr;
+  int lower_length = 0;
+  int upper_length = 0;
+  if (upper != nullptr) {
+    upper_key = processor_.InitKey();
+    upper_length = processor_.SerializePrefix(upper_key, *upper, key_schema_);
+  }
+  if (lower == nullptr) {
+    return std::make_unique<BPlusTreeScanCursor>(GetBeginIterator(), processor_, key_schema_, include_schema_, nullptr,
+                                                 0, true, upper_key, upper_length, upper_inclusive);
+  }
+  lower_key = processor_.InitKey();
+  lower_length = processor_.SerializePrefix(lower_key, *lower, key_schema_);
+  // the zero padding of a partial bound sorts before every key sharing its prefix
+  IndexIterator iter = GetBeginIterator(lower_key);
+  return std::make_unique<BPlusTreeScanCursor>(std::move(iter), processor_, key_schema_, include_schema_, lower_key,
+                                               lower_length, lower_inclusive, upper_key, upper_length,
+                                               upper_inclusive);
+}
+
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
-  GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
   if (compare_operator == "=") {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeFromKey(index_key, key, key_schema_);
     container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == ">") {
-    auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn))
-      ++iter;
-    result.clear();
-    for (; iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-  } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
+    free(index_key);
+  } else {
+    std::vector<std::unique_ptr<IndexScanCursor>> cursors;
+    if (compare_operator == ">") {
+      cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+    } else if (compare_operator == ">=") {
+      cursors.emplace_back(Scan(&key, true, nullptr, false, txn));
+    } else if (compare_operator == "<") {
+      cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+    } else if (compare_operator == "<=") {
+      cursors.emplace_back(Scan(nullptr, false, &key, true, txn));
+    } else if (compare_operator == "<>") {
+      cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+      cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
     }
-  } else if (compare_operator == "<") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
+    RowId rid;
+    for (auto &cursor : cursors) {
+      while (cursor->Next(&rid)) {
+        result.emplace_back(rid);
+      }
     }
-  } else if (compare_operator == "<=") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == "<>") {
-    for (auto iter = GetBeginIterator(); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
   }
-  delete index_key;
   if (!result.empty())
     return DB_SUCCESS;
   else
     return DB_KEY_NOT_FOUND;
 }
 
+void BPlusTreeIndex::ScanKeys(const std::vector<Row> &keys, std::vector<std::vector<RowId>> &results,
+                              Transaction *txn) {
+  std::vector<GenericKey *> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i] = processor_.InitKey();
+    processor_.SerializeFromKey(index_keys[i], keys[i], key_schema_);
+  }
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return processor_.CompareKeys(index_keys[a], index_keys[b]) < 0;
+  });
+
+  std::vector<GenericKey *> sorted_keys;
+  sorted_keys.reserve(keys.size());
+  for (size_t i : order) {
+    sorted_keys.push_back(index_keys[i]);
+  }
+  std::vector<std::vector<RowId>> sorted_results;
+  container_.GetValues(sorted_keys, sorted_results, txn);
+
+  results.assign(keys.size(), {});
+  for (size_t i = 0; i < order.size(); i++) {
+    results[order[i]] = std::move(sorted_results[i]);
+  }
+  for (GenericKey *index_key : index_keys) {
+    free(index_key);
+  }
+}
+
 dberr_t BPlusTreeIndex::Destroy() {
   container_.Destroy();
   return DB_SUCCESS;
@@ -0,0 +1,229 @@
+#include "index/bitmap_index.h"
+
+#include <cstring>
+
+namespace {
+/**
+ * Walks the entries of the key range one heap page at a time. Bounds only cover the
+ * key columns, so they are compared on their serialized length and every page of a
+ * matching key is in range.
+ */
+class BitmapScanCursor : public IndexScanCursor {
+ public:
+  BitmapScanCursor(const KeyManager &processor, IndexIterator &&iter, GenericKey *lower, int lower_length,
+                   bool lower_inclusive, GenericKey *upper, int upper_length, bool upper_inclusive)
+      : processor_(processor),
+        iter_(std::move(iter)),
+        lower_(lower),
+        lower_length_(lower_length),
+        lower_inclusive_(lower_inclusive),
+        upper_(upper),
+        upper_length_(upper_length),
+        upper_inclusive_(upper_inclusive) {}
+
+  ~BitmapScanCursor() override {
+    free(lower_);
+    free(upper_);
+  }
+
+  bool Next(RowId *rid) override {
+    while (pos_ == slots_.size()) {
+      std::vector<uint64_t> words;
+      if (!NextPage(page_id_, words)) {
+        return false;
+      }
+      slots_.clear();
+      pos_ = 0;
+      for (size_t i = 0; i < words.size(); i++) {
+        for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+          slots_.push_back(i * 64 + __builtin_ctzll(word));
+        }
+      }
+    }
+    *rid = RowId(page_id_, slots_[pos_++]);
+    return true;
+  }
+
+  void CollectRowIds(RowIdBitmap *bitmap) override {
+    while (pos_ < slots_.size()) {
+      bitmap->Add(RowId(page_id_, slots_[pos_++]));
+    }
+    page_id_t page_id;
+    std::vector<uint64_t> words;
+    while (NextPage(page_id, words)) {
+      bitmap->AddPage(page_id, words.data(), words.size());
+    }
+  }
+
+ private:
+  bool NextPage(page_id_t &page_id, std::vector<uint64_t> &words) {
+    while (!iter_.IsEnd()) {
+      auto entry = *iter_;
+      // an exclusive lower bound only has to skip the entries of the key equal to it, which come first
+      if (lower_ != nullptr && !lower_inclusive_) {
+        if (processor_.ComparePrefix(entry.first, lower_, lower_length_) == 0) {
+          ++iter_;
+          continue;
+        }
+        free(lower_);
+        lower_ = nullptr;
+      }
+      if (upper_ != nullptr) {
+        int cmp = processor_.ComparePrefix(entry.first, upper_, upper_length_);
+        if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+          iter_ = IndexIterator();
+          return false;
+        }
+      }
+      page_id = entry.second.GetPageId();
+      int length;
+      const char *payload = iter_.Payload(length);
+      words.assign(length / sizeof(uint64_t), 0);
+      memcpy(words.data(), payload, words.size() * sizeof(uint64_t));
+      ++iter_;
+      return true;
+    }
+    return false;
+  }
+
+  const KeyManager &processor_;
+  IndexIterator iter_;
+  GenericKey *lower_;
+  int lower_length_;
+  bool lower_inclusive_;
+  GenericKey *upper_;
+  int upper_length_;
+  bool upper_inclusive_;
+  /** Slots of the current page not handed out yet */
+  std::vector<uint32_t> slots_;
+  size_t pos_{0};
+  page_id_t page_id_{INVALID_PAGE_ID};
+};
+}  // namespace
+
+BitmapIndex::BitmapIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager)
+    : Index(index_id, key_schema),
+      entry_schema_(MakeEntrySchema(key_schema)),
+      processor_(entry_schema_, KeyManager::GetMaxKeyLength(entry_schema_)),
+      container_(index_id, buffer_pool_manager, processor_, UNDEFINED_SIZE, UNDEFINED_SIZE, true, true, true) {}
+
+BitmapIndex::~BitmapIndex() { delete entry_schema_; }
+
+Schema *BitmapIndex::MakeEntrySchema(const IndexSchema *key_schema) {
+  std::vector<Column *> columns;
+  for (auto col : key_schema->GetColumns()) {
+    columns.push_back(new Column(col));
+  }
+  columns.push_back(new Column("page_id", TypeId::kTypeInt, columns.size(), false, false));
+  return new Schema(columns, true);
+}
+
+GenericKey *BitmapIndex::MakeEntryKey(const Row &key, page_id_t page_id) const {
+  std::vector<Field> fields;
+  for (uint32_t i = 0; i < key_schema_->GetColumnCount(); i++) {
+    fields.emplace_back(*key.GetField(i));
+  }
+  fields.emplace_back(TypeId::kTypeInt, static_cast<int32_t>(page_id));
+  Row entry(fields);
+  GenericKey *entry_key = processor_.InitKey();
+  processor_.SerializeFromKey(entry_key, entry, entry_schema_);
+  return entry_key;
+}
+
+bool BitmapIndex::SetSlot(std::string &payload, uint32_t slot, bool set) {
+  size_t offset = slot / 64 * sizeof(uint64_t);
+  uint64_t bit = 1ull << (slot % 64);
+  if (payload.size() <= offset) {
+    if (!set) {
+      return false;
+    }
+    payload.resize(offset + sizeof(uint64_t), 0);
+  }
+  uint64_t word;
+  memcpy(&word, payload.data() + offset, sizeof(uint64_t));
+  if (((word & bit) != 0) == set) {
+    return false;
+  }
+  word ^= bit;
+  memcpy(payload.data() + offset, &word, sizeof(uint64_t));
+  // trailing zero words are dropped, an empty bitset takes the entry away
+  while (!payload.empty()) {
+    memcpy(&word, payload.data() + payload.size() - sizeof(uint64_t), sizeof(uint64_t));
+    if (word != 0) {
+      break;
+    }
+    payload.resize(payload.size() - sizeof(uint64_t));
+  }
+  return true;
+}
+
+dberr_t BitmapIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  GenericKey *entry_key = MakeEntryKey(key, row_id.GetPageId());
+  uint32_t slot = row_id.GetSlotNum();
+  bool inserted = container_.UpdatePayload(
+      entry_key, RowId(row_id.GetPageId(), 0), [slot](std::string &payload) { return SetSlot(payload, slot, true); },
+      txn);
+  free(entry_key);
+  return inserted ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t BitmapIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  GenericKey *entry_key = MakeEntryKey(key, row_id.GetPageId());
+  uint32_t slot = row_id.GetSlotNum();
+  container_.UpdatePayload(
+      entry_key, RowId(row_id.GetPageId(), 0), [slot](std::string &payload) { return SetSlot(payload, slot, false); },
+      txn);
+  free(entry_key);
+  return DB_SUCCESS;
+}
+
+std::unique_ptr<IndexScanCursor> BitmapIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                   bool upper_inclusive, Transaction *txn) {
+  // bounds never carry the page id, they are prefixes of the entry keys
+  GenericKey *lower_key = nullptr;
+  GenericKey *upper_key = nullptr;
+  int lower_length = 0;
+  int upper_length = 0;
+  if (upper != nullptr) {
+    upper_key = processor_.InitKey();
+    upper_length = processor_.SerializePrefix(upper_key, *upper, key_schema_);
+  }
+  if (lower == nullptr) {
+    return std::make_unique<BitmapScanCursor>(processor_, container_.Begin(), nullptr, 0, true, upper_key,
+                                              upper_length, upper_inclusive);
+  }
+  lower_key = processor_.InitKey();
+  lower_length = processor_.SerializePrefix(lower_key, *lower, key_schema_);
+  return std::make_unique<BitmapScanCursor>(processor_, container_.Begin(lower_key), lower_key, lower_length,
+                                            lower_inclusive, upper_key, upper_length, upper_inclusive);
+}
+
+dberr_t BitmapIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
+  std::vector<std::unique_ptr<IndexScanCursor>> cursors;
+  if (compare_operator == "=") {
+    cursors.emplace_back(Scan(&key, true, &key, true, txn));
+  } else if (compare_operator == ">") {
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    cursors.emplace_back(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    cursors.emplace_back(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  }
+  RowId rid;
+  for (auto &cursor : cursors) {
+    while (cursor->Next(&rid)) {
+      result.emplace_back(rid);
+    }
+  }
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+dberr_t BitmapIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
@@ -0,0 +1,510 @@
+#include "index/extendible_hash_index.h"
+
+#include "page/index_roots_page.h"
+
+ExtendibleHashIndex::ExtendibleHashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                                         BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema),
+      processor_(key_schema_, key_size),
+      buffer_pool_manager_(buffer_pool_manager),
+      unique_(unique) {
+  auto *roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  if (!roots->GetRootId(index_id_, &header_page_id_)) {
+    header_page_id_ = INVALID_PAGE_ID;
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+}
+
+/**
+ * FNV-1a over the key without its zero padding, then a final mix so the low
+ * bits used by the directory are as good as the high ones used by the header.
+ */
+uint32_t ExtendibleHashIndex::Hash(const GenericKey *key) const {
+  const char *buf = reinterpret_cast<const char *>(key);
+  int len = KeyManager::KeyLength(buf, processor_.GetKeySize());
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i = 0; i < len; i++) {
+    hash ^= static_cast<uint8_t>(buf[i]);
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return static_cast<uint32_t>(hash);
+}
+
+HashBucketPage *ExtendibleHashIndex::NewBucket(page_id_t &page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw std::runtime_error("out of memory");
+  }
+  auto *bucket = reinterpret_cast<HashBucketPage *>(page->GetData());
+  bucket->Init(processor_.GetKeySize());
+  return bucket;
+}
+
+page_id_t ExtendibleHashIndex::FindDirectory(uint32_t hash, bool create) {
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    if (!create) {
+      return INVALID_PAGE_ID;
+    }
+    auto *header = reinterpret_cast<HashHeaderPage *>(buffer_pool_manager_->NewPage(header_page_id_)->GetData());
+    header->Init();
+    buffer_pool_manager_->UnpinPage(header_page_id_, true);
+    auto *roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    roots->Insert(index_id_, header_page_id_);
+    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  }
+  auto *header = reinterpret_cast<HashHeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id_)->GetData());
+  uint32_t index = HashHeaderPage::HashToDirectoryIndex(hash);
+  page_id_t directory_page_id = header->GetDirectoryPageId(index);
+  if (directory_page_id == INVALID_PAGE_ID && create) {
+    page_id_t bucket_page_id;
+    NewBucket(bucket_page_id);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    auto *directory =
+        reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->NewPage(directory_page_id)->GetData());
+    directory->Init(bucket_page_id);
+    buffer_pool_manager_->UnpinPage(directory_page_id, true);
+    header->SetDirectoryPageId(index, directory_page_id);
+    buffer_pool_manager_->UnpinPage(header_page_id_, true);
+    return directory_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  return directory_page_id;
+}
+
+void ExtendibleHashIndex::InsertIntoChain(page_id_t bucket_page_id, const GenericKey *key, const RowId &value) {
+  while (true) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+    if (bucket->Insert(key, value)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      return;
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      NewBucket(next_page_id)->Insert(key, value);
+      buffer_pool_manager_->UnpinPage(next_page_id, true);
+      bucket->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      return;
+    }
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    bucket_page_id = next_page_id;
+  }
+}
+
+bool ExtendibleHashIndex::Insert(const GenericKey *key, const RowId &value) {
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = FindDirectory(hash, true);
+  auto *directory = reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id)->GetData());
+  bool dirty = false;
+  while (true) {
+    uint32_t index = directory->HashToBucketIndex(hash);
+    page_id_t bucket_page_id = directory->GetBucketPageId(index);
+    // look for the key, room for it and whether more hash bits could tell the pairs apart
+    bool has_room = false;
+    bool same_hash = true;
+    for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+      auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      for (int i = 0; i < bucket->GetSize(); i++) {
+        if (processor_.CompareKeys(bucket->KeyAt(i), key) == 0) {
+          if (unique_ || bucket->ValueAt(i) == value) {
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            buffer_pool_manager_->UnpinPage(directory_page_id, dirty);
+            return false;
+          }
+        } else if (same_hash && Hash(bucket->KeyAt(i)) != hash) {
+          same_hash = false;
+        }
+      }
+      has_room |= !bucket->IsFull();
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    bool can_split = directory->GetLocalDepth(index) < directory->GetGlobalDepth() || directory->CanGrow();
+    if (has_room || same_hash || !can_split) {
+      InsertIntoChain(bucket_page_id, key, value);
+      break;
+    }
+    SplitBucket(directory, index);
+    dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id, dirty);
+  return true;
+}
+
+void ExtendibleHashIndex::SplitBucket(HashDirectoryPage *directory, uint32_t index) {
+  uint32_t depth = directory->GetLocalDepth(index);
+  if (depth == directory->GetGlobalDepth()) {
+    directory->IncrGlobalDepth();
+  }
+  page_id_t old_page_id = directory->GetBucketPageId(index);
+
+  // take every pair out of the chain, only the first bucket is kept
+  std::vector<char> keys;
+  std::vector<RowId> values;
+  int key_size = processor_.GetKeySize();
+  for (page_id_t page_id = old_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      const char *key = reinterpret_cast<const char *>(bucket->KeyAt(i));
+      keys.insert(keys.end(), key, key + key_size);
+      values.push_back(bucket->ValueAt(i));
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (page_id == old_page_id) {
+      bucket->Init(key_size);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    } else {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    page_id = next_page_id;
+  }
+
+  page_id_t new_page_id;
+  NewBucket(new_page_id);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  for (uint32_t i = 0; i < directory->GetSize(); i++) {
+    if (directory->GetBucketPageId(i) == old_page_id) {
+      directory->SetLocalDepth(i, depth + 1);
+      if ((i >> depth) & 1) {
+        directory->SetBucketPageId(i, new_page_id);
+      }
+    }
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    auto *key = reinterpret_cast<GenericKey *>(keys.data() + i * key_size);
+    InsertIntoChain((Hash(key) >> depth) & 1 ? new_page_id : old_page_id, key, values[i]);
+  }
+}
+
+bool ExtendibleHashIndex::Remove(const GenericKey *key, const RowId &value) {
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = FindDirectory(hash, false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto *directory = reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id)->GetData());
+  uint32_t index = directory->HashToBucketIndex(hash);
+  page_id_t first_page_id = directory->GetBucketPageId(index);
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  bool dirty = false;
+  bool found = false;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID && !found;) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      if (processor_.CompareKeys(bucket->KeyAt(i), key) == 0 && (unique_ || bucket->ValueAt(i) == value)) {
+        bucket->RemoveAt(i);
+        found = true;
+        break;
+      }
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (!found || bucket->GetSize() > 0) {
+      buffer_pool_manager_->UnpinPage(page_id, found);
+    } else if (prev_page_id != INVALID_PAGE_ID) {
+      // drop the empty overflow bucket from the chain
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      auto *prev = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(prev_page_id)->GetData());
+      prev->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    } else if (next_page_id != INVALID_PAGE_ID) {
+      // the first bucket takes over the content of the second one
+      auto *next = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+      memcpy(reinterpret_cast<char *>(bucket), reinterpret_cast<char *>(next), PAGE_SIZE);
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      buffer_pool_manager_->DeletePage(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    } else {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      MergeBucket(directory, index);
+      dirty = true;
+    }
+    prev_page_id = page_id;
+    page_id = next_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id, dirty);
+  return found;
+}
+
+void ExtendibleHashIndex::MergeBucket(HashDirectoryPage *directory, uint32_t index) {
+  uint32_t depth = directory->GetLocalDepth(index);
+  if (depth == 0) {
+    return;
+  }
+  uint32_t image = directory->GetSplitImageIndex(index);
+  if (directory->GetLocalDepth(image) != depth) {
+    return;
+  }
+  page_id_t empty_page_id = directory->GetBucketPageId(index);
+  page_id_t image_page_id = directory->GetBucketPageId(image);
+  for (uint32_t i = 0; i < directory->GetSize(); i++) {
+    page_id_t page_id = directory->GetBucketPageId(i);
+    if (page_id == empty_page_id || page_id == image_page_id) {
+      directory->SetBucketPageId(i, image_page_id);
+      directory->SetLocalDepth(i, depth - 1);
+    }
+  }
+  buffer_pool_manager_->DeletePage(empty_page_id);
+  while (directory->CanShrink()) {
+    directory->DecrGlobalDepth();
+  }
+}
+
+bool ExtendibleHashIndex::Lookup(const GenericKey *key, std::vector<RowId> &result) {
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = FindDirectory(hash, false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto *directory = reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id)->GetData());
+  page_id_t page_id = directory->GetBucketPageId(directory->HashToBucketIndex(hash));
+  buffer_pool_manager_->UnpinPage(directory_page_id, false);
+  size_t size = result.size();
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      if (processor_.CompareKeys(bucket->KeyAt(i), key) == 0) {
+        result.push_back(bucket->ValueAt(i));
+      }
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return result.size() > size;
+}
+
+dberr_t ExtendibleHashIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  bool status = Insert(index_key, row_id);
+  free(index_key);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t ExtendibleHashIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  Remove(index_key, row_id);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+namespace {
+/**
+ * Either hands out the row ids of a single key, or walks every bucket once and
+ * keeps the pairs within the bounds. Buckets are read one chain at a time.
+ */
+class HashScanCursor : public IndexScanCursor {
+ public:
+  /** Cursor over the row ids found by a point lookup */
+  explicit HashScanCursor(std::vector<RowId> &&rids) : buffer_(std::move(rids)), done_(true) {}
+
+  HashScanCursor(BufferPoolManager *buffer_pool_manager, page_id_t header_page_id, const KeyManager &processor,
+                 GenericKey *lower, int lower_length, bool lower_inclusive, GenericKey *upper, int upper_length,
+                 bool upper_inclusive)
+      : buffer_pool_manager_(buffer_pool_manager),
+        header_page_id_(header_page_id),
+        processor_(&processor),
+        lower_(lower),
+        lower_length_(lower_length),
+        lower_inclusive_(lower_inclusive),
+        upper_(upper),
+        upper_length_(upper_length),
+        upper_inclusive_(upper_inclusive),
+        done_(header_page_id == INVALID_PAGE_ID) {}
+
+  ~HashScanCursor() override {
+    free(lower_);
+    free(upper_);
+  }
+
+  bool Next(RowId *rid) override {
+    while (pos_ == buffer_.size()) {
+      if (done_) {
+        return false;
+      }
+      buffer_.clear();
+      pos_ = 0;
+      LoadNextChain();
+    }
+    *rid = buffer_[pos_++];
+    return true;
+  }
+
+ private:
+  bool InRange(const GenericKey *key) const {
+    if (lower_ != nullptr) {
+      int cmp = processor_->ComparePrefix(key, lower_, lower_length_);
+      if (cmp < 0 || (cmp == 0 && !lower_inclusive_)) {
+        return false;
+      }
+    }
+    if (upper_ != nullptr) {
+      int cmp = processor_->ComparePrefix(key, upper_, upper_length_);
+      if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** Fill the buffer from the next bucket chain, an entry only owns its bucket if it is the lowest one pointing to it */
+  void LoadNextChain() {
+    while (directory_index_ < HashHeaderPage::GetMaxSize()) {
+      auto *header = reinterpret_cast<HashHeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id_)->GetData());
+      page_id_t directory_page_id = header->GetDirectoryPageId(directory_index_);
+      buffer_pool_manager_->UnpinPage(header_page_id_, false);
+      if (directory_page_id != INVALID_PAGE_ID) {
+        auto *directory =
+            reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id)->GetData());
+        while (bucket_index_ < directory->GetSize()) {
+          uint32_t index = bucket_index_++;
+          if (index >= (1u << directory->GetLocalDepth(index))) {
+            continue;
+          }
+          page_id_t page_id = directory->GetBucketPageId(index);
+          buffer_pool_manager_->UnpinPage(directory_page_id, false);
+          while (page_id != INVALID_PAGE_ID) {
+            auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+            for (int i = 0; i < bucket->GetSize(); i++) {
+              if (InRange(bucket->KeyAt(i))) {
+                buffer_.push_back(bucket->ValueAt(i));
+              }
+            }
+            page_id_t next_page_id = bucket->GetNextPageId();
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            page_id = next_page_id;
+          }
+          return;
+        }
+        buffer_pool_manager_->UnpinPage(directory_page_id, false);
+      }
+      directory_index_++;
+      bucket_index_ = 0;
+    }
+    done_ = true;
+  }
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  page_id_t header_page_id_{INVALID_PAGE_ID};
+  const KeyManager *processor_{nullptr};
+  GenericKey *lower_{nullptr};
+  int lower_length_{0};
+  bool lower_inclusive_{true};
+  GenericKey *upper_{nullptr};
+  int upper_length_{0};
+  bool upper_inclusive_{true};
+  std::vector<RowId> buffer_;
+  size_t pos_{0};
+  uint32_t directory_index_{0};
+  uint32_t bucket_index_{0};
+  bool done_;
+};
+}  // namespace
+
+std::unique_ptr<IndexScanCursor> ExtendibleHashIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                           bool upper_inclusive, Transaction *txn) {
+  GenericKey *lower_key = nullptr;
+  GenericKey *upper_key = nullptr;
+  int lower_length = 0;
+  int upper_length = 0;
+  if (lower != nullptr) {
+    lower_key = processor_.InitKey();
+    lower_length = processor_.SerializePrefix(lower_key, *lower, key_schema_);
+  }
+  if (upper != nullptr) {
+    upper_key = processor_.InitKey();
+    upper_length = processor_.SerializePrefix(upper_key, *upper, key_schema_);
+  }
+  // a single full key is the one thing hashing answers directly, a prefix hashes to anywhere
+  uint32_t key_count = key_schema_->GetColumnCount();
+  if (lower_key != nullptr && upper_key != nullptr && lower_inclusive && upper_inclusive &&
+      lower->GetFieldCount() >= key_count && upper->GetFieldCount() >= key_count &&
+      processor_.CompareKeys(lower_key, upper_key) == 0) {
+    std::vector<RowId> rids;
+    Lookup(lower_key, rids);
+    free(lower_key);
+    free(upper_key);
+    return std::make_unique<HashScanCursor>(std::move(rids));
+  }
+  return std::make_unique<HashScanCursor>(buffer_pool_manager_, header_page_id_, processor_, lower_key, lower_length,
+                                          lower_inclusive, upper_key, upper_length, upper_inclusive);
+}
+
+dberr_t ExtendibleHashIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn,
+                                     string compare_operator) {
+  if (compare_operator == "=") {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+    Lookup(index_key, result);
+    free(index_key);
+  } else {
+    std::vector<std::unique_ptr<IndexScanCursor>> cursors;
+    if (compare_operator == ">") {
+      cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+    } else if (compare_operator == ">=") {
+      cursors.emplace_back(Scan(&key, true, nullptr, false, txn));
+    } else if (compare_operator == "<") {
+      cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+    } else if (compare_operator == "<=") {
+      cursors.emplace_back(Scan(nullptr, false, &key, true, txn));
+    } else if (compare_operator == "<>") {
+      cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+      cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+    }
+    RowId rid;
+    for (auto &cursor : cursors) {
+      while (cursor->Next(&rid)) {
+        result.emplace_back(rid);
+      }
+    }
+  }
+  if (!result.empty())
+    return DB_SUCCESS;
+  else
+    return DB_KEY_NOT_FOUND;
+}
+
+dberr_t ExtendibleHashIndex::Destroy() {
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    return DB_SUCCESS;
+  }
+  auto *header = reinterpret_cast<HashHeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id_)->GetData());
+  for (uint32_t d = 0; d < HashHeaderPage::GetMaxSize(); d++) {
+    page_id_t directory_page_id = header->GetDirectoryPageId(d);
+    if (directory_page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    auto *directory =
+        reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id)->GetData());
+    for (uint32_t i = 0; i < directory->GetSize(); i++) {
+      if (i >= (1u << directory->GetLocalDepth(i))) {
+        continue;
+      }
+      for (page_id_t page_id = directory->GetBucketPageId(i); page_id != INVALID_PAGE_ID;) {
+        auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+        page_id_t next_page_id = bucket->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        buffer_pool_manager_->DeletePage(page_id);
+        page_id = next_page_id;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+    buffer_pool_manager_->DeletePage(directory_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  buffer_pool_manager_->DeletePage(header_page_id_);
+  auto *roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  roots->Delete(index_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  header_page_id_ = INVALID_PAGE_ID;
+  return DB_SUCCESS;
+}
@@ -2,6 +2,7 @@
 
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "index/posting_list.h"
 
 IndexIterator::IndexIterator() = default;
 
@@ -9,49 +10,120 @@ IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int inde
     : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm)
 {
     page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+    key_ = reinterpret_cast<GenericKey *>(malloc(page->GetKeySize()));
+    SkipExhausted();
+    LoadPostings();
+}
+
+IndexIterator::IndexIterator(IndexIterator &&other) noexcept
+    : current_page_id(other.current_page_id), page(other.page), item_index(other.item_index),
+      buffer_pool_manager(other.buffer_pool_manager), key_(other.key_), postings_(std::move(other.postings_)),
+      posting_index_(other.posting_index_), overflow_page_id_(other.overflow_page_id_)
+{
+    other.current_page_id = INVALID_PAGE_ID;
+    other.page = nullptr;
+    other.key_ = nullptr;
+}
+
+IndexIterator &IndexIterator::operator=(IndexIterator &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (current_page_id != INVALID_PAGE_ID)
+            buffer_pool_manager->UnpinPage(current_page_id, false);
+        free(key_);
+        current_page_id = other.current_page_id;
+        page = other.page;
+        item_index = other.item_index;
+        buffer_pool_manager = other.buffer_pool_manager;
+        key_ = other.key_;
+        postings_ = std::move(other.postings_);
+        posting_index_ = other.posting_index_;
+        overflow_page_id_ = other.overflow_page_id_;
+        other.current_page_id = INVALID_PAGE_ID;
+        other.page = nullptr;
+        other.key_ = nullptr;
+    }
+    return *this;
 }
 
 IndexIterator::~IndexIterator()
 {
     if (current_page_id != INVALID_PAGE_ID)
         buffer_pool_manager->UnpinPage(current_page_id, false);
+    free(key_);
 }
 
+/*
+ * The key is only valid until the iterator moves
+ */
 std::pair<GenericKey *, RowId> IndexIterator::operator*()
 {
-    // ASSERT(false, "Not implemented yet.");
     ASSERT(page != nullptr, "Invalid access");
-    return page->GetItem(item_index);
+    page->KeyAt(item_index, key_);
+    return std::make_pair(key_, page->IsPostingPage() ? postings_[posting_index_] : page->ValueAt(item_index));
+}
+
+const char *IndexIterator::Payload(int &length) const
+{
+    ASSERT(page != nullptr && page->IsCoveringPage(), "Invalid access");
+    return page->PayloadAt(item_index, length);
 }
 
 IndexIterator &IndexIterator::operator++()
 {
-    // ASSERT(false, "Not implemented yet.");
-    if (++item_index == page->GetSize())
+    if (page != nullptr && page->IsPostingPage())
+    {
+        if (++posting_index_ < (int)postings_.size())
+            return *this;
+        if (overflow_page_id_ != INVALID_PAGE_ID)
+        {
+            postings_.clear();
+            posting_index_ = 0;
+            overflow_page_id_ = PostingList::LoadPage(overflow_page_id_, postings_, buffer_pool_manager);
+            return *this;
+        }
+    }
+    ++item_index;
+    SkipExhausted();
+    LoadPostings();
+    return *this;
+}
+
+void IndexIterator::LoadPostings()
+{
+    postings_.clear();
+    posting_index_ = 0;
+    overflow_page_id_ = INVALID_PAGE_ID;
+    if (page == nullptr || !page->IsPostingPage())
+        return;
+    int length;
+    const char *data = page->PostingAt(item_index, length);
+    overflow_page_id_ = PostingList::LoadFirst(data, length, postings_, buffer_pool_manager);
+}
+
+void IndexIterator::SkipExhausted()
+{
+    while (current_page_id != INVALID_PAGE_ID && item_index >= page->GetSize())
     {
         page_id_t next_page_id = page->GetNextPageId();
         buffer_pool_manager->UnpinPage(current_page_id, false);
+        current_page_id = next_page_id;
+        item_index = 0;
         if (next_page_id == INVALID_PAGE_ID) // no more pages
-        {
-            // page = nullptr;
-            current_page_id = INVALID_PAGE_ID;
-            item_index = 0;
-        }
+            page = nullptr;
         else
-        {
             page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(next_page_id)->GetData());
-            current_page_id = next_page_id;
-            item_index = 0;
-        }
     }
 }
 
 bool IndexIterator::operator==(const IndexIterator &itr) const
 {
-    return current_page_id == itr.current_page_id && item_index == itr.item_index;
+    return current_page_id == itr.current_page_id && item_index == itr.item_index &&
+           posting_index_ == itr.posting_index_ && overflow_page_id_ == itr.overflow_page_id_;
 }
 
 bool IndexIterator::operator!=(const IndexIterator &itr) const
 {
     return !(*this == itr);
-}
\ No newline at end of file
+}
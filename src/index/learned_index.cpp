@@ -0,0 +1,341 @@
+#include "index/learned_index.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+const int64_t NULL_KEY = std::numeric_limits<int64_t>::min();
+/** The radix table has at most 2^16 + 1 slots */
+const int MAX_RADIX_BITS = 16;
+
+/** Distance from base to key, without overflowing for the null key */
+uint64_t Offset(int64_t key, int64_t base) { return static_cast<uint64_t>(key) - static_cast<uint64_t>(base); }
+
+/** Positive if (dx2, dy2) turns clockwise from (dx1, dy1), that is has the smaller slope */
+double Cross(double dx1, double dy1, double dx2, double dy2) { return dy1 * dx2 - dy2 * dx1; }
+}  // namespace
+
+struct LearnedIndex::Segment {
+  /** @return the position of the first entry whose key is not less than key */
+  size_t LowerBound(int64_t key) const;
+
+  /** Fit the spline and the radix table to keys */
+  void Train();
+
+  std::vector<int64_t> keys;
+  std::vector<RowId> values;
+  std::vector<char> removed;
+  /** Points (key, position) the spline passes through, increasing in both */
+  std::vector<std::pair<int64_t, double>> spline;
+  /** radix[p] is the first spline point whose key offset has the leading bits p */
+  std::vector<uint32_t> radix;
+  int shift{0};
+};
+
+void LearnedIndex::Segment::Train() {
+  spline.clear();
+  radix.clear();
+  if (keys.empty()) {
+    return;
+  }
+  // greedy spline corridor: the current segment goes on while every key since its
+  // start stays within MAX_ERROR of it, the corridor narrows with every key it takes
+  std::pair<int64_t, double> prev;
+  std::pair<int64_t, double> upper;
+  std::pair<int64_t, double> lower;
+  size_t distinct = 0;
+  for (size_t i = 0; i < keys.size(); i++) {
+    // a key is trained on the first of its positions
+    if (i > 0 && keys[i] == keys[i - 1]) {
+      continue;
+    }
+    std::pair<int64_t, double> point(keys[i], static_cast<double>(i));
+    double up = point.second + MAX_ERROR;
+    double down = point.second - MAX_ERROR;
+    if (++distinct == 1) {
+      spline.push_back(point);
+    } else if (distinct == 2) {
+      upper = {point.first, up};
+      lower = {point.first, down};
+    } else {
+      const auto &base = spline.back();
+      double dx = static_cast<double>(Offset(point.first, base.first));
+      double upper_dx = static_cast<double>(Offset(upper.first, base.first));
+      double lower_dx = static_cast<double>(Offset(lower.first, base.first));
+      double upper_dy = upper.second - base.second;
+      double lower_dy = lower.second - base.second;
+      if (Cross(upper_dx, upper_dy, dx, point.second - base.second) <= 0 ||
+          Cross(lower_dx, lower_dy, dx, point.second - base.second) >= 0) {
+        // out of the corridor, the segment ends at the key before
+        spline.push_back(prev);
+        upper = {point.first, up};
+        lower = {point.first, down};
+      } else {
+        if (Cross(upper_dx, upper_dy, dx, up - base.second) > 0) {
+          upper = {point.first, up};
+        }
+        if (Cross(lower_dx, lower_dy, dx, down - base.second) < 0) {
+          lower = {point.first, down};
+        }
+      }
+    }
+    prev = point;
+  }
+  if (spline.back().first != prev.first) {
+    spline.push_back(prev);
+  }
+
+  // about one spline point per slot
+  int bits = 1;
+  while (bits < MAX_RADIX_BITS && (size_t(1) << bits) < spline.size()) {
+    bits++;
+  }
+  uint64_t range = Offset(spline.back().first, spline.front().first);
+  int range_bits = 64 - __builtin_clzll(range | 1);
+  shift = std::max(0, range_bits - bits);
+  size_t slots = (range >> shift) + 2;
+  radix.resize(slots);
+  size_t slot = 0;
+  for (uint32_t i = 0; i < spline.size(); i++) {
+    uint64_t prefix = Offset(spline[i].first, spline.front().first) >> shift;
+    while (slot <= prefix) {
+      radix[slot++] = i;
+    }
+  }
+  while (slot < slots) {
+    radix[slot++] = spline.size();
+  }
+}
+
+size_t LearnedIndex::Segment::LowerBound(int64_t key) const {
+  size_t n = keys.size();
+  if (n == 0 || key <= keys.front()) {
+    return 0;
+  }
+  if (key > keys.back()) {
+    return n;
+  }
+  // the first spline point at or past key lies between the slot of key and the next one
+  uint64_t prefix = Offset(key, spline.front().first) >> shift;
+  size_t begin = radix[prefix];
+  size_t end = std::min<size_t>(radix[prefix + 1], spline.size() - 1) + 1;
+  size_t i = std::lower_bound(spline.begin() + begin, spline.begin() + end, key,
+                              [](const std::pair<int64_t, double> &point, int64_t k) { return point.first < k; }) -
+             spline.begin();
+  const auto &a = spline[i - 1];
+  const auto &b = spline[i];
+  double estimate = a.second + (b.second - a.second) * static_cast<double>(Offset(key, a.first)) /
+                                   static_cast<double>(Offset(b.first, a.first));
+  auto guess = static_cast<int64_t>(estimate);
+  auto lo = static_cast<size_t>(std::clamp<int64_t>(guess - MAX_ERROR, 0, n));
+  auto hi = static_cast<size_t>(std::clamp<int64_t>(guess + MAX_ERROR + 2, 0, n));
+  size_t pos = std::lower_bound(keys.begin() + lo, keys.begin() + hi, key) - keys.begin();
+  // the error is bounded for the trained keys, a long run of one key may still push an absent key out
+  if (pos == lo && lo > 0 && keys[lo - 1] >= key) {
+    pos = std::lower_bound(keys.begin(), keys.begin() + lo, key) - keys.begin();
+  } else if (pos == hi && hi < n && keys[hi] < key) {
+    pos = std::lower_bound(keys.begin() + hi, keys.end(), key) - keys.begin();
+  }
+  return pos;
+}
+
+namespace {
+/**
+ * Merges the array from the lower bound with the delta entries in bounds, which are
+ * copied up front so a retraining while the scan is open cannot pull them away.
+ */
+class LearnedScanCursor : public IndexScanCursor {
+ public:
+  LearnedScanCursor(std::shared_ptr<const LearnedIndex::Segment> segment, int64_t lower, int64_t upper,
+                    std::vector<std::pair<int64_t, RowId>> delta)
+      : segment_(std::move(segment)), pos_(segment_->LowerBound(lower)), upper_(upper), delta_(std::move(delta)) {}
+
+  bool Next(RowId *rid) override { return Fetch(rid, nullptr); }
+
+  bool NextEntry(RowId *rid, Row *entry) override { return Fetch(rid, entry); }
+
+ private:
+  bool Fetch(RowId *rid, Row *row) {
+    const std::vector<int64_t> &keys = segment_->keys;
+    while (pos_ < keys.size() && segment_->removed[pos_]) {
+      pos_++;
+    }
+    bool from_array = pos_ < keys.size() && keys[pos_] <= upper_;
+    bool from_delta = next_delta_ < delta_.size();
+    if (!from_array && !from_delta) {
+      return false;
+    }
+    int64_t key;
+    // the delta buffer only holds later inserts, so the array goes first on equal keys
+    if (from_array && (!from_delta || keys[pos_] <= delta_[next_delta_].first)) {
+      key = keys[pos_];
+      *rid = segment_->values[pos_++];
+    } else {
+      key = delta_[next_delta_].first;
+      *rid = delta_[next_delta_++].second;
+    }
+    if (row != nullptr) {
+      row->destroy();
+      row->GetFields().push_back(key == NULL_KEY ? new Field(TypeId::kTypeInt)
+                                                 : new Field(TypeId::kTypeInt, static_cast<int32_t>(key)));
+      row->SetRowId(*rid);
+    }
+    return true;
+  }
+
+  std::shared_ptr<const LearnedIndex::Segment> segment_;
+  size_t pos_;
+  int64_t upper_;
+  std::vector<std::pair<int64_t, RowId>> delta_;
+  size_t next_delta_{0};
+};
+}  // namespace
+
+LearnedIndex::LearnedIndex(index_id_t index_id, IndexSchema *key_schema, bool unique)
+    : Index(index_id, key_schema), unique_(unique), segment_(std::make_shared<Segment>()) {}
+
+int64_t LearnedIndex::KeyOf(const Row &key) {
+  const Field *field = key.GetField(0);
+  if (field->IsNull()) {
+    return NULL_KEY;
+  }
+  int32_t value;
+  field->SerializeTo(reinterpret_cast<char *>(&value));
+  return value;
+}
+
+dberr_t LearnedIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  int64_t k = KeyOf(key);
+  if (unique_ && k != NULL_KEY) {
+    std::vector<RowId> found;
+    if (ScanKey(key, found, txn) == DB_SUCCESS) {
+      return DB_FAILED;
+    }
+  }
+  delta_.emplace(k, row_id);
+  RetrainIfDue();
+  return DB_SUCCESS;
+}
+
+dberr_t LearnedIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  int64_t k = KeyOf(key);
+  auto range = delta_.equal_range(k);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == row_id) {
+      delta_.erase(it);
+      return DB_SUCCESS;
+    }
+  }
+  Segment &segment = *segment_;
+  for (size_t pos = segment.LowerBound(k); pos < segment.keys.size() && segment.keys[pos] == k; pos++) {
+    if (!segment.removed[pos] && segment.values[pos] == row_id) {
+      segment.removed[pos] = 1;
+      removed_count_++;
+      RetrainIfDue();
+      break;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+std::unique_ptr<IndexScanCursor> LearnedIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                    bool upper_inclusive, Transaction *txn) {
+  // integer keys turn exclusive bounds into inclusive ones
+  int64_t lower_key = NULL_KEY;
+  int64_t upper_key = std::numeric_limits<int64_t>::max();
+  if (lower != nullptr && lower->GetFieldCount() > 0) {
+    lower_key = KeyOf(*lower) + (lower_inclusive ? 0 : 1);
+  }
+  if (upper != nullptr && upper->GetFieldCount() > 0) {
+    upper_key = KeyOf(*upper);
+    if (!upper_inclusive) {
+      // nothing sorts before a null, the scan is empty
+      if (upper_key == NULL_KEY) {
+        lower_key = NULL_KEY + 1;
+      } else {
+        upper_key--;
+      }
+    }
+  }
+  std::vector<std::pair<int64_t, RowId>> delta;
+  for (auto it = delta_.lower_bound(lower_key); it != delta_.end() && it->first <= upper_key; ++it) {
+    delta.emplace_back(*it);
+  }
+  return std::make_unique<LearnedScanCursor>(segment_, lower_key, upper_key, std::move(delta));
+}
+
+dberr_t LearnedIndex::ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                              std::string compare_operator) {
+  std::vector<std::unique_ptr<IndexScanCursor>> cursors;
+  if (compare_operator == "=") {
+    cursors.emplace_back(Scan(&key, true, &key, true, txn));
+  } else if (compare_operator == ">") {
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    cursors.emplace_back(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    cursors.emplace_back(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  }
+  RowId rid;
+  for (auto &cursor : cursors) {
+    while (cursor->Next(&rid)) {
+      result.emplace_back(rid);
+    }
+  }
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+dberr_t LearnedIndex::Destroy() {
+  segment_ = std::make_shared<Segment>();
+  delta_.clear();
+  removed_count_ = 0;
+  return DB_SUCCESS;
+}
+
+void LearnedIndex::RetrainIfDue() {
+  if (delta_.size() + removed_count_ >= std::max(MIN_RETRAIN_CHANGES, segment_->keys.size() / 8)) {
+    Retrain();
+  }
+}
+
+void LearnedIndex::Retrain() {
+  const Segment &old = *segment_;
+  auto segment = std::make_shared<Segment>();
+  size_t count = old.keys.size() - removed_count_ + delta_.size();
+  segment->keys.reserve(count);
+  segment->values.reserve(count);
+  auto it = delta_.begin();
+  for (size_t pos = 0; pos <= old.keys.size(); pos++) {
+    // inserted later, delta entries follow the array entries of the same key
+    while (it != delta_.end() && (pos == old.keys.size() || it->first < old.keys[pos])) {
+      segment->keys.push_back(it->first);
+      segment->values.push_back(it->second);
+      ++it;
+    }
+    if (pos < old.keys.size() && !old.removed[pos]) {
+      segment->keys.push_back(old.keys[pos]);
+      segment->values.push_back(old.values[pos]);
+    }
+  }
+  segment->removed.assign(segment->keys.size(), 0);
+  segment->Train();
+  segment_ = std::move(segment);
+  delta_.clear();
+  removed_count_ = 0;
+}
+
+size_t LearnedIndex::GetMemoryUsage() const {
+  const Segment &segment = *segment_;
+  // a node of the delta tree holds three links and a color next to its entry
+  return sizeof(*this) + sizeof(segment) + segment.keys.capacity() * sizeof(int64_t) +
+         segment.values.capacity() * sizeof(RowId) + segment.removed.capacity() +
+         segment.spline.capacity() * sizeof(segment.spline[0]) + segment.radix.capacity() * sizeof(uint32_t) +
+         delta_.size() * (sizeof(std::pair<const int64_t, RowId>) + 4 * sizeof(void *));
+}
+
+size_t LearnedIndex::GetSplinePointCount() const { return segment_->spline.size(); }
@@ -0,0 +1,173 @@
+#include "index/lsm_index.h"
+
+namespace {
+/**
+ * Merges the memtable and the runs in key order from the lower bound. Bounds are byte
+ * prefixes of the tree keys, so the row id suffix of a non-unique index never takes
+ * part in them.
+ */
+class LsmScanCursor : public IndexScanCursor {
+ public:
+  LsmScanCursor(LsmTree::Iterator &&iter, const KeyManager &processor, Schema *key_schema, std::string lower,
+                bool has_lower, bool lower_inclusive, std::string upper, bool has_upper, bool upper_inclusive)
+      : iter_(std::move(iter)),
+        processor_(processor),
+        key_schema_(key_schema),
+        lower_(std::move(lower)),
+        skip_lower_(has_lower && !lower_inclusive),
+        upper_(std::move(upper)),
+        has_upper_(has_upper),
+        upper_inclusive_(upper_inclusive) {}
+
+  bool Next(RowId *rid) override { return Fetch(rid, nullptr); }
+
+  bool NextEntry(RowId *rid, Row *entry) override { return Fetch(rid, entry); }
+
+ private:
+  bool Fetch(RowId *rid, Row *row) {
+    if (done_) {
+      return false;
+    }
+    const LsmEntry *entry;
+    while ((entry = iter_.Next()) != nullptr) {
+      // an exclusive lower bound only has to skip the keys equal to it, which come first
+      if (skip_lower_) {
+        if (entry->key.compare(0, lower_.size(), lower_) == 0) {
+          continue;
+        }
+        skip_lower_ = false;
+      }
+      if (has_upper_) {
+        int cmp = entry->key.compare(0, upper_.size(), upper_);
+        if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+          break;
+        }
+      }
+      *rid = entry->value;
+      if (row != nullptr) {
+        // the key columns come first, a row id suffix is past what the schema reads
+        GenericKey *key = processor_.InitKey();
+        memset(key, 0, processor_.GetKeySize());
+        memcpy(key, entry->key.data(), std::min<size_t>(entry->key.size(), processor_.GetKeySize()));
+        processor_.DeserializeToKey(key, *row, key_schema_);
+        free(key);
+        row->SetRowId(entry->value);
+      }
+      return true;
+    }
+    done_ = true;
+    return false;
+  }
+
+  LsmTree::Iterator iter_;
+  const KeyManager &processor_;
+  Schema *key_schema_;
+  std::string lower_;
+  bool skip_lower_;
+  std::string upper_;
+  bool has_upper_;
+  bool upper_inclusive_;
+  bool done_{false};
+};
+}  // namespace
+
+LsmIndex::LsmIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                   bool unique, size_t memtable_limit)
+    : Index(index_id, key_schema),
+      processor_(key_schema_, KeyManager::GetMaxKeyLength(key_schema)),
+      unique_(unique),
+      tree_(index_id, buffer_pool_manager, unique ? 0 : sizeof(uint64_t), memtable_limit) {}
+
+std::string LsmIndex::EncodeKey(const Row &key) const {
+  GenericKey *key_buf = processor_.InitKey();
+  int length = processor_.SerializePrefix(key_buf, key, key_schema_);
+  std::string bytes(reinterpret_cast<const char *>(key_buf), length);
+  free(key_buf);
+  return bytes;
+}
+
+std::string LsmIndex::EncodeEntry(const Row &key, RowId row_id) const {
+  ASSERT(key.GetFieldCount() >= key_schema_->GetColumnCount(), "field nums not match.");
+  std::string bytes = EncodeKey(key);
+  if (!unique_) {
+    // big endian, so the entries of a key are ordered by row id
+    uint64_t rid = static_cast<uint64_t>(row_id.Get());
+    for (int b = 7; b >= 0; b--) {
+      bytes.push_back(static_cast<char>(rid >> (b * 8)));
+    }
+  }
+  return bytes;
+}
+
+dberr_t LsmIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  std::string entry = EncodeEntry(key, row_id);
+  RowId existing;
+  if (unique_ && tree_.Get(entry, &existing)) {
+    return DB_FAILED;
+  }
+  tree_.Put(entry, row_id);
+  return DB_SUCCESS;
+}
+
+dberr_t LsmIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  std::string entry = EncodeEntry(key, row_id);
+  // a tombstone hides whatever the key maps to, so a unique key must still be this row's
+  RowId existing;
+  if (unique_ && (!tree_.Get(entry, &existing) || !(existing == row_id))) {
+    return DB_SUCCESS;
+  }
+  tree_.Delete(entry);
+  return DB_SUCCESS;
+}
+
+std::unique_ptr<IndexScanCursor> LsmIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                bool upper_inclusive, Transaction *txn) {
+  std::string lower_key = lower == nullptr ? "" : EncodeKey(*lower);
+  std::string upper_key = upper == nullptr ? "" : EncodeKey(*upper);
+  // equal bounds on the whole key are what the Bloom filters are built from
+  bool point = lower != nullptr && upper != nullptr && lower_inclusive && upper_inclusive &&
+               lower->GetFieldCount() >= key_schema_->GetColumnCount() && lower_key == upper_key;
+  return std::make_unique<LsmScanCursor>(tree_.Seek(lower_key, point), processor_, key_schema_, lower_key,
+                                         lower != nullptr, lower_inclusive, upper_key, upper != nullptr,
+                                         upper_inclusive);
+}
+
+dberr_t LsmIndex::ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
+                          std::string compare_operator) {
+  std::vector<std::unique_ptr<IndexScanCursor>> cursors;
+  if (compare_operator == "=") {
+    // a whole key of a unique index is a single lookup
+    if (unique_ && key.GetFieldCount() >= key_schema_->GetColumnCount()) {
+      RowId rid;
+      if (!tree_.Get(EncodeKey(key), &rid)) {
+        return DB_KEY_NOT_FOUND;
+      }
+      result.emplace_back(rid);
+      return DB_SUCCESS;
+    }
+    cursors.emplace_back(Scan(&key, true, &key, true, txn));
+  } else if (compare_operator == ">") {
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    cursors.emplace_back(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    cursors.emplace_back(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    cursors.emplace_back(Scan(nullptr, false, &key, false, txn));
+    cursors.emplace_back(Scan(&key, false, nullptr, false, txn));
+  }
+  RowId rid;
+  for (auto &cursor : cursors) {
+    while (cursor->Next(&rid)) {
+      result.emplace_back(rid);
+    }
+  }
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+dberr_t LsmIndex::Destroy() {
+  tree_.Destroy();
+  return DB_SUCCESS;
+}
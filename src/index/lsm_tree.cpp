@@ -0,0 +1,816 @@
+#include "index/lsm_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <random>
+
+#include "page/index_roots_page.h"
+
+namespace
+{
+template <typename T>
+void PutValue(std::string &buf, T value)
+{
+    buf.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+T GetValue(const std::string &buf, size_t &ofs)
+{
+    T value;
+    memcpy(&value, buf.data() + ofs, sizeof(T));
+    ofs += sizeof(T);
+    return value;
+}
+
+/** Entries level i + 1 may hold before it is merged into the next level */
+size_t LevelLimit(size_t memtable_limit, size_t level_index)
+{
+    size_t limit = memtable_limit * LsmTree::LEVEL0_RUN_LIMIT;
+    for (size_t i = 0; i < level_index; i++)
+        limit *= 10;
+    return limit;
+}
+
+/** FNV-1a followed by a finalizer, the filters are stored so the hash must not change between runs */
+uint64_t HashKey(const char *data, size_t length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/** Bloom filter with 10 bits per key and 7 probes, about 1% false positives */
+struct BloomFilter
+{
+    static constexpr size_t BITS_PER_KEY = 10;
+    static constexpr uint32_t PROBES = 7;
+
+    void Reset(size_t keys) { words.assign(std::max<size_t>(1, (keys * BITS_PER_KEY + 63) / 64), 0); }
+
+    void Add(const char *data, size_t length)
+    {
+        uint64_t hash = HashKey(data, length);
+        uint64_t delta = (hash >> 32) | 1;
+        uint64_t bits = words.size() * 64;
+        for (uint32_t i = 0; i < PROBES; i++, hash += delta)
+            words[(hash % bits) / 64] |= 1ull << (hash % bits % 64);
+    }
+
+    bool MayContain(const char *data, size_t length) const
+    {
+        uint64_t hash = HashKey(data, length);
+        uint64_t delta = (hash >> 32) | 1;
+        uint64_t bits = words.size() * 64;
+        for (uint32_t i = 0; i < PROBES; i++, hash += delta)
+        {
+            if (!(words[(hash % bits) / 64] >> (hash % bits % 64) & 1))
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<uint64_t> words;
+};
+
+std::vector<page_id_t> ChainPages(BufferPoolManager *buffer_pool_manager, page_id_t head_page_id)
+{
+    std::vector<page_id_t> pages;
+    for (page_id_t page_id = head_page_id; page_id != INVALID_PAGE_ID;)
+    {
+        pages.push_back(page_id);
+        auto *page = reinterpret_cast<LsmMetaPage *>(buffer_pool_manager->FetchPage(page_id)->GetData());
+        page_id_t next_page_id = page->next_page_id_;
+        buffer_pool_manager->UnpinPage(page_id, false);
+        page_id = next_page_id;
+    }
+    return pages;
+}
+
+/** Store data in the chain starting at head_page_id, which grows or shrinks to fit it */
+void WriteChain(BufferPoolManager *buffer_pool_manager, page_id_t head_page_id, const std::string &data)
+{
+    std::vector<page_id_t> pages = ChainPages(buffer_pool_manager, head_page_id);
+    size_t needed = std::max<size_t>(1, (data.size() + LsmMetaPage::LSM_META_PAGE_CAPACITY - 1) /
+                                            LsmMetaPage::LSM_META_PAGE_CAPACITY);
+    while (pages.size() > needed)
+    {
+        buffer_pool_manager->DeletePage(pages.back());
+        pages.pop_back();
+    }
+    while (pages.size() < needed)
+    {
+        page_id_t page_id;
+        buffer_pool_manager->NewPage(page_id);
+        buffer_pool_manager->UnpinPage(page_id, true);
+        pages.push_back(page_id);
+    }
+    size_t ofs = 0;
+    for (size_t i = 0; i < needed; i++)
+    {
+        auto *page = reinterpret_cast<LsmMetaPage *>(buffer_pool_manager->FetchPage(pages[i])->GetData());
+        page->next_page_id_ = i + 1 < needed ? pages[i + 1] : INVALID_PAGE_ID;
+        page->bytes_ = std::min<size_t>(LsmMetaPage::LSM_META_PAGE_CAPACITY, data.size() - ofs);
+        memcpy(page->data_, data.data() + ofs, page->bytes_);
+        ofs += page->bytes_;
+        buffer_pool_manager->UnpinPage(pages[i], true);
+    }
+}
+
+page_id_t NewChain(BufferPoolManager *buffer_pool_manager, const std::string &data)
+{
+    page_id_t head_page_id;
+    Page *page = buffer_pool_manager->NewPage(head_page_id);
+    ASSERT(page != nullptr, "Out of buffer pool pages.");
+    reinterpret_cast<LsmMetaPage *>(page->GetData())->next_page_id_ = INVALID_PAGE_ID;
+    buffer_pool_manager->UnpinPage(head_page_id, true);
+    WriteChain(buffer_pool_manager, head_page_id, data);
+    return head_page_id;
+}
+
+std::string ReadChain(BufferPoolManager *buffer_pool_manager, page_id_t head_page_id)
+{
+    std::string data;
+    for (auto page_id : ChainPages(buffer_pool_manager, head_page_id))
+    {
+        auto *page = reinterpret_cast<LsmMetaPage *>(buffer_pool_manager->FetchPage(page_id)->GetData());
+        data.append(page->data_, page->bytes_);
+        buffer_pool_manager->UnpinPage(page_id, false);
+    }
+    return data;
+}
+
+void FreeChain(BufferPoolManager *buffer_pool_manager, page_id_t head_page_id)
+{
+    for (auto page_id : ChainPages(buffer_pool_manager, head_page_id))
+        buffer_pool_manager->DeletePage(page_id);
+}
+} // namespace
+
+/**
+ * Skip list of the latest version of each key written since the last flush.
+ * Nodes are only ever added, so iterators stay valid while the writer goes on.
+ */
+class LsmTree::MemTable
+{
+public:
+    struct Node
+    {
+        LsmEntry entry;
+        int height;
+        Node *next[1];
+    };
+
+    MemTable() : head_(NewNode(MAX_HEIGHT)) {}
+
+    ~MemTable()
+    {
+        for (Node *node = head_; node != nullptr;)
+        {
+            Node *next = node->next[0];
+            FreeNode(node);
+            node = next;
+        }
+    }
+
+    void Put(const std::string &key, const RowId &value, bool deleted)
+    {
+        Node *prev[MAX_HEIGHT];
+        Node *node = FindGreaterOrEqual(key, prev);
+        if (node != nullptr && node->entry.key == key)
+        {
+            node->entry.value = value;
+            node->entry.deleted = deleted;
+            return;
+        }
+        int height = 1;
+        while (height < MAX_HEIGHT && rng_() % 4 == 0)
+            height++;
+        for (int i = height_; i < height; i++)
+            prev[i] = head_;
+        height_ = std::max(height_, height);
+        node = NewNode(height);
+        node->entry.key = key;
+        node->entry.value = value;
+        node->entry.deleted = deleted;
+        for (int i = 0; i < height; i++)
+        {
+            node->next[i] = prev[i]->next[i];
+            prev[i]->next[i] = node;
+        }
+        size_++;
+    }
+
+    const LsmEntry *Get(const std::string &key) const
+    {
+        const Node *node = FindGreaterOrEqual(key, nullptr);
+        return node != nullptr && node->entry.key == key ? &node->entry : nullptr;
+    }
+
+    /** @return the first node whose key is not less than key */
+    const Node *Seek(const std::string &key) const { return FindGreaterOrEqual(key, nullptr); }
+
+    size_t Size() const { return size_; }
+
+private:
+    static constexpr int MAX_HEIGHT = 12;
+
+    static Node *NewNode(int height)
+    {
+        void *mem = ::operator new(sizeof(Node) + (height - 1) * sizeof(Node *));
+        Node *node = new (mem) Node();
+        node->height = height;
+        for (int i = 0; i < height; i++)
+            node->next[i] = nullptr;
+        return node;
+    }
+
+    static void FreeNode(Node *node)
+    {
+        node->~Node();
+        ::operator delete(node);
+    }
+
+    Node *FindGreaterOrEqual(const std::string &key, Node **prev) const
+    {
+        Node *node = head_;
+        for (int level = height_ - 1; level >= 0; level--)
+        {
+            while (node->next[level] != nullptr && node->next[level]->entry.key < key)
+                node = node->next[level];
+            if (prev != nullptr)
+                prev[level] = node;
+        }
+        return node->next[0];
+    }
+
+    Node *head_;
+    int height_{1};
+    size_t size_{0};
+    std::mt19937 rng_{0x5eed};
+};
+
+/**
+ * An immutable run of entries in key order. The page ids, the first key of every
+ * page and the Bloom filter are kept in memory and stored in a chain of meta pages.
+ * A run replaced by a compaction frees its pages once the last reader lets go of it.
+ */
+class LsmTree::SortedRun
+{
+public:
+    explicit SortedRun(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+    ~SortedRun()
+    {
+        if (!obsolete_)
+            return;
+        for (auto page_id : pages_)
+            buffer_pool_manager_->DeletePage(page_id);
+        if (meta_page_id_ != INVALID_PAGE_ID)
+            FreeChain(buffer_pool_manager_, meta_page_id_);
+    }
+
+    /** @return the only page that may hold key, the last one starting at or before it */
+    size_t FindPage(const std::string &key) const
+    {
+        auto it = std::upper_bound(fences_.begin(), fences_.end(), key);
+        return it == fences_.begin() ? 0 : it - fences_.begin() - 1;
+    }
+
+    void ReadPage(size_t index, std::vector<LsmEntry> &entries) const
+    {
+        Page *page = buffer_pool_manager_->FetchPage(pages_[index]);
+        reinterpret_cast<const SortedRunPage *>(page->GetData())->Decode(entries);
+        buffer_pool_manager_->UnpinPage(pages_[index], false);
+    }
+
+    /** Find the version of key in this run, the filter takes the key without its suffix */
+    bool Get(const std::string &key, uint32_t suffix_length, LsmEntry *entry) const
+    {
+        if (pages_.empty() || !filter_.MayContain(key.data(), key.size() - suffix_length))
+            return false;
+        std::vector<LsmEntry> entries;
+        ReadPage(FindPage(key), entries);
+        auto it = std::lower_bound(entries.begin(), entries.end(), key,
+                                   [](const LsmEntry &lhs, const std::string &rhs) { return lhs.key < rhs; });
+        if (it == entries.end() || it->key != key)
+            return false;
+        *entry = *it;
+        return true;
+    }
+
+    /**
+     * Format:
+     *  ----------------------------------------------------------------------------------
+     * | Entries (8) | PageCount (4) | PageIds | KeyLength (2) | Fence | ... | Words (4) |
+     *  ----------------------------------------------------------------------------------
+     * followed by the words of the filter.
+     */
+    std::string Serialize() const
+    {
+        std::string data;
+        PutValue<uint64_t>(data, entries_);
+        PutValue<uint32_t>(data, pages_.size());
+        for (auto page_id : pages_)
+            PutValue<page_id_t>(data, page_id);
+        for (auto &fence : fences_)
+        {
+            PutValue<uint16_t>(data, fence.size());
+            data.append(fence);
+        }
+        PutValue<uint32_t>(data, filter_.words.size());
+        data.append(reinterpret_cast<const char *>(filter_.words.data()), filter_.words.size() * sizeof(uint64_t));
+        return data;
+    }
+
+    void Deserialize(const std::string &data)
+    {
+        size_t ofs = 0;
+        entries_ = GetValue<uint64_t>(data, ofs);
+        pages_.resize(GetValue<uint32_t>(data, ofs));
+        for (auto &page_id : pages_)
+            page_id = GetValue<page_id_t>(data, ofs);
+        fences_.resize(pages_.size());
+        for (auto &fence : fences_)
+        {
+            uint16_t length = GetValue<uint16_t>(data, ofs);
+            fence.assign(data.data() + ofs, length);
+            ofs += length;
+        }
+        filter_.words.resize(GetValue<uint32_t>(data, ofs));
+        memcpy(filter_.words.data(), data.data() + ofs, filter_.words.size() * sizeof(uint64_t));
+    }
+
+    page_id_t meta_page_id_{INVALID_PAGE_ID};
+    std::vector<page_id_t> pages_;
+    std::vector<std::string> fences_;
+    BloomFilter filter_;
+    uint64_t entries_{0};
+    bool obsolete_{false};
+
+private:
+    BufferPoolManager *buffer_pool_manager_;
+};
+
+/** A sorted stream of entries taking part in a merge */
+class LsmTree::Source
+{
+public:
+    virtual ~Source() = default;
+
+    /** @return the current entry, null once the source is exhausted */
+    virtual const LsmEntry *Current() const = 0;
+
+    virtual void Advance() = 0;
+};
+
+namespace
+{
+class MemTableSource : public LsmTree::Source
+{
+public:
+    MemTableSource(std::shared_ptr<LsmTree::MemTable> memtable, const std::string &key)
+        : memtable_(std::move(memtable)), node_(memtable_->Seek(key)) {}
+
+    const LsmEntry *Current() const override { return node_ == nullptr ? nullptr : &node_->entry; }
+
+    void Advance() override { node_ = node_->next[0]; }
+
+private:
+    std::shared_ptr<LsmTree::MemTable> memtable_;
+    const LsmTree::MemTable::Node *node_;
+};
+
+/** Reads a run a page at a time */
+class RunSource : public LsmTree::Source
+{
+public:
+    RunSource(std::shared_ptr<LsmTree::SortedRun> run, const std::string &key) : run_(std::move(run))
+    {
+        if (run_->pages_.empty())
+            return;
+        page_index_ = run_->FindPage(key);
+        run_->ReadPage(page_index_, entries_);
+        pos_ = std::lower_bound(entries_.begin(), entries_.end(), key,
+                                [](const LsmEntry &lhs, const std::string &rhs) { return lhs.key < rhs; }) -
+               entries_.begin();
+        if (pos_ == entries_.size())
+            NextPage();
+    }
+
+    const LsmEntry *Current() const override { return pos_ < entries_.size() ? &entries_[pos_] : nullptr; }
+
+    void Advance() override
+    {
+        if (++pos_ == entries_.size())
+            NextPage();
+    }
+
+private:
+    void NextPage()
+    {
+        if (page_index_ + 1 >= run_->pages_.size())
+            return;
+        entries_.clear();
+        run_->ReadPage(++page_index_, entries_);
+        pos_ = 0;
+    }
+
+    std::shared_ptr<LsmTree::SortedRun> run_;
+    size_t page_index_{0};
+    std::vector<LsmEntry> entries_;
+    size_t pos_{0};
+};
+
+/** Writes a run front to back, a page is finished as soon as the next entry doesn't fit */
+class RunWriter
+{
+public:
+    RunWriter(BufferPoolManager *buffer_pool_manager, uint32_t suffix_length, size_t expected_entries)
+        : buffer_pool_manager_(buffer_pool_manager),
+          suffix_length_(suffix_length),
+          run_(std::make_shared<LsmTree::SortedRun>(buffer_pool_manager))
+    {
+        run_->filter_.Reset(expected_entries);
+    }
+
+    void Add(const LsmEntry &entry)
+    {
+        if (page_ == nullptr || !page_->Append(entry))
+        {
+            FinishPage();
+            Page *page = buffer_pool_manager_->NewPage(page_id_);
+            ASSERT(page != nullptr, "Out of buffer pool pages.");
+            page_ = reinterpret_cast<SortedRunPage *>(page->GetData());
+            page_->Init();
+            page_->Append(entry);
+            run_->pages_.push_back(page_id_);
+            run_->fences_.push_back(entry.key);
+        }
+        run_->filter_.Add(entry.key.data(), entry.key.size() - suffix_length_);
+        run_->entries_++;
+    }
+
+    std::shared_ptr<LsmTree::SortedRun> Finish()
+    {
+        FinishPage();
+        run_->meta_page_id_ = NewChain(buffer_pool_manager_, run_->Serialize());
+        return run_;
+    }
+
+private:
+    void FinishPage()
+    {
+        if (page_ != nullptr)
+            buffer_pool_manager_->UnpinPage(page_id_, true);
+        page_ = nullptr;
+    }
+
+    BufferPoolManager *buffer_pool_manager_;
+    uint32_t suffix_length_;
+    std::shared_ptr<LsmTree::SortedRun> run_;
+    SortedRunPage *page_{nullptr};
+    page_id_t page_id_{INVALID_PAGE_ID};
+};
+} // namespace
+
+LsmTree::Iterator::Iterator(bool keep_deleted) : keep_deleted_(keep_deleted) {}
+
+LsmTree::Iterator::Iterator(Iterator &&other) noexcept = default;
+
+LsmTree::Iterator::~Iterator() = default;
+
+const LsmEntry *LsmTree::Iterator::Next()
+{
+    while (true)
+    {
+        for (auto i : advance_)
+            sources_[i]->Advance();
+        advance_.clear();
+        // the smallest key wins, and of its versions the one of the newest source
+        const LsmEntry *newest = nullptr;
+        for (size_t i = 0; i < sources_.size(); i++)
+        {
+            const LsmEntry *entry = sources_[i]->Current();
+            if (entry == nullptr)
+                continue;
+            int cmp = newest == nullptr ? -1 : entry->key.compare(newest->key);
+            if (cmp < 0)
+            {
+                newest = entry;
+                advance_.clear();
+            }
+            if (cmp <= 0)
+                advance_.push_back(i);
+        }
+        if (newest == nullptr || keep_deleted_ || !newest->deleted)
+            return newest;
+    }
+}
+
+LsmTree::LsmTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, uint32_t suffix_length,
+                 size_t memtable_limit)
+    : index_id_(index_id),
+      buffer_pool_manager_(buffer_pool_manager),
+      suffix_length_(suffix_length),
+      memtable_limit_(memtable_limit),
+      memtable_(std::make_shared<MemTable>())
+{
+    auto *roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    if (roots->GetRootId(index_id_, &manifest_page_id_))
+    {
+        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+        LoadManifest();
+    }
+    else
+    {
+        manifest_page_id_ = NewChain(buffer_pool_manager_, "");
+        WriteManifest();
+        roots->Insert(index_id_, manifest_page_id_);
+        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+    }
+    std::lock_guard<std::mutex> lock(latch_);
+    ScheduleCompaction();
+}
+
+LsmTree::~LsmTree()
+{
+    StopWorker();
+    if (!destroyed_)
+        Flush();
+}
+
+void LsmTree::Put(const std::string &key, const RowId &value)
+{
+    memtable_->Put(key, value, false);
+    if (memtable_->Size() >= memtable_limit_)
+        Flush();
+}
+
+void LsmTree::Delete(const std::string &key)
+{
+    memtable_->Put(key, RowId(), true);
+    if (memtable_->Size() >= memtable_limit_)
+        Flush();
+}
+
+bool LsmTree::Get(const std::string &key, RowId *value)
+{
+    const LsmEntry *latest = memtable_->Get(key);
+    if (latest != nullptr)
+    {
+        *value = latest->value;
+        return !latest->deleted;
+    }
+    std::vector<std::shared_ptr<SortedRun>> runs;
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        runs = level0_;
+        for (auto &run : levels_)
+        {
+            if (run != nullptr)
+                runs.push_back(run);
+        }
+    }
+    LsmEntry entry;
+    for (auto &run : runs)
+    {
+        if (run->Get(key, suffix_length_, &entry))
+        {
+            *value = entry.value;
+            return !entry.deleted;
+        }
+    }
+    return false;
+}
+
+LsmTree::Iterator LsmTree::Seek(const std::string &key, bool point)
+{
+    Iterator iter(false);
+    iter.sources_.push_back(std::make_unique<MemTableSource>(memtable_, key));
+    std::lock_guard<std::mutex> lock(latch_);
+    auto add_run = [&](const std::shared_ptr<SortedRun> &run) {
+        if (run == nullptr || (point && !run->filter_.MayContain(key.data(), key.size())))
+            return;
+        iter.sources_.push_back(std::make_unique<RunSource>(run, key));
+    };
+    for (auto &run : level0_)
+        add_run(run);
+    for (auto &run : levels_)
+        add_run(run);
+    return iter;
+}
+
+void LsmTree::Flush()
+{
+    if (memtable_->Size() == 0)
+        return;
+    std::shared_ptr<MemTable> memtable = std::move(memtable_);
+    memtable_ = std::make_shared<MemTable>();
+    RunWriter writer(buffer_pool_manager_, suffix_length_, memtable->Size());
+    for (auto *node = memtable->Seek(""); node != nullptr; node = node->next[0])
+        writer.Add(node->entry);
+    std::shared_ptr<SortedRun> run = writer.Finish();
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        level0_.insert(level0_.begin(), run);
+        WriteManifest();
+        ScheduleCompaction();
+    }
+}
+
+bool LsmTree::PickCompaction(Compaction &compaction) const
+{
+    if (level0_.size() >= LEVEL0_RUN_LIMIT)
+    {
+        compaction.inputs = level0_;
+        if (!levels_.empty() && levels_[0] != nullptr)
+            compaction.inputs.push_back(levels_[0]);
+        compaction.level = 1;
+    }
+    else
+    {
+        size_t i = 0;
+        while (i < levels_.size() && (levels_[i] == nullptr || levels_[i]->entries_ <= LevelLimit(memtable_limit_, i)))
+            i++;
+        if (i == levels_.size())
+            return false;
+        compaction.inputs = {levels_[i]};
+        if (i + 1 < levels_.size() && levels_[i + 1] != nullptr)
+            compaction.inputs.push_back(levels_[i + 1]);
+        compaction.level = i + 2;
+    }
+    // tombstones only have to hide something in the levels below the output
+    compaction.drop_deleted = true;
+    for (size_t i = compaction.level; i < levels_.size(); i++)
+        compaction.drop_deleted &= levels_[i] == nullptr;
+    return true;
+}
+
+void LsmTree::InstallCompaction(const Compaction &compaction, const std::shared_ptr<SortedRun> &output)
+{
+    for (auto &input : compaction.inputs)
+        input->obsolete_ = true;
+    level0_.erase(std::remove_if(level0_.begin(), level0_.end(),
+                                 [](const std::shared_ptr<SortedRun> &run) { return run->obsolete_; }),
+                  level0_.end());
+    for (auto &run : levels_)
+    {
+        if (run != nullptr && run->obsolete_)
+            run = nullptr;
+    }
+    if (levels_.size() < compaction.level)
+        levels_.resize(compaction.level);
+    // every entry may have been a tombstone dropped on the way
+    if (output->entries_ > 0)
+        levels_[compaction.level - 1] = output;
+    else
+        output->obsolete_ = true;
+    WriteManifest();
+}
+
+void LsmTree::ScheduleCompaction()
+{
+    Compaction compaction;
+    if (busy_ || stop_ || !PickCompaction(compaction))
+        return;
+    busy_ = true;
+    thread_pool_->Submit(compactions_, TaskPriority::kLow, [this] { RunCompactions(); });
+}
+
+void LsmTree::RunCompactions()
+{
+    std::unique_lock<std::mutex> lock(latch_);
+    Compaction compaction;
+    while (!stop_ && !compactions_->IsCancelled() && PickCompaction(compaction))
+    {
+        lock.unlock();
+        // the inputs are immutable, readers and the writer go on while they are merged
+        size_t expected = 0;
+        Iterator merged(true);
+        for (auto &input : compaction.inputs)
+        {
+            expected += input->entries_;
+            merged.sources_.push_back(std::make_unique<RunSource>(input, ""));
+        }
+        RunWriter writer(buffer_pool_manager_, suffix_length_, expected);
+        for (const LsmEntry *entry = merged.Next(); entry != nullptr; entry = merged.Next())
+        {
+            if (!entry->deleted || !compaction.drop_deleted)
+                writer.Add(*entry);
+        }
+        std::shared_ptr<SortedRun> output = writer.Finish();
+        lock.lock();
+        InstallCompaction(compaction, output);
+        compaction = Compaction();
+    }
+    busy_ = false;
+    idle_cv_.notify_all();
+}
+
+void LsmTree::StopWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+        stop_ = true;
+    }
+    idle_cv_.notify_all();
+    // a compaction still queued is dropped, a running one finishes its merge
+    compactions_->Cancel();
+    thread_pool_->Wait(compactions_);
+}
+
+void LsmTree::WaitForCompaction()
+{
+    std::unique_lock<std::mutex> lock(latch_);
+    Compaction compaction;
+    idle_cv_.wait(lock, [&] { return stop_ || (!busy_ && !PickCompaction(compaction)); });
+}
+
+size_t LsmTree::GetRunCount()
+{
+    std::lock_guard<std::mutex> lock(latch_);
+    return level0_.size() + std::count_if(levels_.begin(), levels_.end(),
+                                          [](const std::shared_ptr<SortedRun> &run) { return run != nullptr; });
+}
+
+void LsmTree::Destroy()
+{
+    StopWorker();
+    std::lock_guard<std::mutex> lock(latch_);
+    for (auto &run : level0_)
+        run->obsolete_ = true;
+    for (auto &run : levels_)
+    {
+        if (run != nullptr)
+            run->obsolete_ = true;
+    }
+    level0_.clear();
+    levels_.clear();
+    FreeChain(buffer_pool_manager_, manifest_page_id_);
+    auto *roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    roots->Delete(index_id_);
+    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+    memtable_ = std::make_shared<MemTable>();
+    destroyed_ = true;
+}
+
+/**
+ * Format:
+ *  ------------------------------------------------------------------
+ * | RunCount (4) | Level (4) | MetaPageId (4) | Level (4) | ... |
+ *  ------------------------------------------------------------------
+ * with the runs of level 0 first, newest first.
+ */
+void LsmTree::WriteManifest()
+{
+    std::string data;
+    PutValue<uint32_t>(data, 0);
+    uint32_t count = 0;
+    for (auto &run : level0_)
+    {
+        PutValue<uint32_t>(data, 0);
+        PutValue<page_id_t>(data, run->meta_page_id_);
+        count++;
+    }
+    for (size_t i = 0; i < levels_.size(); i++)
+    {
+        if (levels_[i] == nullptr)
+            continue;
+        PutValue<uint32_t>(data, i + 1);
+        PutValue<page_id_t>(data, levels_[i]->meta_page_id_);
+        count++;
+    }
+    memcpy(&data[0], &count, sizeof(count));
+    WriteChain(buffer_pool_manager_, manifest_page_id_, data);
+}
+
+void LsmTree::LoadManifest()
+{
+    std::string data = ReadChain(buffer_pool_manager_, manifest_page_id_);
+    size_t ofs = 0;
+    uint32_t count = GetValue<uint32_t>(data, ofs);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t level = GetValue<uint32_t>(data, ofs);
+        auto run = std::make_shared<SortedRun>(buffer_pool_manager_);
+        run->meta_page_id_ = GetValue<page_id_t>(data, ofs);
+        run->Deserialize(ReadChain(buffer_pool_manager_, run->meta_page_id_));
+        if (level == 0)
+        {
+            level0_.push_back(run);
+            continue;
+        }
+        if (levels_.size() < level)
+            levels_.resize(level);
+        levels_[level - 1] = run;
+    }
+}
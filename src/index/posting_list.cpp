@@ -0,0 +1,311 @@
+#include "index/posting_list.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static bool RowIdLess(const RowId &a, const RowId &b)
+{
+    return PostingPage::Order(a) < PostingPage::Order(b);
+}
+
+PostingList::PostingList(const char *data, int length, BufferPoolManager *buffer_pool_manager)
+    : buffer_pool_manager_(buffer_pool_manager)
+{
+    if (data == nullptr || length == 0)
+    {
+        Serialize();
+        return;
+    }
+    data_.assign(data, length);
+    if (static_cast<uint8_t>(data[0]) == OVERFLOW_TAG)
+    {
+        overflow_ = true;
+        memcpy(&head_, data + 1, sizeof(page_id_t));
+        memcpy(&tail_, data + 1 + sizeof(page_id_t), sizeof(page_id_t));
+        memcpy(&count_, data + 1 + 2 * sizeof(page_id_t), sizeof(int));
+    }
+    else
+        LoadFirst(data, length, rids_, buffer_pool_manager_);
+}
+
+void PostingList::Serialize()
+{
+    data_.clear();
+    if (overflow_)
+    {
+        data_.push_back(static_cast<char>(OVERFLOW_TAG));
+        data_.append(reinterpret_cast<const char *>(&head_), sizeof(page_id_t));
+        data_.append(reinterpret_cast<const char *>(&tail_), sizeof(page_id_t));
+        data_.append(reinterpret_cast<const char *>(&count_), sizeof(int));
+        return;
+    }
+    char buf[10];
+    data_.push_back(static_cast<char>(INLINE_TAG));
+    data_.append(buf, PostingPage::PutVarint(buf, rids_.size()));
+    uint64_t prev = 0;
+    for (auto &rid : rids_)
+    {
+        data_.append(buf, PostingPage::PutVarint(buf, PostingPage::Order(rid) - prev));
+        prev = PostingPage::Order(rid);
+    }
+}
+
+page_id_t PostingList::LoadFirst(const char *data, int length, std::vector<RowId> &rids,
+                                 BufferPoolManager *buffer_pool_manager)
+{
+    if (static_cast<uint8_t>(data[0]) == OVERFLOW_TAG)
+    {
+        if (length < 1 + static_cast<int>(sizeof(page_id_t)))
+            throw std::runtime_error("corrupt posting list");
+        page_id_t head;
+        memcpy(&head, data + 1, sizeof(page_id_t));
+        return LoadPage(head, rids, buffer_pool_manager);
+    }
+    // the record comes from a page, a corrupt one must not send the decode past its end
+    const char *end = data + length;
+    uint64_t count, value = 0;
+    const char *buf = data + 1;
+    int len = PostingPage::GetVarint(buf, end, count);
+    if (len == 0)
+        throw std::runtime_error("corrupt posting list");
+    buf += len;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t delta;
+        len = PostingPage::GetVarint(buf, end, delta);
+        if (len == 0)
+            throw std::runtime_error("corrupt posting list");
+        buf += len;
+        value += delta;
+        rids.emplace_back(static_cast<int64_t>(value));
+    }
+    return INVALID_PAGE_ID;
+}
+
+page_id_t PostingList::LoadPage(page_id_t page_id, std::vector<RowId> &rids, BufferPoolManager *buffer_pool_manager)
+{
+    auto *page = reinterpret_cast<PostingPage *>(buffer_pool_manager->FetchPage(page_id)->GetData());
+    page->Decode(rids);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager->UnpinPage(page_id, false);
+    return next_page_id;
+}
+
+PostingPage *PostingList::FetchPostingPage(page_id_t page_id)
+{
+    return reinterpret_cast<PostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+}
+
+PostingPage *PostingList::NewPostingPage(page_id_t &page_id)
+{
+    Page *page = buffer_pool_manager_->NewPage(page_id);
+    if (page == nullptr)
+        throw std::runtime_error("out of memory");
+    auto *posting = reinterpret_cast<PostingPage *>(page->GetData());
+    posting->Init();
+    return posting;
+}
+
+void PostingList::GetAll(std::vector<RowId> &rids) const
+{
+    if (!overflow_)
+    {
+        rids.insert(rids.end(), rids_.begin(), rids_.end());
+        return;
+    }
+    for (page_id_t page_id = head_; page_id != INVALID_PAGE_ID;)
+        page_id = LoadPage(page_id, rids, buffer_pool_manager_);
+}
+
+bool PostingList::Insert(const RowId &rid)
+{
+    if (!overflow_)
+    {
+        auto it = std::lower_bound(rids_.begin(), rids_.end(), rid, RowIdLess);
+        if (it != rids_.end() && *it == rid)
+            return false;
+        rids_.insert(it, rid);
+        Serialize();
+        if (data_.size() > POSTING_INLINE_LIMIT)
+            Spill();
+        return true;
+    }
+
+    PostingPage *tail = FetchPostingPage(tail_);
+    if (RowIdLess(tail->GetLastRid(), rid))
+    {
+        // the common case, row ids grow with the table
+        if (!tail->Append(rid))
+        {
+            page_id_t page_id;
+            PostingPage *page = NewPostingPage(page_id);
+            page->Append(rid);
+            tail->SetNextPageId(page_id);
+            buffer_pool_manager_->UnpinPage(page_id, true);
+            buffer_pool_manager_->UnpinPage(tail_, true);
+            tail_ = page_id;
+        }
+        else
+            buffer_pool_manager_->UnpinPage(tail_, true);
+        count_++;
+        Serialize();
+        return true;
+    }
+    buffer_pool_manager_->UnpinPage(tail_, false);
+
+    // the first page whose last row id is not smaller holds the slot for rid
+    page_id_t page_id = head_;
+    PostingPage *page = FetchPostingPage(page_id);
+    while (RowIdLess(page->GetLastRid(), rid))
+    {
+        page_id_t next_page_id = page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
+        page = FetchPostingPage(page_id);
+    }
+    std::vector<RowId> rids;
+    page->Decode(rids);
+    auto it = std::lower_bound(rids.begin(), rids.end(), rid, RowIdLess);
+    if (it != rids.end() && *it == rid)
+    {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return false;
+    }
+    rids.insert(it, rid);
+    if (!page->Encode(rids.data(), rids.size()))
+    {
+        // split the run, the upper half goes to a new page right after this one
+        int half = rids.size() / 2;
+        page_id_t new_page_id;
+        PostingPage *new_page = NewPostingPage(new_page_id);
+        new_page->Encode(rids.data() + half, rids.size() - half);
+        page->Encode(rids.data(), half);
+        new_page->SetNextPageId(page->GetNextPageId());
+        page->SetNextPageId(new_page_id);
+        buffer_pool_manager_->UnpinPage(new_page_id, true);
+        if (tail_ == page_id)
+            tail_ = new_page_id;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    count_++;
+    Serialize();
+    return true;
+}
+
+bool PostingList::Remove(const RowId &rid)
+{
+    if (!overflow_)
+    {
+        auto it = std::lower_bound(rids_.begin(), rids_.end(), rid, RowIdLess);
+        if (it == rids_.end() || !(*it == rid))
+            return false;
+        rids_.erase(it);
+        Serialize();
+        return true;
+    }
+
+    page_id_t prev_page_id = INVALID_PAGE_ID;
+    page_id_t page_id = head_;
+    PostingPage *page = nullptr;
+    while (page_id != INVALID_PAGE_ID)
+    {
+        page = FetchPostingPage(page_id);
+        if (!RowIdLess(page->GetLastRid(), rid))
+            break;
+        page_id_t next_page_id = page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        prev_page_id = page_id;
+        page_id = next_page_id;
+    }
+    if (page_id == INVALID_PAGE_ID)
+        return false;
+
+    std::vector<RowId> rids;
+    page->Decode(rids);
+    auto it = std::lower_bound(rids.begin(), rids.end(), rid, RowIdLess);
+    if (it == rids.end() || !(*it == rid))
+    {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return false;
+    }
+    rids.erase(it);
+    if (rids.empty())
+    {
+        page_id_t next_page_id = page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        buffer_pool_manager_->DeletePage(page_id);
+        if (prev_page_id == INVALID_PAGE_ID)
+            head_ = next_page_id;
+        else
+        {
+            FetchPostingPage(prev_page_id)->SetNextPageId(next_page_id);
+            buffer_pool_manager_->UnpinPage(prev_page_id, true);
+        }
+        if (tail_ == page_id)
+            tail_ = prev_page_id;
+    }
+    else
+    {
+        page->Encode(rids.data(), rids.size());
+        buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    count_--;
+    // worst case every delta takes 10 bytes, only come back when that fits twice
+    if (count_ * 10 + 6 <= POSTING_INLINE_LIMIT / 2)
+        Unspill();
+    Serialize();
+    return true;
+}
+
+void PostingList::Spill()
+{
+    page_id_t page_id;
+    PostingPage *page = NewPostingPage(page_id);
+    head_ = page_id;
+    for (auto &rid : rids_)
+    {
+        if (page->Append(rid))
+            continue;
+        page_id_t next_page_id;
+        PostingPage *next_page = NewPostingPage(next_page_id);
+        next_page->Append(rid);
+        page->SetNextPageId(next_page_id);
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        page = next_page;
+        page_id = next_page_id;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    tail_ = page_id;
+    count_ = rids_.size();
+    rids_.clear();
+    overflow_ = true;
+    Serialize();
+}
+
+void PostingList::Unspill()
+{
+    std::vector<RowId> rids;
+    GetAll(rids);
+    Destroy();
+    rids_ = std::move(rids);
+    Serialize();
+}
+
+void PostingList::Destroy()
+{
+    if (overflow_)
+    {
+        for (page_id_t page_id = head_; page_id != INVALID_PAGE_ID;)
+        {
+            page_id_t next_page_id = FetchPostingPage(page_id)->GetNextPageId();
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            buffer_pool_manager_->DeletePage(page_id);
+            page_id = next_page_id;
+        }
+    }
+    overflow_ = false;
+    head_ = tail_ = INVALID_PAGE_ID;
+    count_ = 0;
+    rids_.clear();
+    Serialize();
+}
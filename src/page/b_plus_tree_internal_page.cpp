@@ -1,11 +1,10 @@
 #include "page/b_plus_tree_internal_page.h"
 
+#include <algorithm>
+
 #include "index/generic_key.h"
 
-#define pairs_off (data_)
-#define pair_size (GetKeySize() + sizeof(page_id_t))
-#define key_off 0
-#define val_off GetKeySize()
+#define record_size(len) (sizeof(page_id_t) + (len))
 
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
@@ -18,35 +17,87 @@
 void InternalPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size)
 {
     SetPageType(IndexPageType::INTERNAL_PAGE);
-    // TODO
-    SetSize(1); // INVALD PAGE
+    SetSize(0);
     SetPageId(page_id);
     SetParentPageId(parent_id);
     SetKeySize(key_size);
     SetMaxSize(max_size);
+    record_start_ = INTERNAL_PAGE_CAPACITY;
+    record_bytes_ = 0;
+    InsertRecord(0, nullptr, INVALID_PAGE_ID); // INVALID KEY
+}
+
+uint16_t InternalPage::SlotOffset(int index) const
+{
+    uint16_t offset;
+    memcpy(&offset, data_ + index * INTERNAL_SLOT_SIZE, sizeof(uint16_t));
+    return offset;
 }
+
+uint16_t InternalPage::SlotLength(int index) const
+{
+    uint16_t length;
+    memcpy(&length, data_ + index * INTERNAL_SLOT_SIZE + sizeof(uint16_t), sizeof(uint16_t));
+    return length;
+}
+
+void InternalPage::WriteSlot(int index, uint16_t offset, uint16_t length)
+{
+    memcpy(data_ + index * INTERNAL_SLOT_SIZE, &offset, sizeof(uint16_t));
+    memcpy(data_ + index * INTERNAL_SLOT_SIZE + sizeof(uint16_t), &length, sizeof(uint16_t));
+}
+
+int InternalPage::GetUsedBytes() const
+{
+    return GetSize() * INTERNAL_SLOT_SIZE + record_bytes_;
+}
+
+bool InternalPage::IsUnderflow() const
+{
+    return GetUsedBytes() < INTERNAL_PAGE_CAPACITY / 4;
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *InternalPage::KeyAt(int index)
+void InternalPage::KeyAt(int index, GenericKey *key) const
 {
-    return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
+    char *buf = reinterpret_cast<char *>(key);
+    memset(buf, 0, GetKeySize());
+    memcpy(buf, data_ + SlotOffset(index) + sizeof(page_id_t), SlotLength(index));
 }
 
-void InternalPage::SetKeyAt(int index, GenericKey *key)
+bool InternalPage::SetKeyAt(int index, const GenericKey *key)
 {
-    memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
+    const char *buf = reinterpret_cast<const char *>(key);
+    uint16_t length = KeyManager::KeyLength(buf, GetKeySize());
+    uint16_t old_length = SlotLength(index);
+    if (length <= old_length)
+    {
+        memcpy(data_ + SlotOffset(index) + sizeof(page_id_t), buf, length);
+        WriteSlot(index, SlotOffset(index), length);
+        record_bytes_ -= old_length - length;
+        return true;
+    }
+    if (INTERNAL_PAGE_CAPACITY - GetUsedBytes() < length - old_length)
+        return false;
+    page_id_t value = ValueAt(index);
+    Remove(index);
+    InsertRecord(index, buf, value);
+    return true;
 }
 
 page_id_t InternalPage::ValueAt(int index) const
 {
-    return *reinterpret_cast<const page_id_t *>(pairs_off + index * pair_size + val_off);
+    page_id_t value;
+    memcpy(&value, data_ + SlotOffset(index), sizeof(page_id_t));
+    return value;
 }
 
 void InternalPage::SetValueAt(int index, page_id_t value)
 {
-    *reinterpret_cast<page_id_t *>(pairs_off + index * pair_size + val_off) = value;
+    memcpy(data_ + SlotOffset(index), &value, sizeof(page_id_t));
 }
 
 int InternalPage::ValueIndex(const page_id_t &value) const
@@ -59,14 +110,87 @@ int InternalPage::ValueIndex(const page_id_t &value) const
     return -1;
 }
 
-void *InternalPage::PairPtrAt(int index)
+void InternalPage::Export(std::vector<char> &keys, std::vector<page_id_t> &values, int begin, int end) const
+{
+    if (end < 0)
+        end = GetSize();
+    size_t base = keys.size();
+    keys.resize(base + (end - begin) * GetKeySize());
+    for (int i = begin; i < end; i++)
+    {
+        KeyAt(i, reinterpret_cast<GenericKey *>(keys.data() + base + (i - begin) * GetKeySize()));
+        values.push_back(ValueAt(i));
+    }
+}
+
+bool InternalPage::Load(const char *keys, const page_id_t *values, int size)
+{
+    int total = size * INTERNAL_SLOT_SIZE;
+    for (int i = 0; i < size; i++)
+        total += record_size(KeyManager::KeyLength(keys + i * GetKeySize(), GetKeySize()));
+    if (total > INTERNAL_PAGE_CAPACITY)
+        return false;
+    SetSize(0);
+    record_start_ = INTERNAL_PAGE_CAPACITY;
+    record_bytes_ = 0;
+    for (int i = 0; i < size; i++)
+        InsertRecord(i, keys + i * GetKeySize(), values[i]);
+    return true;
+}
+
+/*
+ * Put a record in front of slot "index", key may be null for the invalid key
+ */
+bool InternalPage::InsertRecord(int index, const char *key, page_id_t value)
+{
+    uint16_t length = key == nullptr ? 0 : KeyManager::KeyLength(key, GetKeySize());
+    int slots_end = (GetSize() + 1) * INTERNAL_SLOT_SIZE;
+    if (record_start_ - slots_end < (int)record_size(length))
+    {
+        if (INTERNAL_PAGE_CAPACITY - slots_end - record_bytes_ < (int)record_size(length))
+            return false;
+        Compact();
+    }
+    record_start_ -= record_size(length);
+    memcpy(data_ + record_start_, &value, sizeof(page_id_t));
+    if (length > 0)
+        memcpy(data_ + record_start_ + sizeof(page_id_t), key, length);
+    memmove(data_ + (index + 1) * INTERNAL_SLOT_SIZE, data_ + index * INTERNAL_SLOT_SIZE,
+            (GetSize() - index) * INTERNAL_SLOT_SIZE);
+    WriteSlot(index, record_start_, length);
+    record_bytes_ += record_size(length);
+    IncreaseSize(1);
+    return true;
+}
+
+void InternalPage::Compact()
 {
-    return KeyAt(index);
+    char buffer[INTERNAL_PAGE_CAPACITY];
+    uint16_t start = INTERNAL_PAGE_CAPACITY;
+    for (int i = 0; i < GetSize(); i++)
+    {
+        uint16_t length = SlotLength(i);
+        start -= record_size(length);
+        memcpy(buffer + start, data_ + SlotOffset(i), record_size(length));
+        WriteSlot(i, start, length);
+    }
+    memcpy(data_ + start, buffer + start, INTERNAL_PAGE_CAPACITY - start);
+    record_start_ = start;
 }
 
-void InternalPage::PairCopy(void *dest, void *src, int pair_num)
+/*
+ * Every child in [begin, end) now hangs below this page, persist it with the
+ * BufferPoolManager
+ */
+void InternalPage::Adopt(int begin, int end, BufferPoolManager *buffer_pool_manager)
 {
-    memcpy(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
+    for (int i = begin; i < end; i++)
+    {
+        page_id_t page_id = ValueAt(i);
+        BPlusTreePage *page_ptr = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(page_id)->GetData());
+        page_ptr->SetParentPageId(GetPageId());
+        buffer_pool_manager->UnpinPage(page_id, true);
+    }
 }
 /*****************************************************************************
  * LOOKUP
@@ -75,25 +199,22 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num)
  * Find and return the child pointer(page_id) which points to the child page
  * that contains input "key"
  * Start the search from the second key(the first key should always be invalid)
- * 用了二分查找
  */
-page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM)
+page_id_t InternalPage::Lookup(const GenericKey *key) const
 {
-    int left = 0, right = GetSize() - 1;
-    if (right == 0)
-        return ValueAt(0);
-    while (right - left > 1)
+    const char *buf = reinterpret_cast<const char *>(key);
+    // first slot whose key is greater than key
+    int left = 1, right = GetSize();
+    while (left < right)
     {
         int mid = (left + right) / 2;
-        int res = KM.CompareKeys(key, KeyAt(mid));
-        if (res > 0)
-            left = mid;
-        else if (res < 0)
-            right = mid;
+        // a stored key equal to the first bytes of key is never greater, whatever key holds after them
+        if (memcmp(data_ + SlotOffset(mid) + sizeof(page_id_t), buf, SlotLength(mid)) <= 0)
+            left = mid + 1;
         else
-            return ValueAt(mid);
+            right = mid;
     }
-    return KM.CompareKeys(key, KeyAt(right)) < 0 ? ValueAt(left) : ValueAt(right);
+    return ValueAt(left - 1);
 }
 
 /*****************************************************************************
@@ -105,64 +226,45 @@ page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM)
  * page, you should create a new root page and populate its elements.
  * NOTE: This method is only called within InsertIntoParent()(b_plus_tree.cpp)
  */
-void InternalPage::PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value)
+void InternalPage::PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value)
 {
     SetValueAt(0, old_value);
-    SetKeyAt(1, new_key);
-    SetValueAt(1, new_value);
-    SetSize(2);
+    InsertRecord(1, reinterpret_cast<const char *>(new_key), new_value);
 }
 
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
- * @return:  new size after insertion
  */
-int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value)
+bool InternalPage::InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value)
 {
-    int index = ValueIndex(old_value) + 1;
-    //! may cause overflow
-    std::move_backward(data_ + index * pair_size, data_ + GetSize() * pair_size, data_ + (GetSize() + 1) * pair_size);
-    SetKeyAt(index, new_key);
-    SetValueAt(index, new_value);
-    IncreaseSize(1);
-    return GetSize();
+    if (GetSize() + 1 >= GetMaxSize())
+        return false;
+    return InsertRecord(ValueIndex(old_value) + 1, reinterpret_cast<const char *>(new_key), new_value);
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
- * buffer_pool_manager 是干嘛的？传给CopyNFrom()用于Fetch数据页
+ * Remove half of the records (by size) from this page to "recipient" page.
+ * The first key of the recipient is the one to push up into the parent.
  */
 void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager)
 {
-    int total = GetSize(), idx = GetMinSize();
-    if (total > idx)
-    {
-        recipient->CopyNFrom(data_ + idx * pair_size, total - idx, buffer_pool_manager);
-        SetSize(idx);
-    }
-}
+    int size = GetSize();
+    ASSERT(size >= 2, "Can not split a page with less than 2 children.");
+    int total = GetUsedBytes(), split = 0, acc = 0;
+    while (split < size - 1 && acc + (int)(INTERNAL_SLOT_SIZE + record_size(SlotLength(split))) <= total / 2)
+        acc += INTERNAL_SLOT_SIZE + record_size(SlotLength(split++));
+    split = std::max(split, 1);
 
-/* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
- *
- */
-void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager)
-{
-    memcpy(data_ + GetSize() * pair_size, src, size * pair_size); //! append to data_, may cause overflow
-    int idx = GetSize();
-    for (int i = 0; i < size; i++)
-    {
-        page_id_t page_id = ValueAt(idx + i);
-        BPlusTreePage *page_ptr = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(page_id)->GetData());
-        page_ptr->SetParentPageId(GetPageId());
-        buffer_pool_manager->UnpinPage(page_id, true);
-    }
-    IncreaseSize(size);
+    std::vector<char> keys;
+    std::vector<page_id_t> values;
+    Export(keys, values);
+    recipient->Load(keys.data() + split * GetKeySize(), values.data() + split, size - split);
+    Load(keys.data(), values.data(), split);
+    recipient->Adopt(0, recipient->GetSize(), buffer_pool_manager);
 }
 
 /*****************************************************************************
@@ -171,103 +273,83 @@ void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool
 /*
  * Remove the key & value pair in internal page according to input index(a.k.a
  * array offset)
- * NOTE: store key&value pair continuously after deletion
+ * NOTE: the record bytes are left as a hole until the next compaction
  */
 void InternalPage::Remove(int index)
 {
-    std::move(data_ + (index + 1) * pair_size, data_ + GetSize() * pair_size, data_ + index * pair_size);
+    record_bytes_ -= record_size(SlotLength(index));
+    memmove(data_ + index * INTERNAL_SLOT_SIZE, data_ + (index + 1) * INTERNAL_SLOT_SIZE,
+            (GetSize() - index - 1) * INTERNAL_SLOT_SIZE);
     IncreaseSize(-1);
-    memset(data_ + GetSize() * pair_size, 0, pair_size); // cleaning rubbish data
 }
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
-//? whether INVALID_KEY is included
 page_id_t InternalPage::RemoveAndReturnOnlyChild()
 {
-    SetSize(0);
-    return ValueAt(0);
+    page_id_t child = ValueAt(0);
+    Remove(0);
+    return child;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 /*
- * Remove all key & value pairs from this page to "recipient" page.
- * The middle_key is the separation key you should get from the parent. You need
- * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
+ * Remove all key & value pairs from this page to "recipient" page, which is the
+ * left sibling. The middle_key is the separation key from the parent, it becomes
+ * the key of my first child in the recipient.
+ * @return false if the merged page would not fit, nothing is moved then
  */
-void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager)
+bool InternalPage::MoveAllTo(InternalPage *recipient, const GenericKey *middle_key,
+                             BufferPoolManager *buffer_pool_manager)
 {
-    SetKeyAt(0, middle_key);
-    recipient->CopyNFrom(data_, GetSize(), buffer_pool_manager);
+    std::vector<char> keys;
+    std::vector<page_id_t> values;
+    recipient->Export(keys, values);
+    int first = values.size();
+    Export(keys, values);
+    memcpy(keys.data() + first * GetKeySize(), middle_key, GetKeySize());
+    if ((int)values.size() + 1 >= recipient->GetMaxSize() || !recipient->Load(keys.data(), values.data(), values.size()))
+        return false;
+    recipient->Adopt(first, recipient->GetSize(), buffer_pool_manager);
     SetSize(0);
+    return true;
 }
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
 /*
- * Remove the first key & value pair from this page to tail of "recipient" page.
- *
- * The middle_key is the separation key you should get from the parent. You need
- * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
+ * Remove the first child of this page to the tail of "recipient" page, under
+ * the middle_key taken from the parent. My second key is left in slot 0 so the
+ * caller can push it up as the new separator.
  */
-void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_key,
+bool InternalPage::MoveFirstToEndOf(InternalPage *recipient, const GenericKey *middle_key,
                                     BufferPoolManager *buffer_pool_manager)
 {
-    SetKeyAt(0, middle_key);
-    recipient->CopyNFrom(data_, 1, buffer_pool_manager);
+    if (!recipient->InsertRecord(recipient->GetSize(), reinterpret_cast<const char *>(middle_key), ValueAt(0)))
+        return false;
+    recipient->Adopt(recipient->GetSize() - 1, recipient->GetSize(), buffer_pool_manager);
     Remove(0);
-}
-
-/* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager)
-{
-    SetValueAt(GetSize(), value);
-    SetKeyAt(GetSize(), key);
-    IncreaseSize(1);
-    BPlusTreePage *page_ptr = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(value)->GetData());
-    page_ptr->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(value, true);
+    return true;
 }
 
 /*
- * Remove the last key & value pair from this page to head of "recipient" page.
- * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
- * right place.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
- * moved to the recipient
+ * Remove my last child to the head of "recipient" page. The middle_key from the
+ * parent becomes the key of the recipient's old first child, and my last key is
+ * left in the recipient's slot 0 for the caller to push up.
  */
-// TODO: update parent entry
-void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key,
+bool InternalPage::MoveLastToFrontOf(InternalPage *recipient, const GenericKey *middle_key,
                                      BufferPoolManager *buffer_pool_manager)
 {
-    recipient->SetKeyAt(0, middle_key);
-    recipient->CopyFirstFrom(ValueAt(GetSize() - 1), buffer_pool_manager); //? child page updated in this function
-    IncreaseSize(-1);
+    std::vector<char> key(GetKeySize());
+    KeyAt(GetSize() - 1, reinterpret_cast<GenericKey *>(key.data()));
+    if (!recipient->SetKeyAt(0, middle_key) || !recipient->InsertRecord(0, key.data(), ValueAt(GetSize() - 1)))
+        return false;
+    recipient->Adopt(0, 1, buffer_pool_manager);
+    Remove(GetSize() - 1);
+    return true;
 }
-
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-//? first key is updated somewhere else
-void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffer_pool_manager)
-{
-    std::move_backward(data_, data_ + GetSize() * pair_size, data_ + (GetSize() + 1) * pair_size);
-    SetValueAt(0, value);
-    BPlusTreePage *page_ptr = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(value)->GetData());
-    page_ptr->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(value, true);
-    IncreaseSize(1);
-}
\ No newline at end of file
@@ -4,10 +4,7 @@
 
 #include "index/generic_key.h"
 
-#define pairs_off (data_)
-#define pair_size (GetKeySize() + sizeof(RowId))
-#define key_off 0
-#define val_off GetKeySize()
+#define slots_off (data_ + prefix_len_)
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
@@ -16,9 +13,8 @@
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
  * next page id and set max size
- * 未初始化next_page_id
  */
-void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size)
+void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size, bool compress, LeafFormat format)
 {
     SetPageType(IndexPageType::LEAF_PAGE);
     SetSize(0);
@@ -27,6 +23,11 @@ void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int ma
     SetKeySize(key_size);
     SetNextPageId(INVALID_PAGE_ID);
     SetMaxSize(max_size);
+    prefix_len_ = 0;
+    record_start_ = LEAF_PAGE_CAPACITY;
+    record_bytes_ = 0;
+    compress_ = compress;
+    format_ = format;
 }
 
 /**
@@ -46,73 +47,205 @@ void LeafPage::SetNextPageId(page_id_t next_page_id)
     }
 }
 
+uint16_t LeafPage::SlotOffset(int index) const
+{
+    uint16_t offset;
+    memcpy(&offset, slots_off + index * LEAF_SLOT_SIZE, sizeof(uint16_t));
+    return offset;
+}
+
+uint16_t LeafPage::SlotLength(int index) const
+{
+    uint16_t length;
+    memcpy(&length, slots_off + index * LEAF_SLOT_SIZE + sizeof(uint16_t), sizeof(uint16_t));
+    return length;
+}
+
+void LeafPage::WriteSlot(int index, uint16_t offset, uint16_t length)
+{
+    memcpy(slots_off + index * LEAF_SLOT_SIZE, &offset, sizeof(uint16_t));
+    memcpy(slots_off + index * LEAF_SLOT_SIZE + sizeof(uint16_t), &length, sizeof(uint16_t));
+}
+
+int LeafPage::ValueSize(uint16_t offset) const
+{
+    if (format_ == LEAF_ROW_ID)
+        return sizeof(RowId);
+    int base = format_ == LEAF_COVERING ? sizeof(RowId) : 0;
+    uint16_t length;
+    memcpy(&length, data_ + offset + base, sizeof(uint16_t));
+    return base + sizeof(uint16_t) + length;
+}
+
+int LeafPage::RecordSize(int index) const
+{
+    return ValueSize(SlotOffset(index)) + SlotLength(index);
+}
+
+const char *LeafPage::SuffixAt(int index) const
+{
+    uint16_t offset = SlotOffset(index);
+    return data_ + offset + ValueSize(offset);
+}
+
+int LeafPage::GetUsedBytes() const
+{
+    return prefix_len_ + GetSize() * LEAF_SLOT_SIZE + record_bytes_;
+}
+
+bool LeafPage::IsUnderflow() const
+{
+    return GetUsedBytes() < LEAF_PAGE_CAPACITY / 4;
+}
+
+int LeafPage::CompareSuffix(int index, const char *key, int key_len) const
+{
+    int length = SlotLength(index);
+    int res = memcmp(SuffixAt(index), key + prefix_len_, length);
+    if (res != 0)
+        return res;
+    // the stored key is zero padded, so it is smaller as long as key has bytes left
+    return key_len > prefix_len_ + length ? -1 : 0;
+}
+
+int LeafPage::CompareAt(int index, const GenericKey *key) const
+{
+    const char *buf = reinterpret_cast<const char *>(key);
+    int res = memcmp(data_, buf, prefix_len_);
+    if (res != 0)
+        return res;
+    return CompareSuffix(index, buf, KeyManager::KeyLength(buf, GetKeySize()));
+}
+
 /**
  * Helper method to find the first index i so that pairs_[i].first >= key
- * NOTE: This method is only used when generating index iterator
- * 二分查找
+ * The page prefix is checked once, then the binary search only looks at suffixes
  */
-int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM)
+int LeafPage::KeyIndex(const GenericKey *key) const
 {
-    if (KM.CompareKeys(key, KeyAt(GetSize() - 1)) > 0)
+    const char *buf = reinterpret_cast<const char *>(key);
+    int res = memcmp(data_, buf, prefix_len_);
+    if (GetSize() == 0 || res > 0)
+        return 0;
+    if (res < 0)
         return GetSize();
-    int left = 0, right = GetSize() - 1;
-    while (right - left > 1)
+    int key_len = KeyManager::KeyLength(buf, GetKeySize());
+    int left = 0, right = GetSize();
+    while (left < right)
     {
-        int mid = (right + left) / 2;
-        int res = KM.CompareKeys(key, KeyAt(mid));
-        if (res > 0)
-            left = mid;
-        else if (res < 0)
-            right = mid;
+        int mid = (left + right) / 2;
+        if (CompareSuffix(mid, buf, key_len) < 0)
+            left = mid + 1;
         else
-            return mid;
+            right = mid;
     }
-    return KM.CompareKeys(key, KeyAt(left)) > 0 ? right : left;
+    return left;
 }
 
 /*
- * Helper method to find and return the key associated with input "index"(a.k.a
+ * Helper method to rebuild the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *LeafPage::KeyAt(int index)
+void LeafPage::KeyAt(int index, GenericKey *key) const
 {
-    return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
+    char *buf = reinterpret_cast<char *>(key);
+    memset(buf, 0, GetKeySize());
+    memcpy(buf, data_, prefix_len_);
+    memcpy(buf + prefix_len_, SuffixAt(index), SlotLength(index));
 }
 
-void LeafPage::SetKeyAt(int index, GenericKey *key)
+RowId LeafPage::ValueAt(int index) const
 {
-    memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
+    // record ids are stored in their int64 form
+    int64_t value;
+    memcpy(&value, data_ + SlotOffset(index), sizeof(value));
+    return RowId(value);
 }
 
-RowId LeafPage::ValueAt(int index) const
+void LeafPage::SetValueAt(int index, RowId value)
 {
-    return *reinterpret_cast<const RowId *>(pairs_off + index * pair_size + val_off);
+    int64_t rid = value.Get();
+    memcpy(data_ + SlotOffset(index), &rid, sizeof(rid));
 }
 
-void LeafPage::SetValueAt(int index, RowId value)
+const char *LeafPage::PostingAt(int index, int &length) const
 {
-    *reinterpret_cast<RowId *>(pairs_off + index * pair_size + val_off) = value;
+    uint16_t offset = SlotOffset(index);
+    length = ValueSize(offset) - sizeof(uint16_t);
+    return data_ + offset + sizeof(uint16_t);
 }
 
-void *LeafPage::PairPtrAt(int index)
+const char *LeafPage::PayloadAt(int index, int &length) const
 {
-    return KeyAt(index);
+    uint16_t offset = SlotOffset(index);
+    length = ValueSize(offset) - sizeof(RowId) - sizeof(uint16_t);
+    return data_ + offset + sizeof(RowId) + sizeof(uint16_t);
 }
 
-void LeafPage::PairCopy(void *dest, void *src, int pair_num)
+void LeafPage::Export(std::vector<char> &keys, std::vector<std::string> &values, int begin, int end) const
 {
-    memcpy(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
+    if (end < 0)
+        end = GetSize();
+    size_t base = keys.size();
+    keys.resize(base + (end - begin) * GetKeySize());
+    for (int i = begin; i < end; i++)
+    {
+        KeyAt(i, reinterpret_cast<GenericKey *>(keys.data() + base + (i - begin) * GetKeySize()));
+        uint16_t offset = SlotOffset(i);
+        values.emplace_back(data_ + offset, ValueSize(offset));
+    }
 }
 
 /*
- * Helper method to find and return the key & value pair associated with input
- * "index"(a.k.a. array offset)
+ * The prefix of a freshly loaded page is whatever its first and last keys
+ * share, every key in between shares it as well since keys compare bytewise.
  */
-std::pair<GenericKey *, RowId> LeafPage::GetItem(int index)
+bool LeafPage::Load(const char *keys, const std::string *values, int size)
 {
-    GenericKey *key = KeyAt(index);
-    RowId rid = ValueAt(index);
-    return make_pair(key, rid);
+    int key_size = GetKeySize();
+    int prefix_len = 0;
+    if (compress_ && size == 1)
+        prefix_len = KeyManager::KeyLength(keys, key_size);
+    else if (compress_ && size > 1)
+        prefix_len = KeyManager::CommonPrefix(keys, keys + (size - 1) * key_size, key_size);
+
+    int total = prefix_len + size * LEAF_SLOT_SIZE;
+    for (int i = 0; i < size; i++)
+        total += values[i].size() + std::max(0, KeyManager::KeyLength(keys + i * key_size, key_size) - prefix_len);
+    if (total > LEAF_PAGE_CAPACITY)
+        return false;
+
+    prefix_len_ = prefix_len;
+    memcpy(data_, keys, prefix_len);
+    record_start_ = LEAF_PAGE_CAPACITY;
+    record_bytes_ = 0;
+    for (int i = 0; i < size; i++)
+    {
+        const char *key = keys + i * key_size;
+        uint16_t length = std::max(0, KeyManager::KeyLength(key, key_size) - prefix_len);
+        record_start_ -= values[i].size() + length;
+        memcpy(data_ + record_start_, values[i].data(), values[i].size());
+        memcpy(data_ + record_start_ + values[i].size(), key + prefix_len, length);
+        WriteSlot(i, record_start_, length);
+        record_bytes_ += values[i].size() + length;
+    }
+    SetSize(size);
+    return true;
+}
+
+void LeafPage::Compact()
+{
+    char buffer[LEAF_PAGE_CAPACITY];
+    uint16_t start = LEAF_PAGE_CAPACITY;
+    for (int i = 0; i < GetSize(); i++)
+    {
+        int size = RecordSize(i);
+        start -= size;
+        memcpy(buffer + start, data_ + SlotOffset(i), size);
+        WriteSlot(i, start, SlotLength(i));
+    }
+    memcpy(data_ + start, buffer + start, LEAF_PAGE_CAPACITY - start);
+    record_start_ = start;
 }
 
 /*****************************************************************************
@@ -120,43 +253,135 @@ std::pair<GenericKey *, RowId> LeafPage::GetItem(int index)
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
- * @return page size after insertion
+ * A key outside of the page prefix makes the whole page be re-encoded with the
+ * shorter prefix.
+ * @return false if the pair does not fit, the page is not modified then
  */
-int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM)
+bool LeafPage::Insert(const GenericKey *key, const RowId &value, const char *payload, int length)
 {
-    int index = GetSize() == 0 ? 0 : KeyIndex(key, KM); // first key[i] that >= key
-    if (index != GetSize())
-        std::move_backward(data_ + index * pair_size, data_ + GetSize() * pair_size, data_ + ((GetSize() + 1) * pair_size));
-    SetKeyAt(index, key);
-    SetValueAt(index, value);
-    IncreaseSize(1);
-    return GetSize();
+    int64_t rid = value.Get();
+    if (format_ != LEAF_COVERING)
+        return InsertRecord(key, reinterpret_cast<const char *>(&rid), sizeof(rid));
+    std::string record(reinterpret_cast<const char *>(&rid), sizeof(rid));
+    uint16_t size = length;
+    record.append(reinterpret_cast<const char *>(&size), sizeof(uint16_t));
+    record.append(payload, length);
+    return InsertRecord(key, record.data(), record.size());
+}
+
+bool LeafPage::InsertPosting(const GenericKey *key, const char *posting, int length)
+{
+    std::string value(sizeof(uint16_t), 0);
+    uint16_t size = length;
+    memcpy(value.data(), &size, sizeof(uint16_t));
+    value.append(posting, length);
+    return InsertRecord(key, value.data(), value.size());
+}
+
+bool LeafPage::SetPostingAt(int index, const char *posting, int length)
+{
+    return SetTailAt(index, 0, posting, length);
+}
+
+bool LeafPage::SetPayloadAt(int index, const char *payload, int length)
+{
+    return SetTailAt(index, sizeof(RowId), payload, length);
 }
 
-/*****************************************************************************
- * SPLIT
- *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Records only grow by being moved to the free space, the old bytes are a hole
+ * until the next compaction. Shrinking is done in place and always succeeds.
  */
-void LeafPage::MoveHalfTo(LeafPage *recipient)
+bool LeafPage::SetTailAt(int index, int base, const char *data, int length)
 {
-    int total = GetSize(), idx = GetMinSize();
-    if (total > idx)
+    uint16_t offset = SlotOffset(index);
+    int old_length = ValueSize(offset) - base - sizeof(uint16_t);
+    char *record = data_ + offset + base;
+    if (length <= old_length)
     {
-        recipient->CopyNFrom(data_ + idx * pair_size, total - idx);
-        SetSize(idx);
-        recipient->IncreaseSize(total - idx);
+        uint16_t size = length;
+        memmove(record + sizeof(uint16_t) + length, record + sizeof(uint16_t) + old_length, SlotLength(index));
+        memcpy(record, &size, sizeof(uint16_t));
+        memcpy(record + sizeof(uint16_t), data, length);
+        record_bytes_ -= old_length - length;
+        return true;
     }
+
+    std::vector<char> key(GetKeySize());
+    KeyAt(index, reinterpret_cast<GenericKey *>(key.data()));
+    std::string old_value(data_ + offset, ValueSize(offset));
+    std::string value(old_value, 0, base);
+    uint16_t size = length;
+    value.append(reinterpret_cast<const char *>(&size), sizeof(uint16_t));
+    value.append(data, length);
+    Remove(index);
+    if (InsertRecord(reinterpret_cast<GenericKey *>(key.data()), value.data(), value.size()))
+        return true;
+    [[maybe_unused]] bool restored = InsertRecord(reinterpret_cast<GenericKey *>(key.data()), old_value.data(), old_value.size());
+    ASSERT(restored, "The old record must fit again.");
+    return false;
+}
+
+bool LeafPage::InsertRecord(const GenericKey *key, const char *value, int value_size)
+{
+    if (GetSize() + 1 >= GetMaxSize())
+        return false;
+    const char *buf = reinterpret_cast<const char *>(key);
+    int index = KeyIndex(key);
+    if (memcmp(data_, buf, prefix_len_) != 0)
+    {
+        std::vector<char> keys;
+        std::vector<std::string> values;
+        Export(keys, values);
+        keys.insert(keys.begin() + index * GetKeySize(), buf, buf + GetKeySize());
+        values.emplace(values.begin() + index, value, value_size);
+        return Load(keys.data(), values.data(), values.size());
+    }
+
+    uint16_t length = std::max(0, KeyManager::KeyLength(buf, GetKeySize()) - prefix_len_);
+    int slots_end = prefix_len_ + (GetSize() + 1) * LEAF_SLOT_SIZE;
+    if (record_start_ - slots_end < value_size + length)
+    {
+        if (LEAF_PAGE_CAPACITY - slots_end - record_bytes_ < value_size + length)
+            return false;
+        Compact();
+    }
+    record_start_ -= value_size + length;
+    memcpy(data_ + record_start_, value, value_size);
+    memcpy(data_ + record_start_ + value_size, buf + prefix_len_, length);
+    memmove(slots_off + (index + 1) * LEAF_SLOT_SIZE, slots_off + index * LEAF_SLOT_SIZE,
+            (GetSize() - index) * LEAF_SLOT_SIZE);
+    WriteSlot(index, record_start_, length);
+    record_bytes_ += value_size + length;
+    IncreaseSize(1);
+    return true;
 }
 
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
 /*
- * Copy starting from items, and copy {size} number of elements into me.
+ * Remove half of the records (by size) from this page to "recipient" page
+ * Both halves get their own, possibly longer, prefix.
  */
-void LeafPage::CopyNFrom(void *src, int size)
+void LeafPage::MoveHalfTo(LeafPage *recipient)
 {
-    // memcpy(data_ + GetSize() * pair_size, (char *)src, size * pair_size);
-    std::move((char *)src, (char *)src + size * pair_size, data_ + GetSize() * pair_size);
+    int size = GetSize();
+    ASSERT(size >= 2, "Can not split a page with less than 2 records.");
+    int total = 0;
+    for (int i = 0; i < size; i++)
+        total += LEAF_SLOT_SIZE + RecordSize(i);
+    int split = 0, acc = 0;
+    while (split < size - 1 && acc + (int)LEAF_SLOT_SIZE + RecordSize(split) <= total / 2)
+        acc += LEAF_SLOT_SIZE + RecordSize(split++);
+    split = std::max(split, 1);
+
+    std::vector<char> keys;
+    std::vector<std::string> values;
+    Export(keys, values);
+    [[maybe_unused]] bool moved = recipient->Load(keys.data() + split * GetKeySize(), values.data() + split, size - split);
+    [[maybe_unused]] bool kept = Load(keys.data(), values.data(), split);
+    ASSERT(moved && kept, "Split halves must fit in a page.");
 }
 
 /*****************************************************************************
@@ -167,10 +392,10 @@ void LeafPage::CopyNFrom(void *src, int size)
  * does, then store its corresponding value in input "value" and return true.
  * If the key does not exist, then return false
  */
-bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
+bool LeafPage::Lookup(const GenericKey *key, RowId &value) const
 {
-    int index = KeyIndex(key, KM);
-    if (index != GetSize() && KM.CompareKeys(KeyAt(index), key) == 0)
+    int index = KeyIndex(key);
+    if (index != GetSize() && CompareAt(index, key) == 0)
     {
         value = ValueAt(index);
         return true;
@@ -184,34 +409,52 @@ bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
 /*
  * First look through leaf page to see whether delete key exist or not. If
  * existed, perform deletion, otherwise return immediately.
- * NOTE: store key&value pair continuously after deletion
  * @return  page size after deletion
  */
-int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM)
+int LeafPage::RemoveAndDeleteRecord(const GenericKey *key)
 {
-    int index = KeyIndex(key, KM);
-    if (index != GetSize() && KM.CompareKeys(KeyAt(index), key) == 0)
+    int index = KeyIndex(key);
+    if (index != GetSize() && CompareAt(index, key) == 0)
+        Remove(index);
+    return GetSize();
+}
+
+/*
+ * The record bytes are left as a hole until the next compaction
+ */
+void LeafPage::Remove(int index)
+{
+    record_bytes_ -= RecordSize(index);
+    memmove(slots_off + index * LEAF_SLOT_SIZE, slots_off + (index + 1) * LEAF_SLOT_SIZE,
+            (GetSize() - index - 1) * LEAF_SLOT_SIZE);
+    IncreaseSize(-1);
+    if (GetSize() == 0)
     {
-        std::move(data_ + (index + 1) * pair_size, data_ + GetSize() * pair_size, data_ + index * pair_size);
-        IncreaseSize(-1);
-        // memset(data_ + GetSize() * pair_size, 0, pair_size);
+        prefix_len_ = 0;
+        record_start_ = LEAF_PAGE_CAPACITY;
+        record_bytes_ = 0;
     }
-    return GetSize();
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 /*
- * Remove all key & value pairs from this page to "recipient" page. Don't forget
- * to update the next_page id in the sibling page
+ * Remove all key & value pairs from this page to "recipient" page, which is the
+ * left sibling. Don't forget to update the next_page id in the sibling page
+ * @return false if the merged page would not fit, nothing is moved then
  */
-void LeafPage::MoveAllTo(LeafPage *recipient)
+bool LeafPage::MoveAllTo(LeafPage *recipient)
 {
-    recipient->CopyNFrom(data_, GetSize());
+    std::vector<char> keys;
+    std::vector<std::string> values;
+    recipient->Export(keys, values);
+    Export(keys, values);
+    if ((int)values.size() + 1 >= recipient->GetMaxSize() || !recipient->Load(keys.data(), values.data(), values.size()))
+        return false;
     recipient->SetNextPageId(GetNextPageId());
-    recipient->IncreaseSize(GetSize());
     SetSize(0);
+    return true;
 }
 
 /*****************************************************************************
@@ -219,43 +462,27 @@ void LeafPage::MoveAllTo(LeafPage *recipient)
  *****************************************************************************/
 /*
  * Remove the first key & value pair from this page to "recipient" page.
- *
  */
-void LeafPage::MoveFirstToEndOf(LeafPage *recipient)
+bool LeafPage::MoveFirstToEndOf(LeafPage *recipient)
 {
-    recipient->CopyNFrom(data_, 1);
-    recipient->IncreaseSize(1);
-    std::move(data_ + pair_size, data_ + GetSize() * pair_size, data_);
-    IncreaseSize(-1);
-}
-
-/*
- * Copy the item into the end of my item list. (Append item to my array)
- */
-void LeafPage::CopyLastFrom(GenericKey *key, const RowId value)
-{
-    SetValueAt(GetSize(), value);
-    SetKeyAt(GetSize(), key);
-    IncreaseSize(1);
+    std::vector<char> key(GetKeySize());
+    KeyAt(0, reinterpret_cast<GenericKey *>(key.data()));
+    if (!recipient->InsertRecord(reinterpret_cast<GenericKey *>(key.data()), data_ + SlotOffset(0), ValueSize(SlotOffset(0))))
+        return false;
+    Remove(0);
+    return true;
 }
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
  */
-void LeafPage::MoveLastToFrontOf(LeafPage *recipient)
+bool LeafPage::MoveLastToFrontOf(LeafPage *recipient)
 {
-    recipient->CopyFirstFrom(KeyAt(GetSize() - 1), ValueAt(GetSize() - 1));
-    IncreaseSize(-1);
+    std::vector<char> key(GetKeySize());
+    KeyAt(GetSize() - 1, reinterpret_cast<GenericKey *>(key.data()));
+    uint16_t offset = SlotOffset(GetSize() - 1);
+    if (!recipient->InsertRecord(reinterpret_cast<GenericKey *>(key.data()), data_ + offset, ValueSize(offset)))
+        return false;
+    Remove(GetSize() - 1);
+    return true;
 }
-
-/*
- * Insert item at the front of my items. Move items accordingly.
- *
- */
-void LeafPage::CopyFirstFrom(GenericKey *key, const RowId value)
-{
-    std::move_backward(data_, data_ + GetSize() * pair_size, data_ + (GetSize() + 1) * pair_size);
-    SetKeyAt(0, key);
-    SetValueAt(0, value);
-    IncreaseSize(1);
-}
\ No newline at end of file
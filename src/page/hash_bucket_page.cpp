@@ -0,0 +1,40 @@
+#include "page/hash_bucket_page.h"
+
+#define pair_size (key_size_ + sizeof(RowId))
+
+void HashBucketPage::Init(int key_size)
+{
+    key_size_ = key_size;
+    size_ = 0;
+    next_page_id_ = INVALID_PAGE_ID;
+}
+
+const GenericKey *HashBucketPage::KeyAt(int index) const
+{
+    return reinterpret_cast<const GenericKey *>(data_ + index * pair_size);
+}
+
+RowId HashBucketPage::ValueAt(int index) const
+{
+    int64_t value;
+    memcpy(&value, data_ + index * pair_size + key_size_, sizeof(value));
+    return RowId(value);
+}
+
+bool HashBucketPage::Insert(const GenericKey *key, const RowId &value)
+{
+    if (IsFull())
+        return false;
+    memcpy(data_ + size_ * pair_size, key, key_size_);
+    int64_t rid = value.Get();
+    memcpy(data_ + size_ * pair_size + key_size_, &rid, sizeof(rid));
+    size_++;
+    return true;
+}
+
+void HashBucketPage::RemoveAt(int index)
+{
+    size_--;
+    if (index != size_)
+        memcpy(data_ + index * pair_size, data_ + size_ * pair_size, pair_size);
+}
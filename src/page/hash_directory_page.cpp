@@ -0,0 +1,31 @@
+#include "page/hash_directory_page.h"
+
+void HashDirectoryPage::Init(page_id_t bucket_page_id)
+{
+    global_depth_ = 0;
+    local_depths_[0] = 0;
+    bucket_page_ids_[0] = bucket_page_id;
+}
+
+void HashDirectoryPage::IncrGlobalDepth()
+{
+    uint32_t size = GetSize();
+    for (uint32_t i = 0; i < size; i++)
+    {
+        local_depths_[size + i] = local_depths_[i];
+        bucket_page_ids_[size + i] = bucket_page_ids_[i];
+    }
+    global_depth_++;
+}
+
+bool HashDirectoryPage::CanShrink() const
+{
+    if (global_depth_ == 0)
+        return false;
+    for (uint32_t i = 0; i < GetSize(); i++)
+    {
+        if (local_depths_[i] == global_depth_)
+            return false;
+    }
+    return true;
+}
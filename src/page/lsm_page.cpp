@@ -0,0 +1,43 @@
+#include "page/lsm_page.h"
+
+#include <cstring>
+
+void SortedRunPage::Init()
+{
+    count_ = 0;
+    bytes_ = 0;
+}
+
+bool SortedRunPage::Append(const LsmEntry &entry)
+{
+    if (bytes_ + EntrySize(entry) > SORTED_RUN_PAGE_CAPACITY)
+        return false;
+    char *buf = data_ + bytes_;
+    uint16_t key_length = entry.key.size();
+    memcpy(buf, &key_length, sizeof(key_length));
+    memcpy(buf + 2, entry.key.data(), key_length);
+    int64_t rid = entry.value.Get();
+    memcpy(buf + 2 + key_length, &rid, sizeof(rid));
+    buf[2 + key_length + 8] = entry.deleted;
+    bytes_ += EntrySize(entry);
+    count_++;
+    return true;
+}
+
+void SortedRunPage::Decode(std::vector<LsmEntry> &entries) const
+{
+    const char *buf = data_;
+    for (int i = 0; i < count_; i++)
+    {
+        LsmEntry entry;
+        uint16_t key_length;
+        memcpy(&key_length, buf, sizeof(key_length));
+        entry.key.assign(buf + 2, key_length);
+        int64_t rid;
+        memcpy(&rid, buf + 2 + key_length, sizeof(rid));
+        entry.value = RowId(rid);
+        entry.deleted = buf[2 + key_length + 8] != 0;
+        buf += SortedRunPage::EntrySize(entry);
+        entries.emplace_back(std::move(entry));
+    }
+}
@@ -0,0 +1,100 @@
+#include "page/posting_page.h"
+
+#include <cstring>
+
+void PostingPage::Init()
+{
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+    bytes_ = 0;
+    last_rid_ = 0;
+}
+
+int PostingPage::PutVarint(char *buf, uint64_t value)
+{
+    int len = 0;
+    while (value >= 0x80)
+    {
+        buf[len++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = static_cast<char>(value);
+    return len;
+}
+
+int PostingPage::GetVarint(const char *buf, uint64_t &value)
+{
+    int len = 0;
+    int shift = 0;
+    value = 0;
+    while (true)
+    {
+        uint8_t byte = static_cast<uint8_t>(buf[len++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            break;
+        shift += 7;
+    }
+    return len;
+}
+
+int PostingPage::GetVarint(const char *buf, const char *end, uint64_t &value)
+{
+    int len = 0;
+    int shift = 0;
+    value = 0;
+    while (buf + len < end && shift < 64)
+    {
+        uint8_t byte = static_cast<uint8_t>(buf[len++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return len;
+        shift += 7;
+    }
+    return 0;
+}
+
+void PostingPage::Decode(std::vector<RowId> &rids) const
+{
+    uint64_t value = 0;
+    const char *buf = data_;
+    for (int i = 0; i < count_; i++)
+    {
+        uint64_t delta;
+        buf += GetVarint(buf, delta);
+        value += delta;
+        rids.emplace_back(static_cast<int64_t>(value));
+    }
+}
+
+bool PostingPage::Encode(const RowId *rids, int count)
+{
+    char buf[POSTING_PAGE_CAPACITY + 10];
+    int bytes = 0;
+    uint64_t prev = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bytes += PutVarint(buf + bytes, Order(rids[i]) - prev);
+        if (bytes > POSTING_PAGE_CAPACITY)
+            return false;
+        prev = Order(rids[i]);
+    }
+    memcpy(data_, buf, bytes);
+    count_ = count;
+    bytes_ = bytes;
+    last_rid_ = static_cast<int64_t>(prev);
+    return true;
+}
+
+bool PostingPage::Append(const RowId &rid)
+{
+    char buf[10];
+    int len = PutVarint(buf, Order(rid) - static_cast<uint64_t>(last_rid_));
+    if (bytes_ + len > POSTING_PAGE_CAPACITY)
+        return false;
+    memcpy(data_ + bytes_, buf, len);
+    bytes_ += len;
+    count_++;
+    last_rid_ = rid.Get();
+    return true;
+}
@@ -577,10 +577,35 @@ char *yytext;
 #line 1 "minisql.l"
 #line 2 "minisql.l"
     #include <stdio.h>
+    #include <string.h>
     #include "parser/parser.h"
     #include "parser/minisql_yacc.h"
     int yywrap();
     extern YYSTYPE yylval;
+
+    /* keywords recognized by the identifier rule, 0 if text is not one */
+    static int MinisqlKeyword(const char *text) {
+      static const struct { const char *name; int token; } keywords[] = {
+        {"include", INCLUDE},
+        {"in", IN},
+        {"conflict", CONFLICT},
+        {"do", DO},
+        {"nothing", NOTHING},
+        {"join", JOIN},
+        {"group", GROUP},
+        {"by", BY},
+        {"order", ORDER},
+        {"asc", ASC},
+        {"desc", DESC},
+        {"limit", LIMIT},
+      };
+      for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        if (strcmp(text, keywords[i].name) == 0) {
+          return keywords[i].token;
+        }
+      }
+      return 0;
+    }
 #line 585 "../../parser/minisql_lex.c"
 
 #define INITIAL 0
@@ -1170,6 +1195,10 @@ YY_RULE_SETUP
 #line 208 "minisql.l"
 {
   MinisqlParserMovePos(yylineno, yytext);
+  int keyword = MinisqlKeyword(yytext);
+  if (keyword != 0) {
+    return keyword;
+  }
   yylval.syntax_node = CreateSyntaxNode(kNodeIdentifier, yytext);
   return IDENTIFIER;
 }
@@ -1300,6 +1329,11 @@ case 55:
 YY_RULE_SETUP
 #line 290 "minisql.l"
 {
+  if (yytext[0] == '.') {
+    /* separates the table and the column of a qualified column */
+    MinisqlParserMovePos(yylineno, yytext);
+    return ('.');
+  }
   char str[128] = {0};
   sprintf(str, "Unrecognized token [%s] in input sql.", yytext);
   MinisqlParserSetError(str);
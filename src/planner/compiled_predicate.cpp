@@ -0,0 +1,328 @@
+#include "planner/compiled_predicate.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
+
+namespace {
+/** @return whether expr reads a column of the row */
+bool HasColumn(const AbstractExpressionRef &expr) {
+  if (expr->GetType() == ExpressionType::ColumnExpression) {
+    return true;
+  }
+  return std::any_of(expr->GetChildren().begin(), expr->GetChildren().end(), HasColumn);
+}
+
+/** @return the value of an expression without columns, as the interpreter reads it */
+CmpBool Fold(const AbstractExpressionRef &expr) {
+  Field value = expr->Evaluate(nullptr);
+  if (value.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(value.CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue);
+}
+
+/** @return the operator that compares the same as comp_type with its operands swapped */
+std::string Mirror(const std::string &comp_type) {
+  if (comp_type == "<") return ">";
+  if (comp_type == "<=") return ">=";
+  if (comp_type == ">") return "<";
+  if (comp_type == ">=") return "<=";
+  return comp_type;
+}
+
+CmpBool And(CmpBool l, CmpBool r) {
+  if (l == CmpBool::kFalse || r == CmpBool::kFalse) {
+    return CmpBool::kFalse;
+  }
+  return l == CmpBool::kTrue && r == CmpBool::kTrue ? CmpBool::kTrue : CmpBool::kNull;
+}
+
+CmpBool Or(CmpBool l, CmpBool r) {
+  if (l == CmpBool::kTrue || r == CmpBool::kTrue) {
+    return CmpBool::kTrue;
+  }
+  return l == CmpBool::kFalse && r == CmpBool::kFalse ? CmpBool::kFalse : CmpBool::kNull;
+}
+}  // namespace
+
+template <typename Cmp, TypeId Type, bool RightConstant>
+CmpBool CompiledPredicate::Compare(const Instruction &instruction, const Row &row) {
+  const Field *left = row.GetField(instruction.left_column);
+  const Field *right = RightConstant ? nullptr : row.GetField(instruction.right_column);
+  if (left->is_null_ || (!RightConstant && right->is_null_)) {
+    return CmpBool::kNull;
+  }
+  if constexpr (Type == TypeId::kTypeInt) {
+    int32_t value = RightConstant ? instruction.int_value : right->value_.integer_;
+    return GetCmpBool(Cmp()(left->value_.integer_, value));
+  } else if constexpr (Type == TypeId::kTypeFloat) {
+    float value = RightConstant ? instruction.float_value : right->value_.float_;
+    return GetCmpBool(Cmp()(left->value_.float_, value));
+  } else {
+    const char *data = RightConstant ? instruction.chars_value.data() : right->value_.chars_;
+    uint32_t len = RightConstant ? instruction.chars_value.size() : right->len_;
+    int order = memcmp(left->value_.chars_, data, std::min(left->len_, len));
+    if (order == 0) {
+      order = static_cast<int>(left->len_) - static_cast<int>(len);
+    }
+    return GetCmpBool(Cmp()(order, 0));
+  }
+}
+
+template <typename Cmp>
+CompiledPredicate::CompareFn CompiledPredicate::Resolve(TypeId type, bool right_constant) {
+  switch (type) {
+    case TypeId::kTypeInt:
+      return right_constant ? Compare<Cmp, TypeId::kTypeInt, true> : Compare<Cmp, TypeId::kTypeInt, false>;
+    case TypeId::kTypeFloat:
+      return right_constant ? Compare<Cmp, TypeId::kTypeFloat, true> : Compare<Cmp, TypeId::kTypeFloat, false>;
+    case TypeId::kTypeChar:
+      return right_constant ? Compare<Cmp, TypeId::kTypeChar, true> : Compare<Cmp, TypeId::kTypeChar, false>;
+    default:
+      return nullptr;
+  }
+}
+
+std::unique_ptr<CompiledPredicate> CompiledPredicate::Compile(const AbstractExpressionRef &expr) {
+  if (expr == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<CompiledPredicate> predicate(new CompiledPredicate());
+  if (!Emit(expr, predicate->program_)) {
+    return nullptr;
+  }
+  // Run() keeps its stack in a fixed array
+  size_t depth = 0, max_depth = 0;
+  for (auto &instruction : predicate->program_) {
+    depth = instruction.op == OpCode::kAnd || instruction.op == OpCode::kOr ? depth - 1 : depth + 1;
+    max_depth = std::max(max_depth, depth);
+  }
+  if (max_depth > MAX_DEPTH) {
+    return nullptr;
+  }
+  return predicate;
+}
+
+bool CompiledPredicate::Emit(const AbstractExpressionRef &expr, std::vector<Instruction> &program) {
+  if (!HasColumn(expr)) {
+    if (expr->GetReturnType() != TypeId::kTypeInt) {
+      return false;
+    }
+    Instruction instruction{OpCode::kConstant};
+    instruction.constant = Fold(expr);
+    program.push_back(std::move(instruction));
+    return true;
+  }
+  switch (expr->GetType()) {
+    case ExpressionType::ComparisonExpression:
+      return EmitComparison(expr, program);
+    case ExpressionType::LogicExpression: {
+      auto logic_type = std::dynamic_pointer_cast<LogicExpression>(expr)->logic_type_;
+      size_t begin = program.size();
+      if (!Emit(expr->GetChildAt(0), program)) {
+        return false;
+      }
+      size_t middle = program.size();
+      if (!Emit(expr->GetChildAt(1), program)) {
+        return false;
+      }
+      // One side is a constant: it either decides the result or drops out
+      auto dominant = logic_type == LogicType::And ? CmpBool::kFalse : CmpBool::kTrue;
+      auto neutral = logic_type == LogicType::And ? CmpBool::kTrue : CmpBool::kFalse;
+      bool left_constant = middle - begin == 1 && program[begin].op == OpCode::kConstant;
+      bool right_constant = program.size() - middle == 1 && program[middle].op == OpCode::kConstant;
+      if ((left_constant && program[begin].constant == dominant) ||
+          (right_constant && program[middle].constant == dominant)) {
+        program.erase(program.begin() + begin + 1, program.end());
+        program[begin] = Instruction{OpCode::kConstant};
+        program[begin].constant = dominant;
+      } else if (left_constant && program[begin].constant == neutral) {
+        program.erase(program.begin() + begin);
+      } else if (right_constant && program[middle].constant == neutral) {
+        program.pop_back();
+      } else {
+        program.push_back(Instruction{logic_type == LogicType::And ? OpCode::kAnd : OpCode::kOr});
+      }
+      return true;
+    }
+    default:
+      // A column read as a boolean
+      return false;
+  }
+}
+
+bool CompiledPredicate::EmitComparison(const AbstractExpressionRef &expr, std::vector<Instruction> &program) {
+  std::string comp_type = std::dynamic_pointer_cast<ComparisonExpression>(expr)->GetComparisonType();
+  auto left = expr->GetChildAt(0);
+  auto right = expr->GetChildAt(1);
+  if (comp_type == "is" || comp_type == "not") {
+    if (left->GetType() != ExpressionType::ColumnExpression) {
+      return false;
+    }
+    Instruction instruction{comp_type == "is" ? OpCode::kIsNull : OpCode::kIsNotNull};
+    instruction.left_column = std::dynamic_pointer_cast<ColumnValueExpression>(left)->GetColIdx();
+    program.push_back(std::move(instruction));
+    return true;
+  }
+  // Keep the column on the left
+  if (left->GetType() != ExpressionType::ColumnExpression) {
+    std::swap(left, right);
+    comp_type = Mirror(comp_type);
+  }
+  if (left->GetType() != ExpressionType::ColumnExpression || left->GetReturnType() != right->GetReturnType()) {
+    return false;
+  }
+  bool right_constant = right->GetType() == ExpressionType::ConstantExpression;
+  if (!right_constant && right->GetType() != ExpressionType::ColumnExpression) {
+    return false;
+  }
+  Instruction instruction{OpCode::kCompare};
+  instruction.right_constant = right_constant;
+  instruction.left_column = std::dynamic_pointer_cast<ColumnValueExpression>(left)->GetColIdx();
+  if (right_constant) {
+    const Field &value = std::dynamic_pointer_cast<ConstantValueExpression>(right)->val_;
+    if (value.IsNull()) {
+      // Compares to nothing for every row
+      instruction = Instruction{OpCode::kConstant};
+      program.push_back(std::move(instruction));
+      return true;
+    }
+    instruction.int_value = value.value_.integer_;
+    instruction.float_value = value.value_.float_;
+    if (value.GetTypeId() == TypeId::kTypeChar) {
+      instruction.chars_value.assign(value.GetData(), value.GetLength());
+    }
+  } else {
+    instruction.right_column = std::dynamic_pointer_cast<ColumnValueExpression>(right)->GetColIdx();
+  }
+  TypeId type = left->GetReturnType();
+  instruction.type = type;
+  if (comp_type == "=") {
+    instruction.compare = Resolve<std::equal_to<>>(type, right_constant);
+    instruction.compare_op = CompareOp::kEqual;
+  } else if (comp_type == "<>") {
+    instruction.compare = Resolve<std::not_equal_to<>>(type, right_constant);
+    instruction.compare_op = CompareOp::kNotEqual;
+  } else if (comp_type == "<") {
+    instruction.compare = Resolve<std::less<>>(type, right_constant);
+    instruction.compare_op = CompareOp::kLess;
+  } else if (comp_type == "<=") {
+    instruction.compare = Resolve<std::less_equal<>>(type, right_constant);
+    instruction.compare_op = CompareOp::kLessEqual;
+  } else if (comp_type == ">") {
+    instruction.compare = Resolve<std::greater<>>(type, right_constant);
+    instruction.compare_op = CompareOp::kGreater;
+  } else if (comp_type == ">=") {
+    instruction.compare = Resolve<std::greater_equal<>>(type, right_constant);
+    instruction.compare_op = CompareOp::kGreaterEqual;
+  }
+  if (instruction.compare == nullptr) {
+    return false;
+  }
+  program.push_back(std::move(instruction));
+  return true;
+}
+
+CmpBool CompiledPredicate::Run(const Row &row) const {
+  CmpBool stack[MAX_DEPTH];
+  size_t top = 0;
+  for (const auto &instruction : program_) {
+    switch (instruction.op) {
+      case OpCode::kConstant:
+        stack[top++] = instruction.constant;
+        break;
+      case OpCode::kCompare:
+        stack[top++] = instruction.compare(instruction, row);
+        break;
+      case OpCode::kIsNull:
+        stack[top++] = GetCmpBool(row.GetField(instruction.left_column)->IsNull());
+        break;
+      case OpCode::kIsNotNull:
+        stack[top++] = GetCmpBool(!row.GetField(instruction.left_column)->IsNull());
+        break;
+      case OpCode::kAnd:
+        top--;
+        stack[top - 1] = And(stack[top - 1], stack[top]);
+        break;
+      case OpCode::kOr:
+        top--;
+        stack[top - 1] = Or(stack[top - 1], stack[top]);
+        break;
+    }
+  }
+  return stack[0];
+}
+
+void CompiledPredicate::FilterColumn(const Instruction &instruction, const RowBatch &batch, uint64_t *mask) {
+  const ColumnVector &left = batch.GetColumn(instruction.left_column);
+  bool right_constant = instruction.right_constant;
+  const ColumnVector &right = batch.GetColumn(right_constant ? instruction.left_column : instruction.right_column);
+  size_t n = batch.Size();
+  switch (instruction.type) {
+    case TypeId::kTypeInt:
+      if (right_constant) {
+        FilterInts(instruction.compare_op, left.GetInts(), instruction.int_value, n, mask);
+      } else {
+        FilterInts(instruction.compare_op, left.GetInts(), right.GetInts(), n, mask);
+      }
+      break;
+    case TypeId::kTypeFloat:
+      if (right_constant) {
+        FilterFloats(instruction.compare_op, left.GetFloats(), instruction.float_value, n, mask);
+      } else {
+        FilterFloats(instruction.compare_op, left.GetFloats(), right.GetFloats(), n, mask);
+      }
+      break;
+    default:
+      if (right_constant) {
+        FilterChars(instruction.compare_op, left, instruction.chars_value.data(), instruction.chars_value.size(), mask);
+      } else {
+        FilterChars(instruction.compare_op, left, right, mask);
+      }
+      break;
+  }
+  ClearNulls(left, mask);
+  if (!right_constant) {
+    ClearNulls(right, mask);
+  }
+}
+
+void CompiledPredicate::Filter(const RowBatch &batch, uint64_t *mask) const {
+  static constexpr size_t WORDS = (RowBatch::CAPACITY + 63) / 64;
+  uint64_t stack[MAX_DEPTH][WORDS];
+  size_t words = MaskWords(batch.Size());
+  size_t top = 0;
+  for (const auto &instruction : program_) {
+    switch (instruction.op) {
+      case OpCode::kConstant:
+        std::fill(stack[top], stack[top] + words, instruction.constant == CmpBool::kTrue ? ~0ULL : 0);
+        top++;
+        break;
+      case OpCode::kCompare:
+        FilterColumn(instruction, batch, stack[top++]);
+        break;
+      case OpCode::kIsNull:
+      case OpCode::kIsNotNull:
+        FilterNulls(batch.GetColumn(instruction.left_column), instruction.op == OpCode::kIsNull, stack[top++]);
+        break;
+      case OpCode::kAnd:
+        top--;
+        for (size_t i = 0; i < words; i++) {
+          stack[top - 1][i] &= stack[top][i];
+        }
+        break;
+      case OpCode::kOr:
+        top--;
+        for (size_t i = 0; i < words; i++) {
+          stack[top - 1][i] |= stack[top][i];
+        }
+        break;
+    }
+  }
+  std::copy(stack[0], stack[0] + words, mask);
+}
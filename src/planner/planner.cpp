@@ -2,6 +2,8 @@
 // Created by njz on 2023/2/2.
 //
 #include <algorithm>
+#include <thread>
+#include <tuple>
 #include "planner/planner.h"
 
 void Planner::PlanQuery(pSyntaxNode ast) {
@@ -34,31 +36,587 @@ void Planner::PlanQuery(pSyntaxNode ast) {
       throw std::logic_error("the statement is not supported in planner yet");
   }
 }
+namespace {
+/**
+ * Gather the comparisons of a column with a constant that every result row satisfies, those
+ * reachable from the root through AND nodes. The OR nodes reached that way go to disjunctions.
+ * @return false if some part of the predicate is not such a comparison
+ */
+bool CollectConjuncts(const AbstractExpressionRef &node, std::vector<AbstractExpressionRef> &conjuncts,
+                      std::vector<AbstractExpressionRef> *disjunctions = nullptr) {
+  if (node->GetType() == ExpressionType::LogicExpression) {
+    if (dynamic_pointer_cast<LogicExpression>(node)->logic_type_ != LogicType::And) {
+      if (disjunctions != nullptr && dynamic_pointer_cast<LogicExpression>(node)->logic_type_ == LogicType::Or) {
+        disjunctions->push_back(node);
+      }
+      return false;
+    }
+    bool all = true;
+    for (auto &child : node->GetChildren()) {
+      all &= CollectConjuncts(child, conjuncts, disjunctions);
+    }
+    return all;
+  }
+  if (node->GetType() != ExpressionType::ComparisonExpression ||
+      node->GetChildAt(0)->GetType() != ExpressionType::ColumnExpression ||
+      node->GetChildAt(1)->GetType() != ExpressionType::ConstantExpression ||
+      dynamic_pointer_cast<ConstantValueExpression>(node->GetChildAt(1))->val_.IsNull()) {
+    return false;
+  }
+  conjuncts.push_back(node);
+  return true;
+}
+
+/** Split nested OR nodes into their operands */
+void CollectDisjuncts(const AbstractExpressionRef &node, std::vector<AbstractExpressionRef> &disjuncts) {
+  if (node->GetType() == ExpressionType::LogicExpression &&
+      dynamic_pointer_cast<LogicExpression>(node)->logic_type_ == LogicType::Or) {
+    for (auto &child : node->GetChildren()) {
+      CollectDisjuncts(child, disjuncts);
+    }
+    return;
+  }
+  disjuncts.push_back(node);
+}
+
+/** All conjuncts on one column folded into a single interval */
+struct ColumnInterval {
+  const Field *lower{nullptr};
+  bool lower_inclusive{true};
+  const Field *upper{nullptr};
+  bool upper_inclusive{true};
+  /** No value satisfies every conjunct */
+  bool empty{false};
+  /** Positions of the folded conjuncts */
+  std::vector<size_t> folded;
+
+  bool IsPoint() const {
+    return lower != nullptr && upper != nullptr && lower_inclusive && upper_inclusive &&
+           lower->CompareEquals(*upper) == CmpBool::kTrue;
+  }
+};
+
+/**
+ * Intersect the comparisons of column col. The tighter bound wins on each side, so an
+ * equality overrides any range holding its value and empties any other.
+ */
+ColumnInterval FoldColumn(const std::vector<AbstractExpressionRef> &conjuncts, uint32_t col) {
+  ColumnInterval interval;
+  for (size_t i = 0; i < conjuncts.size(); i++) {
+    if (dynamic_pointer_cast<ColumnValueExpression>(conjuncts[i]->GetChildAt(0))->GetColIdx() != col) {
+      continue;
+    }
+    std::string comp_type = dynamic_pointer_cast<ComparisonExpression>(conjuncts[i])->GetComparisonType();
+    const Field &value = dynamic_pointer_cast<ConstantValueExpression>(conjuncts[i]->GetChildAt(1))->val_;
+    bool sets_lower = comp_type == "=" || comp_type == ">" || comp_type == ">=";
+    bool sets_upper = comp_type == "=" || comp_type == "<" || comp_type == "<=";
+    if (!sets_lower && !sets_upper) {
+      continue;
+    }
+    bool inclusive = comp_type.size() != 1 || comp_type == "=";
+    if (sets_lower && (interval.lower == nullptr || value.CompareGreaterThan(*interval.lower) == CmpBool::kTrue ||
+                       (value.CompareEquals(*interval.lower) == CmpBool::kTrue && !inclusive))) {
+      interval.lower = &value;
+      interval.lower_inclusive = inclusive;
+    }
+    if (sets_upper && (interval.upper == nullptr || value.CompareLessThan(*interval.upper) == CmpBool::kTrue ||
+                       (value.CompareEquals(*interval.upper) == CmpBool::kTrue && !inclusive))) {
+      interval.upper = &value;
+      interval.upper_inclusive = inclusive;
+    }
+    interval.folded.push_back(i);
+  }
+  if (interval.lower != nullptr && interval.upper != nullptr) {
+    interval.empty = interval.lower->CompareGreaterThan(*interval.upper) == CmpBool::kTrue ||
+                     (interval.lower->CompareEquals(*interval.upper) == CmpBool::kTrue &&
+                      !(interval.lower_inclusive && interval.upper_inclusive));
+  }
+  return interval;
+}
+
+/** The range an index can take from the conjuncts */
+struct IndexMatch {
+  IndexScanRange range;
+  /** Number of leading key columns fixed to a single value */
+  size_t eq_count{0};
+  /** Whether the column after them is bounded on some side */
+  bool has_range{false};
+  /** Some key column has an empty interval, the scan reads nothing */
+  bool empty{false};
+  bool covers{false};
+  /** The conjuncts turned into bounds, nothing else has to check them */
+  std::vector<bool> used;
+
+  bool Usable() const {
+    if (empty) {
+      return true;
+    }
+    // the range of an unordered index is a filter over all its buckets, it only finds whole keys
+    if (!range.index->GetIndex()->IsOrdered()) {
+      return eq_count == range.index->GetIndexKeySchema()->GetColumnCount();
+    }
+    return eq_count > 0 || has_range;
+  }
+
+  /** Pin down more key columns first, then avoid the heap, then prefer cheap probes and shorter keys */
+  bool BetterThan(const IndexMatch &other) const {
+    auto rank = [](const IndexMatch &m) {
+      // a radix tree or a learned model in memory beats a hash lookup, which beats a descent through pages
+      const std::string &type = m.range.index->GetIndexType();
+      // bitmaps are built on columns with few values, whose keys each match many rows: a fixed key hands
+      // them over a heap page at a time instead of one row id per posting entry
+      bool bitmap_point = type == "bitmap" && m.eq_count == m.range.index->GetIndexKeySchema()->GetColumnCount();
+      int probe = type == "art" || type == "learned" ? 2 : type == "hash" || bitmap_point ? 1 : 0;
+      return std::make_tuple(m.empty, m.eq_count, m.has_range, m.covers, probe,
+                             -static_cast<int>(m.range.index->GetIndexKeySchema()->GetColumnCount()));
+    };
+    return rank(*this) > rank(other);
+  }
+};
+
+/** Fix key columns to single values as far as possible, then bound the next one by its interval */
+IndexMatch MatchIndex(IndexInfo *index, const std::vector<AbstractExpressionRef> &conjuncts) {
+  IndexMatch match;
+  match.range.index = index;
+  match.used.assign(conjuncts.size(), false);
+  for (auto col : index->GetIndexKeySchema()->GetColumns()) {
+    ColumnInterval interval = FoldColumn(conjuncts, col->GetTableInd());
+    for (auto i : interval.folded) {
+      match.used[i] = true;
+    }
+    if (interval.empty) {
+      match.empty = true;
+      return match;
+    }
+    if (interval.IsPoint()) {
+      match.range.lower_key.emplace_back(*interval.lower);
+      match.range.upper_key.emplace_back(*interval.upper);
+      match.eq_count++;
+      continue;
+    }
+    if (interval.lower != nullptr) {
+      match.range.lower_key.emplace_back(*interval.lower);
+      match.range.lower_inclusive = interval.lower_inclusive;
+      match.has_range = true;
+    }
+    if (interval.upper != nullptr) {
+      match.range.upper_key.emplace_back(*interval.upper);
+      match.range.upper_inclusive = interval.upper_inclusive;
+      match.has_range = true;
+    }
+    break;
+  }
+  return match;
+}
+
+/**
+ * @param used_columns Columns the query reads, null if an index-only scan is not an option
+ * @return the best usable match among the indexes, with a null index if there is none
+ */
+IndexMatch BestMatch(const std::vector<IndexInfo *> &indexes, const std::vector<AbstractExpressionRef> &conjuncts,
+                     const std::vector<uint32_t> *used_columns) {
+  IndexMatch best;
+  for (auto index : indexes) {
+    IndexMatch match = MatchIndex(index, conjuncts);
+    if (!match.Usable()) {
+      continue;
+    }
+    match.covers = used_columns != nullptr && std::all_of(used_columns->begin(), used_columns->end(),
+                                                          [index](uint32_t col) { return index->Covers(col); });
+    if (best.range.index == nullptr || match.BetterThan(best)) {
+      best = std::move(match);
+    }
+  }
+  return best;
+}
+
+/** Split nested AND nodes into their operands */
+void SplitConjuncts(const AbstractExpressionRef &node, std::vector<AbstractExpressionRef> &conjuncts) {
+  if (node->GetType() == ExpressionType::LogicExpression &&
+      dynamic_pointer_cast<LogicExpression>(node)->logic_type_ == LogicType::And) {
+    for (auto &child : node->GetChildren()) {
+      SplitConjuncts(child, conjuncts);
+    }
+    return;
+  }
+  conjuncts.push_back(node);
+}
+
+/** @return a bit per side of the join node reads columns of, 1 for the left and 2 for the right */
+uint32_t ReferencedSides(const AbstractExpressionRef &node) {
+  if (node->GetType() == ExpressionType::ColumnExpression) {
+    return 1U << dynamic_pointer_cast<ColumnValueExpression>(node)->GetRowIdx();
+  }
+  uint32_t sides = 0;
+  for (auto &child : node->GetChildren()) {
+    sides |= ReferencedSides(child);
+  }
+  return sides;
+}
+
+/** Add the columns node reads to columns, once each */
+void CollectColumns(const AbstractExpressionRef &node, std::vector<uint32_t> &columns) {
+  if (node->GetType() == ExpressionType::ColumnExpression) {
+    uint32_t col = dynamic_pointer_cast<ColumnValueExpression>(node)->GetColIdx();
+    if (std::find(columns.begin(), columns.end(), col) == columns.end()) {
+      columns.push_back(col);
+    }
+    return;
+  }
+  for (auto &child : node->GetChildren()) {
+    CollectColumns(child, columns);
+  }
+}
+
+/**
+ * Find the B+ tree whose every key column is one of keys, columns of the same table. The index
+ * join looks a whole batch of outer keys up at once, which only a B+ tree does in one walk along
+ * its leaves, other index types leave the join to the hash join. positions gets the key
+ * matching each column of the index key.
+ * @return null if no B+ tree is covered by keys
+ */
+IndexInfo *IndexOnKeys(const std::vector<IndexInfo *> &indexes, const std::vector<AbstractExpressionRef> &keys,
+                       std::vector<size_t> *positions) {
+  for (auto index : indexes) {
+    if (index->GetIndexType() != "bptree") {
+      continue;
+    }
+    std::vector<size_t> matched;
+    for (auto col : index->GetIndexKeySchema()->GetColumns()) {
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (dynamic_pointer_cast<ColumnValueExpression>(keys[i])->GetColIdx() == col->GetTableInd()) {
+          matched.push_back(i);
+          break;
+        }
+      }
+    }
+    if (matched.size() == index->GetIndexKeySchema()->GetColumnCount()) {
+      *positions = std::move(matched);
+      return index;
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
 AbstractPlanNodeRef Planner::PlanSelect(std::shared_ptr<SelectStatement> statement) {
-  auto out_schema = MakeOutputSchema(statement->column_list_);
-  vector<IndexInfo *> indexes;
-  vector<IndexInfo *> available_index;
+  AbstractPlanNodeRef plan = PlanOrderedScan(statement);
+  if (plan == nullptr) {
+    // the columns ORDER BY reads that the SELECT list leaves out come after it, for the sort to drop
+    auto columns = statement->column_list_;
+    columns.insert(columns.end(), statement->order_columns_.begin(), statement->order_columns_.end());
+    if (statement->IsAggregation()) {
+      plan = PlanAggregation(statement, columns);
+    } else if (!statement->join_table_name_.empty()) {
+      plan = PlanJoin(statement, columns);
+    } else {
+      plan = PlanScan(statement->table_name_, MakeOutputSchema(columns), statement->where_,
+                      statement->column_in_condition_);
+    }
+    if (!statement->order_by_.empty()) {
+      return PlanSort(statement, plan);
+    }
+  }
+  if (statement->limit_ != SortPlanNode::NO_LIMIT) {
+    return std::make_shared<LimitPlanNode>(plan->OutputSchema(), plan, statement->limit_);
+  }
+  return plan;
+}
+
+AbstractPlanNodeRef Planner::PlanOrderedScan(std::shared_ptr<SelectStatement> statement) {
+  // a B+ tree is read in ascending key order, the keys have to be ascending leading columns of one
+  if (statement->order_by_.empty() || statement->IsAggregation() || !statement->join_table_name_.empty()) {
+    return nullptr;
+  }
+  std::vector<uint32_t> order_columns;
+  for (auto &order_by : statement->order_by_) {
+    if (order_by.first != OrderByType::Asc) {
+      return nullptr;
+    }
+    size_t i = dynamic_pointer_cast<ColumnValueExpression>(order_by.second)->GetColIdx();
+    auto &column = i < statement->column_list_.size() ? statement->column_list_[i]
+                                                      : statement->order_columns_[i - statement->column_list_.size()];
+    order_columns.push_back(dynamic_pointer_cast<ColumnValueExpression>(column.second)->GetColIdx());
+  }
+  std::vector<IndexInfo *> indexes;
   context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
+  IndexInfo *ordered = nullptr;
   for (auto index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
-        available_index.push_back(index);
+    auto &key_columns = index->GetIndexKeySchema()->GetColumns();
+    if (index->GetIndexType() != "bptree" || key_columns.size() < order_columns.size()) {
+      continue;
+    }
+    bool leading = true;
+    for (size_t i = 0; i < order_columns.size(); i++) {
+      leading = leading && key_columns[i]->GetTableInd() == order_columns[i];
+    }
+    if (leading) {
+      ordered = index;
+      break;
+    }
+  }
+  if (ordered == nullptr) {
+    return nullptr;
+  }
+  auto out_schema = MakeOutputSchema(statement->column_list_);
+  auto scan = PlanScan(statement->table_name_, out_schema, statement->where_, statement->column_in_condition_);
+  if (scan->GetType() == PlanType::IndexScan) {
+    // a single range of the same index is already in order, other index scans are narrower than a walk
+    auto index_scan = dynamic_pointer_cast<const IndexScanPlanNode>(scan);
+    if (index_scan->IsSingleRange() && index_scan->range_sets_[0][0].index == ordered) {
+      return scan;
+    }
+    return nullptr;
+  }
+  // instead of reading the whole table, walk the leaf chain of the index over all of it
+  IndexScanRange range;
+  range.index = ordered;
+  return std::make_shared<IndexScanPlanNode>(out_schema, statement->table_name_,
+                                             std::vector<std::vector<IndexScanRange>>{{std::move(range)}},
+                                             statement->where_ != nullptr, statement->where_);
+}
+
+AbstractPlanNodeRef Planner::PlanSort(std::shared_ptr<SelectStatement> statement, const AbstractPlanNodeRef &child) {
+  // the sort outputs the columns of the SELECT list, the first ones of its child
+  std::vector<std::pair<std::string, AbstractExpressionRef>> outputs;
+  std::vector<AbstractExpressionRef> columns;
+  for (size_t i = 0; i < statement->column_list_.size(); i++) {
+    auto &column = statement->column_list_[i];
+    columns.push_back(std::make_shared<ColumnValueExpression>(0, i, column.second->GetReturnType()));
+    outputs.emplace_back(column.first, columns.back());
+  }
+  return std::make_shared<SortPlanNode>(MakeOutputSchema(outputs), child, statement->order_by_, std::move(columns),
+                                        statement->limit_, SORT_MEMORY_BUDGET);
+}
+
+AbstractPlanNodeRef Planner::PlanAggregation(std::shared_ptr<SelectStatement> statement,
+                                             const std::vector<std::pair<std::string, AbstractExpressionRef>> &columns) {
+  // the child produces each column read by a group-by or an aggregate once
+  std::vector<std::pair<std::string, AbstractExpressionRef>> inputs;
+  auto input_of = [&inputs](const AbstractExpressionRef &expr) -> AbstractExpressionRef {
+    auto col = dynamic_pointer_cast<ColumnValueExpression>(expr);
+    size_t i = 0;
+    while (i < inputs.size()) {
+      auto input = dynamic_pointer_cast<ColumnValueExpression>(inputs[i].second);
+      if (input->GetRowIdx() == col->GetRowIdx() && input->GetColIdx() == col->GetColIdx()) {
+        break;
+      }
+      i++;
+    }
+    if (i == inputs.size()) {
+      inputs.emplace_back("#" + std::to_string(i), expr);
+    }
+    return std::make_shared<ColumnValueExpression>(0, i, expr->GetReturnType());
+  };
+  std::vector<AbstractExpressionRef> group_bys;
+  for (auto &expr : statement->group_by_) {
+    group_bys.push_back(input_of(expr));
+  }
+  std::vector<AbstractExpressionRef> aggregates;
+  std::vector<AggregationType> agg_types;
+  for (auto &aggregate : statement->aggregates_) {
+    agg_types.push_back(aggregate.first);
+    aggregates.push_back(aggregate.second == nullptr ? nullptr : input_of(aggregate.second));
+  }
+  AbstractPlanNodeRef child;
+  if (!statement->join_table_name_.empty()) {
+    child = PlanJoin(statement, inputs);
+  } else {
+    child = PlanScan(statement->table_name_, MakeOutputSchema(inputs), statement->where_,
+                     statement->column_in_condition_);
+  }
+  std::vector<AbstractExpressionRef> exprs;
+  for (auto &column : columns) {
+    exprs.push_back(column.second);
+  }
+  return std::make_shared<AggregationPlanNode>(MakeOutputSchema(columns), child, std::move(group_bys),
+                                               std::move(aggregates), std::move(agg_types), std::move(exprs),
+                                               AGGREGATE_MEMORY_BUDGET);
+}
+
+AbstractPlanNodeRef Planner::PlanJoin(std::shared_ptr<SelectStatement> statement,
+                                      const std::vector<std::pair<std::string, AbstractExpressionRef>> &column_list) {
+  const std::string tables[] = {statement->table_name_, statement->join_table_name_};
+  // a condition on one table filters its scan, an equality across the tables is a join key
+  std::vector<AbstractExpressionRef> conjuncts;
+  if (statement->where_ != nullptr) {
+    SplitConjuncts(statement->where_, conjuncts);
+  }
+  AbstractExpressionRef filters[2];
+  std::vector<uint32_t> filter_columns[2];
+  std::vector<AbstractExpressionRef> keys[2];
+  std::vector<AbstractExpressionRef> key_conjuncts;
+  // an int column equal to a float one, only the hash join compares their keys by value
+  bool mixed_keys = false;
+  AbstractExpressionRef predicate = nullptr;
+  auto conjoin = [](AbstractExpressionRef &lhs, const AbstractExpressionRef &rhs) {
+    lhs = lhs == nullptr ? rhs : std::make_shared<LogicExpression>(lhs, rhs, LogicType::And);
+  };
+  for (auto &conjunct : conjuncts) {
+    uint32_t sides = ReferencedSides(conjunct);
+    if (sides == 1 || sides == 2) {
+      conjoin(filters[sides - 1], conjunct);
+      CollectColumns(conjunct, filter_columns[sides - 1]);
+    } else if (conjunct->GetType() == ExpressionType::ComparisonExpression &&
+               dynamic_pointer_cast<ComparisonExpression>(conjunct)->GetComparisonType() == "=" &&
+               conjunct->GetChildAt(0)->GetType() == ExpressionType::ColumnExpression &&
+               conjunct->GetChildAt(1)->GetType() == ExpressionType::ColumnExpression) {
+      for (auto &child : conjunct->GetChildren()) {
+        keys[dynamic_pointer_cast<ColumnValueExpression>(child)->GetRowIdx()].push_back(child);
+      }
+      key_conjuncts.push_back(conjunct);
+      mixed_keys |= conjunct->GetChildAt(0)->GetReturnType() != conjunct->GetChildAt(1)->GetReturnType();
+    } else {
+      conjoin(predicate, conjunct);
+    }
+  }
+  AbstractPlanNodeRef scans[2];
+  size_t pages[2];
+  for (uint32_t side = 0; side < 2; side++) {
+    TableInfo *info = nullptr;
+    context_->GetCatalog()->GetTable(tables[side], info);
+    scans[side] = PlanScan(tables[side], info->GetSchema(), filters[side], filter_columns[side]);
+    std::vector<page_id_t> page_ids;
+    info->GetTableHeap()->GetPageIds(&page_ids);
+    pages[side] = page_ids.size();
+  }
+  std::vector<AbstractExpressionRef> columns;
+  for (auto &column : column_list) {
+    columns.push_back(column.second);
+  }
+  // a small or selective side looks its matches up in an index of the other one on the join keys,
+  // the inner table is then never read whole
+  for (uint32_t outer : {pages[0] <= pages[1] ? 0U : 1U, pages[0] <= pages[1] ? 1U : 0U}) {
+    uint32_t inner = 1 - outer;
+    if (key_conjuncts.empty() || mixed_keys ||
+        (scans[outer]->GetType() != PlanType::IndexScan && pages[outer] * INDEX_JOIN_PAGE_RATIO > pages[inner])) {
+      continue;
+    }
+    std::vector<IndexInfo *> indexes;
+    context_->GetCatalog()->GetTableIndexes(tables[inner], indexes);
+    std::vector<size_t> positions;
+    IndexInfo *index = IndexOnKeys(indexes, keys[inner], &positions);
+    if (index == nullptr) {
+      continue;
+    }
+    std::vector<AbstractExpressionRef> outer_keys;
+    for (size_t i : positions) {
+      outer_keys.push_back(keys[outer][i]);
+    }
+    // join keys outside the index are checked on the joined rows
+    for (size_t i = 0; i < key_conjuncts.size(); i++) {
+      if (std::find(positions.begin(), positions.end(), i) == positions.end()) {
+        conjoin(predicate, key_conjuncts[i]);
+      }
+    }
+    return std::make_shared<NestedIndexJoinPlanNode>(MakeOutputSchema(column_list), scans[outer],
+                                                     tables[inner], index, std::move(outer_keys), filters[inner],
+                                                     predicate, std::move(columns), outer == 0);
+  }
+  // the hash table is built over the smaller table
+  return std::make_shared<HashJoinPlanNode>(MakeOutputSchema(column_list), scans[0], scans[1],
+                                            std::move(keys[0]), std::move(keys[1]), predicate, std::move(columns),
+                                            pages[0] < pages[1], JOIN_MEMORY_BUDGET);
+}
+
+AbstractPlanNodeRef Planner::PlanScan(const std::string &table_name, const Schema *out_schema,
+                                      const AbstractExpressionRef &where,
+                                      const std::vector<uint32_t> &column_in_condition) {
+  vector<IndexInfo *> indexes;
+  context_->GetCatalog()->GetTableIndexes(table_name, indexes);
+  std::vector<AbstractExpressionRef> conjuncts;
+  std::vector<AbstractExpressionRef> disjunctions;
+  bool only_conjuncts = where != nullptr && CollectConjuncts(where, conjuncts, &disjunctions);
+  // an index holding every projected and filtered column answers the query without touching the heap
+  std::vector<uint32_t> used_columns = column_in_condition;
+  for (auto col : out_schema->GetColumns()) {
+    used_columns.push_back(col->GetTableInd());
+  }
+  IndexMatch best = BestMatch(indexes, conjuncts, &used_columns);
+  bool unique_point = best.range.index != nullptr && best.range.index->IsUnique() &&
+                      best.eq_count == best.range.index->GetIndexKeySchema()->GetColumnCount();
+  if (best.range.index != nullptr && (best.empty || best.covers || unique_point)) {
+    // the range is exact when it consumed the whole predicate
+    bool need_filter = !only_conjuncts || std::find(best.used.begin(), best.used.end(), false) != best.used.end();
+    std::vector<IndexScanRange> ranges;
+    if (!best.empty) {
+      ranges.push_back(std::move(best.range));
+    }
+    return make_shared<IndexScanPlanNode>(out_schema, table_name,
+                                          std::vector<std::vector<IndexScanRange>>{std::move(ranges)}, need_filter,
+                                          where, best.covers && !best.empty);
+  }
+
+  std::vector<std::vector<IndexScanRange>> range_sets;
+  std::vector<bool> used(conjuncts.size(), false);
+  if (best.range.index != nullptr && best.eq_count > 0) {
+    used = best.used;
+    range_sets.push_back({best.range});
+    // other indexes fixing columns the first one leaves open narrow the rows down further
+    for (auto index : indexes) {
+      if (index == best.range.index) {
+        continue;
+      }
+      IndexMatch match = MatchIndex(index, conjuncts);
+      if (!match.Usable() || match.eq_count == 0) {
+        continue;
+      }
+      bool narrows = false;
+      for (size_t i = 0; i < used.size(); i++) {
+        narrows |= match.used[i] && !used[i];
+        used[i] = used[i] || match.used[i];
       }
+      if (narrows) {
+        range_sets.push_back({std::move(match.range)});
+      }
+    }
+  }
+  // an OR whose every operand has a usable index contributes the union of their ranges
+  bool exact = only_conjuncts;
+  for (auto &disjunction : disjunctions) {
+    std::vector<AbstractExpressionRef> disjuncts;
+    CollectDisjuncts(disjunction, disjuncts);
+    std::vector<IndexScanRange> ranges;
+    bool usable = true;
+    for (auto &disjunct : disjuncts) {
+      // the conjuncts outside the OR hold within every operand too
+      std::vector<AbstractExpressionRef> terms(conjuncts);
+      CollectConjuncts(disjunct, terms);
+      IndexMatch match = BestMatch(indexes, terms, nullptr);
+      if (match.range.index == nullptr) {
+        usable = false;
+        break;
+      }
+      if (!match.empty) {
+        ranges.push_back(std::move(match.range));
+      }
+    }
+    if (usable) {
+      range_sets.push_back(std::move(ranges));
+      exact = false;
     }
   }
-  if (available_index.empty() || statement->has_or) {
-    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
+  if (range_sets.empty() && best.range.index != nullptr) {
+    used = best.used;
+    range_sets.push_back({std::move(best.range)});
+  }
+  if (range_sets.empty()) {
+    auto scan_plan = make_shared<SeqScanPlanNode>(out_schema, table_name, where);
+    uint32_t workers = std::min(std::thread::hardware_concurrency(), MAX_SCAN_WORKERS);
+    if (workers > 1) {
+      return make_shared<GatherPlanNode>(out_schema, scan_plan, workers);
+    }
+    return scan_plan;
   }
-  return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index,
-                                        available_index.size() != statement->column_in_condition_.size(),
-                                        statement->where_);
+  bool need_filter = !exact || std::find(used.begin(), used.end(), false) != used.end();
+  return make_shared<IndexScanPlanNode>(out_schema, table_name, std::move(range_sets), need_filter,
+                                        where);
 }
 
 AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> statement) {
   auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, statement->raw_values_);
-  return std::make_shared<InsertPlanNode>(nullptr, value_plan, statement->table_name_);
+  return std::make_shared<InsertPlanNode>(nullptr, value_plan, statement->table_name_, statement->on_conflict_,
+                                          statement->update_attrs_);
 }
 
 AbstractPlanNodeRef Planner::PlanDelete(std::shared_ptr<DeleteStatement> statement) {
@@ -94,7 +94,7 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id)
     bool res = page->DeAllocatePage(logical_page_id % BITMAP_SIZE);
     meta_data->num_allocated_pages_ -= res ? 1 : 0;
     meta_data->extent_used_page_[logical_page_id / BITMAP_SIZE] -= res ? 1 : 0;
-    if (meta_data->extent_used_page_[logical_page_id / BITMAP_SIZE] == 0)
+    if (res && meta_data->extent_used_page_[logical_page_id / BITMAP_SIZE] == 0)
         meta_data->num_extents_--;
     WritePhysicalPage(logical_page_id / BITMAP_SIZE * (1 + BITMAP_SIZE) + 1, buffer);
 }
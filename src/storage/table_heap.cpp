@@ -1,5 +1,7 @@
 #include "storage/table_heap.h"
 
+#include <stdexcept>
+
 bool TableHeap::InsertTuple(Row &row, Transaction *txn)
 {
     if (row.GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW)
@@ -125,22 +127,41 @@ void TableHeap::DeleteTable(page_id_t page_id)
 
 TableIterator TableHeap::Begin(Transaction *txn)
 {
-    Page *page_ptr = buffer_pool_manager_->FetchPage(first_page_id_);
-    if (page_ptr == nullptr)
+    // skip pages whose tuples are all deleted
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID)
     {
-        buffer_pool_manager_->UnpinPage(first_page_id_, false);
-        return End();
+        Page *page_ptr = buffer_pool_manager_->FetchPage(page_id);
+        if (page_ptr == nullptr)
+            return End();
+        TablePage *table_page = reinterpret_cast<TablePage *>(page_ptr->GetData());
+        RowId first_rid;
+        bool found = table_page->GetFirstTupleRid(&first_rid);
+        page_id_t next_page_id = table_page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        if (found)
+            return TableIterator(this, first_rid);
+        page_id = next_page_id;
     }
-    TablePage *table_page = reinterpret_cast<TablePage *>(page_ptr->GetData());
-    RowId first_rid;
-    if (table_page->GetFirstTupleRid(&first_rid))
+    return End();
+}
+
+void TableHeap::GetPageIds(std::vector<page_id_t> *page_ids)
+{
+    page_ids->clear();
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID)
     {
-        // Row tst;
-        // table_page->GetTuple(&tst,schema_,nullptr,nullptr);
-        buffer_pool_manager_->UnpinPage(first_page_id_, false);
-        return TableIterator(this, first_rid);
+        auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        if (page == nullptr)
+            throw std::runtime_error("failed to fetch a table page");
+        page_ids->push_back(page_id);
+        page->RLatch();
+        page_id_t next_page_id = page->GetNextPageId();
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
     }
-    return End();
 }
 
 TableIterator TableHeap::End()
@@ -86,20 +86,23 @@ TableIterator TableIterator::operator++(int)
 
 void TableIterator::FindNextRow(RowId &row_id)
 {
+    BufferPoolManager *bpm = tables->buffer_pool_manager_;
+    TablePage *current_page = reinterpret_cast<TablePage *>(bpm->FetchPage(row_id.GetPageId())->GetData());
     RowId next;
-    TablePage *current_page = reinterpret_cast<TablePage *>(tables->buffer_pool_manager_->FetchPage(row_id.GetPageId())->GetData());
-    tables->buffer_pool_manager_->UnpinPage(current_page->GetPageId(), false);
-    if (current_page->GetNextTupleRid(row_id, &next))
-        row_id = next;
-    // current page has no more rows
-    else
+    bool found = current_page->GetNextTupleRid(row_id, &next);
+    // current page has no more rows, the next ones may have none left either
+    while (!found)
     {
         page_id_t next_page_id = current_page->GetNextPageId();
+        bpm->UnpinPage(current_page->GetTablePageId(), false);
         if (next_page_id == INVALID_PAGE_ID)
         {
             row_id = INVALID_ROWID;
+            return;
         }
-        else
-            row_id.Set(next_page_id, 0);
+        current_page = reinterpret_cast<TablePage *>(bpm->FetchPage(next_page_id)->GetData());
+        found = current_page->GetFirstTupleRid(&next);
     }
+    bpm->UnpinPage(current_page->GetTablePageId(), false);
+    row_id = next;
 }
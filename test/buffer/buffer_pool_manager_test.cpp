@@ -5,6 +5,7 @@
 #include <string>
 
 #include "gtest/gtest.h"
+#include "page/disk_file_meta_page.h"
 
 TEST(BufferPoolManagerTest, BinaryDataTest) {
   const std::string db_name = "bpm_test.db";
@@ -71,4 +72,40 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+
+TEST(BufferPoolManagerTest, DoubleDeleteTest) {
+  const std::string db_name = "bpm_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+  auto *meta = reinterpret_cast<DiskFileMetaPage *>(disk_manager->GetMetaData());
+
+  page_id_t first, second;
+  ASSERT_NE(nullptr, bpm->NewPage(first));
+  ASSERT_NE(nullptr, bpm->NewPage(second));
+  EXPECT_TRUE(bpm->UnpinPage(first, false));
+  EXPECT_TRUE(bpm->UnpinPage(second, false));
+  EXPECT_EQ(2, meta->GetAllocatedPages());
+  EXPECT_EQ(1, meta->GetExtentNums());
+
+  // Scenario: deleting a page again, once it is out of the pool, leaves the counts alone.
+  EXPECT_TRUE(bpm->DeletePage(first));
+  EXPECT_TRUE(bpm->DeletePage(first));
+  EXPECT_EQ(1, meta->GetAllocatedPages());
+  EXPECT_EQ(1, meta->GetExtentNums());
+  EXPECT_TRUE(bpm->IsPageFree(first));
+  EXPECT_FALSE(bpm->IsPageFree(second));
+
+  // Scenario: once the extent is empty, a second delete must not count it off again.
+  EXPECT_TRUE(bpm->DeletePage(second));
+  EXPECT_TRUE(bpm->DeletePage(second));
+  EXPECT_EQ(0, meta->GetAllocatedPages());
+  EXPECT_EQ(0, meta->GetExtentNums());
+
+  disk_manager->Close();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
@@ -0,0 +1,85 @@
+#include "common/rowid_bitmap.h"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+
+namespace {
+std::set<int64_t> RandomRowIds(std::mt19937 &rng, int count, int pages, int slots) {
+  std::set<int64_t> rids;
+  for (int i = 0; i < count; i++) {
+    rids.insert(RowId(rng() % pages, rng() % slots).Get());
+  }
+  return rids;
+}
+
+RowIdBitmap MakeBitmap(const std::set<int64_t> &rids) {
+  RowIdBitmap bitmap;
+  for (auto rid : rids) {
+    bitmap.Add(RowId(rid));
+  }
+  return bitmap;
+}
+
+void ExpectEquals(const std::set<int64_t> &expected, const RowIdBitmap &bitmap) {
+  ASSERT_EQ(expected.size(), bitmap.Cardinality());
+  std::vector<RowId> rids;
+  bitmap.ToVector(rids);
+  ASSERT_EQ(expected.size(), rids.size());
+  auto it = expected.begin();
+  for (auto &rid : rids) {
+    ASSERT_EQ(*it++, rid.Get());
+  }
+}
+}  // namespace
+
+TEST(RowIdBitmapTest, SparseAndDenseTest) {
+  RowIdBitmap bitmap;
+  ASSERT_TRUE(bitmap.Empty());
+  // page 3 stays sparse, page 5 fills up and turns into a bitset
+  bitmap.Add(RowId(3, 7));
+  bitmap.Add(RowId(3, 7));
+  for (uint32_t slot = 0; slot < 200; slot += 2) {
+    bitmap.Add(RowId(5, slot));
+  }
+  ASSERT_EQ(101, bitmap.Cardinality());
+  ASSERT_TRUE(bitmap.Contains(RowId(3, 7)));
+  ASSERT_FALSE(bitmap.Contains(RowId(3, 8)));
+  ASSERT_TRUE(bitmap.Contains(RowId(5, 198)));
+  ASSERT_FALSE(bitmap.Contains(RowId(5, 199)));
+  ASSERT_FALSE(bitmap.Contains(RowId(4, 0)));
+  std::vector<RowId> rids;
+  bitmap.ToVector(rids);
+  ASSERT_EQ(RowId(3, 7), rids.front());
+  ASSERT_EQ(RowId(5, 0), rids[1]);
+  ASSERT_EQ(RowId(5, 198), rids.back());
+}
+
+TEST(RowIdBitmapTest, IntersectAndUnionTest) {
+  std::mt19937 rng(42);
+  // few slots per page make dense containers, many slots sparse ones
+  for (int slots : {16, 100, 4000}) {
+    auto a = RandomRowIds(rng, 3000, 50, slots);
+    auto b = RandomRowIds(rng, 3000, 50, slots);
+    std::set<int64_t> both, either;
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::inserter(both, both.end()));
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::inserter(either, either.end()));
+
+    RowIdBitmap intersection = MakeBitmap(a);
+    intersection.IntersectWith(MakeBitmap(b));
+    ExpectEquals(both, intersection);
+
+    RowIdBitmap set_union = MakeBitmap(a);
+    set_union.UnionWith(MakeBitmap(b));
+    ExpectEquals(either, set_union);
+
+    // results keep working as operands
+    intersection.UnionWith(set_union);
+    ExpectEquals(either, intersection);
+    set_union.IntersectWith(RowIdBitmap());
+    ASSERT_TRUE(set_union.Empty());
+  }
+}
@@ -0,0 +1,67 @@
+#include "common/thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+TEST(ThreadPoolTest, RunTest) {
+  ThreadPool pool(4);
+  auto group = std::make_shared<TaskGroup>();
+  std::atomic<int> sum{0};
+  for (int i = 1; i <= 1000; i++) {
+    pool.Submit(group, i % 2 == 0 ? TaskPriority::kHigh : TaskPriority::kLow, [&sum, i] { sum += i; });
+  }
+  pool.Wait(group);
+  ASSERT_EQ(500500, sum);
+
+  // tasks submitted by a task go to its own worker and are stolen by the others
+  auto nested = std::make_shared<TaskGroup>();
+  std::atomic<int> count{0};
+  pool.Submit(nested, TaskPriority::kHigh, [&] {
+    for (int i = 0; i < 100; i++) {
+      pool.Submit(nested, TaskPriority::kHigh, [&count] { count++; });
+    }
+  });
+  pool.Wait(nested);
+  ASSERT_EQ(100, count);
+
+  auto failing = std::make_shared<TaskGroup>();
+  pool.Submit(failing, TaskPriority::kHigh, [] { throw std::runtime_error("failed"); });
+  ASSERT_THROW(pool.Wait(failing), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, CancelTest) {
+  ThreadPool pool(1);
+  // keep the only worker busy so the rest of the group stays queued
+  auto blocker = std::make_shared<TaskGroup>();
+  std::atomic<bool> release{false};
+  std::atomic<bool> started{false};
+  pool.Submit(blocker, TaskPriority::kHigh, [&] {
+    started = true;
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  auto group = std::make_shared<TaskGroup>();
+  std::atomic<int> ran{0};
+  for (int i = 0; i < 10; i++) {
+    pool.Submit(group, TaskPriority::kLow, [&ran] { ran++; });
+  }
+  group->Cancel();
+  // queued tasks of the group are dropped without waiting for the worker
+  pool.Wait(group);
+  ASSERT_EQ(0, ran);
+
+  // a group waited on runs its queued tasks on the waiting thread
+  auto helped = std::make_shared<TaskGroup>();
+  pool.Submit(helped, TaskPriority::kLow, [&ran] { ran++; });
+  pool.Wait(helped);
+  ASSERT_EQ(1, ran);
+  release = true;
+  pool.Wait(blocker);
+}
@@ -1,11 +1,29 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include "executor/executors/seq_scan_executor.h"
+#include "executor/executors/sort_executor.h"
+#include "executor/executors/gather_executor.h"
+#include "executor/executors/hash_aggregate_executor.h"
+#include "executor/executors/hash_join_executor.h"
+#include "executor/executors/index_scan_executor.h"
+#include "executor/executors/limit_executor.h"
+#include "executor/executors/nested_index_join_executor.h"
+#include "executor/filter_kernels.h"
+#include "executor/plans/aggregation_plan.h"
 #include "executor/plans/delete_plan.h"
+#include "executor/plans/hash_join_plan.h"
+#include "executor/plans/index_scan_plan.h"
 #include "executor/plans/insert_plan.h"
+#include "executor/plans/limit_plan.h"
+#include "executor/plans/nested_index_join_plan.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "executor/plans/sort_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
+#include "planner/compiled_predicate.h"
+#include "planner/expressions/logic_expression.h"
+#include "planner/planner.h"
 #include "executor_test_util.h" // NOLINT
 
 // SELECT id FROM table-1 WHERE id < 500
@@ -163,3 +181,1265 @@ TEST_F(ExecutorTest, SimpleUpdateTest)
         ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
     }
 }
+
+// SELECT id FROM table-1 WHERE id = 7 OR id = 42 OR (id >= 40 AND id < 46)
+TEST_F(ExecutorTest, IndexUnionScanTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    IndexInfo *index_info = nullptr;
+    std::vector<std::string> index_keys{"id"};
+    ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(),
+                                                                          index_info, "bptree"));
+    TableHeap *table_heap = table_info->GetTableHeap();
+    for (auto it = table_heap->Begin(GetTxn()); it != table_heap->End(); ++it)
+    {
+        ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(index_info->GetEntry(*it), it.GetRid(), GetTxn()));
+    }
+
+    // one range per disjunct, the third overlaps the second
+    std::vector<IndexScanRange> ranges(3);
+    for (auto &range : ranges)
+        range.index = index_info;
+    ranges[0].lower_key.emplace_back(kTypeInt, 7);
+    ranges[0].upper_key.emplace_back(kTypeInt, 7);
+    ranges[1].lower_key.emplace_back(kTypeInt, 42);
+    ranges[1].upper_key.emplace_back(kTypeInt, 42);
+    ranges[2].lower_key.emplace_back(kTypeInt, 40);
+    ranges[2].upper_key.emplace_back(kTypeInt, 46);
+    ranges[2].upper_inclusive = false;
+    auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+    auto out_schema = MakeOutputSchema({{"id", col_id}});
+    auto plan = std::make_shared<IndexScanPlanNode>(out_schema, table_info->GetTableName(),
+                                                    std::vector<std::vector<IndexScanRange>>{std::move(ranges)}, false);
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+
+    // each row once, no matter how many ranges hold it
+    ASSERT_EQ(7, result_set.size());
+    for (int id : {7, 40, 41, 42, 43, 44, 45})
+    {
+        auto count = std::count_if(result_set.begin(), result_set.end(), [id](const Row &row) {
+            return row.GetField(0)->CompareEquals(Field(kTypeInt, id)) == CmpBool::kTrue;
+        });
+        ASSERT_EQ(1, count);
+    }
+}
+
+// SELECT id FROM table-1 WHERE <conjuncts on id>, folded into a single index range
+TEST_F(ExecutorTest, FoldRangeTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    IndexInfo *index_info = nullptr;
+    std::vector<std::string> index_keys{"id"};
+    ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(),
+                                                                          index_info, "bptree"));
+    TableHeap *table_heap = table_info->GetTableHeap();
+    for (auto it = table_heap->Begin(GetTxn()); it != table_heap->End(); ++it)
+    {
+        ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(index_info->GetEntry(*it), it.GetRid(), GetTxn()));
+    }
+
+    auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+    auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+    auto out_schema = MakeOutputSchema({{"id", col_id}});
+    auto id_is = [&](const std::string &comp_type, int value) {
+        return MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, value)), comp_type);
+    };
+    auto conjoin = [](const std::vector<AbstractExpressionRef> &terms) {
+        AbstractExpressionRef where = terms[0];
+        for (size_t i = 1; i < terms.size(); i++)
+            where = std::make_shared<LogicExpression>(where, terms[i], LogicType::And);
+        return where;
+    };
+    Planner planner(GetExecutorContext());
+    // the columns in the conditions, as the statement collects them
+    auto plan_scan = [&](const AbstractExpressionRef &where, const std::vector<uint32_t> &columns = {0}) {
+        auto plan =
+            std::dynamic_pointer_cast<const IndexScanPlanNode>(planner.PlanScan("table-1", out_schema, where, columns));
+        EXPECT_NE(nullptr, plan);
+        return plan;
+    };
+    auto scan_ids = [&](const AbstractPlanNodeRef &plan) {
+        std::vector<Row> result_set;
+        GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+        std::vector<int32_t> ids;
+        for (auto &row : result_set)
+        {
+            int32_t id;
+            row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+            ids.push_back(id);
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    auto ids_between = [](int32_t first, int32_t last) {
+        std::vector<int32_t> ids;
+        for (int32_t id = first; id <= last; id++)
+            ids.push_back(id);
+        return ids;
+    };
+
+    // several ranges on the column fold into one interval, the tightest bound on each side
+    auto plan = plan_scan(conjoin({id_is(">", 10), id_is("<=", 50), id_is(">=", 20), id_is("<", 40)}));
+    ASSERT_TRUE(plan->IsSingleRange());
+    const IndexScanRange *range = &plan->range_sets_[0][0];
+    ASSERT_EQ(CmpBool::kTrue, range->lower_key[0].CompareEquals(Field(kTypeInt, 20)));
+    ASSERT_TRUE(range->lower_inclusive);
+    ASSERT_EQ(CmpBool::kTrue, range->upper_key[0].CompareEquals(Field(kTypeInt, 40)));
+    ASSERT_FALSE(range->upper_inclusive);
+    ASSERT_FALSE(plan->need_filter_);
+    ASSERT_EQ(ids_between(20, 39), scan_ids(plan));
+
+    // on equal values the exclusive bound is the tighter one, whichever comes first
+    for (auto &where : {conjoin({id_is(">=", 10), id_is(">", 10), id_is("<", 15), id_is("<=", 15)}),
+                        conjoin({id_is(">", 10), id_is(">=", 10), id_is("<=", 15), id_is("<", 15)})})
+    {
+        plan = plan_scan(where);
+        ASSERT_TRUE(plan->IsSingleRange());
+        ASSERT_FALSE(plan->range_sets_[0][0].lower_inclusive);
+        ASSERT_FALSE(plan->range_sets_[0][0].upper_inclusive);
+        ASSERT_EQ(ids_between(11, 14), scan_ids(plan));
+    }
+    // inclusive bounds on the same value make a point
+    plan = plan_scan(conjoin({id_is(">=", 10), id_is("<=", 10)}));
+    ASSERT_TRUE(plan->IsSingleRange());
+    ASSERT_TRUE(plan->range_sets_[0][0].lower_inclusive && plan->range_sets_[0][0].upper_inclusive);
+    ASSERT_EQ(std::vector<int32_t>{10}, scan_ids(plan));
+
+    // an equality overrides a range holding its value
+    plan = plan_scan(conjoin({id_is(">", 10), id_is("=", 30), id_is("<", 100)}));
+    ASSERT_TRUE(plan->IsSingleRange());
+    range = &plan->range_sets_[0][0];
+    ASSERT_EQ(CmpBool::kTrue, range->lower_key[0].CompareEquals(Field(kTypeInt, 30)));
+    ASSERT_EQ(CmpBool::kTrue, range->upper_key[0].CompareEquals(Field(kTypeInt, 30)));
+    ASSERT_TRUE(range->lower_inclusive && range->upper_inclusive);
+    ASSERT_FALSE(plan->need_filter_);
+    ASSERT_EQ(std::vector<int32_t>{30}, scan_ids(plan));
+
+    // contradictory bounds leave no range to scan
+    for (auto &where : {conjoin({id_is(">", 50), id_is("<", 20)}), conjoin({id_is(">", 30), id_is("=", 30)}),
+                        conjoin({id_is(">=", 10), id_is("<", 10)}), conjoin({id_is("=", 5), id_is("=", 6)})})
+    {
+        plan = plan_scan(where);
+        ASSERT_EQ(1, plan->range_sets_.size());
+        ASSERT_TRUE(plan->range_sets_[0].empty());
+        ASSERT_TRUE(scan_ids(plan).empty());
+    }
+
+    // the filter is dropped only when the range consumed every conjunct
+    plan = plan_scan(conjoin({id_is(">=", 100), id_is("<", 200)}));
+    ASSERT_FALSE(plan->need_filter_);
+    auto account_positive =
+        MakeComparisonExpression(col_account, MakeConstantValueExpression(Field(kTypeFloat, 0.f)), ">");
+    plan = plan_scan(conjoin({id_is(">=", 100), account_positive, id_is("<", 200)}), {0, 2});
+    ASSERT_TRUE(plan->need_filter_);
+    std::vector<int32_t> expected;
+    for (auto it = table_heap->Begin(GetTxn()); it != table_heap->End(); ++it)
+    {
+        int32_t id;
+        float account;
+        it->GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+        it->GetField(2)->SerializeTo(reinterpret_cast<char *>(&account));
+        if (id >= 100 && id < 200 && account > 0)
+            expected.push_back(id);
+    }
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(expected, scan_ids(plan));
+    // nor can any range hold the rows of an OR over a column without an index
+    auto where = std::make_shared<LogicExpression>(id_is(">=", 100), account_positive, LogicType::Or);
+    ASSERT_NE(PlanType::IndexScan, planner.PlanScan("table-1", out_schema, where, {0, 2})->GetType());
+}
+
+// SELECT id, name FROM table-1 WHERE account = <value>, with a B+ tree and a bitmap on account
+TEST_F(ExecutorTest, BitmapPreferenceTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+    auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+    auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+    auto out_schema = MakeOutputSchema({{"id", col_id}, {"name", col_name}});
+    auto where = MakeComparisonExpression(col_account, MakeConstantValueExpression(Field(kTypeFloat, 1.0f)), "=");
+    Planner planner(GetExecutorContext());
+
+    // a fixed key goes to the bitmap, whichever index the catalog lists first
+    std::vector<std::string> index_keys{"account"};
+    for (bool bitmap_first : {true, false})
+    {
+        IndexInfo *bptree_info = nullptr;
+        IndexInfo *bitmap_info = nullptr;
+        for (int i = 0; i < 2; i++)
+        {
+            if ((i == 0) == bitmap_first)
+                ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex(
+                                          "table-1", "index-bitmap", index_keys, GetTxn(), bitmap_info, "bitmap"));
+            else
+                ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex(
+                                          "table-1", "index-bptree", index_keys, GetTxn(), bptree_info, "bptree"));
+        }
+        auto plan = std::dynamic_pointer_cast<const IndexScanPlanNode>(
+            planner.PlanScan("table-1", out_schema, where, std::vector<uint32_t>{2}));
+        ASSERT_NE(nullptr, plan);
+        ASSERT_EQ(bitmap_info, plan->range_sets_[0][0].index);
+        ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->DropIndex("table-1", "index-bitmap"));
+        ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->DropIndex("table-1", "index-bptree"));
+    }
+}
+
+// SELECT id, name FROM table-1 WHERE id <op> 10, with only a hash index on id
+TEST_F(ExecutorTest, HashIndexRangeTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    IndexInfo *index_info = nullptr;
+    std::vector<std::string> index_keys{"id"};
+    ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(),
+                                                                          index_info, "hash"));
+    ASSERT_FALSE(index_info->GetIndex()->IsOrdered());
+
+    auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+    auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+    auto out_schema = MakeOutputSchema({{"id", col_id}, {"name", col_name}});
+    Planner planner(GetExecutorContext());
+    auto plan_type = [&](const std::string &comp_type) {
+        auto where = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 10)), comp_type);
+        return planner.PlanScan("table-1", out_schema, where, std::vector<uint32_t>{0})->GetType();
+    };
+    // a whole key is looked up, a range is never scanned out of its buckets
+    ASSERT_EQ(PlanType::IndexScan, plan_type("="));
+    for (auto comp_type : {"<", "<=", ">", ">="})
+        ASSERT_NE(PlanType::IndexScan, plan_type(comp_type));
+}
+
+// INSERT INTO table-1 VALUES (2000, ...), (1001, ...) ON CONFLICT DO UPDATE / DO NOTHING
+TEST_F(ExecutorTest, UpsertTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    IndexInfo *index_info = nullptr;
+    std::vector<std::string> index_keys{"id"};
+    ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(),
+                                                                         index_info, "bptree", {}, true));
+
+    auto make_values = [this](int first, int second) {
+        std::vector<std::vector<AbstractExpressionRef>> raw_values;
+        for (int id : {first, second})
+            raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, id)),
+                                  MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("new"), 3, false)),
+                                  MakeConstantValueExpression(Field(kTypeFloat, 1.0f))});
+        return std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    };
+    auto count_rows = [&](int id, const char *name) {
+        auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+        auto predicate = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, id)), "=");
+        auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+        std::vector<Row> result_set;
+        GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+        return std::count_if(result_set.begin(), result_set.end(), [name](const Row &row) {
+            return row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>(name), strlen(name), false)) ==
+                   CmpBool::kTrue;
+        });
+    };
+
+    // a new index starts out empty, so insert the rows it is to find
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(std::make_shared<InsertPlanNode>(nullptr, make_values(2000, 2001), "table-1"),
+                                      &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(2, result_set.size());
+
+    // 2000 is taken and gets its name set, 1001 goes in
+    std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs;
+    update_attrs.emplace(1, MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("upsert"), 6, false)));
+    auto update_plan = std::make_shared<InsertPlanNode>(nullptr, make_values(2000, 1001), "table-1",
+                                                        OnConflict::DoUpdate, update_attrs);
+    result_set.clear();
+    GetExecutionEngine()->ExecutePlan(update_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(2, result_set.size());
+    ASSERT_EQ(1, count_rows(2000, "upsert"));
+    ASSERT_EQ(1, count_rows(1001, "new"));
+
+    // both taken now but 1002, nothing changes for them
+    auto nothing_plan =
+        std::make_shared<InsertPlanNode>(nullptr, make_values(1001, 1002), "table-1", OnConflict::DoNothing);
+    result_set.clear();
+    GetExecutionEngine()->ExecutePlan(nothing_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(1, result_set.size());
+    ASSERT_EQ(1, count_rows(1001, "new"));
+    ASSERT_EQ(1, count_rows(1002, "new"));
+
+    // the index still maps every key to its single row
+    std::vector<RowId> rids;
+    std::vector<Field> key_fields{Field(kTypeInt, 2000)};
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(Row(key_fields), rids, GetTxn()));
+    ASSERT_EQ(1, rids.size());
+
+    // moving 2000 onto the key of 1001 fails and leaves both rows and the index as they were
+    std::unordered_map<uint32_t, AbstractExpressionRef> clash_attrs;
+    clash_attrs.emplace(0, MakeConstantValueExpression(Field(kTypeInt, 1001)));
+    clash_attrs.emplace(1, MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("clash"), 5, false)));
+    auto clash_plan = std::make_shared<InsertPlanNode>(nullptr, make_values(2000, 3000), "table-1",
+                                                       OnConflict::DoUpdate, clash_attrs);
+    result_set.clear();
+    ASSERT_EQ(DB_FAILED, GetExecutionEngine()->ExecutePlan(clash_plan, &result_set, GetTxn(), GetExecutorContext()));
+    ASSERT_EQ(1, count_rows(2000, "upsert"));
+    ASSERT_EQ(1, count_rows(1001, "new"));
+    ASSERT_EQ(0, count_rows(1001, "clash"));
+    for (int id : {2000, 1001})
+    {
+        rids.clear();
+        std::vector<Field> fields{Field(kTypeInt, id)};
+        ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(Row(fields), rids, GetTxn()));
+        ASSERT_EQ(1, rids.size());
+        Row row(rids[0]);
+        ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, GetTxn()));
+        ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(kTypeInt, id)));
+    }
+}
+
+// SELECT id, name FROM table-1 WHERE id < 500, a batch at a time
+TEST_F(ExecutorTest, BatchSeqScanTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+    auto col_b = MakeColumnValueExpression(*schema, 0, "name");
+    auto predicate = MakeComparisonExpression(col_a, MakeConstantValueExpression(Field(kTypeInt, 500)), "<");
+    auto out_schema = MakeOutputSchema({{"id", col_a}, {"name", col_b}});
+    auto plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate);
+
+    SeqScanExecutor executor(GetExecutorContext(), plan.get());
+    executor.Init();
+    RowBatch batch;
+    std::vector<bool> seen(500, false);
+    while (executor.NextBatch(&batch))
+    {
+        ASSERT_LE(batch.Size(), RowBatch::CAPACITY);
+        ASSERT_EQ(2, batch.GetColumnCount());
+        ASSERT_EQ(kTypeInt, batch.GetColumn(0).GetType());
+        ASSERT_EQ(kTypeChar, batch.GetColumn(1).GetType());
+        const int32_t *ids = batch.GetColumn(0).GetInts();
+        for (uint32_t i : batch.GetSelection())
+        {
+            ASSERT_LT(ids[i], 500);
+            ASSERT_FALSE(seen[ids[i]]);
+            seen[ids[i]] = true;
+            // the row interface sees the same values
+            Row row;
+            batch.GetRow(i, &row);
+            ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(kTypeInt, ids[i])));
+            ASSERT_EQ(batch.GetColumn(1).GetLength(i), row.GetField(1)->GetLength());
+        }
+    }
+    ASSERT_EQ(500, std::count(seen.begin(), seen.end(), true));
+}
+
+TEST_F(ExecutorTest, CompiledPredicateTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    auto id = MakeColumnValueExpression(*schema, 0, "id");
+    auto name = MakeColumnValueExpression(*schema, 0, "name");
+    auto account = MakeColumnValueExpression(*schema, 0, "account");
+    char prefix[] = "m";
+    auto name_lt = MakeComparisonExpression(name, MakeConstantValueExpression(Field(kTypeChar, prefix, 1, true)), "<");
+    auto account_ge = MakeComparisonExpression(account, MakeConstantValueExpression(Field(kTypeFloat, 0.f)), ">=");
+    auto id_ne = MakeComparisonExpression(MakeConstantValueExpression(Field(kTypeInt, 300)), id, "<>");
+    auto id_lt = MakeComparisonExpression(MakeConstantValueExpression(Field(kTypeInt, 600)), id, ">");
+    auto yes = MakeComparisonExpression(MakeConstantValueExpression(Field(kTypeInt, 1)),
+                                        MakeConstantValueExpression(Field(kTypeInt, 1)), "=");
+    auto no = MakeComparisonExpression(MakeConstantValueExpression(Field(kTypeInt, 1)),
+                                       MakeConstantValueExpression(Field(kTypeInt, 2)), "=");
+    auto id_null = MakeComparisonExpression(id, MakeConstantValueExpression(Field(kTypeInt)), "=");
+    auto both = std::make_shared<LogicExpression>(name_lt, account_ge, LogicType::And);
+    auto either = std::make_shared<LogicExpression>(both, id_lt, LogicType::Or);
+    std::vector<AbstractExpressionRef> predicates = {
+        name_lt,
+        account_ge,
+        id_ne,
+        MakeComparisonExpression(account, account, "<="),
+        MakeComparisonExpression(name, name, "<>"),
+        std::make_shared<LogicExpression>(either, id_ne, LogicType::And),
+        std::make_shared<LogicExpression>(id_null, id_lt, LogicType::Or),
+        std::make_shared<LogicExpression>(yes, either, LogicType::And),
+        std::make_shared<LogicExpression>(no, either, LogicType::Or),
+    };
+
+    std::vector<std::unique_ptr<CompiledPredicate>> compiled;
+    for (auto &predicate : predicates)
+    {
+        compiled.push_back(CompiledPredicate::Compile(predicate));
+        ASSERT_NE(nullptr, compiled.back());
+    }
+    // The constant side of a logic expression is folded away
+    ASSERT_EQ(5, compiled[7]->GetInstructionCount());
+    ASSERT_EQ(5, compiled[8]->GetInstructionCount());
+    ASSERT_EQ(1, CompiledPredicate::Compile(std::make_shared<LogicExpression>(no, either, LogicType::And))
+                     ->GetInstructionCount());
+    // A column can not be read as a boolean
+    ASSERT_EQ(nullptr, CompiledPredicate::Compile(std::make_shared<LogicExpression>(id, yes, LogicType::And)));
+
+    TableHeap *table_heap = table_info->GetTableHeap();
+    uint32_t passed = 0;
+    for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it)
+    {
+        for (size_t i = 0; i < predicates.size(); i++)
+        {
+            bool expected = predicates[i]->Evaluate(&*it).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+            ASSERT_EQ(expected, compiled[i]->Evaluate(*it)) << "predicate " << i;
+            passed += expected;
+        }
+    }
+    ASSERT_GT(passed, 0);
+}
+
+TEST_F(ExecutorTest, FilterKernelTest)
+{
+    // Column against column and constant, with a length that leaves a tail past the vector lanes
+    std::vector<int32_t> ints;
+    std::vector<float> floats;
+    for (int i = 0; i < 203; i++)
+    {
+        ints.push_back(i % 17 - 8);
+        floats.push_back((i % 13 - 6) * 0.5f);
+    }
+    std::vector<CompareOp> ops = {CompareOp::kEqual, CompareOp::kNotEqual, CompareOp::kLess,
+                                  CompareOp::kLessEqual, CompareOp::kGreater, CompareOp::kGreaterEqual};
+    auto expect = [](CompareOp op, auto l, auto r) {
+        switch (op)
+        {
+        case CompareOp::kEqual:
+            return l == r;
+        case CompareOp::kNotEqual:
+            return l != r;
+        case CompareOp::kLess:
+            return l < r;
+        case CompareOp::kLessEqual:
+            return l <= r;
+        case CompareOp::kGreater:
+            return l > r;
+        default:
+            return l >= r;
+        }
+    };
+    size_t n = ints.size();
+    std::vector<uint64_t> mask(MaskWords(n));
+    for (auto op : ops)
+    {
+        FilterInts(op, ints.data(), 2, n, mask.data());
+        for (size_t i = 0; i < n; i++)
+            ASSERT_EQ(expect(op, ints[i], 2), (mask[i / 64] >> (i % 64) & 1) == 1);
+        FilterInts(op, ints.data(), ints.data() + 1, n - 1, mask.data());
+        for (size_t i = 0; i < n - 1; i++)
+            ASSERT_EQ(expect(op, ints[i], ints[i + 1]), (mask[i / 64] >> (i % 64) & 1) == 1);
+        FilterFloats(op, floats.data(), -0.5f, n, mask.data());
+        for (size_t i = 0; i < n; i++)
+            ASSERT_EQ(expect(op, floats[i], -0.5f), (mask[i / 64] >> (i % 64) & 1) == 1);
+        FilterFloats(op, floats.data(), floats.data() + 1, n - 1, mask.data());
+        for (size_t i = 0; i < n - 1; i++)
+            ASSERT_EQ(expect(op, floats[i], floats[i + 1]), (mask[i / 64] >> (i % 64) & 1) == 1);
+    }
+
+    // The batch filter agrees with the row interpreter on every row of the table
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    auto id = MakeColumnValueExpression(*schema, 0, "id");
+    auto name = MakeColumnValueExpression(*schema, 0, "name");
+    auto account = MakeColumnValueExpression(*schema, 0, "account");
+    char prefix[] = "m";
+    auto name_ge = MakeComparisonExpression(name, MakeConstantValueExpression(Field(kTypeChar, prefix, 1, true)), ">=");
+    auto account_lt = MakeComparisonExpression(account, MakeConstantValueExpression(Field(kTypeFloat, 100.f)), "<");
+    auto id_le = MakeComparisonExpression(id, MakeConstantValueExpression(Field(kTypeInt, 700)), "<=");
+    auto id_eq = MakeComparisonExpression(id, MakeConstantValueExpression(Field(kTypeInt, 900)), "=");
+    std::vector<AbstractExpressionRef> predicates = {
+        name_ge,
+        MakeComparisonExpression(name, name, "="),
+        std::make_shared<LogicExpression>(std::make_shared<LogicExpression>(name_ge, account_lt, LogicType::And),
+                                          std::make_shared<LogicExpression>(id_le, id_eq, LogicType::Or),
+                                          LogicType::And),
+        std::make_shared<LogicExpression>(MakeComparisonExpression(id, MakeConstantValueExpression(Field(kTypeInt)), "<"),
+                                          id_eq, LogicType::Or),
+    };
+    std::vector<uint32_t> columns = {0, 1, 2};
+    RowBatch batch;
+    batch.Reset(schema);
+    std::vector<Row> rows;
+    TableHeap *table_heap = table_info->GetTableHeap();
+    for (auto it = table_heap->Begin(nullptr); it != table_heap->End() && !batch.Full(); ++it)
+    {
+        batch.Append(*it, columns, it.GetRid());
+        rows.emplace_back(*it);
+    }
+    mask.assign(MaskWords(batch.Size()), 0);
+    for (auto &predicate : predicates)
+    {
+        auto compiled = CompiledPredicate::Compile(predicate);
+        ASSERT_NE(nullptr, compiled);
+        compiled->Filter(batch, mask.data());
+        for (size_t i = 0; i < batch.Size(); i++)
+        {
+            bool expected = predicate->Evaluate(&rows[i]).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+            ASSERT_EQ(expected, (mask[i / 64] >> (i % 64) & 1) == 1);
+        }
+    }
+}
+
+TEST_F(ExecutorTest, ParallelSeqScanTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    // enough pages for every worker to get a morsel
+    char name[40];
+    memset(name, 'x', sizeof(name));
+    for (int i = 1000; i < 5000; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        fields.emplace_back(kTypeChar, name, sizeof(name), true);
+        fields.emplace_back(kTypeFloat, 1.f);
+        Row row(fields);
+        ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+    std::vector<page_id_t> page_ids;
+    table_info->GetTableHeap()->GetPageIds(&page_ids);
+    ASSERT_GT(page_ids.size(), 4 * MorselQueue::MORSEL_PAGES);
+
+    auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+    auto col_c = MakeColumnValueExpression(*schema, 0, "account");
+    auto out_schema = MakeOutputSchema({{"id", col_a}, {"account", col_c}});
+    auto filtered = MakeComparisonExpression(col_a, MakeConstantValueExpression(Field(kTypeInt, 700)), ">=");
+    for (auto &predicate : {AbstractExpressionRef(), filtered})
+    {
+        auto scan_plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate);
+        auto plan = make_shared<GatherPlanNode>(out_schema, scan_plan, 4);
+        std::vector<Row> result_set;
+        GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+        std::vector<bool> seen(5000, false);
+        for (auto &row : result_set)
+        {
+            int32_t id;
+            row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+            ASSERT_FALSE(seen[id]);
+            seen[id] = true;
+        }
+        ASSERT_EQ(predicate == nullptr ? 5000 : 4300, result_set.size());
+    }
+}
+
+// two parallel scans open at once, on a pool the workers of either can take all of
+TEST_F(ExecutorTest, ConcurrentGatherTest)
+{
+    TableInfo *left_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", left_info);
+    char name[40];
+    memset(name, 'x', sizeof(name));
+    for (int i = 1000; i < 5000; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        fields.emplace_back(kTypeChar, name, sizeof(name), true);
+        fields.emplace_back(kTypeFloat, 1.f);
+        Row row(fields);
+        ASSERT_TRUE(left_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+    std::vector<Column *> columns = {new Column("tid", TypeId::kTypeInt, 0, false, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *right_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), right_info));
+    for (int i = 0; i < 20000; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        Row row(fields);
+        ASSERT_TRUE(right_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+
+    auto left_id = MakeColumnValueExpression(*left_info->GetSchema(), 0, "id");
+    auto right_tid = MakeColumnValueExpression(*right_info->GetSchema(), 1, "tid");
+    auto left_schema = MakeOutputSchema({{"id", left_id}});
+    auto right_schema = MakeOutputSchema({{"tid", right_tid}});
+    auto left_plan = make_shared<GatherPlanNode>(
+        left_schema, make_shared<SeqScanPlanNode>(left_schema, left_info->GetTableName(), nullptr), 4);
+    auto right_plan = make_shared<GatherPlanNode>(
+        right_schema, make_shared<SeqScanPlanNode>(right_schema, right_info->GetTableName(), nullptr), 4);
+    auto read_all = [](GatherExecutor *executor, size_t count) {
+        std::vector<bool> seen(count, false);
+        size_t rows = 0;
+        RowBatch batch;
+        while (executor->NextBatch(&batch))
+        {
+            for (uint32_t i : batch.GetSelection())
+            {
+                Row row;
+                batch.GetRow(i, &row);
+                int32_t id;
+                row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+                EXPECT_FALSE(seen[id]);
+                seen[id] = true;
+                rows++;
+            }
+        }
+        return rows;
+    };
+    for (size_t workers : {2, 4})
+    {
+        ThreadPool pool(workers);
+        ExecuteContext parallel_ctx(GetTxn(), GetExecutorContext()->GetCatalog(),
+                                    GetExecutorContext()->GetBufferPoolManager(), &pool);
+        GatherExecutor left(&parallel_ctx, left_plan.get());
+        GatherExecutor right(&parallel_ctx, right_plan.get());
+        // the tasks of the scan opened last are taken first, the first one is read first
+        left.Init();
+        right.Init();
+        ASSERT_EQ(5000, read_all(&left, 5000));
+        ASSERT_EQ(20000, read_all(&right, 20000));
+    }
+}
+
+// SELECT table-1.id, table-2.tid FROM table-1, table-2 WHERE table-1.id = table-2.ref
+TEST_F(ExecutorTest, HashJoinTest)
+{
+    TableInfo *left_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", left_info);
+    std::vector<Column *> columns = {new Column("tid", TypeId::kTypeInt, 0, false, false),
+                                     new Column("ref", TypeId::kTypeInt, 1, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *right_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), right_info));
+    // three rows per id of table-1, and rows with a null key that match nothing
+    for (int i = 0; i < 3100; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        if (i < 3000)
+            fields.emplace_back(kTypeInt, i % 1000);
+        else
+            fields.emplace_back(kTypeInt);
+        Row row(fields);
+        ASSERT_TRUE(right_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+
+    auto left_id = MakeColumnValueExpression(*left_info->GetSchema(), 0, "id");
+    auto right_tid = MakeColumnValueExpression(*right_info->GetSchema(), 1, "tid");
+    auto right_ref = MakeColumnValueExpression(*right_info->GetSchema(), 1, "ref");
+    auto out_schema = MakeOutputSchema({{"id", left_id}, {"tid", right_tid}});
+    auto left_scan = make_shared<SeqScanPlanNode>(left_info->GetSchema(), "table-1");
+    auto right_scan = make_shared<SeqScanPlanNode>(right_info->GetSchema(), "table-2");
+    auto residual = MakeComparisonExpression(right_tid, MakeConstantValueExpression(Field(kTypeInt, 1500)), "<");
+    // both build sides, in memory and partitioned twice over on disk, with and without a residual predicate
+    for (bool build_left : {true, false})
+    {
+        for (size_t budget : {size_t(16) << 20, size_t(4096)})
+        {
+            for (auto &predicate : {AbstractExpressionRef(), residual})
+            {
+                auto plan = make_shared<HashJoinPlanNode>(
+                    out_schema, left_scan, right_scan, std::vector<AbstractExpressionRef>{left_id},
+                    std::vector<AbstractExpressionRef>{right_ref}, predicate,
+                    std::vector<AbstractExpressionRef>{left_id, right_tid}, build_left, budget);
+                HashJoinExecutor executor(GetExecutorContext(), plan.get(),
+                                          std::make_unique<SeqScanExecutor>(GetExecutorContext(), left_scan.get()),
+                                          std::make_unique<SeqScanExecutor>(GetExecutorContext(), right_scan.get()));
+                executor.Init();
+                ASSERT_EQ(budget == 4096, executor.IsSpilled());
+                std::vector<bool> seen(3000, false);
+                size_t count = 0;
+                RowBatch batch;
+                while (executor.NextBatch(&batch))
+                {
+                    for (uint32_t i : batch.GetSelection())
+                    {
+                        Row row;
+                        batch.GetRow(i, &row);
+                        int32_t id, tid;
+                        row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+                        row.GetField(1)->SerializeTo(reinterpret_cast<char *>(&tid));
+                        ASSERT_EQ(tid % 1000, id);
+                        ASSERT_FALSE(seen[tid]);
+                        seen[tid] = true;
+                        count++;
+                    }
+                }
+                ASSERT_EQ(predicate == nullptr ? 3000 : 1500, count);
+            }
+        }
+    }
+}
+
+// SELECT id, tid FROM table-1 JOIN table-2 ON id = ref, an int key against a float one
+TEST_F(ExecutorTest, HashJoinMixedTypeTest)
+{
+    TableInfo *left_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", left_info);
+    std::vector<Column *> columns = {new Column("tid", TypeId::kTypeInt, 0, false, false),
+                                     new Column("ref", TypeId::kTypeFloat, 1, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *right_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), right_info));
+    // whole numbers match an id, -0 matches 0, and the halves in between match nothing
+    for (int i = 0; i < 2000; i++)
+    {
+        float ref = i < 1000 ? static_cast<float>(i) : i - 1000 + 0.5f;
+        std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeFloat, i == 0 ? -0.0f : ref)};
+        Row row(fields);
+        ASSERT_TRUE(right_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+
+    auto left_id = MakeColumnValueExpression(*left_info->GetSchema(), 0, "id");
+    auto right_tid = MakeColumnValueExpression(*right_info->GetSchema(), 1, "tid");
+    auto right_ref = MakeColumnValueExpression(*right_info->GetSchema(), 1, "ref");
+    auto out_schema = MakeOutputSchema({{"id", left_id}, {"tid", right_tid}});
+    auto left_scan = make_shared<SeqScanPlanNode>(left_info->GetSchema(), "table-1");
+    auto right_scan = make_shared<SeqScanPlanNode>(right_info->GetSchema(), "table-2");
+    for (bool build_left : {true, false})
+    {
+        auto plan = make_shared<HashJoinPlanNode>(out_schema, left_scan, right_scan,
+                                                  std::vector<AbstractExpressionRef>{left_id},
+                                                  std::vector<AbstractExpressionRef>{right_ref}, nullptr,
+                                                  std::vector<AbstractExpressionRef>{left_id, right_tid}, build_left,
+                                                  size_t(16) << 20);
+        HashJoinExecutor executor(GetExecutorContext(), plan.get(),
+                                  std::make_unique<SeqScanExecutor>(GetExecutorContext(), left_scan.get()),
+                                  std::make_unique<SeqScanExecutor>(GetExecutorContext(), right_scan.get()));
+        executor.Init();
+        std::vector<bool> seen(1000, false);
+        size_t count = 0;
+        RowBatch batch;
+        while (executor.NextBatch(&batch))
+        {
+            for (uint32_t i : batch.GetSelection())
+            {
+                Row row;
+                batch.GetRow(i, &row);
+                int32_t id, tid;
+                row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+                row.GetField(1)->SerializeTo(reinterpret_cast<char *>(&tid));
+                ASSERT_EQ(tid, id);
+                ASSERT_FALSE(seen[tid]);
+                seen[tid] = true;
+                count++;
+            }
+        }
+        ASSERT_EQ(1000, count);
+    }
+}
+
+// the same join over parallel scans of both tables, as planned for tables without an index
+TEST_F(ExecutorTest, HashJoinGatherTest)
+{
+    TableInfo *left_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", left_info);
+    char name[40];
+    memset(name, 'x', sizeof(name));
+    for (int i = 1000; i < 5000; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        fields.emplace_back(kTypeChar, name, sizeof(name), true);
+        fields.emplace_back(kTypeFloat, 1.f);
+        Row row(fields);
+        ASSERT_TRUE(left_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+    std::vector<Column *> columns = {new Column("tid", TypeId::kTypeInt, 0, false, false),
+                                     new Column("ref", TypeId::kTypeInt, 1, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *right_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), right_info));
+    for (int i = 0; i < 20000; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        fields.emplace_back(kTypeInt, i % 5000);
+        Row row(fields);
+        ASSERT_TRUE(right_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+
+    auto left_id = MakeColumnValueExpression(*left_info->GetSchema(), 0, "id");
+    auto right_tid = MakeColumnValueExpression(*right_info->GetSchema(), 1, "tid");
+    auto right_ref = MakeColumnValueExpression(*right_info->GetSchema(), 1, "ref");
+    auto out_schema = MakeOutputSchema({{"id", left_id}, {"tid", right_tid}});
+    auto left_scan = make_shared<SeqScanPlanNode>(left_info->GetSchema(), "table-1");
+    auto right_scan = make_shared<SeqScanPlanNode>(right_info->GetSchema(), "table-2");
+    auto left_gather = make_shared<GatherPlanNode>(left_info->GetSchema(), left_scan, 4);
+    auto right_gather = make_shared<GatherPlanNode>(right_info->GetSchema(), right_scan, 4);
+    // pools small enough for the workers of either scan to take all of them
+    for (size_t workers : {2, 4})
+    {
+        ThreadPool pool(workers);
+        ExecuteContext parallel_ctx(GetTxn(), GetExecutorContext()->GetCatalog(),
+                                    GetExecutorContext()->GetBufferPoolManager(), &pool);
+        auto plan = make_shared<HashJoinPlanNode>(out_schema, left_gather, right_gather,
+                                                  std::vector<AbstractExpressionRef>{left_id},
+                                                  std::vector<AbstractExpressionRef>{right_ref}, nullptr,
+                                                  std::vector<AbstractExpressionRef>{left_id, right_tid}, true,
+                                                  size_t(16) << 20);
+        HashJoinExecutor executor(&parallel_ctx, plan.get(),
+                                  std::make_unique<GatherExecutor>(&parallel_ctx, left_gather.get()),
+                                  std::make_unique<GatherExecutor>(&parallel_ctx, right_gather.get()));
+        executor.Init();
+        std::vector<bool> seen(20000, false);
+        size_t count = 0;
+        RowBatch batch;
+        while (executor.NextBatch(&batch))
+        {
+            for (uint32_t i : batch.GetSelection())
+            {
+                Row row;
+                batch.GetRow(i, &row);
+                int32_t id, tid;
+                row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+                row.GetField(1)->SerializeTo(reinterpret_cast<char *>(&tid));
+                ASSERT_EQ(tid % 5000, id);
+                ASSERT_FALSE(seen[tid]);
+                seen[tid] = true;
+                count++;
+            }
+        }
+        ASSERT_EQ(20000, count);
+    }
+}
+
+TEST_F(ExecutorTest, NestedIndexJoinTest)
+{
+    TableInfo *outer_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", outer_info);
+    std::vector<Column *> columns = {new Column("tid", TypeId::kTypeInt, 0, false, false),
+                                     new Column("ref", TypeId::kTypeInt, 1, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *inner_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), inner_info));
+    IndexInfo *index_info = nullptr;
+    ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-2", "index-ref", {"ref"}, GetTxn(),
+                                                                          index_info, "bptree"));
+    // three rows per id of table-1, and rows with a null key that match nothing
+    for (int i = 0; i < 3100; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        if (i < 3000)
+            fields.emplace_back(kTypeInt, i % 1000);
+        else
+            fields.emplace_back(kTypeInt);
+        Row row(fields);
+        ASSERT_TRUE(inner_info->GetTableHeap()->InsertTuple(row, nullptr));
+        ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(index_info->GetEntry(row), row.GetRowId(), nullptr));
+    }
+    // a deleted row is skipped even if its entry is still in the index
+    ASSERT_TRUE(inner_info->GetTableHeap()->MarkDelete(RowId(inner_info->GetTableHeap()->GetFirstPageId(), 7), nullptr));
+
+    auto outer_id = MakeColumnValueExpression(*outer_info->GetSchema(), 0, "id");
+    auto inner_tid = MakeColumnValueExpression(*inner_info->GetSchema(), 1, "tid");
+    auto out_schema = MakeOutputSchema({{"id", outer_id}, {"tid", inner_tid}});
+    auto outer_filter = MakeComparisonExpression(outer_id, MakeConstantValueExpression(Field(kTypeInt, 200)), "<");
+    auto outer_scan = make_shared<SeqScanPlanNode>(outer_info->GetSchema(), "table-1", outer_filter);
+    auto inner_filter = MakeComparisonExpression(inner_tid, MakeConstantValueExpression(Field(kTypeInt, 1500)), "<");
+    auto residual = MakeComparisonExpression(inner_tid, MakeConstantValueExpression(Field(kTypeInt, 2000)), "<");
+    // without conditions on the inner rows, filtered before the join, and checked on the joined rows
+    for (auto &filter : {AbstractExpressionRef(), inner_filter})
+    {
+        for (auto &predicate : {AbstractExpressionRef(), residual})
+        {
+            auto plan = make_shared<NestedIndexJoinPlanNode>(
+                out_schema, outer_scan, "table-2", index_info, std::vector<AbstractExpressionRef>{outer_id}, filter,
+                predicate, std::vector<AbstractExpressionRef>{outer_id, inner_tid}, true);
+            NestedIndexJoinExecutor executor(GetExecutorContext(), plan.get(),
+                                             std::make_unique<SeqScanExecutor>(GetExecutorContext(), outer_scan.get()));
+            executor.Init();
+            std::vector<bool> seen(3000, false);
+            size_t count = 0;
+            RowBatch batch;
+            while (executor.NextBatch(&batch))
+            {
+                for (uint32_t i : batch.GetSelection())
+                {
+                    Row row;
+                    batch.GetRow(i, &row);
+                    int32_t id, tid;
+                    row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+                    row.GetField(1)->SerializeTo(reinterpret_cast<char *>(&tid));
+                    ASSERT_EQ(tid % 1000, id);
+                    ASSERT_LT(id, 200);
+                    ASSERT_NE(7, tid);
+                    ASSERT_FALSE(seen[tid]);
+                    seen[tid] = true;
+                    count++;
+                }
+            }
+            // every id below 200 has its rows at tid, tid + 1000 and tid + 2000, less the deleted one
+            ASSERT_EQ(filter != nullptr ? 399 : predicate != nullptr ? 399 : 599, count);
+        }
+    }
+}
+
+// SELECT ref, COUNT(*), COUNT(tid), SUM(tid), AVG(tid), MIN(tid), MAX(tag) FROM table-2 GROUP BY ref
+TEST_F(ExecutorTest, HashAggregateTest)
+{
+    std::vector<Column *> columns = {new Column("tid", TypeId::kTypeInt, 0, false, false),
+                                     new Column("ref", TypeId::kTypeInt, 1, true, false),
+                                     new Column("tag", TypeId::kTypeChar, 32, 2, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *table_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), table_info));
+    // three rows per ref below 1000, and a group of rows with a null ref; the tags sort like the tids
+    for (int i = 0; i < 3100; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        if (i < 3000)
+            fields.emplace_back(kTypeInt, i % 1000);
+        else
+            fields.emplace_back(kTypeInt);
+        char tag[40];
+        snprintf(tag, sizeof(tag), "tag-%05d-%022d", i, 0);
+        fields.emplace_back(kTypeChar, tag, strlen(tag), true);
+        Row row(fields);
+        ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+    std::vector<page_id_t> page_ids;
+    table_info->GetTableHeap()->GetPageIds(&page_ids);
+    ASSERT_GT(page_ids.size(), 2 * MorselQueue::MORSEL_PAGES);
+
+    auto tid = MakeColumnValueExpression(*table_info->GetSchema(), 0, "tid");
+    auto ref = MakeColumnValueExpression(*table_info->GetSchema(), 0, "ref");
+    auto tag = MakeColumnValueExpression(*table_info->GetSchema(), 0, "tag");
+    std::vector<AggregationType> agg_types = {AggregationType::CountStarAggregate, AggregationType::CountAggregate,
+                                              AggregationType::SumAggregate,       AggregationType::AvgAggregate,
+                                              AggregationType::MinAggregate,       AggregationType::MaxAggregate};
+    std::vector<AbstractExpressionRef> aggregates = {nullptr, tid, tid, tid, tid, tag};
+    std::vector<std::pair<std::string, AbstractExpressionRef>> outputs = {
+        {"ref", std::make_shared<ColumnValueExpression>(0, 0, kTypeInt)},
+        {"count", std::make_shared<ColumnValueExpression>(0, 1, kTypeInt)},
+        {"count_tid", std::make_shared<ColumnValueExpression>(0, 2, kTypeInt)},
+        {"sum", std::make_shared<ColumnValueExpression>(0, 3, kTypeInt)},
+        {"avg", std::make_shared<ColumnValueExpression>(0, 4, kTypeFloat)},
+        {"min", std::make_shared<ColumnValueExpression>(0, 5, kTypeInt)},
+        {"max", std::make_shared<ColumnValueExpression>(0, 6, kTypeChar)}};
+    auto out_schema = MakeOutputSchema(outputs);
+    std::vector<AbstractExpressionRef> output_exprs;
+    for (auto &output : outputs)
+        output_exprs.push_back(output.second);
+    auto scan_plan = make_shared<SeqScanPlanNode>(table_info->GetSchema(), "table-2");
+    auto gather_plan = make_shared<GatherPlanNode>(table_info->GetSchema(), scan_plan, 4);
+    // workers of their own, the shared pool has a single one on a single core
+    ThreadPool pool(4);
+    ExecuteContext parallel_ctx(GetTxn(), GetExecutorContext()->GetCatalog(),
+                                GetExecutorContext()->GetBufferPoolManager(), &pool);
+    // serial and over a parallel scan, in memory and partitioned to disk down to the last level
+    for (bool parallel : {false, true})
+    {
+        for (size_t budget : {size_t(16) << 20, size_t(4096)})
+        {
+            AbstractPlanNodeRef child_plan = parallel ? AbstractPlanNodeRef(gather_plan) : scan_plan;
+            auto plan = make_shared<AggregationPlanNode>(out_schema, child_plan, std::vector<AbstractExpressionRef>{ref},
+                                                         aggregates, agg_types, output_exprs, budget);
+            ExecuteContext *exec_ctx = parallel ? &parallel_ctx : GetExecutorContext();
+            std::unique_ptr<AbstractExecutor> child;
+            if (parallel)
+                child = std::make_unique<GatherExecutor>(exec_ctx, gather_plan.get());
+            else
+                child = std::make_unique<SeqScanExecutor>(exec_ctx, scan_plan.get());
+            HashAggregateExecutor executor(exec_ctx, plan.get(), std::move(child));
+            executor.Init();
+            ASSERT_EQ(budget == 4096, executor.IsSpilled());
+            ASSERT_EQ(parallel ? 4 : 1, executor.GetWorkerCount());
+            std::vector<bool> seen(1001, false);
+            RowBatch batch;
+            while (executor.NextBatch(&batch))
+            {
+                for (uint32_t i : batch.GetSelection())
+                {
+                    Row row;
+                    batch.GetRow(i, &row);
+                    bool null_group = row.GetField(0)->IsNull();
+                    int32_t group = 1000;
+                    if (!null_group)
+                        row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&group));
+                    ASSERT_FALSE(seen[group]);
+                    seen[group] = true;
+                    int32_t count = null_group ? 100 : 3;
+                    int32_t first = null_group ? 3000 : group;
+                    int32_t last = null_group ? 3099 : group + 2000;
+                    int32_t sum = null_group ? (3000 + 3099) * 50 : 3 * group + 3000;
+                    ASSERT_EQ(Field(kTypeInt, count).CompareEquals(*row.GetField(1)), CmpBool::kTrue);
+                    ASSERT_EQ(Field(kTypeInt, count).CompareEquals(*row.GetField(2)), CmpBool::kTrue);
+                    ASSERT_EQ(Field(kTypeInt, sum).CompareEquals(*row.GetField(3)), CmpBool::kTrue);
+                    ASSERT_EQ(Field(kTypeFloat, static_cast<float>(sum) / count).CompareEquals(*row.GetField(4)),
+                              CmpBool::kTrue);
+                    ASSERT_EQ(Field(kTypeInt, first).CompareEquals(*row.GetField(5)), CmpBool::kTrue);
+                    char tag[40];
+                    snprintf(tag, sizeof(tag), "tag-%05d-%022d", last, 0);
+                    ASSERT_EQ(std::string(tag),
+                              std::string(row.GetField(6)->GetData(), row.GetField(6)->GetLength()));
+                }
+            }
+            ASSERT_EQ(std::vector<bool>(1001, true), seen);
+        }
+    }
+
+    // without group-by columns, aggregates over no rows make one row of a zero count and nulls
+    auto none = MakeComparisonExpression(tid, MakeConstantValueExpression(Field(kTypeInt, 0)), "<");
+    auto empty_scan = make_shared<SeqScanPlanNode>(table_info->GetSchema(), "table-2", none);
+    auto plan = make_shared<AggregationPlanNode>(
+        MakeOutputSchema({outputs[0], outputs[1]}), empty_scan, std::vector<AbstractExpressionRef>{},
+        std::vector<AbstractExpressionRef>{nullptr, tid}, std::vector<AggregationType>{agg_types[0], agg_types[2]},
+        std::vector<AbstractExpressionRef>{outputs[0].second, outputs[1].second}, size_t(16) << 20);
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(1, result_set.size());
+    ASSERT_EQ(Field(kTypeInt, 0).CompareEquals(*result_set[0].GetField(0)), CmpBool::kTrue);
+    ASSERT_TRUE(result_set[0].GetField(1)->IsNull());
+}
+
+// SELECT SUM(v) FROM table-2, right up to the largest int and one past it
+TEST_F(ExecutorTest, SumOverflowTest)
+{
+    std::vector<Column *> columns = {new Column("v", TypeId::kTypeInt, 0, false, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *table_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), table_info));
+    auto v = MakeColumnValueExpression(*table_info->GetSchema(), 0, "v");
+    std::vector<std::pair<std::string, AbstractExpressionRef>> outputs = {
+        {"sum", std::make_shared<ColumnValueExpression>(0, 0, kTypeInt)}};
+    auto scan_plan = make_shared<SeqScanPlanNode>(table_info->GetSchema(), "table-2");
+    auto plan = make_shared<AggregationPlanNode>(
+        MakeOutputSchema(outputs), scan_plan, std::vector<AbstractExpressionRef>{},
+        std::vector<AbstractExpressionRef>{v}, std::vector<AggregationType>{AggregationType::SumAggregate},
+        std::vector<AbstractExpressionRef>{outputs[0].second}, size_t(16) << 20);
+
+    for (int32_t value : {INT32_MAX - 1, 1})
+    {
+        std::vector<Field> fields{Field(kTypeInt, value)};
+        Row row(fields);
+        ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+    std::vector<Row> result_set;
+    ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext()));
+    ASSERT_EQ(1, result_set.size());
+    ASSERT_EQ(Field(kTypeInt, INT32_MAX).CompareEquals(*result_set[0].GetField(0)), CmpBool::kTrue);
+
+    // one more and the sum no longer fits its int column
+    std::vector<Field> fields{Field(kTypeInt, 1)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    result_set.clear();
+    ASSERT_EQ(DB_FAILED, GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext()));
+    ASSERT_TRUE(result_set.empty());
+}
+
+// SELECT tid FROM table-2 ORDER BY ref, name DESC, tid LIMIT n
+TEST_F(ExecutorTest, SortTest)
+{
+    std::vector<Column *> columns = {new Column("tid", TypeId::kTypeInt, 0, false, false),
+                                     new Column("ref", TypeId::kTypeInt, 1, true, false),
+                                     new Column("name", TypeId::kTypeChar, 16, 2, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableInfo *table_info;
+    ASSERT_EQ(DB_SUCCESS,
+              GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema.get(), GetTxn(), table_info));
+    // negative refs, null refs, and names that are prefixes of each other
+    struct Expected
+    {
+        int32_t tid;
+        bool null_ref;
+        int32_t ref;
+        std::string name;
+    };
+    std::vector<Expected> expected;
+    for (int i = 0; i < 3000; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        bool null_ref = i % 97 == 0;
+        int32_t ref = (i * 7919) % 101 - 50;
+        if (null_ref)
+            fields.emplace_back(kTypeInt);
+        else
+            fields.emplace_back(kTypeInt, ref);
+        std::string name = std::string("n") + std::string(i % 5, 'x');
+        fields.emplace_back(kTypeChar, const_cast<char *>(name.data()), name.size(), true);
+        Row row(fields);
+        ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+        expected.push_back({i, null_ref, ref, name});
+    }
+    std::sort(expected.begin(), expected.end(), [](const Expected &lhs, const Expected &rhs) {
+        if (lhs.null_ref != rhs.null_ref)
+            return lhs.null_ref;
+        if (!lhs.null_ref && lhs.ref != rhs.ref)
+            return lhs.ref < rhs.ref;
+        if (lhs.name != rhs.name)
+            return lhs.name > rhs.name;
+        return lhs.tid < rhs.tid;
+    });
+
+    auto tid = std::make_shared<ColumnValueExpression>(0, 0, kTypeInt);
+    auto ref = std::make_shared<ColumnValueExpression>(0, 1, kTypeInt);
+    auto name = std::make_shared<ColumnValueExpression>(0, 2, kTypeChar);
+    std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys = {
+        {OrderByType::Asc, ref}, {OrderByType::Desc, name}, {OrderByType::Asc, tid}};
+    auto out_schema = MakeOutputSchema({{"tid", tid}});
+    auto scan_plan = make_shared<SeqScanPlanNode>(table_info->GetSchema(), "table-2");
+    // in memory and in runs on disk, whole and cut down by a heap or by the merge
+    for (size_t budget : {size_t(16) << 20, size_t(8192)})
+    {
+        for (size_t limit : {SortPlanNode::NO_LIMIT, size_t(10), size_t(0)})
+        {
+            auto plan = make_shared<SortPlanNode>(out_schema, scan_plan, order_bys, std::vector<AbstractExpressionRef>{tid},
+                                                  limit, budget);
+            SortExecutor executor(GetExecutorContext(), plan.get(),
+                                  std::make_unique<SeqScanExecutor>(GetExecutorContext(), scan_plan.get()));
+            executor.Init();
+            ASSERT_EQ(limit != SortPlanNode::NO_LIMIT, executor.IsTopN());
+            ASSERT_EQ(budget == 8192 && limit == SortPlanNode::NO_LIMIT, executor.GetRunCount() > 1);
+            std::vector<int32_t> tids;
+            RowBatch batch;
+            while (executor.NextBatch(&batch))
+            {
+                for (uint32_t i : batch.GetSelection())
+                {
+                    Row row;
+                    batch.GetRow(i, &row);
+                    int32_t value;
+                    row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&value));
+                    tids.push_back(value);
+                }
+            }
+            ASSERT_EQ(std::min(limit, expected.size()), tids.size());
+            for (size_t i = 0; i < tids.size(); i++)
+                ASSERT_EQ(expected[i].tid, tids[i]);
+        }
+    }
+
+    // nulls come first in descending order as well
+    std::sort(expected.begin(), expected.end(), [](const Expected &lhs, const Expected &rhs) {
+        if (lhs.null_ref != rhs.null_ref)
+            return lhs.null_ref;
+        if (!lhs.null_ref && lhs.ref != rhs.ref)
+            return lhs.ref > rhs.ref;
+        return lhs.tid < rhs.tid;
+    });
+    std::vector<std::pair<OrderByType, AbstractExpressionRef>> desc_order_bys = {{OrderByType::Desc, ref},
+                                                                                 {OrderByType::Asc, tid}};
+    for (size_t budget : {size_t(16) << 20, size_t(8192)})
+    {
+        auto plan = make_shared<SortPlanNode>(out_schema, scan_plan, desc_order_bys,
+                                              std::vector<AbstractExpressionRef>{tid}, SortPlanNode::NO_LIMIT, budget);
+        std::vector<Row> result_set;
+        ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext()));
+        ASSERT_EQ(expected.size(), result_set.size());
+        for (size_t i = 0; i < result_set.size(); i++)
+            ASSERT_EQ(Field(kTypeInt, expected[i].tid).CompareEquals(*result_set[i].GetField(0)), CmpBool::kTrue);
+    }
+
+    // a limit without an order cuts the rows of its child short
+    auto limit_plan = make_shared<LimitPlanNode>(table_info->GetSchema(), scan_plan, 1500);
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(limit_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(1500, result_set.size());
+}
+
+// SELECT id FROM table-1 LIMIT n, over a scan, a parallel scan and an index scan
+TEST_F(ExecutorTest, LimitPushdownTest)
+{
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    char name[40];
+    memset(name, 'x', sizeof(name));
+    for (int i = 1000; i < 5000; i++)
+    {
+        std::vector<Field> fields;
+        fields.emplace_back(kTypeInt, i);
+        fields.emplace_back(kTypeChar, name, sizeof(name), true);
+        fields.emplace_back(kTypeFloat, 1.f);
+        Row row(fields);
+        ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    }
+    auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+    auto out_schema = MakeOutputSchema({{"id", col_id}});
+    auto scan_plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), nullptr);
+    auto read_ids = [](AbstractExecutor *executor) {
+        std::vector<int32_t> ids;
+        RowBatch batch;
+        while (executor->NextBatch(&batch))
+        {
+            for (uint32_t i : batch.GetSelection())
+            {
+                Row row;
+                batch.GetRow(i, &row);
+                int32_t id;
+                row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    };
+
+    // under a row limit, a scan reads no more pages than it takes to reach it
+    SeqScanExecutor scan(GetExecutorContext(), scan_plan.get());
+    scan.SetRowLimit(5);
+    scan.Init();
+    std::vector<int32_t> ids = read_ids(&scan);
+    ASSERT_GE(ids.size(), 5);
+    ASSERT_LE(ids.size(), TablePage::MAX_TUPLE_COUNT);
+
+    // on the calling thread for a small limit, on workers stopped once it is reached for a large one
+    auto gather_plan = make_shared<GatherPlanNode>(out_schema, scan_plan, 4);
+    ThreadPool pool(4);
+    ExecuteContext parallel_ctx(GetTxn(), GetExecutorContext()->GetCatalog(),
+                                GetExecutorContext()->GetBufferPoolManager(), &pool);
+    for (size_t limit : {size_t(5), size_t(2000)})
+    {
+        auto plan = make_shared<LimitPlanNode>(out_schema, gather_plan, limit);
+        auto gather = std::make_unique<GatherExecutor>(&parallel_ctx, gather_plan.get());
+        GatherExecutor *child = gather.get();
+        LimitExecutor executor(&parallel_ctx, plan.get(), std::move(gather));
+        executor.Init();
+        ids = read_ids(&executor);
+        ASSERT_EQ(limit, ids.size());
+        std::sort(ids.begin(), ids.end());
+        ASSERT_EQ(ids.end(), std::unique(ids.begin(), ids.end()));
+        RowBatch batch;
+        ASSERT_FALSE(child->NextBatch(&batch));
+    }
+
+    // an index scan opens its range on the first batch and closes it at the limit
+    IndexInfo *index_info = nullptr;
+    std::vector<std::string> index_keys{"id"};
+    ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(),
+                                                                          index_info, "bptree"));
+    TableHeap *table_heap = table_info->GetTableHeap();
+    for (auto it = table_heap->Begin(GetTxn()); it != table_heap->End(); ++it)
+    {
+        ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(index_info->GetEntry(*it), it.GetRid(), GetTxn()));
+    }
+    IndexScanRange range;
+    range.index = index_info;
+    range.lower_key.emplace_back(kTypeInt, 3000);
+    auto index_plan = std::make_shared<IndexScanPlanNode>(
+        out_schema, table_info->GetTableName(), std::vector<std::vector<IndexScanRange>>{{range}}, false);
+    auto plan = make_shared<LimitPlanNode>(out_schema, index_plan, 4);
+    auto index_scan = std::make_unique<IndexScanExecutor>(GetExecutorContext(), index_plan.get());
+    IndexScanExecutor *child = index_scan.get();
+    LimitExecutor executor(GetExecutorContext(), plan.get(), std::move(index_scan));
+    executor.Init();
+    ASSERT_EQ((std::vector<int32_t>{3000, 3001, 3002, 3003}), read_ids(&executor));
+    RowBatch batch;
+    ASSERT_FALSE(child->NextBatch(&batch));
+}
@@ -58,7 +58,8 @@ class ExecutorTest : public ::testing::Test {
       delete[] characters;
     }
     // Create an executor context for our executors
-    exec_ctx_ = std::make_unique<ExecuteContext>(txn_, db_test_->catalog_mgr_, db_test_->bpm_);
+    exec_ctx_ = std::make_unique<ExecuteContext>(txn_, db_test_->catalog_mgr_, db_test_->bpm_,
+                                                 db_test_->thread_pool_.get());
 
     // Construct the executor engine for the test
     execution_engine_ = std::make_unique<ExecuteEngine>();
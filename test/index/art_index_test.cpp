@@ -0,0 +1,146 @@
+#include "index/art_index.h"
+
+#include <map>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+/**
+ * Keys with a shared head of random length, so paths of every length get compressed,
+ * some of them longer than a node keeps inline. No key is a prefix of another.
+ */
+std::string RandomKey(std::mt19937 &rng) {
+  static const std::string long_head = "Zthe-head-shared-by-a-few-of-the-keys";
+  std::string key =
+      rng() % 4 == 0 ? long_head.substr(0, 1 + rng() % long_head.size()) : std::string(rng() % 24, 'k');
+  int tail = 1 + rng() % 4;
+  for (int i = 0; i < tail; i++) {
+    key.push_back(static_cast<char>(1 + rng() % 255));
+  }
+  key.push_back(0);
+  return key;
+}
+
+void ExpectSameOrder(const std::map<std::string, int64_t> &expected, AdaptiveRadixTree::Iterator iter) {
+  for (auto &pair : expected) {
+    const AdaptiveRadixTree::Leaf *leaf = iter.Next();
+    ASSERT_NE(nullptr, leaf);
+    ASSERT_EQ(pair.first, leaf->key);
+    ASSERT_EQ(pair.second, leaf->value.Get());
+  }
+  ASSERT_EQ(nullptr, iter.Next());
+}
+}  // namespace
+
+TEST(ArtIndexTests, RadixTreeTest) {
+  std::mt19937 rng(7);
+  AdaptiveRadixTree tree;
+  std::map<std::string, int64_t> expected;
+  // grow every node size, then shrink them back while checking the order
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 20000; i++) {
+      std::string key = RandomKey(rng);
+      bool inserted = expected.emplace(key, i).second;
+      ASSERT_EQ(inserted, tree.Insert(key, RowId(i)));
+    }
+    ASSERT_EQ(expected.size(), tree.Size());
+    ExpectSameOrder(expected, tree.Begin());
+    for (auto &pair : expected) {
+      ASSERT_NE(nullptr, tree.Lookup(pair.first));
+      ASSERT_EQ(pair.second, tree.Lookup(pair.first)->value.Get());
+    }
+    // seek to keys that are and are not in the tree
+    for (int i = 0; i < 200; i++) {
+      std::string bound = RandomKey(rng);
+      bound.resize(rng() % bound.size());
+      ExpectSameOrder(std::map<std::string, int64_t>(expected.lower_bound(bound), expected.end()),
+                      tree.LowerBound(bound));
+    }
+    for (auto it = expected.begin(); it != expected.end();) {
+      if (rng() % 4 != 0) {
+        ASSERT_TRUE(tree.Remove(it->first));
+        ASSERT_FALSE(tree.Remove(it->first));
+        ASSERT_EQ(nullptr, tree.Lookup(it->first));
+        it = expected.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    ASSERT_EQ(expected.size(), tree.Size());
+    ExpectSameOrder(expected, tree.Begin());
+  }
+  tree.Clear();
+  ASSERT_EQ(nullptr, tree.Begin().Next());
+}
+
+TEST(ArtIndexTests, ArtIndexScanTest) {
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false),
+                                   new Column("b", TypeId::kTypeInt, 1, false, false)};
+  Schema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0, 1});
+  ArtIndex unique_index(0, key_schema, true);
+  ArtIndex index(1, key_schema, false);
+  auto make_key = [](std::vector<int32_t> values) {
+    std::vector<Field> fields;
+    for (auto v : values) {
+      fields.emplace_back(TypeId::kTypeInt, v);
+    }
+    return Row(fields);
+  };
+  // (a, b) for a in [-50, 50), b in [0, 10), every key twice in the non-unique index
+  for (int a = -50; a < 50; a++) {
+    for (int b = 0; b < 10; b++) {
+      Row key = make_key({a, b});
+      RowId rid((a + 50) * 10 + b, 0);
+      ASSERT_EQ(DB_SUCCESS, unique_index.InsertEntry(key, rid, nullptr));
+      ASSERT_EQ(DB_FAILED, unique_index.InsertEntry(key, RowId(0, 1), nullptr));
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(key, rid, nullptr));
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(key, RowId(rid.GetPageId(), 1), nullptr));
+    }
+  }
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, unique_index.ScanKey(make_key({-3, 4}), ret, nullptr));
+  ASSERT_EQ(1, ret.size());
+  ASSERT_EQ(RowId(474, 0), ret[0]);
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key({-3, 4}), ret, nullptr));
+  ASSERT_EQ(2, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, unique_index.ScanKey(make_key({60, 0}), ret, nullptr));
+
+  // a = 7 and b > 2 and b <= 5, in key order, with the entries rebuilt from the keys
+  Row lower = make_key({7, 2});
+  Row upper = make_key({7, 5});
+  auto cursor = unique_index.Scan(&lower, false, &upper, true, nullptr);
+  RowId rid;
+  Row entry;
+  for (int b = 3; b <= 5; b++) {
+    ASSERT_TRUE(cursor->NextEntry(&rid, &entry));
+    ASSERT_EQ(RowId(570 + b, 0), rid);
+    ASSERT_TRUE(entry.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 7)) == CmpBool::kTrue);
+    ASSERT_TRUE(entry.GetField(1)->CompareEquals(Field(TypeId::kTypeInt, b)) == CmpBool::kTrue);
+  }
+  ASSERT_FALSE(cursor->Next(&rid));
+
+  // a prefix bound takes every b, negative values sort first
+  Row prefix = make_key({-1});
+  cursor = index.Scan(nullptr, false, &prefix, false, nullptr);
+  int count = 0;
+  while (cursor->Next(&rid)) {
+    count++;
+  }
+  ASSERT_EQ(49 * 10 * 2, count);
+
+  for (int b = 0; b < 10; b++) {
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(make_key({0, b}), RowId(500 + b, 0), nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key({0}), ret, nullptr));
+  ASSERT_EQ(10, ret.size());
+  ASSERT_EQ(DB_SUCCESS, index.Destroy());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(make_key({0}), ret, nullptr, ">="));
+  delete key_schema;
+}
@@ -1,10 +1,12 @@
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
 #include <string>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/generic_key.h"
+#include "utils/utils.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
 
@@ -66,4 +68,393 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     i++;
   }
   delete index;
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BPlusTreeIndexRangeScanTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 32, engine.bpm_);
+  // empty index yields an exhausted cursor
+  RowId rid;
+  ASSERT_FALSE(index->Scan(nullptr, true, nullptr, true, nullptr)->Next(&rid));
+  const int n = 2000;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(i / 100, i % 100), nullptr));
+  }
+  auto drain = [&](const Row *lower, bool lower_inclusive, const Row *upper, bool upper_inclusive) {
+    std::vector<int> keys;
+    auto cursor = index->Scan(lower, lower_inclusive, upper, upper_inclusive, nullptr);
+    RowId r;
+    while (cursor->Next(&r)) {
+      keys.push_back(r.GetPageId() * 100 + r.GetSlotNum());
+    }
+    return keys;
+  };
+  std::vector<Field> low_fields{Field(TypeId::kTypeInt, 500)}, high_fields{Field(TypeId::kTypeInt, 1500)};
+  Row low(low_fields), high(high_fields);
+  auto keys = drain(&low, true, &high, false);
+  ASSERT_EQ(1000, keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(500 + (int)i, keys[i]);
+  }
+  keys = drain(&low, false, &high, true);
+  ASSERT_EQ(1000, keys.size());
+  ASSERT_EQ(501, keys.front());
+  ASSERT_EQ(1500, keys.back());
+  keys = drain(nullptr, true, &low, false);
+  ASSERT_EQ(500, keys.size());
+  keys = drain(&high, true, nullptr, true);
+  ASSERT_EQ(n - 1500, keys.size());
+  // bounds beyond the stored keys
+  std::vector<Field> past_fields{Field(TypeId::kTypeInt, n + 10)};
+  Row past(past_fields);
+  ASSERT_TRUE(drain(&past, true, nullptr, true).empty());
+  ASSERT_EQ(n, drain(nullptr, true, &past, true).size());
+  // operator based lookups are served by the same cursors
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(low, ret, nullptr, "<>"));
+  ASSERT_EQ(n - 1, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(past, ret, nullptr, ">"));
+  delete index;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexPrefixScanTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false),
+                                   new Column("b", TypeId::kTypeChar, 16, 1, false, false),
+                                   new Column("c", TypeId::kTypeInt, 2, false, false)};
+  std::vector<uint32_t> index_key_map{0, 1, 2};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 32, engine.bpm_);
+  // keys (a, "b<j>", c), 10 x 10 x 10, row id encodes the triple
+  const char *names[] = {"b0", "b1", "b2", "b3", "b4", "b5", "b6", "b7", "b8", "b9"};
+  for (int a = 0; a < 10; a++) {
+    for (int b = 0; b < 10; b++) {
+      for (int c = 0; c < 10; c++) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, a),
+                                  Field(TypeId::kTypeChar, const_cast<char *>(names[b]), 2, true),
+                                  Field(TypeId::kTypeInt, c)};
+        Row row(fields);
+        ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(a, b * 10 + c), nullptr));
+      }
+    }
+  }
+  auto drain = [&](std::vector<Field> lower_fields, bool lower_inclusive, std::vector<Field> upper_fields,
+                   bool upper_inclusive) {
+    std::vector<int> keys;
+    Row lower(lower_fields), upper(upper_fields);
+    auto cursor = index->Scan(lower_fields.empty() ? nullptr : &lower, lower_inclusive,
+                              upper_fields.empty() ? nullptr : &upper, upper_inclusive, nullptr);
+    RowId r;
+    while (cursor->Next(&r)) {
+      keys.push_back(r.GetPageId() * 100 + r.GetSlotNum());
+    }
+    return keys;
+  };
+  // the first count columns of (a, names[b], c)
+  auto bound = [&](size_t count, int a, int b = 0, int c = 0) {
+    std::vector<Field> fields;
+    fields.emplace_back(TypeId::kTypeInt, a);
+    if (count > 1) fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(names[b]), 2, true);
+    if (count > 2) fields.emplace_back(TypeId::kTypeInt, c);
+    return fields;
+  };
+  // a = 3
+  auto keys = drain(bound(1, 3), true, bound(1, 3), true);
+  ASSERT_EQ(100, keys.size());
+  ASSERT_EQ(300, keys.front());
+  ASSERT_EQ(399, keys.back());
+  // a = 3 and b = "b4"
+  keys = drain(bound(2, 3, 4), true, bound(2, 3, 4), true);
+  ASSERT_EQ(10, keys.size());
+  ASSERT_EQ(340, keys.front());
+  // a = 3 and b = "b4" and 2 < c <= 6
+  keys = drain(bound(3, 3, 4, 2), false, bound(3, 3, 4, 6), true);
+  ASSERT_EQ((std::vector<int>{343, 344, 345, 346}), keys);
+  // a = 3 and b > "b4"
+  keys = drain(bound(2, 3, 4), false, bound(1, 3), true);
+  ASSERT_EQ(50, keys.size());
+  ASSERT_EQ(350, keys.front());
+  ASSERT_EQ(399, keys.back());
+  // a = 3 and b < "b4"
+  keys = drain(bound(1, 3), true, bound(2, 3, 4), false);
+  ASSERT_EQ(40, keys.size());
+  ASSERT_EQ(339, keys.back());
+  // 3 < a < 5
+  keys = drain(bound(1, 3), false, bound(1, 5), false);
+  ASSERT_EQ(100, keys.size());
+  ASSERT_EQ(400, keys.front());
+  delete index;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexNonUniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("dept", TypeId::kTypeInt, 1, false, false)};
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 16, engine.bpm_, false);
+  // five hot keys spill to overflow pages, the rest hold a single row each
+  const int n = 20000;
+  auto key_of = [](int i) { return i < n / 2 ? i % 5 : i; };
+  std::vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int i : order) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key_of(i))};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(i / 100, i % 100), nullptr));
+  }
+  std::vector<Field> dup_fields{Field(TypeId::kTypeInt, 3)};
+  Row dup(dup_fields);
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(dup, RowId(0, 3), nullptr));
+
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(dup, ret, nullptr));
+  ASSERT_EQ(n / 10, ret.size());
+  for (size_t i = 0; i < ret.size(); i++) {
+    ASSERT_EQ(3, key_of(ret[i].GetPageId() * 100 + ret[i].GetSlotNum()));
+    if (i > 0) {
+      ASSERT_LT(ret[i - 1].Get(), ret[i].Get());
+    }
+  }
+  std::vector<Field> low_fields{Field(TypeId::kTypeInt, 1)}, high_fields{Field(TypeId::kTypeInt, 3)};
+  Row low(low_fields), high(high_fields);
+  auto cursor = index->Scan(&low, true, &high, true, nullptr);
+  int count = 0;
+  RowId rid;
+  while (cursor->Next(&rid)) {
+    count++;
+  }
+  ASSERT_EQ(3 * n / 10, count);
+  cursor.reset();
+
+  // removing single rows keeps the key until its last row is gone
+  for (int i = 3; i < n / 2; i += 5) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(dup, RowId(i / 100, i % 100), nullptr));
+    ret.clear();
+    if (i + 5 < n / 2) {
+      ASSERT_EQ(DB_SUCCESS, index->ScanKey(dup, ret, nullptr));
+      ASSERT_EQ((n / 2 - i) / 5, ret.size());
+    }
+  }
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(dup, ret, nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(dup, ret, nullptr, ">="));
+  ASSERT_EQ(n / 10 + n / 2, ret.size());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  delete index;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexCoveringTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false),
+                                   new Column("balance", TypeId::kTypeFloat, 2, true, false)};
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> index_key_map{0}, include_map{1, 2};
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *include_schema = Schema::ShallowCopySchema(&table_schema, include_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 16, engine.bpm_, true, include_schema);
+  ASSERT_TRUE(index->SupportsIndexOnlyScan());
+  const int n = 5000;
+  std::vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int i : order) {
+    std::string name = "name" + std::to_string(i);
+    // every third row has no balance
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                              i % 3 ? Field(TypeId::kTypeFloat, i * 0.5f) : Field(TypeId::kTypeFloat)};
+    Row entry(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(entry, RowId(i / 100, i % 100), nullptr));
+  }
+  // the key alone still finds the row
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 42)};
+  Row key(key_fields);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key, ret, nullptr));
+  ASSERT_EQ(RowId(0, 42).Get(), ret[0].Get());
+
+  std::vector<Field> low_fields{Field(TypeId::kTypeInt, 100)};
+  Row low(low_fields);
+  auto cursor = index->Scan(&low, false, nullptr, true, nullptr);
+  RowId rid;
+  Row entry;
+  int expected = 101;
+  while (cursor->NextEntry(&rid, &entry)) {
+    ASSERT_EQ(3, entry.GetFieldCount());
+    ASSERT_EQ(CmpBool::kTrue, entry.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, expected)));
+    std::string name = "name" + std::to_string(expected);
+    ASSERT_EQ(name, std::string(entry.GetField(1)->GetData(), entry.GetField(1)->GetLength()));
+    if (expected % 3) {
+      ASSERT_EQ(CmpBool::kTrue, entry.GetField(2)->CompareEquals(Field(TypeId::kTypeFloat, expected * 0.5f)));
+    } else {
+      ASSERT_TRUE(entry.GetField(2)->IsNull());
+    }
+    ASSERT_EQ(RowId(expected / 100, expected % 100).Get(), rid.Get());
+    expected++;
+  }
+  ASSERT_EQ(n, expected);
+  cursor.reset();
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  delete index;
+  delete include_schema;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBatchInsertTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *unique = new BPlusTreeIndex(0, index_schema, 16, engine.bpm_);
+  auto *non_unique = new BPlusTreeIndex(1, index_schema, 16, engine.bpm_, false);
+  // the even keys are there already, the batches bring the odd ones and some of both twice
+  const int n = 20000;
+  for (int i = 0; i < n; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, unique->InsertEntry(Row(fields), RowId(i), nullptr));
+  }
+  std::vector<int> order;
+  for (int i = 0; i < n; i++) {
+    order.push_back(i);
+  }
+  for (int i = 1; i < n; i += 10) {
+    order.push_back(i);
+  }
+  ShuffleArray(order);
+
+  std::vector<bool> seen(n, false);
+  const size_t batch_size = 1000;
+  for (size_t start = 0; start < order.size(); start += batch_size) {
+    std::vector<Row> keys;
+    std::vector<RowId> row_ids;
+    for (size_t j = start; j < std::min(order.size(), start + batch_size); j++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, order[j])};
+      keys.emplace_back(fields);
+      row_ids.emplace_back(j);
+    }
+    std::vector<bool> inserted;
+    unique->InsertEntries(keys, row_ids, inserted, nullptr);
+    ASSERT_EQ(keys.size(), inserted.size());
+    for (size_t j = 0; j < keys.size(); j++) {
+      int key = order[start + j];
+      ASSERT_EQ(key % 2 == 1 && !seen[key], inserted[j]);
+      if (key % 2 == 1) {
+        seen[key] = true;
+      }
+    }
+    non_unique->InsertEntries(keys, row_ids, inserted, nullptr);
+    ASSERT_EQ(keys.size(), static_cast<size_t>(std::count(inserted.begin(), inserted.end(), true)));
+    ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  }
+
+  // every key once, in order, each odd key with the row of its first occurrence
+  std::vector<RowId> first(n);
+  for (size_t j = order.size(); j-- > 0;) {
+    first[order[j]] = RowId(j);
+  }
+  auto cursor = unique->Scan(nullptr, true, nullptr, true, nullptr);
+  RowId rid;
+  Row entry;
+  int count = 0;
+  while (cursor->NextEntry(&rid, &entry)) {
+    int32_t key;
+    entry.GetField(0)->SerializeTo(reinterpret_cast<char *>(&key));
+    ASSERT_EQ(count, key);
+    ASSERT_EQ(key % 2 == 0 ? RowId(key) : first[key], rid);
+    count++;
+  }
+  ASSERT_EQ(n, count);
+  cursor.reset();
+  std::vector<RowId> ret;
+  std::vector<Field> dup_fields{Field(TypeId::kTypeInt, 11)};
+  ASSERT_EQ(DB_SUCCESS, non_unique->ScanKey(Row(dup_fields), ret, nullptr));
+  ASSERT_EQ(2, ret.size());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  ASSERT_EQ(DB_SUCCESS, unique->Destroy());
+  ASSERT_EQ(DB_SUCCESS, non_unique->Destroy());
+  delete unique;
+  delete non_unique;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBatchLookupTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *unique = new BPlusTreeIndex(0, index_schema, 16, engine.bpm_);
+  auto *non_unique = new BPlusTreeIndex(1, index_schema, 16, engine.bpm_, false);
+  // the even keys, once in the unique tree and key % 3 + 1 times in the other
+  const int n = 20000;
+  for (int i = 0; i < n; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, unique->InsertEntry(Row(fields), RowId(i), nullptr));
+    for (int j = 0; j <= i % 3; j++) {
+      ASSERT_EQ(DB_SUCCESS, non_unique->InsertEntry(Row(fields), RowId(i, j), nullptr));
+    }
+  }
+  // present and missing keys, some repeated, some past either end of the tree
+  std::vector<int> probes;
+  for (int i = -10; i < n + 10; i += 3) {
+    probes.push_back(i);
+  }
+  for (int i = 0; i < n; i += 101) {
+    probes.push_back(i);
+  }
+  ShuffleArray(probes);
+
+  const size_t batch_size = 500;
+  for (size_t start = 0; start < probes.size(); start += batch_size) {
+    std::vector<Row> keys;
+    for (size_t j = start; j < std::min(probes.size(), start + batch_size); j++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, probes[j])};
+      keys.emplace_back(fields);
+    }
+    std::vector<std::vector<RowId>> results;
+    unique->ScanKeys(keys, results, nullptr);
+    ASSERT_EQ(keys.size(), results.size());
+    for (size_t j = 0; j < keys.size(); j++) {
+      int key = probes[start + j];
+      bool present = key >= 0 && key < n && key % 2 == 0;
+      ASSERT_EQ(present ? 1 : 0, results[j].size());
+      if (present) {
+        ASSERT_EQ(RowId(key), results[j][0]);
+      }
+    }
+    non_unique->ScanKeys(keys, results, nullptr);
+    ASSERT_EQ(keys.size(), results.size());
+    for (size_t j = 0; j < keys.size(); j++) {
+      int key = probes[start + j];
+      bool present = key >= 0 && key < n && key % 2 == 0;
+      ASSERT_EQ(present ? key % 3 + 1 : 0, results[j].size());
+      std::vector<RowId> expected;
+      ASSERT_EQ(present ? DB_SUCCESS : DB_KEY_NOT_FOUND, non_unique->ScanKey(keys[j], expected, nullptr));
+      std::sort(expected.begin(), expected.end(), [](RowId a, RowId b) { return a.Get() < b.Get(); });
+      std::sort(results[j].begin(), results[j].end(), [](RowId a, RowId b) { return a.Get() < b.Get(); });
+      ASSERT_EQ(expected, results[j]);
+    }
+    ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  }
+  ASSERT_EQ(DB_SUCCESS, unique->Destroy());
+  ASSERT_EQ(DB_SUCCESS, non_unique->Destroy());
+  delete unique;
+  delete non_unique;
+}
@@ -3,6 +3,7 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
+#include "index/posting_list.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -140,4 +141,109 @@ TEST(BPlusTreeTests, SampleTest)
         ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
     }
     // ASSERT_TRUE(tree.Check());
-}
\ No newline at end of file
+}
+
+static int CountLeaves(BPlusTree &tree, BufferPoolManager *bpm)
+{
+    Page *page = tree.FindLeafPage(nullptr, INVALID_PAGE_ID, true);
+    int count = 0;
+    while (page != nullptr)
+    {
+        count++;
+        auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+        page_id_t next = leaf->GetNextPageId();
+        bpm->UnpinPage(leaf->GetPageId(), false);
+        page = next == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next);
+    }
+    return count;
+}
+
+TEST(BPlusTreeTests, CompressedKeyTest)
+{
+    DBStorageEngine engine(db_name);
+    std::vector<Column *> columns = {
+        new Column("name", TypeId::kTypeChar, 64, 0, false, false),
+    };
+    Schema *table_schema = new Schema(columns);
+    KeyManager KP(table_schema, KeyManager::GetMaxKeyLength(table_schema));
+    BPlusTree compressed(0, engine.bpm_, KP);
+    BPlusTree plain(1, engine.bpm_, KP, UNDEFINED_SIZE, UNDEFINED_SIZE, false);
+    // long shared prefixes, as in urls or paths
+    const int n = 20000;
+    vector<GenericKey *> keys;
+    for (int i = 0; i < n; i++)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "https://www.example.com/users/profile/%08d", i);
+        GenericKey *key = KP.InitKey();
+        std::vector<Field> fields{Field(TypeId::kTypeChar, buf, strlen(buf), false)};
+        KP.SerializeFromKey(key, Row(fields), table_schema);
+        keys.push_back(key);
+    }
+    ShuffleArray(keys);
+    for (int i = 0; i < n; i++)
+    {
+        ASSERT_TRUE(compressed.Insert(keys[i], RowId(i)));
+        ASSERT_TRUE(plain.Insert(keys[i], RowId(i)));
+    }
+    ASSERT_FALSE(compressed.Insert(keys[0], RowId(0)));
+    ASSERT_LT(CountLeaves(compressed, engine.bpm_) * 2, CountLeaves(plain, engine.bpm_));
+    // remove most keys to exercise merge and redistribute on variable length pages
+    for (int i = 0; i < n - n / 10; i++)
+    {
+        compressed.Remove(keys[i]);
+        plain.Remove(keys[i]);
+    }
+    vector<RowId> ans;
+    for (int i = 0; i < n; i++)
+    {
+        ans.clear();
+        ASSERT_EQ(i >= n - n / 10, compressed.GetValue(keys[i], ans));
+        if (!ans.empty())
+        {
+            ASSERT_EQ(RowId(i), ans[0]);
+        }
+        ans.clear();
+        ASSERT_EQ(i >= n - n / 10, plain.GetValue(keys[i], ans));
+    }
+    // the leaf chain is still sorted and complete
+    int count = 0;
+    GenericKey *prev = nullptr;
+    for (auto it = compressed.Begin(); it != compressed.End(); ++it)
+    {
+        GenericKey *key = (*it).first;
+        if (prev != nullptr)
+            ASSERT_LT(KP.CompareKeys(prev, key), 0);
+        else
+            prev = KP.InitKey();
+        memcpy(prev, key, KP.GetKeySize());
+        count++;
+    }
+    free(prev);
+    ASSERT_EQ(n / 10, count);
+    ASSERT_TRUE(compressed.Check());
+    for (auto key : keys)
+        free(key);
+}
+
+TEST(BPlusTreeTests, PostingListDecodeTest) {
+  // an inline record: its tag, the count and the deltas between row ids
+  std::string record(1, '\0');
+  char buf[10];
+  record.append(buf, PostingPage::PutVarint(buf, 2));
+  record.append(buf, PostingPage::PutVarint(buf, RowId(1, 5).Get()));
+  record.append(buf, PostingPage::PutVarint(buf, 300));
+  std::vector<RowId> rids;
+  ASSERT_EQ(INVALID_PAGE_ID, PostingList::LoadFirst(record.data(), record.size(), rids, nullptr));
+  ASSERT_EQ(2, rids.size());
+  ASSERT_EQ(RowId(1, 5).Get(), rids[0].Get());
+  ASSERT_EQ(RowId(1, 305).Get(), rids[1].Get());
+  // cut short inside the last delta, or claiming more row ids than it holds
+  for (size_t length : {record.size() - 1, size_t(2)}) {
+    rids.clear();
+    ASSERT_THROW(PostingList::LoadFirst(record.data(), length, rids, nullptr), std::runtime_error);
+  }
+  record[1] = 3;
+  rids.clear();
+  ASSERT_THROW(PostingList::LoadFirst(record.data(), record.size(), rids, nullptr), std::runtime_error);
+}
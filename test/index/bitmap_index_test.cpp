@@ -0,0 +1,77 @@
+#include "index/bitmap_index.h"
+
+#include <string>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+
+static const std::string db_name = "bitmap_index_test.db";
+
+TEST(BitmapIndexTests, BitmapIndexSimpleTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("status", TypeId::kTypeChar, 8, 1, false, false)};
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BitmapIndex(0, index_schema, engine.bpm_);
+  // three statuses spread over 100 heap pages of 60 slots
+  const char *statuses[] = {"new", "open", "closed"};
+  auto status_row = [&](int i) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(statuses[i]), strlen(statuses[i]), true)};
+    return Row(fields);
+  };
+  for (int page = 0; page < 100; page++) {
+    for (int slot = 0; slot < 60; slot++) {
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(status_row((page + slot) % 3), RowId(page, slot), nullptr));
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(status_row(i), ret, nullptr));
+    ASSERT_EQ(2000, ret.size());
+    for (auto &rid : ret) {
+      ASSERT_EQ(i, (rid.GetPageId() + rid.GetSlotNum()) % 3);
+    }
+  }
+  // a slot is only set once, and a far slot grows the page bitset and shrinks it again
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(status_row(1), RowId(0, 1), nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntry(status_row(1), RowId(0, 200), nullptr));
+  {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(status_row(1), ret, nullptr));
+    ASSERT_EQ(2001, ret.size());
+  }
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(status_row(1), RowId(0, 200), nullptr));
+  // a cursor hands its pages over to a bitmap
+  {
+    Row open = status_row(1);
+    RowIdBitmap bitmap;
+    index->Scan(&open, true, &open, true, nullptr)->CollectRowIds(&bitmap);
+    ASSERT_EQ(2000, bitmap.Cardinality());
+    ASSERT_TRUE(bitmap.Contains(RowId(0, 1)));
+    ASSERT_FALSE(bitmap.Contains(RowId(0, 2)));
+  }
+  // keys are ordered, "closed" < "new" < "open"
+  {
+    Row closed = status_row(2);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(closed, ret, nullptr, ">"));
+    ASSERT_EQ(4000, ret.size());
+  }
+  // removing every row of a page drops its entries
+  for (int slot = 0; slot < 60; slot++) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(status_row(slot % 3), RowId(0, slot), nullptr));
+  }
+  {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(status_row(0), ret, nullptr));
+    ASSERT_EQ(1980, ret.size());
+    for (auto &rid : ret) {
+      ASSERT_NE(0, rid.GetPageId());
+    }
+  }
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  delete index;
+  delete index_schema;
+}
@@ -0,0 +1,111 @@
+#include "index/extendible_hash_index.h"
+
+#include <string>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/generic_key.h"
+
+static const std::string db_name = "hash_index_test.db";
+
+TEST(ExtendibleHashTests, ExtendibleHashIndexSimpleTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new ExtendibleHashIndex(0, index_schema, 16, engine.bpm_);
+  // enough keys to split buckets many times over
+  const int n = 20000;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 7)};
+    Row row(fields);
+    ASSERT_EQ(DB_FAILED, index->InsertEntry(row, RowId(0, 0), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(1000 + i / 100, i % 100).Get(), ret[0].Get());
+  }
+  // ranges are answered by filtering every bucket
+  {
+    std::vector<Field> lower_fields{Field(TypeId::kTypeInt, 100)};
+    std::vector<Field> upper_fields{Field(TypeId::kTypeInt, 200)};
+    Row lower(lower_fields), upper(upper_fields);
+    auto cursor = index->Scan(&lower, true, &upper, false, nullptr);
+    int count = 0;
+    RowId rid;
+    while (cursor->Next(&rid)) count++;
+    ASSERT_EQ(100, count);
+  }
+  // remove every other key, the rest must still be found
+  for (int i = 0; i < n; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(i % 2 ? DB_SUCCESS : DB_KEY_NOT_FOUND, index->ScanKey(row, ret, nullptr));
+  }
+  for (int i = 1; i < n; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  {
+    auto cursor = index->Scan(nullptr, true, nullptr, true, nullptr);
+    RowId rid;
+    ASSERT_FALSE(cursor->Next(&rid));
+  }
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  delete index;
+}
+
+TEST(ExtendibleHashTests, ExtendibleHashIndexNonUniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new ExtendibleHashIndex(0, index_schema, 16, engine.bpm_, false);
+  // more copies of one key than a bucket holds, they can only go to overflow pages
+  const int copies = 1000;
+  for (int k = 0; k < 3; k++) {
+    for (int i = 0; i < copies; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+      Row row(fields);
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(k, i), nullptr));
+    }
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 1)};
+  Row row(fields);
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(row, RowId(1, 5), nullptr));
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+  ASSERT_EQ(copies, ret.size());
+  for (int i = 0; i < copies; i += 3) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1, i), nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+  ASSERT_EQ(copies - (copies + 2) / 3, ret.size());
+  for (auto &rid : ret) {
+    ASSERT_NE(0, rid.GetSlotNum() % 3);
+    ASSERT_EQ(1, rid.GetPageId());
+  }
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  delete index;
+}
@@ -0,0 +1,108 @@
+#include "index/learned_index.h"
+
+#include <limits>
+#include <map>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace {
+Row MakeKey(int32_t value) {
+  std::vector<Field> fields;
+  fields.emplace_back(TypeId::kTypeInt, value);
+  return Row(fields);
+}
+
+/** Every entry of [lower, upper] in key order, then row id order */
+void ExpectRange(const std::multimap<int32_t, int64_t> &expected, LearnedIndex &index, int32_t lower, int32_t upper) {
+  Row lower_key = MakeKey(lower);
+  Row upper_key = MakeKey(upper);
+  auto cursor = index.Scan(&lower_key, true, &upper_key, true, nullptr);
+  RowId rid;
+  Row entry;
+  for (auto it = expected.lower_bound(lower); it != expected.end() && it->first <= upper; ++it) {
+    ASSERT_TRUE(cursor->NextEntry(&rid, &entry));
+    ASSERT_EQ(it->second, rid.Get());
+    ASSERT_TRUE(entry.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, it->first)) == CmpBool::kTrue);
+  }
+  ASSERT_FALSE(cursor->Next(&rid));
+}
+}  // namespace
+
+TEST(LearnedIndexTests, MonotonicKeyTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  LearnedIndex index(0, key_schema, true);
+  std::multimap<int32_t, int64_t> expected;
+  // ids grow with gaps, the way an auto increment column with failed inserts does
+  std::mt19937 rng(3);
+  int32_t id = -1000;
+  for (int i = 0; i < 100000; i++) {
+    id += 1 + (rng() % 8 == 0 ? rng() % 50 : 0);
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(MakeKey(id), RowId(i), nullptr));
+    expected.emplace(id, i);
+  }
+  ASSERT_EQ(DB_FAILED, index.InsertEntry(MakeKey(id), RowId(0), nullptr));
+  index.Retrain();
+  // a near linear key space needs few segments, far less than the keys themselves
+  ASSERT_LT(index.GetSplinePointCount(), 2000);
+  for (auto &pair : expected) {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index.ScanKey(MakeKey(pair.first), ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(pair.second, ret[0].Get());
+  }
+  for (int i = 0; i < 100; i++) {
+    int32_t lower = -2000 + static_cast<int32_t>(rng() % (id + 3000));
+    ExpectRange(expected, index, lower, lower + rng() % 500);
+  }
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(MakeKey(id + 1), ret, nullptr));
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(MakeKey(0), ret, nullptr, "<"));
+  ASSERT_EQ(expected.lower_bound(0)->second, ret.size());
+  delete key_schema;
+}
+
+TEST(LearnedIndexTests, DeltaAndRetrainTest) {
+  std::vector<Column *> columns = {new Column("v", TypeId::kTypeInt, 0, false, false)};
+  Schema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0});
+  LearnedIndex index(0, key_schema, false);
+  std::multimap<int32_t, int64_t> expected;
+  std::mt19937 rng(5);
+  // skewed keys with long runs of duplicates, inserted and removed in random order
+  auto random_key = [&]() {
+    return rng() % 4 == 0 ? static_cast<int32_t>(rng() % 10) : static_cast<int32_t>(rng() % 100000) * 1000;
+  };
+  for (int i = 0; i < 60000; i++) {
+    if (rng() % 3 == 0 && !expected.empty()) {
+      auto it = expected.lower_bound(random_key());
+      if (it == expected.end()) {
+        it = expected.begin();
+      }
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(MakeKey(it->first), RowId(it->second), nullptr));
+      expected.erase(it);
+    } else {
+      int32_t key = random_key();
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(MakeKey(key), RowId(i), nullptr));
+      expected.emplace(key, i);
+    }
+    if (i % 10000 == 0) {
+      ExpectRange(expected, index, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
+    }
+  }
+  for (int i = 0; i < 200; i++) {
+    int32_t lower = random_key() - static_cast<int32_t>(rng() % 3);
+    ExpectRange(expected, index, lower, lower + static_cast<int32_t>(rng() % 5000));
+  }
+  index.Retrain();
+  ExpectRange(expected, index, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(MakeKey(3), ret, nullptr));
+  ASSERT_EQ(expected.count(3), ret.size());
+  ASSERT_EQ(DB_SUCCESS, index.Destroy());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(MakeKey(3), ret, nullptr, ">="));
+  delete key_schema;
+}
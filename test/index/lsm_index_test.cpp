@@ -0,0 +1,150 @@
+#include "index/lsm_index.h"
+
+#include <map>
+#include <random>
+#include <string>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+
+static const std::string db_name = "lsm_index_test.db";
+
+namespace {
+void ExpectSameOrder(const std::map<std::string, int64_t> &expected, LsmTree::Iterator iter) {
+  for (auto &pair : expected) {
+    const LsmEntry *entry = iter.Next();
+    ASSERT_NE(nullptr, entry);
+    ASSERT_EQ(pair.first, entry->key);
+    ASSERT_EQ(pair.second, entry->value.Get());
+  }
+  ASSERT_EQ(nullptr, iter.Next());
+}
+
+void ExpectSameContents(const std::map<std::string, int64_t> &expected, LsmTree &tree, std::mt19937 &rng) {
+  ExpectSameOrder(expected, tree.Seek(""));
+  RowId value;
+  for (auto &pair : expected) {
+    ASSERT_TRUE(tree.Get(pair.first, &value));
+    ASSERT_EQ(pair.second, value.Get());
+  }
+  for (int i = 0; i < 50; i++) {
+    std::string bound = "k" + std::to_string(rng() % 5000);
+    ExpectSameOrder(std::map<std::string, int64_t>(expected.lower_bound(bound), expected.end()), tree.Seek(bound));
+  }
+}
+}  // namespace
+
+TEST(LsmIndexTests, LsmTreeTest) {
+  std::mt19937 rng(11);
+  std::map<std::string, int64_t> expected;
+  {
+    DBStorageEngine engine(db_name);
+    {
+      LsmTree tree(0, engine.bpm_, 0, 256);
+      // overwrite and delete keys spread over many flushed runs and compactions
+      for (int i = 0; i < 40000; i++) {
+        std::string key = "k" + std::to_string(rng() % 5000);
+        RowId value;
+        if (rng() % 3 == 0) {
+          tree.Delete(key);
+          expected.erase(key);
+          ASSERT_FALSE(tree.Get(key, &value));
+        } else {
+          tree.Put(key, RowId(i));
+          expected[key] = i;
+          ASSERT_TRUE(tree.Get(key, &value));
+          ASSERT_EQ(i, value.Get());
+        }
+      }
+      tree.WaitForCompaction();
+      ASSERT_LT(tree.GetRunCount(), LsmTree::LEVEL0_RUN_LIMIT + 3);
+      ExpectSameContents(expected, tree, rng);
+    }
+    // the memtable was written out on close, the manifest lists every run
+    LsmTree tree(0, engine.bpm_, 0, 256);
+    ExpectSameContents(expected, tree, rng);
+  }
+  DBStorageEngine engine(db_name, false);
+  LsmTree tree(0, engine.bpm_, 0, 256);
+  ExpectSameContents(expected, tree, rng);
+  tree.Destroy();
+}
+
+TEST(LsmIndexTests, LsmIndexScanTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false),
+                                   new Column("b", TypeId::kTypeInt, 1, false, false)};
+  Schema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0, 1});
+  LsmIndex unique_index(0, key_schema, engine.bpm_, true, 64);
+  LsmIndex index(1, key_schema, engine.bpm_, false, 64);
+  auto make_key = [](std::vector<int32_t> values) {
+    std::vector<Field> fields;
+    for (auto v : values) {
+      fields.emplace_back(TypeId::kTypeInt, v);
+    }
+    return Row(fields);
+  };
+  // (a, b) for a in [-50, 50), b in [0, 10), every key twice in the non-unique index
+  for (int a = -50; a < 50; a++) {
+    for (int b = 0; b < 10; b++) {
+      Row key = make_key({a, b});
+      RowId rid((a + 50) * 10 + b, 0);
+      ASSERT_EQ(DB_SUCCESS, unique_index.InsertEntry(key, rid, nullptr));
+      ASSERT_EQ(DB_FAILED, unique_index.InsertEntry(key, RowId(0, 1), nullptr));
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(key, rid, nullptr));
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(key, RowId(rid.GetPageId(), 1), nullptr));
+    }
+  }
+  ASSERT_GT(index.GetTree().GetRunCount(), 0);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, unique_index.ScanKey(make_key({-3, 4}), ret, nullptr));
+  ASSERT_EQ(1, ret.size());
+  ASSERT_EQ(RowId(474, 0), ret[0]);
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key({-3, 4}), ret, nullptr));
+  ASSERT_EQ(2, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, unique_index.ScanKey(make_key({60, 0}), ret, nullptr));
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(make_key({60, 0}), ret, nullptr));
+
+  // a = 7 and b > 2 and b <= 5, in key order, with the entries rebuilt from the keys
+  Row lower = make_key({7, 2});
+  Row upper = make_key({7, 5});
+  auto cursor = unique_index.Scan(&lower, false, &upper, true, nullptr);
+  RowId rid;
+  Row entry;
+  for (int b = 3; b <= 5; b++) {
+    ASSERT_TRUE(cursor->NextEntry(&rid, &entry));
+    ASSERT_EQ(RowId(570 + b, 0), rid);
+    ASSERT_TRUE(entry.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 7)) == CmpBool::kTrue);
+    ASSERT_TRUE(entry.GetField(1)->CompareEquals(Field(TypeId::kTypeInt, b)) == CmpBool::kTrue);
+  }
+  ASSERT_FALSE(cursor->Next(&rid));
+
+  // a prefix bound takes every b, negative values sort first
+  Row prefix = make_key({-1});
+  cursor = index.Scan(nullptr, false, &prefix, false, nullptr);
+  int count = 0;
+  while (cursor->Next(&rid)) {
+    count++;
+  }
+  ASSERT_EQ(49 * 10 * 2, count);
+
+  // removing a unique key for another row leaves it alone
+  ASSERT_EQ(DB_SUCCESS, unique_index.RemoveEntry(make_key({0, 0}), RowId(0, 1), nullptr));
+  ASSERT_EQ(DB_SUCCESS, unique_index.ScanKey(make_key({0, 0}), ret, nullptr));
+  ret.clear();
+  for (int b = 0; b < 10; b++) {
+    ASSERT_EQ(DB_SUCCESS, unique_index.RemoveEntry(make_key({0, b}), RowId(500 + b, 0), nullptr));
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(make_key({0, b}), RowId(500 + b, 0), nullptr));
+  }
+  ASSERT_EQ(DB_KEY_NOT_FOUND, unique_index.ScanKey(make_key({0}), ret, nullptr));
+  ASSERT_EQ(DB_SUCCESS, index.ScanKey(make_key({0}), ret, nullptr));
+  ASSERT_EQ(10, ret.size());
+  ASSERT_EQ(DB_SUCCESS, unique_index.Destroy());
+  ASSERT_EQ(DB_SUCCESS, index.Destroy());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(make_key({0}), ret, nullptr, ">="));
+  delete key_schema;
+}